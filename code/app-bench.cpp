@@ -0,0 +1,693 @@
+// SPDX-License-Identifier: zlib-acknowledgement
+
+// NOTE(Ryan): Headless timings of the app-ecs.h systems against the entity linked list they replaced,
+// on the same generated population, so the storage can be measured without a window or renderer.
+// Each system's median ns/entity with archetypes is appended to <metric_dir>/app-<system>.metric.
+// Collision is timed separately at fixed collider counts, grid against the all-pairs loop it replaced,
+// with median ms/frame appended to <metric_dir>/app-collision-<count>.metric.
+// The same systems app_update() schedules are then run serially and through app-schedule.h on every core,
+// checked to leave bit-identical worlds, with the scheduled median ms/frame appended to <metric_dir>/app-schedule.metric
+
+#include "base-inc.h"
+#include "app-ecs.h"
+#include "app-schedule.h"
+
+// NOTE(Ryan): Entity as app.h used to store it; every component inline, linked in whatever order the last sort left
+typedef struct LegacyEntity LegacyEntity;
+struct LegacyEntity
+{
+  ENTITY_COMPONENT_FLAG component_flags;
+
+  LegacyEntity *next, *prev;
+
+  TransformComponent transform_component;
+  SpriteComponent sprite_component;
+  BoxColliderComponent box_collider_component;
+  RigidBodyComponent rigid_body_component;
+  AnimationComponent animation_component;
+};
+
+typedef struct LegacyEntityList LegacyEntityList;
+struct LegacyEntityList
+{
+  LegacyEntity *first;
+  LegacyEntity *last;
+};
+
+INTERNAL void
+legacy_update_movement(LegacyEntityList *list, f32 delta)
+{
+  for (LegacyEntity *entity = list->first; entity != NULL; entity = entity->next)
+  {
+    if (HAS_FLAGS_ALL(entity->component_flags, (ENTITY_COMPONENT_FLAG_TRANSFORM | ENTITY_COMPONENT_FLAG_RIGID_BODY)))
+    {
+      entity->transform_component.position += entity->rigid_body_component.velocity * delta;
+    }
+  }
+}
+
+INTERNAL void
+legacy_update_animation(LegacyEntityList *list, u64 ms)
+{
+  for (LegacyEntity *entity = list->first; entity != NULL; entity = entity->next)
+  {
+    if (HAS_FLAGS_ALL(entity->component_flags, (ENTITY_COMPONENT_FLAG_SPRITE | ENTITY_COMPONENT_FLAG_ANIMATION)))
+    {
+      AnimationComponent *anim = &entity->animation_component;
+
+      u32 time_elapsed = (u32)(ms - anim->start_time);
+
+      anim->current_frame = (u32)(time_elapsed * (anim->frame_rate / 1000.0f)) % anim->num_frames;
+
+      entity->sprite_component.texture_offset.x = (i32)(anim->current_frame * entity->sprite_component.dimensions.w);
+    }
+  }
+}
+
+INTERNAL LegacyEntity *
+legacy_get_middle_entity(LegacyEntity *first)
+{
+  LegacyEntity *slow = first, *fast = first->next;
+
+  while (fast != NULL && fast->next != NULL)
+  {
+    slow = slow->next;
+    fast = fast->next->next;
+  }
+
+  return slow;
+}
+
+INTERNAL LegacyEntity *
+legacy_sorted_merge(LegacyEntity *left, LegacyEntity *right)
+{
+  LegacyEntity *first = NULL, *last = NULL;
+
+  while (left != NULL && right != NULL)
+  {
+    if (left->sprite_component.z_index < right->sprite_component.z_index)
+    {
+      LegacyEntity *next = left->next;
+      DLL_PUSH_BACK(first, last, left);
+      left = next;
+    }
+    else
+    {
+      LegacyEntity *next = right->next;
+      DLL_PUSH_BACK(first, last, right);
+      right = next;
+    }
+  }
+
+  while (left != NULL)
+  {
+    LegacyEntity *next = left->next;
+    DLL_PUSH_BACK(first, last, left);
+    left = next;
+  }
+
+  while (right != NULL)
+  {
+    LegacyEntity *next = right->next;
+    DLL_PUSH_BACK(first, last, right);
+    right = next;
+  }
+
+  return first;
+}
+
+INTERNAL LegacyEntity *
+legacy_sort_entities_by_z_index(LegacyEntity *first)
+{
+  LegacyEntity *result = first;
+
+  if (first != NULL && first->next != NULL)
+  {
+    LegacyEntity *one_before_midpoint = legacy_get_middle_entity(first);
+    LegacyEntity *right = one_before_midpoint->next;
+    one_before_midpoint->next = NULL;
+
+    LegacyEntity *left = legacy_sort_entities_by_z_index(first);
+    right = legacy_sort_entities_by_z_index(right);
+
+    result = legacy_sorted_merge(left, right);
+  }
+
+  return result;
+}
+
+// NOTE(Ryan): Sorts list in place as app() did, then walks it for draws
+INTERNAL SpriteDrawList
+legacy_build_sprite_draws(MemArena *arena, LegacyEntityList *list, u32 entity_count)
+{
+  SpriteDrawList result = ZERO_STRUCT;
+  result.draws = MEM_ARENA_PUSH_ARRAY(arena, SpriteDraw, entity_count);
+
+  list->first = legacy_sort_entities_by_z_index(list->first);
+
+  for (LegacyEntity *entity = list->first; entity != NULL; entity = entity->next)
+  {
+    if (HAS_FLAGS_ALL(entity->component_flags, (ENTITY_COMPONENT_FLAG_TRANSFORM | ENTITY_COMPONENT_FLAG_SPRITE)))
+    {
+      SpriteDraw *draw = &result.draws[result.count++];
+      draw->texture_key = entity->sprite_component.texture_key;
+      draw->position = entity->transform_component.position;
+      draw->dimensions = vec2_f32_hadamard(entity->sprite_component.dimensions, entity->transform_component.scale);
+      draw->texture_offset = entity->sprite_component.texture_offset;
+    }
+  }
+
+  return result;
+}
+
+typedef struct AppBenchArchetype AppBenchArchetype;
+struct AppBenchArchetype
+{
+  ENTITY_COMPONENT_FLAG component_flags;
+  u32 weight;
+};
+
+// NOTE(Ryan): Roughly the mix of the level in app_update(): mostly vehicles, some animated, some static scenery
+GLOBAL AppBenchArchetype app_bench_archetypes[] = {
+  {ENTITY_COMPONENT_FLAG_TRANSFORM | ENTITY_COMPONENT_FLAG_RIGID_BODY | ENTITY_COMPONENT_FLAG_SPRITE, 4},
+  {ENTITY_COMPONENT_FLAG_TRANSFORM | ENTITY_COMPONENT_FLAG_RIGID_BODY | ENTITY_COMPONENT_FLAG_SPRITE |
+   ENTITY_COMPONENT_FLAG_BOX_COLLIDER, 2},
+  {ENTITY_COMPONENT_FLAG_TRANSFORM | ENTITY_COMPONENT_FLAG_RIGID_BODY | ENTITY_COMPONENT_FLAG_SPRITE |
+   ENTITY_COMPONENT_FLAG_ANIMATION, 2},
+  {ENTITY_COMPONENT_FLAG_TRANSFORM | ENTITY_COMPONENT_FLAG_SPRITE, 2},
+};
+
+// NOTE(Ryan): Changing any of these makes new results incomparable with what's already in the .metric files
+#define APP_BENCH_SEED 0x41505042
+#define APP_BENCH_Z_INDEX_COUNT 8
+#define APP_BENCH_FRAME_MS 16
+
+// NOTE(Ryan): Same seed, so both storages get identical entities in identical creation order
+INTERNAL void
+app_bench_populate(MemArena *arena, u32 entity_count, LegacyEntityList *list, EntityWorld *world)
+{
+  u32 total_weight = 0;
+  for (u32 archetype_i = 0; archetype_i < ARRAY_COUNT(app_bench_archetypes); archetype_i += 1)
+  {
+    total_weight += app_bench_archetypes[archetype_i].weight;
+  }
+
+  u32 seed = APP_BENCH_SEED;
+  for (u32 entity_i = 0; entity_i < entity_count; entity_i += 1)
+  {
+    u32 pick = u32_rand_range(&seed, total_weight);
+    ENTITY_COMPONENT_FLAG component_flags = 0;
+    for (u32 archetype_i = 0; archetype_i < ARRAY_COUNT(app_bench_archetypes); archetype_i += 1)
+    {
+      if (pick < app_bench_archetypes[archetype_i].weight)
+      {
+        component_flags = app_bench_archetypes[archetype_i].component_flags;
+        break;
+      }
+      pick -= app_bench_archetypes[archetype_i].weight;
+    }
+
+    LegacyEntity entity = ZERO_STRUCT;
+    entity.component_flags = component_flags;
+    entity.transform_component.position = vec2_f32(f32_rand_range(&seed, 0.0f, 1280.0f),
+                                                   f32_rand_range(&seed, 0.0f, 720.0f));
+    entity.transform_component.scale = vec2_f32(1.0f, 1.0f);
+    entity.rigid_body_component.velocity = vec2_f32(f32_rand_bilateral(&seed) * 10.0f, f32_rand_bilateral(&seed) * 10.0f);
+    entity.sprite_component.dimensions = vec2_f32(32.0f, 32.0f);
+    entity.sprite_component.z_index = u32_rand_range(&seed, APP_BENCH_Z_INDEX_COUNT);
+    entity.box_collider_component.size = entity.sprite_component.dimensions;
+    entity.animation_component.num_frames = 2;
+    entity.animation_component.frame_rate = 10;
+    entity.animation_component.should_loop = true;
+
+    LegacyEntity *legacy_entity = MEM_ARENA_PUSH_STRUCT(arena, LegacyEntity);
+    *legacy_entity = entity;
+    DLL_PUSH_BACK(list->first, list->last, legacy_entity);
+
+    EntitySlot *slot = entity_slot(world, entity_create(world, component_flags));
+    EntityArchetype *archetype = &world->archetypes[slot->archetype_index];
+    u32 row = slot->row;
+    archetype->transforms[row] = entity.transform_component;
+    archetype->sprites[row] = entity.sprite_component;
+    if (archetype->rigid_bodies != NULL)
+    {
+      archetype->rigid_bodies[row] = entity.rigid_body_component;
+    }
+    if (archetype->animations != NULL)
+    {
+      archetype->animations[row] = entity.animation_component;
+    }
+    if (archetype->box_colliders != NULL)
+    {
+      archetype->box_colliders[row] = entity.box_collider_component;
+    }
+  }
+}
+
+// NOTE(Ryan): Order independent, so list and archetype draws can be compared
+INTERNAL f64
+sprite_draw_list_checksum(SpriteDrawList *draws)
+{
+  f64 result = 0.0;
+
+  for (u32 draw_i = 0; draw_i < draws->count; draw_i += 1)
+  {
+    SpriteDraw *draw = &draws->draws[draw_i];
+    result += (f64)draw->position.x + (f64)draw->position.y + (f64)draw->texture_offset.x;
+  }
+
+  return result;
+}
+
+typedef u32 APP_BENCH_SYSTEM;
+enum
+{
+  APP_BENCH_SYSTEM_MOVEMENT,
+  APP_BENCH_SYSTEM_ANIMATION,
+  APP_BENCH_SYSTEM_RENDER,
+  APP_BENCH_SYSTEM_COUNT,
+};
+
+GLOBAL const char *app_bench_system_names[APP_BENCH_SYSTEM_COUNT] = {"movement", "animation", "render"};
+
+// NOTE(Ryan): A run is a frame of each system on both storages; render is the z sort plus building draws
+INTERNAL void
+run_app_bench(MemArena *arena, u32 entity_count, u32 warmup_count, u32 run_count, const char *metric_dir)
+{
+  printf("App bench: %u entities, %u warmups + %u runs\n", entity_count, warmup_count, run_count);
+
+  LegacyEntityList list = ZERO_STRUCT;
+  EntityWorld *world = entity_world_create(arena, entity_count);
+  app_bench_populate(arena, entity_count, &list, world);
+
+  u64 *list_ns[APP_BENCH_SYSTEM_COUNT] = ZERO_STRUCT;
+  u64 *archetype_ns[APP_BENCH_SYSTEM_COUNT] = ZERO_STRUCT;
+  for (u32 system_i = 0; system_i < APP_BENCH_SYSTEM_COUNT; system_i += 1)
+  {
+    list_ns[system_i] = MEM_ARENA_PUSH_ARRAY_ZERO(arena, u64, run_count);
+    archetype_ns[system_i] = MEM_ARENA_PUSH_ARRAY_ZERO(arena, u64, run_count);
+  }
+
+  f32 delta = APP_BENCH_FRAME_MS / 1000.0f;
+  f64 list_checksum = 0.0;
+  f64 archetype_checksum = 0.0;
+  for (u32 run_i = 0; run_i < warmup_count + run_count; run_i += 1)
+  {
+    u64 ms = (u64)(run_i + 1) * APP_BENCH_FRAME_MS;
+    u64 system_ns[APP_BENCH_SYSTEM_COUNT] = ZERO_STRUCT;
+    u64 start_ns = 0;
+
+    MemArenaTemp temp = mem_arena_temp_begin(arena);
+
+    start_ns = linux_get_ns();
+    legacy_update_movement(&list, delta);
+    system_ns[APP_BENCH_SYSTEM_MOVEMENT] = linux_get_ns() - start_ns;
+
+    start_ns = linux_get_ns();
+    legacy_update_animation(&list, ms);
+    system_ns[APP_BENCH_SYSTEM_ANIMATION] = linux_get_ns() - start_ns;
+
+    start_ns = linux_get_ns();
+    SpriteDrawList list_draws = legacy_build_sprite_draws(arena, &list, entity_count);
+    system_ns[APP_BENCH_SYSTEM_RENDER] = linux_get_ns() - start_ns;
+    list_checksum = sprite_draw_list_checksum(&list_draws);
+
+    if (run_i >= warmup_count)
+    {
+      for (u32 system_i = 0; system_i < APP_BENCH_SYSTEM_COUNT; system_i += 1)
+      {
+        list_ns[system_i][run_i - warmup_count] = system_ns[system_i];
+      }
+    }
+
+    start_ns = linux_get_ns();
+    entity_update_movement(world, delta);
+    system_ns[APP_BENCH_SYSTEM_MOVEMENT] = linux_get_ns() - start_ns;
+
+    start_ns = linux_get_ns();
+    entity_update_animation(world, ms);
+    system_ns[APP_BENCH_SYSTEM_ANIMATION] = linux_get_ns() - start_ns;
+
+    start_ns = linux_get_ns();
+    SpriteDrawList archetype_draws = entity_build_sprite_draws(arena, world);
+    system_ns[APP_BENCH_SYSTEM_RENDER] = linux_get_ns() - start_ns;
+    archetype_checksum = sprite_draw_list_checksum(&archetype_draws);
+
+    if (run_i >= warmup_count)
+    {
+      for (u32 system_i = 0; system_i < APP_BENCH_SYSTEM_COUNT; system_i += 1)
+      {
+        archetype_ns[system_i][run_i - warmup_count] = system_ns[system_i];
+      }
+    }
+
+    mem_arena_temp_end(temp);
+  }
+
+  // NOTE(Ryan): Float sums in different orders, so only close
+  if (fabs(list_checksum - archetype_checksum) > 1e-6 * fabs(list_checksum))
+  {
+    WARN("Archetype draws differ from list draws", "results are not comparable");
+  }
+
+  for (u32 system_i = 0; system_i < APP_BENCH_SYSTEM_COUNT; system_i += 1)
+  {
+    u64 list_median_ns = u64_percentile(list_ns[system_i], run_count, 50);
+    u64 archetype_median_ns = u64_percentile(archetype_ns[system_i], run_count, 50);
+    f64 list_ns_per_entity = (f64)list_median_ns / entity_count;
+    f64 archetype_ns_per_entity = (f64)archetype_median_ns / entity_count;
+
+    printf("  %-9s: list %8.1fus (%6.2fns/entity), archetype %8.1fus (%6.2fns/entity), %5.1fx\n",
+           app_bench_system_names[system_i], list_median_ns / 1000.0, list_ns_per_entity,
+           archetype_median_ns / 1000.0, archetype_ns_per_entity, list_ns_per_entity / archetype_ns_per_entity);
+
+    char metric_file_name[256] = ZERO_STRUCT;
+    snprintf(metric_file_name, sizeof(metric_file_name), "%s/app-%s.metric", metric_dir,
+             app_bench_system_names[system_i]);
+    char metric[64] = ZERO_STRUCT;
+    snprintf(metric, sizeof(metric), "%.4f\n", archetype_ns_per_entity);
+    s8_append_to_file(s8_cstring(metric_file_name), s8_cstring(metric));
+  }
+}
+
+// NOTE(Ryan): Changing any of these makes new results incomparable with what's already in the .metric files
+#define APP_BENCH_COLLIDER_SPACING 64.0f // world side is sqrt(count) * spacing, so density is the same at every count
+#define APP_BENCH_COLLIDER_MIN_SIZE 16.0f
+#define APP_BENCH_COLLIDER_MAX_SIZE 48.0f
+#define APP_BENCH_COLLISION_CELL_SIZE 96.0f
+// NOTE(Ryan): All pairs at 100k is 5 billion tests a frame, i.e. seconds per run
+#define APP_BENCH_ALL_PAIRS_MAX_COLLIDERS 10000
+
+GLOBAL u32 app_bench_collider_counts[] = {1000, 10000, 100000};
+
+// NOTE(Ryan): The nested loop app() used before the broad phase, on the same gathered bounds
+INTERNAL CollisionPairs
+collision_all_pairs(MemArena *arena, ColliderSet *colliders)
+{
+  CollisionPairs result = ZERO_STRUCT;
+
+  u32 pair_count = 0;
+  for (u32 fill = 0; fill < 2; fill += 1)
+  {
+    if (fill == 1)
+    {
+      result.a = MEM_ARENA_PUSH_ARRAY(arena, u32, pair_count);
+      result.b = MEM_ARENA_PUSH_ARRAY(arena, u32, pair_count);
+    }
+
+    for (u32 a = 0; a < colliders->count; a += 1)
+    {
+      for (u32 b = a + 1; b < colliders->count; b += 1)
+      {
+        if (colliders->min_x[a] < colliders->max_x[b] && colliders->min_x[b] < colliders->max_x[a] &&
+            colliders->min_y[a] < colliders->max_y[b] && colliders->min_y[b] < colliders->max_y[a])
+        {
+          if (fill == 1)
+          {
+            result.a[result.count] = a;
+            result.b[result.count] = b;
+            result.count += 1;
+          }
+          else
+          {
+            pair_count += 1;
+          }
+        }
+      }
+    }
+  }
+
+  return result;
+}
+
+// NOTE(Ryan): Order independent, so grid and all-pairs results can be compared
+INTERNAL u64
+collision_pairs_checksum(CollisionPairs *pairs)
+{
+  u64 result = 0;
+
+  for (u32 pair_i = 0; pair_i < pairs->count; pair_i += 1)
+  {
+    result += ((u64)pairs->a[pair_i] << 32) | pairs->b[pair_i];
+  }
+
+  return result;
+}
+
+// NOTE(Ryan): A frame is gathering bounds from the world, then either the broad and narrow phase or all pairs
+INTERNAL void
+run_collision_bench(MemArena *arena, u32 collider_count, u32 warmup_count, u32 run_count, const char *metric_dir)
+{
+  MemArenaTemp bench_temp = mem_arena_temp_begin(arena);
+
+  EntityWorld *world = entity_world_create(arena, collider_count);
+  f32 world_side = f32_sqrt((f32)collider_count) * APP_BENCH_COLLIDER_SPACING;
+  u32 seed = APP_BENCH_SEED;
+  for (u32 collider_i = 0; collider_i < collider_count; collider_i += 1)
+  {
+    EntitySlot *slot = entity_slot(world, entity_create(world, ENTITY_COMPONENT_FLAG_TRANSFORM | ENTITY_COMPONENT_FLAG_BOX_COLLIDER));
+    EntityArchetype *archetype = &world->archetypes[slot->archetype_index];
+    archetype->transforms[slot->row].position = vec2_f32(f32_rand_range(&seed, 0.0f, world_side),
+                                                         f32_rand_range(&seed, 0.0f, world_side));
+    archetype->transforms[slot->row].scale = vec2_f32(1.0f, 1.0f);
+    archetype->box_colliders[slot->row].size = \
+      vec2_f32(f32_rand_range(&seed, APP_BENCH_COLLIDER_MIN_SIZE, APP_BENCH_COLLIDER_MAX_SIZE),
+               f32_rand_range(&seed, APP_BENCH_COLLIDER_MIN_SIZE, APP_BENCH_COLLIDER_MAX_SIZE));
+  }
+
+  b32 run_all_pairs = (collider_count <= APP_BENCH_ALL_PAIRS_MAX_COLLIDERS);
+  u64 *grid_ns = MEM_ARENA_PUSH_ARRAY_ZERO(arena, u64, run_count);
+  u64 *all_pairs_ns = MEM_ARENA_PUSH_ARRAY_ZERO(arena, u64, run_count);
+  u32 candidate_count = 0;
+  CollisionPairs grid_pairs = ZERO_STRUCT;
+  u64 grid_checksum = 0;
+  u64 all_pairs_checksum = 0;
+  for (u32 run_i = 0; run_i < warmup_count + run_count; run_i += 1)
+  {
+    MemArenaTemp temp = mem_arena_temp_begin(arena);
+
+    u64 start_ns = linux_get_ns();
+    ColliderSet colliders = entity_gather_colliders(arena, world);
+    CollisionCandidates candidates = collision_broad_phase(arena, &colliders, APP_BENCH_COLLISION_CELL_SIZE);
+    grid_pairs = collision_narrow_phase(arena, &candidates);
+    u64 frame_ns = linux_get_ns() - start_ns;
+    candidate_count = candidates.count;
+    grid_checksum = collision_pairs_checksum(&grid_pairs);
+    if (run_i >= warmup_count)
+    {
+      grid_ns[run_i - warmup_count] = frame_ns;
+    }
+
+    if (run_all_pairs)
+    {
+      start_ns = linux_get_ns();
+      ColliderSet all_pairs_colliders = entity_gather_colliders(arena, world);
+      CollisionPairs all_pairs = collision_all_pairs(arena, &all_pairs_colliders);
+      frame_ns = linux_get_ns() - start_ns;
+      all_pairs_checksum = collision_pairs_checksum(&all_pairs);
+      if (run_i >= warmup_count)
+      {
+        all_pairs_ns[run_i - warmup_count] = frame_ns;
+      }
+    }
+
+    mem_arena_temp_end(temp);
+  }
+
+  f64 grid_median_ms = u64_percentile(grid_ns, run_count, 50) / 1000000.0;
+  printf("  collision %6u: grid %8.3fms (%u candidates, %u pairs)", collider_count, grid_median_ms,
+         candidate_count, grid_pairs.count);
+  if (run_all_pairs)
+  {
+    f64 all_pairs_median_ms = u64_percentile(all_pairs_ns, run_count, 50) / 1000000.0;
+    printf(", all pairs %9.3fms, %6.1fx\n", all_pairs_median_ms, all_pairs_median_ms / grid_median_ms);
+    if (grid_checksum != all_pairs_checksum)
+    {
+      WARN("Grid pairs differ from all pairs", "broad phase is missing or duplicating pairs");
+    }
+  }
+  else
+  {
+    printf(", all pairs skipped\n");
+  }
+
+  char metric_file_name[256] = ZERO_STRUCT;
+  snprintf(metric_file_name, sizeof(metric_file_name), "%s/app-collision-%u.metric", metric_dir, collider_count);
+  char metric[64] = ZERO_STRUCT;
+  snprintf(metric, sizeof(metric), "%.4f\n", grid_median_ms);
+  s8_append_to_file(s8_cstring(metric_file_name), s8_cstring(metric));
+
+  mem_arena_temp_end(bench_temp);
+}
+
+// NOTE(Ryan): Two identically populated worlds, so serial and scheduled frames start from the same state
+// and should end with the same draws and collisions
+INTERNAL void
+run_schedule_bench(MemArena *arena, u32 entity_count, u32 worker_count, u32 warmup_count, u32 run_count,
+                   const char *metric_dir)
+{
+  MemArenaTemp bench_temp = mem_arena_temp_begin(arena);
+
+  LegacyEntityList unused_list = ZERO_STRUCT;
+  EntityWorld *serial_world = entity_world_create(arena, entity_count);
+  app_bench_populate(arena, entity_count, &unused_list, serial_world);
+  EntityWorld *scheduled_world = entity_world_create(arena, entity_count);
+  app_bench_populate(arena, entity_count, &unused_list, scheduled_world);
+
+  JobSystem *job_system = job_system_create(arena, worker_count);
+  // NOTE(Ryan): app_bench_populate() packs every entity into one screen, so collision candidates grow with the square 
+  // of entity_count (~250MB at 100k). Other systems are linear, e.g. sprite draws are 120 bytes an entity
+  memory_index system_arena_size = MB(1) + (memory_index)entity_count * 256 + 
+                                   (memory_index)entity_count * entity_count / 32;
+  Schedule *schedule = schedule_create(arena, job_system, system_arena_size);
+  u64 *system_wall_ns[ARRAY_COUNT(app_systems)] = ZERO_STRUCT;
+  u64 *system_busy_ns[ARRAY_COUNT(app_systems)] = ZERO_STRUCT;
+  for (u32 system_i = 0; system_i < ARRAY_COUNT(app_systems); system_i += 1)
+  {
+    system_wall_ns[system_i] = MEM_ARENA_PUSH_ARRAY_ZERO(arena, u64, run_count);
+    system_busy_ns[system_i] = MEM_ARENA_PUSH_ARRAY_ZERO(arena, u64, run_count);
+  }
+
+  printf("Schedule bench: %u entities, %u workers, %u warmups + %u runs\n", entity_count, job_system->worker_count,
+         warmup_count, run_count);
+
+  u64 *serial_ns = MEM_ARENA_PUSH_ARRAY_ZERO(arena, u64, run_count);
+  u64 *scheduled_ns = MEM_ARENA_PUSH_ARRAY_ZERO(arena, u64, run_count);
+  AppSystemsState serial_systems = ZERO_STRUCT;
+  serial_systems.collision_cell_size = APP_BENCH_COLLISION_CELL_SIZE;
+  AppSystemsState scheduled_systems = serial_systems;
+  f64 serial_checksum = 0.0;
+  f64 scheduled_checksum = 0.0;
+  for (u32 run_i = 0; run_i < warmup_count + run_count; run_i += 1)
+  {
+    MemArenaTemp temp = mem_arena_temp_begin(arena);
+
+    SystemContext context = ZERO_STRUCT;
+    context.delta = APP_BENCH_FRAME_MS / 1000.0f;
+    context.ms = (u64)(run_i + 1) * APP_BENCH_FRAME_MS;
+    context.arena = arena;
+
+    context.world = serial_world;
+    context.user = &serial_systems;
+    u64 start_ns = linux_get_ns();
+    entity_update_movement(serial_world, context.delta);
+    entity_update_animation(serial_world, context.ms);
+    app_collision_system(&context);
+    app_sprite_draw_system(&context);
+    u64 frame_ns = linux_get_ns() - start_ns;
+    serial_checksum = sprite_draw_list_checksum(&serial_systems.sprite_draws);
+    if (run_i >= warmup_count)
+    {
+      serial_ns[run_i - warmup_count] = frame_ns;
+    }
+
+    context.world = scheduled_world;
+    context.user = &scheduled_systems;
+    context.arena = NULL;
+    start_ns = linux_get_ns();
+    schedule_begin_frame(schedule);
+    for (u32 system_i = 0; system_i < ARRAY_COUNT(app_systems); system_i += 1)
+    {
+      schedule_add_system(schedule, &app_systems[system_i]);
+    }
+    schedule_run(schedule, arena, &context);
+    frame_ns = linux_get_ns() - start_ns;
+    scheduled_checksum = sprite_draw_list_checksum(&scheduled_systems.sprite_draws);
+    if (run_i >= warmup_count)
+    {
+      scheduled_ns[run_i - warmup_count] = frame_ns;
+      for (u32 system_i = 0; system_i < ARRAY_COUNT(app_systems); system_i += 1)
+      {
+        ScheduleSystem *system = &schedule->systems[system_i];
+        system_wall_ns[system_i][run_i - warmup_count] = system->end_ns - system->start_ns;
+        system_busy_ns[system_i][run_i - warmup_count] = system->busy_ns;
+      }
+    }
+
+    mem_arena_temp_end(temp);
+  }
+
+  if (serial_checksum != scheduled_checksum || 
+      serial_systems.collision_pair_count != scheduled_systems.collision_pair_count)
+  {
+    WARN("Scheduled frame differs from serial frame", "a system is missing a declared read or write");
+  }
+  // NOTE(Ryan): Bit for bit, as replays rely on worker count and interleaving never changing the simulation
+  if (entity_world_checksum(serial_world) != entity_world_checksum(scheduled_world))
+  {
+    WARN("Scheduled world diverged from serial world", "a system's result depends on how its jobs were split or ordered");
+  }
+
+  for (u32 system_i = 0; system_i < ARRAY_COUNT(app_systems); system_i += 1)
+  {
+    printf("  %-12s: wall %8.3fms, busy %8.3fms\n", app_systems[system_i].name,
+           u64_percentile(system_wall_ns[system_i], run_count, 50) / 1000000.0,
+           u64_percentile(system_busy_ns[system_i], run_count, 50) / 1000000.0);
+  }
+
+  f64 serial_median_ms = u64_percentile(serial_ns, run_count, 50) / 1000000.0;
+  f64 scheduled_median_ms = u64_percentile(scheduled_ns, run_count, 50) / 1000000.0;
+  printf("  frame: serial %8.3fms, scheduled %8.3fms, %5.1fx\n", serial_median_ms, scheduled_median_ms,
+         serial_median_ms / scheduled_median_ms);
+
+  char metric_file_name[256] = ZERO_STRUCT;
+  snprintf(metric_file_name, sizeof(metric_file_name), "%s/app-schedule.metric", metric_dir);
+  char metric[64] = ZERO_STRUCT;
+  snprintf(metric, sizeof(metric), "%.4f\n", scheduled_median_ms);
+  s8_append_to_file(s8_cstring(metric_file_name), s8_cstring(metric));
+
+  job_system_destroy(job_system);
+
+  mem_arena_temp_end(bench_temp);
+}
+
+int
+main(int argc, char *argv[])
+{
+  // NOTE(Ryan): -entities n (default 100000) [-threads n, default one per CPU] [-bench-runs n] [-bench-warmups n]
+  // [-metric-dir dir], default misc, i.e. run from repo root
+  u32 entity_count = 100000;
+  u32 run_count = 15;
+  u32 warmup_count = 2;
+  u32 worker_count = 0;
+  const char *metric_dir = "misc";
+  for (s32 arg_i = 1; arg_i < argc; arg_i += 1)
+  {
+    if (strcmp(argv[arg_i], "-entities") == 0 && arg_i + 1 < argc)
+    {
+      entity_count = (u32)strtoul(argv[++arg_i], NULL, 10);
+      entity_count = MAX(1, entity_count);
+    }
+    else if (strcmp(argv[arg_i], "-threads") == 0 && arg_i + 1 < argc)
+    {
+      worker_count = (u32)strtoul(argv[++arg_i], NULL, 10);
+    }
+    else if (strcmp(argv[arg_i], "-bench-runs") == 0 && arg_i + 1 < argc)
+    {
+      run_count = (u32)strtoul(argv[++arg_i], NULL, 10);
+      run_count = MAX(1, run_count);
+    }
+    else if (strcmp(argv[arg_i], "-bench-warmups") == 0 && arg_i + 1 < argc)
+    {
+      warmup_count = (u32)strtoul(argv[++arg_i], NULL, 10);
+    }
+    else if (strcmp(argv[arg_i], "-metric-dir") == 0 && arg_i + 1 < argc)
+    {
+      metric_dir = argv[++arg_i];
+    }
+  }
+
+  MemArena *arena = mem_arena_allocate(GB(4));
+
+  run_app_bench(arena, entity_count, warmup_count, run_count, metric_dir);
+
+  printf("Collision bench: %u warmups + %u runs\n", warmup_count, run_count);
+  for (u32 count_i = 0; count_i < ARRAY_COUNT(app_bench_collider_counts); count_i += 1)
+  {
+    run_collision_bench(arena, app_bench_collider_counts[count_i], warmup_count, run_count, metric_dir);
+  }
+
+  run_schedule_bench(arena, entity_count, worker_count, warmup_count, run_count, metric_dir);
+
+  return 0;
+}
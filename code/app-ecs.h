@@ -0,0 +1,931 @@
+// SPDX-License-Identifier: zlib-acknowledgement
+#pragma once
+
+// NOTE(Ryan): Archetype component storage.
+// Entities with the same set of components share an archetype, which keeps one dense array per component it has.
+// A system walks the rows of every archetype holding all the components it needs,
+// so it only touches matching entities, and only the arrays it actually reads, front to back.
+// An EntityHandle indexes a slot table of (archetype, row). Destroying fills the hole with the archetype's last row,
+// so rows stay packed and only the moved entity's slot changes
+// IMPORTANT(Ryan): No SDL types in here, so app-bench.cpp can build it headless
+
+typedef u32 ENTITY_COMPONENT_FLAG;
+enum
+{
+  ENTITY_COMPONENT_FLAG_TRANSFORM = (1 << 0),
+  ENTITY_COMPONENT_FLAG_SPRITE = (1 << 1),
+  ENTITY_COMPONENT_FLAG_RIGID_BODY = (1 << 2),
+  ENTITY_COMPONENT_FLAG_PROJECTILE = (1 << 3),
+  ENTITY_COMPONENT_FLAG_ANIMATION = (1 << 4),
+  ENTITY_COMPONENT_FLAG_BOX_COLLIDER = (1 << 5),
+  // ...
+};
+
+// NOTE(Ryan): One per combination of the flags above
+#define ENTITY_MAX_ARCHETYPE_COUNT 64
+
+// COMBINATORIC DATA:
+// IMPORTANT: “what something is” and how its memory should be interpreted are different
+// “why do I even care what ‘is a button’ or what ‘is a slider’, to the degree that I have to store it at each node in the hierarchy?”
+// higher level features can be described at a lower level with what data we have, what data we need to produce from that data, and a function (in the mathematical sense) taking our inputs to our outputs.
+// IMPORTANT: no discriminated unions now (okay to have 'waste' data)
+
+struct TransformComponent
+{
+  Vec2F32 position, scale;
+  f32 rotation;
+  Vec2F32 previous_position; // before the last movement tick, so rendering can interpolate between ticks
+};
+
+struct RigidBodyComponent
+{
+  Vec2F32 velocity;
+};
+
+struct AnimationComponent
+{
+  u32 num_frames, current_frame, frame_rate; // frames per second
+  b32 should_loop;
+  u32 start_time;
+};
+
+// could also have circle, pixel-perfect etc.
+struct BoxColliderComponent
+{
+  Vec2F32 size, offset;
+};
+
+struct SpriteComponent
+{
+  Vec2F32 dimensions;
+  Vec2I32 texture_offset;
+  // TODO(Ryan): OPTIMAL SOLUTION IS TO HAVE LAYERS, E.G. VEGETATION LAYER, BULLET LAYER, ETC.
+  u32 z_index;
+  MapKey texture_key;
+};
+
+// NOTE(Ryan): Generational handle, low 32 bits the slot index, high 32 bits the slot's generation when it was made.
+// Destroying bumps the slot's generation, so every handle still held to that entity goes stale,
+// and entity_is_alive() catches it rather than it silently aliasing whatever reuses the slot.
+// 64-bit so generations effectively never wrap; a 32-bit handle with 8 generation bits
+// would alias a stale handle after a slot's 256th reuse, e.g. bullets.
+// Generations start at 1, so a zeroed handle is never alive
+typedef u64 EntityHandle;
+#define ENTITY_HANDLE_INVALID 0
+
+INTERNAL EntityHandle
+entity_handle(u32 index, u32 generation)
+{
+  return ((u64)generation << 32) | index;
+}
+
+INTERNAL u32
+entity_handle_index(EntityHandle handle)
+{
+  return (u32)(handle & U32_MAX);
+}
+
+INTERNAL u32
+entity_handle_generation(EntityHandle handle)
+{
+  return (u32)(handle >> 32);
+}
+
+typedef struct EntitySlot EntitySlot;
+struct EntitySlot
+{
+  u32 generation;
+  u32 destroy_pending; // so a queued entity is queued once, however many systems ask
+  u32 archetype_index;
+  u32 row;
+};
+
+typedef struct EntityArchetype EntityArchetype;
+struct EntityArchetype
+{
+  ENTITY_COMPONENT_FLAG component_flags;
+  u32 count;
+  EntityHandle *entities; // by row, so destroy can fix up the slot of whichever entity it moves
+
+  // NOTE(Ryan): NULL unless in component_flags
+  TransformComponent *transforms;
+  SpriteComponent *sprites;
+  RigidBodyComponent *rigid_bodies;
+  AnimationComponent *animations;
+  BoxColliderComponent *box_colliders;
+};
+
+typedef struct EntityWorld EntityWorld;
+struct EntityWorld
+{
+  // NOTE(Ryan): Archetype arrays are pushed the first time an entity needs them, sized for max_entity_count.
+  // Arena pages are only committed when touched, so unused capacity costs address space only
+  MemArena *arena;
+  u32 max_entity_count;
+  u32 entity_count;
+
+  u32 next_unused_index;
+  u32 free_index_count;
+  u32 *free_indices;
+  EntitySlot *slots; // by handle index
+
+  // NOTE(Ryan): Systems queue destroys rather than destroying mid-walk, which would swap rows
+  // out from under their own loop and any system running alongside.
+  // entity_world_sync() applies them between systems. Pushes are atomic, so parallel systems can share the queue
+  u32 pending_destroy_count;
+  EntityHandle *pending_destroys;
+
+  u32 archetype_count;
+  EntityArchetype archetypes[ENTITY_MAX_ARCHETYPE_COUNT];
+};
+
+INTERNAL b32
+entity_is_alive(EntityWorld *world, EntityHandle handle)
+{
+  u32 index = entity_handle_index(handle);
+  return (index < world->next_unused_index && world->slots[index].generation == entity_handle_generation(handle));
+}
+
+INTERNAL EntitySlot *
+entity_slot(EntityWorld *world, EntityHandle handle)
+{
+  ASSERT(entity_is_alive(world, handle));
+  return &world->slots[entity_handle_index(handle)];
+}
+
+// NOTE(Ryan): Entity must be alive and have the component, e.g. ENTITY_COMPONENT(world, tank, transforms)->position
+#define ENTITY_COMPONENT(world, handle, array) \
+  (&(world)->archetypes[entity_slot((world), (handle))->archetype_index].array[entity_slot((world), (handle))->row])
+
+INTERNAL EntityWorld *
+entity_world_create(MemArena *arena, u32 max_entity_count)
+{
+  EntityWorld *world = MEM_ARENA_PUSH_STRUCT_ZERO(arena, EntityWorld);
+
+  world->arena = arena;
+  world->max_entity_count = max_entity_count;
+  world->free_indices = MEM_ARENA_PUSH_ARRAY(arena, u32, max_entity_count);
+  world->slots = MEM_ARENA_PUSH_ARRAY_ZERO(arena, EntitySlot, max_entity_count);
+  world->pending_destroys = MEM_ARENA_PUSH_ARRAY(arena, EntityHandle, max_entity_count);
+
+  return world;
+}
+
+INTERNAL u32
+entity_archetype_index(EntityWorld *world, ENTITY_COMPONENT_FLAG component_flags)
+{
+  u32 result = U32_MAX;
+
+  for (u32 archetype_i = 0; archetype_i < world->archetype_count; archetype_i += 1)
+  {
+    if (world->archetypes[archetype_i].component_flags == component_flags)
+    {
+      result = archetype_i;
+      break;
+    }
+  }
+
+  if (result == U32_MAX)
+  {
+    ASSERT(world->archetype_count < ENTITY_MAX_ARCHETYPE_COUNT);
+    result = world->archetype_count++;
+
+    EntityArchetype *archetype = &world->archetypes[result];
+    archetype->component_flags = component_flags;
+
+    u32 capacity = world->max_entity_count;
+    archetype->entities = MEM_ARENA_PUSH_ARRAY(world->arena, EntityHandle, capacity);
+    if (component_flags & ENTITY_COMPONENT_FLAG_TRANSFORM)
+    {
+      archetype->transforms = MEM_ARENA_PUSH_ARRAY(world->arena, TransformComponent, capacity);
+    }
+    if (component_flags & ENTITY_COMPONENT_FLAG_SPRITE)
+    {
+      archetype->sprites = MEM_ARENA_PUSH_ARRAY(world->arena, SpriteComponent, capacity);
+    }
+    if (component_flags & ENTITY_COMPONENT_FLAG_RIGID_BODY)
+    {
+      archetype->rigid_bodies = MEM_ARENA_PUSH_ARRAY(world->arena, RigidBodyComponent, capacity);
+    }
+    if (component_flags & ENTITY_COMPONENT_FLAG_ANIMATION)
+    {
+      archetype->animations = MEM_ARENA_PUSH_ARRAY(world->arena, AnimationComponent, capacity);
+    }
+    if (component_flags & ENTITY_COMPONENT_FLAG_BOX_COLLIDER)
+    {
+      archetype->box_colliders = MEM_ARENA_PUSH_ARRAY(world->arena, BoxColliderComponent, capacity);
+    }
+  }
+
+  return result;
+}
+
+// NOTE(Ryan): Components start zeroed. Returns ENTITY_HANDLE_INVALID once max_entity_count are alive
+INTERNAL EntityHandle
+entity_create(EntityWorld *world, ENTITY_COMPONENT_FLAG component_flags)
+{
+  EntityHandle result = ENTITY_HANDLE_INVALID;
+
+  u32 index = U32_MAX;
+  if (world->free_index_count > 0)
+  {
+    index = world->free_indices[--world->free_index_count];
+  }
+  else if (world->next_unused_index < world->max_entity_count)
+  {
+    index = world->next_unused_index++;
+    world->slots[index].generation = 1;
+  }
+  else
+  {
+    WARN("Failed to create entity", "entity world is full");
+  }
+
+  if (index != U32_MAX)
+  {
+    EntitySlot *slot = &world->slots[index];
+    result = entity_handle(index, slot->generation);
+
+    u32 archetype_index = entity_archetype_index(world, component_flags);
+    EntityArchetype *archetype = &world->archetypes[archetype_index];
+    u32 row = archetype->count++;
+
+    archetype->entities[row] = result;
+    if (archetype->transforms != NULL)
+    {
+      MEMORY_ZERO_STRUCT(&archetype->transforms[row]);
+    }
+    if (archetype->sprites != NULL)
+    {
+      MEMORY_ZERO_STRUCT(&archetype->sprites[row]);
+    }
+    if (archetype->rigid_bodies != NULL)
+    {
+      MEMORY_ZERO_STRUCT(&archetype->rigid_bodies[row]);
+    }
+    if (archetype->animations != NULL)
+    {
+      MEMORY_ZERO_STRUCT(&archetype->animations[row]);
+    }
+    if (archetype->box_colliders != NULL)
+    {
+      MEMORY_ZERO_STRUCT(&archetype->box_colliders[row]);
+    }
+
+    slot->archetype_index = archetype_index;
+    slot->row = row;
+    world->entity_count += 1;
+  }
+
+  return result;
+}
+
+// NOTE(Ryan): Immediate, so only safe when no system is walking the archetype, e.g. level unload.
+// Systems use entity_destroy_deferred(). Returns false for a stale handle
+INTERNAL b32
+entity_destroy(EntityWorld *world, EntityHandle handle)
+{
+  b32 result = entity_is_alive(world, handle);
+
+  if (result)
+  {
+    u32 index = entity_handle_index(handle);
+    EntitySlot *slot = &world->slots[index];
+    EntityArchetype *archetype = &world->archetypes[slot->archetype_index];
+
+    u32 last_row = --archetype->count;
+    if (slot->row != last_row)
+    {
+      EntityHandle moved = archetype->entities[last_row];
+      archetype->entities[slot->row] = moved;
+      if (archetype->transforms != NULL)
+      {
+        archetype->transforms[slot->row] = archetype->transforms[last_row];
+      }
+      if (archetype->sprites != NULL)
+      {
+        archetype->sprites[slot->row] = archetype->sprites[last_row];
+      }
+      if (archetype->rigid_bodies != NULL)
+      {
+        archetype->rigid_bodies[slot->row] = archetype->rigid_bodies[last_row];
+      }
+      if (archetype->animations != NULL)
+      {
+        archetype->animations[slot->row] = archetype->animations[last_row];
+      }
+      if (archetype->box_colliders != NULL)
+      {
+        archetype->box_colliders[slot->row] = archetype->box_colliders[last_row];
+      }
+
+      world->slots[entity_handle_index(moved)].row = slot->row;
+    }
+
+    // NOTE(Ryan): 0 is skipped on wrap so a zeroed handle stays invalid
+    slot->generation += 1;
+    if (slot->generation == 0)
+    {
+      slot->generation = 1;
+    }
+    slot->destroy_pending = false;
+
+    world->free_indices[world->free_index_count++] = index;
+    world->entity_count -= 1;
+  }
+
+  return result;
+}
+
+// NOTE(Ryan): Safe from any system, including several in parallel.
+// The entity, and every handle to it, stays valid until the next entity_world_sync()
+INTERNAL void
+entity_destroy_deferred(EntityWorld *world, EntityHandle handle)
+{
+  if (entity_is_alive(world, handle))
+  {
+    EntitySlot *slot = &world->slots[entity_handle_index(handle)];
+    if (!ATOMIC_EXCHANGE_ACQ_REL(&slot->destroy_pending, (u32)true))
+    {
+      // NOTE(Ryan): At most one entry per live entity, so can't overflow
+      u32 pending_i = ATOMIC_ADD_RELAXED(&world->pending_destroy_count, 1);
+      world->pending_destroys[pending_i] = handle;
+    }
+  }
+}
+
+INTERNAL void u32_radix_sort_pairs(MemArena *arena, u32 *keys, u32 *values, u32 count);
+
+// NOTE(Ryan): Frame sync point, called once no system is running.
+// Queue order depends on how parallel systems interleaved, and destroy order decides which rows move
+// and which indices are reused first, so destroys are applied in index order to keep the simulation deterministic
+INTERNAL void
+entity_world_sync(EntityWorld *world)
+{
+  u32 pending_count = world->pending_destroy_count;
+  if (pending_count > 0)
+  {
+    MemArenaTemp temp = mem_arena_temp_begin(world->arena);
+
+    u32 *indices = MEM_ARENA_PUSH_ARRAY(world->arena, u32, pending_count);
+    u32 *generations = MEM_ARENA_PUSH_ARRAY(world->arena, u32, pending_count);
+    for (u32 pending_i = 0; pending_i < pending_count; pending_i += 1)
+    {
+      indices[pending_i] = entity_handle_index(world->pending_destroys[pending_i]);
+      generations[pending_i] = entity_handle_generation(world->pending_destroys[pending_i]);
+    }
+    u32_radix_sort_pairs(world->arena, indices, generations, pending_count);
+
+    for (u32 pending_i = 0; pending_i < pending_count; pending_i += 1)
+    {
+      entity_destroy(world, entity_handle(indices[pending_i], generations[pending_i]));
+    }
+    world->pending_destroy_count = 0;
+
+    mem_arena_temp_end(temp);
+  }
+}
+
+// Introducing 'equations of motion' essentially means giving momentum, i.e. no instantaneous direction changes
+// p = 0.5f * acceleration * SQUARE(time) + velocity * time + position;
+// v = acceleration * t + v
+// if (down) acceleration = 1.0f;
+// acceleration += -0.7f * v (friction)
+// NOTE(Ryan): Row range of an archetype with transform and rigid body, so the scheduler can split it into jobs
+INTERNAL void
+entity_update_movement_rows(EntityArchetype *archetype, u32 row_begin, u32 row_end, f32 delta)
+{
+  TransformComponent *transforms = archetype->transforms;
+  RigidBodyComponent *rigid_bodies = archetype->rigid_bodies;
+  for (u32 row = row_begin; row < row_end; row += 1)
+  {
+    // TODO(Ryan): add acceleration
+    transforms[row].previous_position = transforms[row].position;
+    transforms[row].position += rigid_bodies[row].velocity * delta;
+
+    // TODO(Ryan): add rotation matrices (from app_template)
+  }
+}
+
+INTERNAL void
+entity_update_movement(EntityWorld *world, f32 delta)
+{
+  for (u32 archetype_i = 0; archetype_i < world->archetype_count; archetype_i += 1)
+  {
+    EntityArchetype *archetype = &world->archetypes[archetype_i];
+    if (HAS_FLAGS_ALL(archetype->component_flags, (ENTITY_COMPONENT_FLAG_TRANSFORM | ENTITY_COMPONENT_FLAG_RIGID_BODY)))
+    {
+      entity_update_movement_rows(archetype, 0, archetype->count, delta);
+    }
+  }
+}
+
+// NOTE(Ryan): Row range of an archetype with sprite and animation
+INTERNAL void
+entity_update_animation_rows(EntityArchetype *archetype, u32 row_begin, u32 row_end, u64 ms)
+{
+  SpriteComponent *sprites = archetype->sprites;
+  AnimationComponent *animations = archetype->animations;
+  for (u32 row = row_begin; row < row_end; row += 1)
+  {
+    AnimationComponent *anim = &animations[row];
+
+    u32 time_elapsed = (u32)(ms - anim->start_time);
+
+    anim->current_frame = (u32)(time_elapsed * (anim->frame_rate / 1000.0f)) % anim->num_frames;
+
+    sprites[row].texture_offset.x = (i32)(anim->current_frame * sprites[row].dimensions.w);
+  }
+}
+
+INTERNAL void
+entity_update_animation(EntityWorld *world, u64 ms)
+{
+  for (u32 archetype_i = 0; archetype_i < world->archetype_count; archetype_i += 1)
+  {
+    EntityArchetype *archetype = &world->archetypes[archetype_i];
+    if (HAS_FLAGS_ALL(archetype->component_flags, (ENTITY_COMPONENT_FLAG_SPRITE | ENTITY_COMPONENT_FLAG_ANIMATION)))
+    {
+      entity_update_animation_rows(archetype, 0, archetype->count, ms);
+    }
+  }
+}
+
+// NOTE(Ryan): Stable LSD radix sort of values by keys, a byte per pass.
+// A byte every key shares is skipped, so small keys such as z indices sort in one pass
+INTERNAL void
+u32_radix_sort_pairs(MemArena *arena, u32 *keys, u32 *values, u32 count)
+{
+  MemArenaTemp temp = mem_arena_temp_begin(arena);
+
+  u32 *histograms = MEM_ARENA_PUSH_ARRAY_ZERO(arena, u32, 4 * 256);
+  for (u32 i = 0; i < count; i += 1)
+  {
+    for (u32 byte_i = 0; byte_i < 4; byte_i += 1)
+    {
+      histograms[byte_i * 256 + ((keys[i] >> (byte_i * 8)) & 0xff)] += 1;
+    }
+  }
+
+  u32 *src_keys = keys, *src_values = values;
+  u32 *dst_keys = MEM_ARENA_PUSH_ARRAY(arena, u32, count);
+  u32 *dst_values = MEM_ARENA_PUSH_ARRAY(arena, u32, count);
+  for (u32 byte_i = 0; byte_i < 4 && count > 0; byte_i += 1)
+  {
+    u32 shift = byte_i * 8;
+    u32 *histogram = histograms + byte_i * 256;
+    if (histogram[(src_keys[0] >> shift) & 0xff] == count)
+    {
+      continue;
+    }
+
+    u32 offset = 0;
+    for (u32 bucket_i = 0; bucket_i < 256; bucket_i += 1)
+    {
+      u32 bucket_count = histogram[bucket_i];
+      histogram[bucket_i] = offset;
+      offset += bucket_count;
+    }
+
+    for (u32 i = 0; i < count; i += 1)
+    {
+      u32 dst_i = histogram[(src_keys[i] >> shift) & 0xff]++;
+      dst_keys[dst_i] = src_keys[i];
+      dst_values[dst_i] = src_values[i];
+    }
+
+    SWAP(u32 *, src_keys, dst_keys);
+    SWAP(u32 *, src_values, dst_values);
+  }
+
+  if (src_keys != keys)
+  {
+    MEMORY_COPY(keys, src_keys, sizeof(u32) * count);
+    MEMORY_COPY(values, src_values, sizeof(u32) * count);
+  }
+
+  mem_arena_temp_end(temp);
+}
+
+typedef struct SpriteDraw SpriteDraw;
+struct SpriteDraw
+{
+  MapKey texture_key;
+  Vec2F32 position;
+  Vec2F32 previous_position; // render lerps from here to position
+  Vec2F32 dimensions; // scaled
+  Vec2I32 texture_offset;
+};
+
+typedef struct SpriteDrawList SpriteDrawList;
+struct SpriteDrawList
+{
+  u32 count;
+  SpriteDraw *draws; // back to front
+};
+
+// NOTE(Ryan): alpha is how far the displayed frame is between the last two ticks, so 1 draws the latest tick
+INTERNAL Vec2F32
+sprite_draw_interpolated_position(SpriteDraw *draw, f32 alpha)
+{
+  Vec2F32 result = vec2_f32_lerp(draw->previous_position, draw->position, alpha);
+
+  return result;
+}
+
+// NOTE(Ryan): Replaces merge sorting the entity list by z every frame, which also left the list
+// in z order rather than memory order for every walk after it.
+// Entities stay put; only a (z, index) pair per sprite is sorted, then draws are gathered in that order
+INTERNAL SpriteDrawList
+entity_build_sprite_draws(MemArena *arena, EntityWorld *world)
+{
+  SpriteDrawList result = ZERO_STRUCT;
+
+  u32 sprite_count = 0;
+  for (u32 archetype_i = 0; archetype_i < world->archetype_count; archetype_i += 1)
+  {
+    EntityArchetype *archetype = &world->archetypes[archetype_i];
+    if (HAS_FLAGS_ALL(archetype->component_flags, (ENTITY_COMPONENT_FLAG_TRANSFORM | ENTITY_COMPONENT_FLAG_SPRITE)))
+    {
+      sprite_count += archetype->count;
+    }
+  }
+
+  SpriteDraw *unsorted_draws = MEM_ARENA_PUSH_ARRAY(arena, SpriteDraw, sprite_count);
+  u32 *z_indices = MEM_ARENA_PUSH_ARRAY(arena, u32, sprite_count);
+  u32 *draw_indices = MEM_ARENA_PUSH_ARRAY(arena, u32, sprite_count);
+
+  u32 draw_i = 0;
+  for (u32 archetype_i = 0; archetype_i < world->archetype_count; archetype_i += 1)
+  {
+    EntityArchetype *archetype = &world->archetypes[archetype_i];
+    if (HAS_FLAGS_ALL(archetype->component_flags, (ENTITY_COMPONENT_FLAG_TRANSFORM | ENTITY_COMPONENT_FLAG_SPRITE)))
+    {
+      TransformComponent *transforms = archetype->transforms;
+      SpriteComponent *sprites = archetype->sprites;
+      // NOTE(Ryan): Only movement sets previous_position, so anything without a rigid body is drawn where it is
+      b32 is_moving = (archetype->rigid_bodies != NULL);
+      for (u32 row = 0; row < archetype->count; row += 1)
+      {
+        SpriteDraw *draw = &unsorted_draws[draw_i];
+        draw->texture_key = sprites[row].texture_key;
+        draw->position = transforms[row].position;
+        draw->previous_position = is_moving ? transforms[row].previous_position : transforms[row].position;
+        draw->dimensions = vec2_f32_hadamard(sprites[row].dimensions, transforms[row].scale);
+        draw->texture_offset = sprites[row].texture_offset;
+
+        z_indices[draw_i] = sprites[row].z_index;
+        draw_indices[draw_i] = draw_i;
+        draw_i += 1;
+      }
+    }
+  }
+
+  u32_radix_sort_pairs(arena, z_indices, draw_indices, sprite_count);
+
+  result.count = sprite_count;
+  result.draws = MEM_ARENA_PUSH_ARRAY(arena, SpriteDraw, sprite_count);
+  for (u32 i = 0; i < sprite_count; i += 1)
+  {
+    result.draws[i] = unsorted_draws[draw_indices[i]];
+  }
+
+  return result;
+}
+
+typedef struct ColliderSet ColliderSet;
+struct ColliderSet
+{
+  u32 count;
+  EntityHandle *handles;
+  // NOTE(Ryan): SoA, so the broad phase reads only bounds
+  f32 *min_x, *min_y, *max_x, *max_y;
+};
+
+INTERNAL ColliderSet
+entity_gather_colliders(MemArena *arena, EntityWorld *world)
+{
+  ColliderSet result = ZERO_STRUCT;
+
+  for (u32 archetype_i = 0; archetype_i < world->archetype_count; archetype_i += 1)
+  {
+    EntityArchetype *archetype = &world->archetypes[archetype_i];
+    if (HAS_FLAGS_ALL(archetype->component_flags, (ENTITY_COMPONENT_FLAG_TRANSFORM | ENTITY_COMPONENT_FLAG_BOX_COLLIDER)))
+    {
+      result.count += archetype->count;
+    }
+  }
+
+  result.handles = MEM_ARENA_PUSH_ARRAY(arena, EntityHandle, result.count);
+  result.min_x = MEM_ARENA_PUSH_ARRAY(arena, f32, result.count);
+  result.min_y = MEM_ARENA_PUSH_ARRAY(arena, f32, result.count);
+  result.max_x = MEM_ARENA_PUSH_ARRAY(arena, f32, result.count);
+  result.max_y = MEM_ARENA_PUSH_ARRAY(arena, f32, result.count);
+
+  u32 collider_i = 0;
+  for (u32 archetype_i = 0; archetype_i < world->archetype_count; archetype_i += 1)
+  {
+    EntityArchetype *archetype = &world->archetypes[archetype_i];
+    if (HAS_FLAGS_ALL(archetype->component_flags, (ENTITY_COMPONENT_FLAG_TRANSFORM | ENTITY_COMPONENT_FLAG_BOX_COLLIDER)))
+    {
+      for (u32 row = 0; row < archetype->count; row += 1)
+      {
+        Vec2F32 min = archetype->transforms[row].position + archetype->box_colliders[row].offset;
+        Vec2F32 max = min + archetype->box_colliders[row].size;
+
+        result.handles[collider_i] = archetype->entities[row];
+        result.min_x[collider_i] = min.x;
+        result.min_y[collider_i] = min.y;
+        result.max_x[collider_i] = max.x;
+        result.max_y[collider_i] = max.y;
+        collider_i += 1;
+      }
+    }
+  }
+
+  return result;
+}
+
+typedef struct CollisionCandidates CollisionCandidates;
+struct CollisionCandidates
+{
+  u32 count;
+  u32 *a, *b; // indices into the ColliderSet, a < b
+  // NOTE(Ryan): Bounds copied alongside, so the narrow phase streams through them rather than gathering
+  f32 *a_min_x, *a_min_y, *a_max_x, *a_max_y;
+  f32 *b_min_x, *b_min_y, *b_max_x, *b_max_y;
+};
+
+typedef struct CollisionPairs CollisionPairs;
+struct CollisionPairs
+{
+  u32 count;
+  u32 *a, *b; // indices into the ColliderSet, a < b
+};
+
+// NOTE(Ryan): Cell coordinates are biased and clamped to 16 bits, so a cell packs into a u32 sort key.
+// Clamping only merges far-off cells, so pairs are still found; they just share an edge cell.
+// Biased non-negative first, so truncating is a floor without a floorf() call at baseline ISA.
+// Any monotonic mapping keeps every overlapping pair in a shared cell, so float rounding here is harmless
+INTERNAL u32
+collision_cell_coord(f32 value, f32 inv_cell_size)
+{
+  f32 cell = CLAMP(0.0f, value * inv_cell_size + 32768.0f, 65535.0f);
+  return (u32)cell;
+}
+
+// NOTE(Ryan): Uniform grid broad phase, sorted rather than hashed.
+// Each collider emits a (cell, collider) entry per cell its bounds touch, entries are radix sorted by cell,
+// and colliders sharing a run of entries are candidates. No hash table to size or clear, and the grid is unbounded.
+// A pair sharing several cells is only emitted from the cell holding the max of their min corners,
+// i.e. the top-left of their overlap, so there are no duplicates.
+// cell_size around twice the typical collider size keeps entries per collider at 1-4
+INTERNAL CollisionCandidates
+collision_broad_phase(MemArena *arena, ColliderSet *colliders, f32 cell_size)
+{
+  CollisionCandidates result = ZERO_STRUCT;
+
+  f32 inv_cell_size = 1.0f / cell_size;
+  u32 *cell_mins = MEM_ARENA_PUSH_ARRAY(arena, u32, colliders->count);
+  u32 *cell_maxs = MEM_ARENA_PUSH_ARRAY(arena, u32, colliders->count);
+  u32 entry_count = 0;
+  for (u32 collider_i = 0; collider_i < colliders->count; collider_i += 1)
+  {
+    u32 cell_min_x = collision_cell_coord(colliders->min_x[collider_i], inv_cell_size);
+    u32 cell_min_y = collision_cell_coord(colliders->min_y[collider_i], inv_cell_size);
+    u32 cell_max_x = collision_cell_coord(colliders->max_x[collider_i], inv_cell_size);
+    u32 cell_max_y = collision_cell_coord(colliders->max_y[collider_i], inv_cell_size);
+    cell_mins[collider_i] = (cell_min_y << 16) | cell_min_x;
+    cell_maxs[collider_i] = (cell_max_y << 16) | cell_max_x;
+    entry_count += (cell_max_x - cell_min_x + 1) * (cell_max_y - cell_min_y + 1);
+  }
+
+  // NOTE(Ryan): Pushed in collider order and the sort is stable, so a < b within a run
+  u32 *entry_cells = MEM_ARENA_PUSH_ARRAY(arena, u32, entry_count);
+  u32 *entry_colliders = MEM_ARENA_PUSH_ARRAY(arena, u32, entry_count);
+  u32 entry_i = 0;
+  for (u32 collider_i = 0; collider_i < colliders->count; collider_i += 1)
+  {
+    for (u32 cell_y = (cell_mins[collider_i] >> 16); cell_y <= (cell_maxs[collider_i] >> 16); cell_y += 1)
+    {
+      for (u32 cell_x = (cell_mins[collider_i] & 0xffff); cell_x <= (cell_maxs[collider_i] & 0xffff); cell_x += 1)
+      {
+        entry_cells[entry_i] = (cell_y << 16) | cell_x;
+        entry_colliders[entry_i] = collider_i;
+        entry_i += 1;
+      }
+    }
+  }
+
+  u32_radix_sort_pairs(arena, entry_cells, entry_colliders, entry_count);
+
+  // IMPORTANT(Ryan): Colliders are in arbitrary order relative to cells, so reading their bounds per pair
+  // is a cache miss per pair. Gathered once per entry instead, so the pair loops below only read neighbouring entries
+  u32 *entry_cell_mins = MEM_ARENA_PUSH_ARRAY(arena, u32, entry_count);
+  f32 *entry_min_x = MEM_ARENA_PUSH_ARRAY(arena, f32, entry_count);
+  f32 *entry_min_y = MEM_ARENA_PUSH_ARRAY(arena, f32, entry_count);
+  f32 *entry_max_x = MEM_ARENA_PUSH_ARRAY(arena, f32, entry_count);
+  f32 *entry_max_y = MEM_ARENA_PUSH_ARRAY(arena, f32, entry_count);
+  for (entry_i = 0; entry_i < entry_count; entry_i += 1)
+  {
+    u32 collider_i = entry_colliders[entry_i];
+    entry_cell_mins[entry_i] = cell_mins[collider_i];
+    entry_min_x[entry_i] = colliders->min_x[collider_i];
+    entry_min_y[entry_i] = colliders->min_y[collider_i];
+    entry_max_x[entry_i] = colliders->max_x[collider_i];
+    entry_max_y[entry_i] = colliders->max_y[collider_i];
+  }
+
+  // NOTE(Ryan): Counted first, then filled, so every candidate array is one exact push
+  for (u32 fill = 0; fill < 2; fill += 1)
+  {
+    if (fill == 1)
+    {
+      result.a = MEM_ARENA_PUSH_ARRAY(arena, u32, result.count);
+      result.b = MEM_ARENA_PUSH_ARRAY(arena, u32, result.count);
+      result.a_min_x = MEM_ARENA_PUSH_ARRAY(arena, f32, result.count);
+      result.a_min_y = MEM_ARENA_PUSH_ARRAY(arena, f32, result.count);
+      result.a_max_x = MEM_ARENA_PUSH_ARRAY(arena, f32, result.count);
+      result.a_max_y = MEM_ARENA_PUSH_ARRAY(arena, f32, result.count);
+      result.b_min_x = MEM_ARENA_PUSH_ARRAY(arena, f32, result.count);
+      result.b_min_y = MEM_ARENA_PUSH_ARRAY(arena, f32, result.count);
+      result.b_max_x = MEM_ARENA_PUSH_ARRAY(arena, f32, result.count);
+      result.b_max_y = MEM_ARENA_PUSH_ARRAY(arena, f32, result.count);
+    }
+
+    u32 candidate_i = 0;
+    u32 run_start = 0;
+    while (run_start < entry_count)
+    {
+      u32 cell = entry_cells[run_start];
+      u32 run_end = run_start + 1;
+      while (run_end < entry_count && entry_cells[run_end] == cell)
+      {
+        run_end += 1;
+      }
+
+      for (u32 i = run_start; i < run_end; i += 1)
+      {
+        for (u32 j = i + 1; j < run_end; j += 1)
+        {
+          u32 reference_cell = (MAX(entry_cell_mins[i] & 0xffff0000, entry_cell_mins[j] & 0xffff0000) |
+                                MAX(entry_cell_mins[i] & 0xffff, entry_cell_mins[j] & 0xffff));
+          if (reference_cell == cell)
+          {
+            if (fill == 1)
+            {
+              result.a[candidate_i] = entry_colliders[i];
+              result.b[candidate_i] = entry_colliders[j];
+              result.a_min_x[candidate_i] = entry_min_x[i];
+              result.a_min_y[candidate_i] = entry_min_y[i];
+              result.a_max_x[candidate_i] = entry_max_x[i];
+              result.a_max_y[candidate_i] = entry_max_y[i];
+              result.b_min_x[candidate_i] = entry_min_x[j];
+              result.b_min_y[candidate_i] = entry_min_y[j];
+              result.b_max_x[candidate_i] = entry_max_x[j];
+              result.b_max_y[candidate_i] = entry_max_y[j];
+            }
+            candidate_i += 1;
+          }
+        }
+      }
+
+      run_start = run_end;
+    }
+
+    result.count = candidate_i;
+  }
+
+  return result;
+}
+
+// NOTE(Ryan): Overlap is strict, so touching edges don't collide (as SDL_HasIntersection)
+// IMPORTANT(Ryan): Raw SSE2 rather than base-lane.h, whose 4-wide path needs SSE4.1
+// and the app is built for baseline x86-64. SSE2 is guaranteed there and is all an AABB test needs
+INTERNAL CollisionPairs
+collision_narrow_phase(MemArena *arena, CollisionCandidates *candidates)
+{
+  CollisionPairs result = ZERO_STRUCT;
+  result.a = MEM_ARENA_PUSH_ARRAY(arena, u32, candidates->count);
+  result.b = MEM_ARENA_PUSH_ARRAY(arena, u32, candidates->count);
+
+  u32 candidate_i = 0;
+#if defined(__SSE2__)
+  for (; candidate_i + 4 <= candidates->count; candidate_i += 4)
+  {
+    __m128 a_min_x = _mm_loadu_ps(candidates->a_min_x + candidate_i);
+    __m128 a_min_y = _mm_loadu_ps(candidates->a_min_y + candidate_i);
+    __m128 a_max_x = _mm_loadu_ps(candidates->a_max_x + candidate_i);
+    __m128 a_max_y = _mm_loadu_ps(candidates->a_max_y + candidate_i);
+    __m128 b_min_x = _mm_loadu_ps(candidates->b_min_x + candidate_i);
+    __m128 b_min_y = _mm_loadu_ps(candidates->b_min_y + candidate_i);
+    __m128 b_max_x = _mm_loadu_ps(candidates->b_max_x + candidate_i);
+    __m128 b_max_y = _mm_loadu_ps(candidates->b_max_y + candidate_i);
+
+    __m128 overlap_x = _mm_and_ps(_mm_cmplt_ps(a_min_x, b_max_x), _mm_cmplt_ps(b_min_x, a_max_x));
+    __m128 overlap_y = _mm_and_ps(_mm_cmplt_ps(a_min_y, b_max_y), _mm_cmplt_ps(b_min_y, a_max_y));
+    u32 overlap_mask = (u32)_mm_movemask_ps(_mm_and_ps(overlap_x, overlap_y));
+
+    while (overlap_mask != 0)
+    {
+      u32 lane_i = u32_count_trailing_zeroes(overlap_mask);
+      result.a[result.count] = candidates->a[candidate_i + lane_i];
+      result.b[result.count] = candidates->b[candidate_i + lane_i];
+      result.count += 1;
+      overlap_mask &= overlap_mask - 1;
+    }
+  }
+#endif
+
+  for (; candidate_i < candidates->count; candidate_i += 1)
+  {
+    if (candidates->a_min_x[candidate_i] < candidates->b_max_x[candidate_i] &&
+        candidates->b_min_x[candidate_i] < candidates->a_max_x[candidate_i] &&
+        candidates->a_min_y[candidate_i] < candidates->b_max_y[candidate_i] &&
+        candidates->b_min_y[candidate_i] < candidates->a_max_y[candidate_i])
+    {
+      result.a[result.count] = candidates->a[candidate_i];
+      result.b[result.count] = candidates->b[candidate_i];
+      result.count += 1;
+    }
+  }
+
+  return result;
+}
+
+// NOTE(Ryan): For catching desyncs, not for hash maps. A word at a time through a multiply-xorshift,
+// so hashing the whole world every tick costs little next to the systems themselves
+INTERNAL u64
+checksum_bytes(u64 hash, void *data, u64 size)
+{
+  u64 result = hash;
+
+  u8 *bytes = (u8 *)data;
+  u64 byte_i = 0;
+  for (; byte_i + sizeof(u64) <= size; byte_i += sizeof(u64))
+  {
+    u64 word = 0;
+    MEMORY_COPY(&word, bytes + byte_i, sizeof(u64));
+    result = (result ^ word) * 0x9e3779b97f4a7c15ull;
+    result ^= result >> 29;
+  }
+  for (; byte_i < size; byte_i += 1)
+  {
+    result = (result ^ bytes[byte_i]) * 0x9e3779b97f4a7c15ull;
+    result ^= result >> 29;
+  }
+
+  return result;
+}
+
+// NOTE(Ryan): Two worlds match only if every entity has the same handle, row and component bits,
+// and the same indices are queued for reuse, i.e. every later tick would also match.
+// Components are hashed as raw bytes, which is fine as none has padding and rows are zeroed on create.
+// Sprites are the exception: their texture key holds a string pointer, which ASLR moves between runs
+INTERNAL u64
+entity_world_checksum(EntityWorld *world)
+{
+  u64 result = 0xcbf29ce484222325ull;
+
+  result = checksum_bytes(result, &world->entity_count, sizeof(world->entity_count));
+  result = checksum_bytes(result, world->slots, sizeof(EntitySlot) * world->next_unused_index);
+  result = checksum_bytes(result, world->free_indices, sizeof(u32) * world->free_index_count);
+
+  for (u32 archetype_i = 0; archetype_i < world->archetype_count; archetype_i += 1)
+  {
+    EntityArchetype *archetype = &world->archetypes[archetype_i];
+    u32 count = archetype->count;
+
+    result = checksum_bytes(result, &archetype->component_flags, sizeof(archetype->component_flags));
+    result = checksum_bytes(result, archetype->entities, sizeof(EntityHandle) * count);
+    if (archetype->transforms != NULL)
+    {
+      result = checksum_bytes(result, archetype->transforms, sizeof(TransformComponent) * count);
+    }
+    if (archetype->rigid_bodies != NULL)
+    {
+      result = checksum_bytes(result, archetype->rigid_bodies, sizeof(RigidBodyComponent) * count);
+    }
+    if (archetype->animations != NULL)
+    {
+      result = checksum_bytes(result, archetype->animations, sizeof(AnimationComponent) * count);
+    }
+    if (archetype->box_colliders != NULL)
+    {
+      result = checksum_bytes(result, archetype->box_colliders, sizeof(BoxColliderComponent) * count);
+    }
+    if (archetype->sprites != NULL)
+    {
+      for (u32 row = 0; row < count; row += 1)
+      {
+        SpriteComponent *sprite = &archetype->sprites[row];
+        result = checksum_bytes(result, &sprite->dimensions, sizeof(sprite->dimensions));
+        result = checksum_bytes(result, &sprite->texture_offset, sizeof(sprite->texture_offset));
+        result = checksum_bytes(result, &sprite->z_index, sizeof(sprite->z_index));
+        result = checksum_bytes(result, &sprite->texture_key.hash, sizeof(sprite->texture_key.hash));
+      }
+    }
+  }
+
+  return result;
+}
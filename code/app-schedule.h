@@ -0,0 +1,349 @@
+// SPDX-License-Identifier: zlib-acknowledgement
+#pragma once
+
+// NOTE(Ryan): Per-frame system scheduler on base-job.h.
+// Systems declare what they read and write: component flags, plus SYSTEM_RESOURCE_FLAG bits for any
+// non-component state. Each system depends on every earlier-added system it conflicts with
+// (either writes what the other touches), which gives a dependency graph in add order.
+// Systems with no path between them run concurrently.
+// A chunked system runs as a parallel-for over row ranges of every archetype holding all the components it declares.
+// Otherwise it runs once over the whole world, with its own arena for output.
+//
+// IMPORTANT(Ryan): The schedule is rebuilt every frame with schedule_begin_frame()/schedule_add_system(),
+// so the function pointers always belong to the currently loaded app.so.
+// Systems must not create entities or wait on jobs; destroys go through entity_destroy_deferred()
+// and are applied by entity_world_sync() once schedule_run() returns
+
+#define SCHEDULE_MAX_SYSTEM_COUNT 32
+// NOTE(Ryan): Rows per chunked job; enough that per-job overhead is noise, few enough to spread a 10k archetype
+#define SCHEDULE_CHUNK_ROW_COUNT 2048
+
+// NOTE(Ryan): Bits from here up are free for the app's own resources, e.g. particles, the sprite draw list
+#define SYSTEM_RESOURCE_FLAG_FIRST (1 << 16)
+
+typedef struct SystemContext SystemContext;
+struct SystemContext
+{
+  EntityWorld *world;
+  MemArena *arena; // the system's own, cleared each frame; NULL for chunked systems as chunks run concurrently
+  f32 delta;
+  u64 ms;
+  void *user;
+};
+
+typedef void (*system_func)(SystemContext *context);
+typedef void (*system_chunk_func)(SystemContext *context, EntityArchetype *archetype, u32 row_begin, u32 row_end);
+
+typedef struct SystemDesc SystemDesc;
+struct SystemDesc
+{
+  const char *name;
+  u32 reads;
+  u32 writes;
+  // NOTE(Ryan): Exactly one set
+  system_func func;
+  system_chunk_func chunk_func;
+};
+
+typedef struct Schedule Schedule;
+
+typedef struct ScheduleChunk ScheduleChunk;
+struct ScheduleChunk
+{
+  Schedule *schedule;
+  u32 system_index;
+  EntityArchetype *archetype;
+  u32 row_begin;
+  u32 row_end;
+};
+
+typedef struct ScheduleSystem ScheduleSystem;
+struct ScheduleSystem
+{
+  SystemDesc desc;
+  MemArena *arena;
+
+  u32 dependency_count;
+  u32 dependent_count;
+  u32 dependents[SCHEDULE_MAX_SYSTEM_COUNT];
+
+  // NOTE(Ryan): Per frame
+  u32 pending_dependency_count;
+  u32 pending_chunk_count;
+  u32 chunk_count;
+  ScheduleChunk *chunks;
+
+  // NOTE(Ryan): wall is ready to done, busy is summed over its jobs, so busy > wall means it ran in parallel
+  u64 start_ns;
+  u64 end_ns;
+  u64 busy_ns;
+};
+
+struct Schedule
+{
+  JobSystem *job_system;
+  memory_index system_arena_size;
+  SystemContext context;
+  JobCounter frame_counter;
+
+  u32 system_count;
+  ScheduleSystem systems[SCHEDULE_MAX_SYSTEM_COUNT];
+};
+
+// NOTE(Ryan): Each system gets its own arena of system_arena_size, allocated the first time its slot is used
+INTERNAL Schedule *
+schedule_create(MemArena *arena, JobSystem *job_system, memory_index system_arena_size)
+{
+  Schedule *result = MEM_ARENA_PUSH_STRUCT_ZERO(arena, Schedule);
+
+  result->job_system = job_system;
+  result->system_arena_size = system_arena_size;
+
+  return result;
+}
+
+// NOTE(Ryan): Per-system arenas are kept, so a system's output from the last frame is only invalidated by schedule_run()
+INTERNAL void
+schedule_begin_frame(Schedule *schedule)
+{
+  schedule->system_count = 0;
+}
+
+INTERNAL void
+schedule_add_system(Schedule *schedule, SystemDesc *desc)
+{
+  ASSERT(schedule->system_count < SCHEDULE_MAX_SYSTEM_COUNT);
+  ASSERT((desc->func != NULL) != (desc->chunk_func != NULL));
+
+  u32 system_index = schedule->system_count++;
+  ScheduleSystem *system = &schedule->systems[system_index];
+  system->desc = *desc;
+  system->dependency_count = 0;
+  system->dependent_count = 0;
+  if (system->arena == NULL)
+  {
+    system->arena = mem_arena_allocate(schedule->system_arena_size);
+  }
+
+  for (u32 earlier_i = 0; earlier_i < system_index; earlier_i += 1)
+  {
+    ScheduleSystem *earlier = &schedule->systems[earlier_i];
+    b32 is_conflicting = ((earlier->desc.writes & (desc->reads | desc->writes)) != 0 ||
+                          (earlier->desc.reads & desc->writes) != 0);
+    if (is_conflicting)
+    {
+      earlier->dependents[earlier->dependent_count++] = system_index;
+      system->dependency_count += 1;
+    }
+  }
+}
+
+INTERNAL void schedule_system_launch(Schedule *schedule, u32 system_index);
+
+INTERNAL void
+schedule_system_complete(Schedule *schedule, u32 system_index)
+{
+  ScheduleSystem *system = &schedule->systems[system_index];
+  system->end_ns = linux_get_ns();
+
+  for (u32 dependent_i = 0; dependent_i < system->dependent_count; dependent_i += 1)
+  {
+    u32 dependent_index = system->dependents[dependent_i];
+    // NOTE(Ryan): ACQ_REL, so the last dependency to finish sees every other's writes before launching
+    if (ATOMIC_SUB_ACQ_REL(&schedule->systems[dependent_index].pending_dependency_count, 1) == 1)
+    {
+      schedule_system_launch(schedule, dependent_index);
+    }
+  }
+}
+
+INTERNAL void
+schedule_system_job(UNUSED JobSystem *job_system, void *payload)
+{
+  ScheduleChunk *chunk = (ScheduleChunk *)payload;
+  Schedule *schedule = chunk->schedule;
+  ScheduleSystem *system = &schedule->systems[chunk->system_index];
+
+  u64 start_ns = linux_get_ns();
+
+  SystemContext context = schedule->context;
+  if (system->desc.func != NULL)
+  {
+    context.arena = system->arena;
+    system->desc.func(&context);
+  }
+  else
+  {
+    system->desc.chunk_func(&context, chunk->archetype, chunk->row_begin, chunk->row_end);
+  }
+
+  ATOMIC_ADD_RELAXED(&system->busy_ns, linux_get_ns() - start_ns);
+
+  // IMPORTANT(Ryan): Dependents are submitted from here, before job_execute() signals frame_counter for this job,
+  // so frame_counter can't reach zero with work still to launch
+  if (ATOMIC_SUB_ACQ_REL(&system->pending_chunk_count, 1) == 1)
+  {
+    schedule_system_complete(schedule, chunk->system_index);
+  }
+}
+
+INTERNAL void
+schedule_system_launch(Schedule *schedule, u32 system_index)
+{
+  ScheduleSystem *system = &schedule->systems[system_index];
+  system->start_ns = linux_get_ns();
+
+  if (system->chunk_count == 0)
+  {
+    schedule_system_complete(schedule, system_index);
+  }
+  else
+  {
+    system->pending_chunk_count = system->chunk_count;
+    for (u32 chunk_i = 0; chunk_i < system->chunk_count; chunk_i += 1)
+    {
+      job_submit(schedule->job_system, schedule_system_job, &system->chunks[chunk_i], &schedule->frame_counter);
+    }
+  }
+}
+
+// NOTE(Ryan): Calling thread must be the job system's worker 0, and helps run jobs until every system is done.
+// frame_arena holds the chunk list, so must outlive the call
+INTERNAL void
+schedule_run(Schedule *schedule, MemArena *frame_arena, SystemContext *context)
+{
+  schedule->context = *context;
+  EntityWorld *world = context->world;
+
+  // NOTE(Ryan): Archetype row counts can't change until entity_world_sync(), so chunks are fixed up front
+  for (u32 system_i = 0; system_i < schedule->system_count; system_i += 1)
+  {
+    ScheduleSystem *system = &schedule->systems[system_i];
+    mem_arena_clear(system->arena);
+    system->pending_dependency_count = system->dependency_count;
+    system->busy_ns = 0;
+
+    if (system->desc.func != NULL)
+    {
+      system->chunk_count = 1;
+      system->chunks = MEM_ARENA_PUSH_STRUCT_ZERO(frame_arena, ScheduleChunk);
+      system->chunks[0].schedule = schedule;
+      system->chunks[0].system_index = system_i;
+    }
+    else
+    {
+      ENTITY_COMPONENT_FLAG components = (system->desc.reads | system->desc.writes) & (SYSTEM_RESOURCE_FLAG_FIRST - 1);
+
+      system->chunk_count = 0;
+      for (u32 archetype_i = 0; archetype_i < world->archetype_count; archetype_i += 1)
+      {
+        EntityArchetype *archetype = &world->archetypes[archetype_i];
+        if (HAS_FLAGS_ALL(archetype->component_flags, components))
+        {
+          system->chunk_count += (archetype->count + SCHEDULE_CHUNK_ROW_COUNT - 1) / SCHEDULE_CHUNK_ROW_COUNT;
+        }
+      }
+
+      system->chunks = MEM_ARENA_PUSH_ARRAY(frame_arena, ScheduleChunk, system->chunk_count);
+      u32 chunk_i = 0;
+      for (u32 archetype_i = 0; archetype_i < world->archetype_count; archetype_i += 1)
+      {
+        EntityArchetype *archetype = &world->archetypes[archetype_i];
+        if (HAS_FLAGS_ALL(archetype->component_flags, components))
+        {
+          for (u32 row_begin = 0; row_begin < archetype->count; row_begin += SCHEDULE_CHUNK_ROW_COUNT)
+          {
+            ScheduleChunk *chunk = &system->chunks[chunk_i++];
+            chunk->schedule = schedule;
+            chunk->system_index = system_i;
+            chunk->archetype = archetype;
+            chunk->row_begin = row_begin;
+            chunk->row_end = MIN(row_begin + SCHEDULE_CHUNK_ROW_COUNT, archetype->count);
+          }
+        }
+      }
+    }
+  }
+
+  schedule->frame_counter.value = 0;
+  for (u32 system_i = 0; system_i < schedule->system_count; system_i += 1)
+  {
+    if (schedule->systems[system_i].dependency_count == 0)
+    {
+      schedule_system_launch(schedule, system_i);
+    }
+  }
+
+  job_wait_for_counter(schedule->job_system, &schedule->frame_counter);
+}
+
+// NOTE(Ryan): The game's systems, shared by app.cpp and app-bench.cpp so the benchmark times what ships.
+// SystemContext.user is an AppSystemsState, which holds their settings and outputs
+#define APP_RESOURCE_FLAG_COLLIDERS (SYSTEM_RESOURCE_FLAG_FIRST << 0)
+#define APP_RESOURCE_FLAG_SPRITE_DRAWS (SYSTEM_RESOURCE_FLAG_FIRST << 1)
+
+typedef struct AppSystemsState AppSystemsState;
+struct AppSystemsState
+{
+  f32 collision_cell_size; // broad phase grid, see collision_broad_phase()
+  // NOTE(Ryan): Game destroys both entities of a colliding pair; benchmark keeps them, so every frame does the same work
+  b32 want_destroy_colliding;
+
+  // NOTE(Ryan): System outputs, in their arenas until next frame's schedule_run()
+  ColliderSet colliders;
+  u32 collision_pair_count;
+  SpriteDrawList sprite_draws;
+};
+
+INTERNAL void
+app_movement_system(SystemContext *context, EntityArchetype *archetype, u32 row_begin, u32 row_end)
+{
+  entity_update_movement_rows(archetype, row_begin, row_end, context->delta);
+}
+
+INTERNAL void
+app_animation_system(SystemContext *context, EntityArchetype *archetype, u32 row_begin, u32 row_end)
+{
+  entity_update_animation_rows(archetype, row_begin, row_end, context->ms);
+}
+
+INTERNAL void
+app_collision_system(SystemContext *context)
+{
+  AppSystemsState *state = (AppSystemsState *)context->user;
+
+  state->colliders = entity_gather_colliders(context->arena, context->world);
+  CollisionCandidates collision_candidates = \
+    collision_broad_phase(context->arena, &state->colliders, state->collision_cell_size);
+  CollisionPairs collision_pairs = collision_narrow_phase(context->arena, &collision_candidates);
+  state->collision_pair_count = collision_pairs.count;
+
+  if (state->want_destroy_colliding)
+  {
+    for (u32 pair_i = 0; pair_i < collision_pairs.count; pair_i += 1)
+    {
+      // NOTE(Ryan): Deferred, as an entity can be in several pairs and other systems are walking rows
+      entity_destroy_deferred(context->world, state->colliders.handles[collision_pairs.a[pair_i]]);
+      entity_destroy_deferred(context->world, state->colliders.handles[collision_pairs.b[pair_i]]);
+    }
+  }
+}
+
+INTERNAL void
+app_sprite_draw_system(SystemContext *context)
+{
+  AppSystemsState *state = (AppSystemsState *)context->user;
+
+  state->sprite_draws = entity_build_sprite_draws(context->arena, context->world);
+}
+
+// NOTE(Ryan): Add order is dependency order for systems that conflict.
+// So here movement and animation run together, then collision alongside sprite draws
+GLOBAL SystemDesc app_systems[] = {
+  {"movement", ENTITY_COMPONENT_FLAG_RIGID_BODY, ENTITY_COMPONENT_FLAG_TRANSFORM, NULL, app_movement_system},
+  {"animation", 0, ENTITY_COMPONENT_FLAG_SPRITE | ENTITY_COMPONENT_FLAG_ANIMATION, NULL, app_animation_system},
+  {"collision", ENTITY_COMPONENT_FLAG_TRANSFORM | ENTITY_COMPONENT_FLAG_BOX_COLLIDER, APP_RESOURCE_FLAG_COLLIDERS,
+   app_collision_system, NULL},
+  {"sprite draws", ENTITY_COMPONENT_FLAG_TRANSFORM | ENTITY_COMPONENT_FLAG_SPRITE, APP_RESOURCE_FLAG_SPRITE_DRAWS,
+   app_sprite_draw_system, NULL},
+};
@@ -340,6 +340,7 @@ ThreadContext global_tctx;
 // so NOT:
 //   I'm interested in how much faster ECS than a big heterogeneous linked list like: 
 //   list<IGameObject> scene;
+// NOTE(Ryan): Storage is in app-ecs.h; misc/build app-bench times it against the entity list it replaced
 //
 // these entity ids would be indexes into component arrays
 // entity: id
@@ -354,61 +355,6 @@ ThreadContext global_tctx;
 // inheritance: multiple inheritance
 // component: 
 
-/* IMPORTANT(Ryan): If using a fixed array, just have a queue of ids, e.g:
-  if (first_free_id == NULL)
-  {
-    free_id = num_ids++;
-  }
-  else
-  {
-    free_id = SLL_QUEUE_POP(first_free_id, last_free_id);
-  }
-*/
-
-INTERNAL Entity *
-alloc_pool_entity(Entity **first_free_entity, MemArena *perm_arena)
-{
-  Entity *result = NULL;
-
-  if (*first_free_entity == NULL)
-  {
-    result = MEM_ARENA_PUSH_STRUCT_ZERO(perm_arena, Entity);
-  }
-  else
-  {
-    result = (*first_free_entity);
-    MEMORY_ZERO_STRUCT(result);
-
-    (*first_free_entity) = (*first_free_entity)->next;
-  }
-
-  return result;
-}
-
-INTERNAL void 
-release_pool_entity(Entity **first_free_entity, Entity *entity)
-{
-  // TODO(Ryan): Update next and prev of state->first_entity list
-  entity->next = (*first_free_entity);
-  (*first_free_entity) = entity;
-}
-
-INTERNAL Entity *
-push_entity(Entity **first_free_entity, MemArena *mem_arena, Entity **first_entity, Entity **last_entity, ENTITY_COMPONENT_FLAG flags)
-{
-  Entity *result = NULL;  
-
-  result = alloc_pool_entity(first_free_entity, mem_arena);
-  // IMPORTANT(Ryan): Pointer variables copies just like normal variables; they go away
-  // To actual reassign, must change where that pointer points at, e.g. *a = val;
-  // So, if wanting to what passed in pointer points to, require another layer of indirection
-  DLL_PUSH_BACK((*first_entity), (*last_entity), result);
-
-  result->component_flags = flags;
-
-  return result;
-}
-
 struct PACKED TileMap
 {
   u8 width, height;
@@ -435,110 +381,6 @@ asset_store_add_texture(SDL_Renderer *renderer, Map *texture_map, MemArena *mem_
   }
 }
 
-// merge sort for linked list
-// o(nlogn) best for comparison based sort
-// o(n) best for counting
-
-
-// recursion for readable solutions, but always go for non-recursive e.g. iterative, mathematical formula etc.
-
-INTERNAL Entity *
-get_middle_entity(Entity *first)
-{
-  Entity *slow = first, *fast = first->next;
-
-  while (fast != NULL && fast->next != NULL)
-  {
-    slow = slow->next;
-    fast = fast->next->next;
-  }
-
-  return slow;
-}
-
-INTERNAL void
-print_entity_linked_list(Entity *first)
-{
-  printf("[");
-  for (Entity *entity = first; entity != NULL; entity = entity->next)
-  {
-    printf("%d%s", (u32)entity->sprite_component.z_index, entity->next != NULL ? ", " : "");
-  }
-  printf("]\n");
-}
-
- // logarithmic to split
- // linear to merge
-INTERNAL Entity *
-sorted_merge(Entity *left, Entity *right, u32 indent)
-{
-  Entity *first = NULL, *last = NULL;
-
-  while (left != NULL && right != NULL)
-  {
-    if (left->sprite_component.z_index < right->sprite_component.z_index)
-    {
-      Entity *next = left->next;
-      DLL_PUSH_BACK(first, last, left);
-      left = next;
-    }
-    else
-    {
-      Entity *next = right->next;
-      DLL_PUSH_BACK(first, last, right);
-      right = next;
-    }
-  }
-
-  while (left != NULL)
-  {
-    Entity *next = left->next;
-    DLL_PUSH_BACK(first, last, left);
-    left = next;
-  }
-
-  while (right != NULL)
-  {
-    Entity *next = right->next;
-    DLL_PUSH_BACK(first, last, right);
-    right = next;
-  }
-
-  //printf("%*smerged: ", indent * 4, "");
-  //print_entity_linked_list(first);
-
-  return first;
-}
-
-
-INTERNAL Entity *
-sort_entities_by_z_index(Entity *first, u32 indent)
-{
-  if (first == NULL || first->next == NULL)
-  {
-    return first;
-  }
-  else
-  {
-    Entity *left = first;
-    Entity *one_before_midpoint = get_middle_entity(first);
-    Entity *tmp = one_before_midpoint->next;
-    // NOTE(Ryan): To 'separate' lists
-    one_before_midpoint->next = NULL;
-    Entity *right = tmp;
-
-    left = sort_entities_by_z_index(left, indent + 1);
-    //printf("%*ssplit left: ", indent * 4, "");
-    //print_entity_linked_list(left);
-
-    right = sort_entities_by_z_index(right, indent + 1);
-    //printf("%*ssplit right: ", indent * 4, "");
-    //print_entity_linked_list(right);
-
-    return sorted_merge(left, right, indent + 1);
-  }
-}
-
 #if 0
 struct TreeMapNode 
 {
@@ -1089,8 +931,69 @@ text_input {
 
 #endif
 
+// NOTE(Ryan): Simulation clock, for anything timed such as animations
+INTERNAL u64
+app_tick_ms(u64 tick)
+{
+  return tick * 1000 / APP_TICK_RATE;
+}
+
+// NOTE(Ryan): Systems can't create entities, so input edges spawn here before the schedule runs.
+// Reads only Input and AppState (including rand_seed), so replaying an input log spawns the same entities
+INTERNAL void
+app_spawn_from_input(AppState *state, Input *input)
+{
+  EntityWorld *world = state->entity_world;
+
+  if (input->bullet_fired && entity_is_alive(world, state->player))
+  {
+    Vec2F32 player_position = ENTITY_COMPONENT(world, state->player, transforms)->position;
+
+    // NOTE(Ryan): Immediate destroy is fine, as no system is walking rows yet
+    entity_destroy(world, state->bullets[state->next_bullet]);
+
+    EntityHandle bullet = entity_create(world, ENTITY_COMPONENT_FLAG_TRANSFORM | ENTITY_COMPONENT_FLAG_RIGID_BODY | 
+                                               ENTITY_COMPONENT_FLAG_SPRITE | ENTITY_COMPONENT_FLAG_BOX_COLLIDER);
+    if (bullet != ENTITY_HANDLE_INVALID)
+    {
+      TransformComponent *bullet_transform = ENTITY_COMPONENT(world, bullet, transforms);
+      SpriteComponent *bullet_sprite = ENTITY_COMPONENT(world, bullet, sprites);
+      bullet_transform->position = player_position + vec2_f32(32.0f, 12.0f);
+      bullet_transform->scale = {1.0f, 1.0f};
+      f32 spread = f32_rand_bilateral(&state->rand_seed) * 0.1f;
+      ENTITY_COMPONENT(world, bullet, rigid_bodies)->velocity = vec2_f32(APP_BULLET_SPEED, APP_BULLET_SPEED * spread);
+      // TODO(Ryan): Bullet texture; until then a shrunken tank
+      bullet_sprite->dimensions = {8.0f, 8.0f};
+      bullet_sprite->texture_key = map_key_str(s8_lit("tank-image"));
+      bullet_sprite->z_index = 6;
+      ENTITY_COMPONENT(world, bullet, box_colliders)->size = bullet_sprite->dimensions;
+    }
+
+    state->bullets[state->next_bullet] = bullet;
+    state->next_bullet = (state->next_bullet + 1) % APP_MAX_BULLET_COUNT;
+  }
+
+  // NOTE(Ryan): Drops a target at the cursor, for bullets to hit
+  if (input->mouse_clicked)
+  {
+    EntityHandle target = entity_create(world, ENTITY_COMPONENT_FLAG_TRANSFORM | ENTITY_COMPONENT_FLAG_SPRITE | 
+                                               ENTITY_COMPONENT_FLAG_BOX_COLLIDER);
+    if (target != ENTITY_HANDLE_INVALID)
+    {
+      SpriteComponent *target_sprite = ENTITY_COMPONENT(world, target, sprites);
+      target_sprite->dimensions = {32.0f, 32.0f};
+      target_sprite->texture_key = map_key_str(s8_lit("truck-image"));
+      target_sprite->z_index = 1;
+      TransformComponent *target_transform = ENTITY_COMPONENT(world, target, transforms);
+      target_transform->position = vec2_f32(input->mouse_x, input->mouse_y) - target_sprite->dimensions * 0.5f;
+      target_transform->scale = {1.0f, 1.0f};
+      ENTITY_COMPONENT(world, target, box_colliders)->size = target_sprite->dimensions;
+    }
+  }
+}
+
 EXPORT void
-app(AppState *state, Renderer *renderer, Input *input, MemArena *perm_arena)
+app_update(AppState *state, Input *input, MemArena *perm_arena)
 {
   if (!state->is_initialised)
   {
@@ -1102,6 +1005,113 @@ app(AppState *state, Renderer *renderer, Input *input, MemArena *perm_arena)
     global_tctx = thread_context_create();
     thread_context_set(&global_tctx);
 
+    state->schedule = schedule_create(perm_arena, state->job_system, APP_SYSTEM_ARENA_SIZE);
+    state->systems_state.collision_cell_size = APP_COLLISION_CELL_SIZE;
+    state->systems_state.want_destroy_colliding = true;
+
+#pragma mark LOAD_LEVEL_START
+    // NOTE(Ryan): Sprites only hold texture keys, so the level can load before app_render() has the textures
+    state->entity_world = entity_world_create(perm_arena, APP_MAX_ENTITY_COUNT);
+    EntityWorld *world = state->entity_world;
+
+    EntityHandle tank = entity_create(world, ENTITY_COMPONENT_FLAG_TRANSFORM | ENTITY_COMPONENT_FLAG_RIGID_BODY | ENTITY_COMPONENT_FLAG_SPRITE);
+    TransformComponent *tank_transform = ENTITY_COMPONENT(world, tank, transforms);
+    SpriteComponent *tank_sprite = ENTITY_COMPONENT(world, tank, sprites);
+    tank_transform->position = {100.0f, 100.0f};
+    tank_transform->scale = {1.0f, 1.0f};
+    tank_transform->rotation = 1.0f;
+    ENTITY_COMPONENT(world, tank, rigid_bodies)->velocity = {8.0f, 2.0f};
+    tank_sprite->dimensions = {32.0f, 32.0f}; // actual image dimensions
+    tank_sprite->texture_key = map_key_str(s8_lit("tank-image"));
+    tank_sprite->z_index = 5;
+    state->player = tank;
+
+    EntityHandle tank2 = entity_create(world, ENTITY_COMPONENT_FLAG_TRANSFORM | ENTITY_COMPONENT_FLAG_RIGID_BODY | ENTITY_COMPONENT_FLAG_SPRITE);
+    TransformComponent *tank2_transform = ENTITY_COMPONENT(world, tank2, transforms);
+    SpriteComponent *tank2_sprite = ENTITY_COMPONENT(world, tank2, sprites);
+    tank2_transform->position = {200.0f, 100.0f};
+    tank2_transform->scale = {2.0f, 2.0f};
+    tank2_transform->rotation = 2.0f;
+    ENTITY_COMPONENT(world, tank2, rigid_bodies)->velocity = {-8.0f, 2.0f};
+    tank2_sprite->dimensions = {32.0f, 32.0f};
+    tank2_sprite->texture_key = map_key_str(s8_lit("tank-image"));
+    tank2_sprite->z_index = 1;
+
+    EntityHandle truck = entity_create(world, ENTITY_COMPONENT_FLAG_TRANSFORM | ENTITY_COMPONENT_FLAG_RIGID_BODY | ENTITY_COMPONENT_FLAG_SPRITE | ENTITY_COMPONENT_FLAG_BOX_COLLIDER);
+    TransformComponent *truck_transform = ENTITY_COMPONENT(world, truck, transforms);
+    SpriteComponent *truck_sprite = ENTITY_COMPONENT(world, truck, sprites);
+    truck_transform->position = {300.0f, 300.0f};
+    truck_transform->scale = {1.0f, 1.0f};
+    truck_transform->rotation = 3.0f;
+    ENTITY_COMPONENT(world, truck, rigid_bodies)->velocity = {0.0f, 0.0f};
+    truck_sprite->dimensions = {32.0f, 32.0f};
+    truck_sprite->texture_key = map_key_str(s8_lit("truck-image"));
+    truck_sprite->z_index = 1;
+    ENTITY_COMPONENT(world, truck, box_colliders)->size = truck_sprite->dimensions;
+
+    EntityHandle chopper = entity_create(world, ENTITY_COMPONENT_FLAG_TRANSFORM | ENTITY_COMPONENT_FLAG_RIGID_BODY | ENTITY_COMPONENT_FLAG_SPRITE | ENTITY_COMPONENT_FLAG_ANIMATION);
+    TransformComponent *chopper_transform = ENTITY_COMPONENT(world, chopper, transforms);
+    SpriteComponent *chopper_sprite = ENTITY_COMPONENT(world, chopper, sprites);
+    AnimationComponent *chopper_animation = ENTITY_COMPONENT(world, chopper, animations);
+    chopper_transform->position = {600.0f, 300.0f};
+    chopper_transform->scale = {1.0f, 1.0f};
+    chopper_transform->rotation = 4.0f;
+    ENTITY_COMPONENT(world, chopper, rigid_bodies)->velocity = {0.0f, 0.0f};
+    chopper_sprite->dimensions = {32.0f, 32.0f};
+    chopper_sprite->texture_key = map_key_str(s8_lit("chopper-image"));
+    chopper_sprite->z_index = 1;
+    chopper_animation->num_frames = 2;
+    chopper_animation->current_frame = 0;
+    chopper_animation->frame_rate = 10;
+    chopper_animation->should_loop = true;
+    chopper_animation->start_time = (u32)app_tick_ms(state->tick);
+
+#pragma mark LOAD_LEVEL_END
+  } 
+
+  EntityWorld *world = state->entity_world;
+
+  MemArenaTemp temp_arena = mem_arena_scratch_get(NULL, 0);
+
+  app_spawn_from_input(state, input);
+
+  // NOTE(Ryan): Every tick, as app.so's copy of the job thread locals is fresh after a reload
+  job_system_attach_creator_thread(state->job_system);
+
+  schedule_begin_frame(state->schedule);
+  for (u32 system_i = 0; system_i < ARRAY_COUNT(app_systems); system_i += 1)
+  {
+    schedule_add_system(state->schedule, &app_systems[system_i]);
+  }
+
+  SystemContext system_context = ZERO_STRUCT;
+  system_context.world = world;
+  system_context.delta = APP_TICK_DELTA;
+  system_context.ms = app_tick_ms(state->tick);
+  system_context.user = &state->systems_state;
+  schedule_run(state->schedule, temp_arena.arena, &system_context);
+
+  // NOTE(Ryan): Sync point. Entities destroyed this tick are still in sprite_draws, so are drawn one last time
+  entity_world_sync(world);
+
+  state->tick += 1;
+
+  // TODO(Ryan): Convert pixels/s to m/s
+
+  // TODO(Ryan): process event queues here?
+
+  // collision map for pixel perfect (mesh collider for 3d)
+
+  mem_arena_scratch_release(temp_arena);
+}
+
+EXPORT void
+app_render(AppState *state, Renderer *renderer, f32 alpha, MemArena *perm_arena)
+{
+  if (!state->is_render_initialised)
+  {
+    state->is_render_initialised = true;
+
     state->asset_store.textures = map_create(perm_arena);
     state->asset_store.fonts = map_create(perm_arena);
     state->asset_store.audio = map_create(perm_arena);
@@ -1113,7 +1123,6 @@ app(AppState *state, Renderer *renderer, Input *input, MemArena *perm_arena)
     String8 tile_map_file = s8_read_entire_file(perm_arena, s8_lit("jungle.bin")); 
     TileMap *tile_map = (TileMap *)tile_map_file.str;
 
-#pragma mark LOAD_LEVEL_START
     asset_store_add_texture(renderer->renderer, &state->asset_store.textures, perm_arena,
                             "tank-image", "./tank-panther-right.png");
     asset_store_add_texture(renderer->renderer, &state->asset_store.textures, perm_arena,
@@ -1123,145 +1132,52 @@ app(AppState *state, Renderer *renderer, Input *input, MemArena *perm_arena)
 
     asset_store_add_font(renderer->renderer, &state->asset_store.fonts, perm_arena,
                             "droid-sans", "./DroidSans.ttf", 24);
+  }
 
-    Entity *tank = push_entity(&state->first_free_entity, perm_arena, &state->first_entity, &state->last_entity, 
-                               ENTITY_COMPONENT_FLAG_TRANSFORM | ENTITY_COMPONENT_FLAG_RIGID_BODY | ENTITY_COMPONENT_FLAG_SPRITE);
-    tank->transform_component.position = {100.0f, 100.0f};
-    tank->transform_component.scale = {1.0f, 1.0f};
-    tank->transform_component.rotation = 1.0f;
-    tank->rigid_body_component.velocity = {8.0f, 2.0f};
-    tank->sprite_component.dimensions = {32.0f, 32.0f}; // actual image dimensions
-    tank->sprite_component.texture_key = map_key_str(s8_lit("tank-image"));
-    tank->sprite_component.z_index = 5;
-
-    Entity *tank2 = push_entity(&state->first_free_entity, perm_arena, &state->first_entity, &state->last_entity, 
-                               ENTITY_COMPONENT_FLAG_TRANSFORM | ENTITY_COMPONENT_FLAG_RIGID_BODY | ENTITY_COMPONENT_FLAG_SPRITE);
-    tank2->transform_component.position = {200.0f, 100.0f};
-    tank2->transform_component.scale = {2.0f, 2.0f};
-    tank2->transform_component.rotation = 2.0f;
-    tank2->rigid_body_component.velocity = {-8.0f, 2.0f};
-    tank2->sprite_component.dimensions = {32.0f, 32.0f};
-    tank2->sprite_component.texture_key = map_key_str(s8_lit("tank-image"));
-    tank2->sprite_component.z_index = 1;
-
-    Entity *truck = push_entity(&state->first_free_entity, perm_arena, &state->first_entity, &state->last_entity, 
-                               ENTITY_COMPONENT_FLAG_TRANSFORM | ENTITY_COMPONENT_FLAG_RIGID_BODY | ENTITY_COMPONENT_FLAG_SPRITE | ENTITY_COMPONENT_FLAG_BOX_COLLIDER);
-    truck->transform_component.position = {300.0f, 300.0f};
-    truck->transform_component.scale = {1.0f, 1.0f};
-    truck->transform_component.rotation = 3.0f;
-    truck->rigid_body_component.velocity = {0.0f, 0.0f};
-    truck->sprite_component.dimensions = {32.0f, 32.0f};
-    truck->sprite_component.texture_key = map_key_str(s8_lit("truck-image"));
-    truck->sprite_component.z_index = 1;
-    truck->box_collider_component.size = truck->sprite_component.dimensions;
-
-    Entity *chopper = push_entity(&state->first_free_entity, perm_arena, &state->first_entity, &state->last_entity, 
-                               ENTITY_COMPONENT_FLAG_TRANSFORM | ENTITY_COMPONENT_FLAG_RIGID_BODY | ENTITY_COMPONENT_FLAG_SPRITE | ENTITY_COMPONENT_FLAG_ANIMATION);
-    chopper->transform_component.position = {600.0f, 300.0f};
-    chopper->transform_component.scale = {1.0f, 1.0f};
-    chopper->transform_component.rotation = 4.0f;
-    chopper->rigid_body_component.velocity = {0.0f, 0.0f};
-    chopper->sprite_component.dimensions = {32.0f, 32.0f};
-    chopper->sprite_component.texture_key = map_key_str(s8_lit("chopper-image"));
-    chopper->sprite_component.z_index = 1;
-    chopper->animation_component.num_frames = 2;
-    chopper->animation_component.current_frame = 0;
-    chopper->animation_component.frame_rate = 10;
-    chopper->animation_component.should_loop = true;
-    chopper->animation_component.start_time = state->ms;
+  MemArenaTemp temp_arena = mem_arena_scratch_get(NULL, 0);
 
-#pragma mark LOAD_LEVEL_END
-  } 
+  // TODO(Ryan): map render, cache texture from map asset store if doing subsets?
 
-  for (Entity *entity = state->first_entity; entity != NULL; entity = entity->next)
+  // NOTE(Ryan): Read only, so rendering never feeds back into the simulation
+  for (u32 draw_i = 0; draw_i < state->systems_state.sprite_draws.count; draw_i += 1)
   {
+    SpriteDraw *draw = &state->systems_state.sprite_draws.draws[draw_i];
+    Vec2F32 position = sprite_draw_interpolated_position(draw, alpha);
+    draw_texture(renderer->renderer, &state->asset_store.textures, draw->texture_key,
+                 position, draw->dimensions, draw->texture_offset);
+  }
 
-    if (HAS_FLAGS_ALL(entity->component_flags, (ENTITY_COMPONENT_FLAG_TRANSFORM | ENTITY_COMPONENT_FLAG_RIGID_BODY)))
-    {
-      // Introducing 'equations of motion' essentially means giving momentum, i.e. no instantaneous direction changes
-      // p = 0.5f * acceleration * SQUARE(time) + velocity * time + position;
-      // v = acceleration * t + v
-      // if (down) acceleration = 1.0f;
-      // acceleration += -0.7f * v (friction)
-
-      // TODO(Ryan): add acceleration
-      entity->transform_component.position += entity->rigid_body_component.velocity * state->delta;
-
-      // TODO(Ryan): add rotation matrices (from app_template)
-    }
-
-
-    if (HAS_FLAGS_ALL(entity->component_flags, (ENTITY_COMPONENT_FLAG_SPRITE | ENTITY_COMPONENT_FLAG_ANIMATION)))
+  if (state->debug_overlay)
+  {
+    SDL_SetRenderDrawColor(renderer->renderer, 255, 255, 255, 255);
+    ColliderSet *colliders = &state->systems_state.colliders;
+    for (u32 draw_collider_i = 0; draw_collider_i < colliders->count; draw_collider_i += 1)
     {
-      AnimationComponent *anim = &entity->animation_component;
-
-      u32 time_elapsed = (state->ms - anim->start_time);
-
-      anim->current_frame = (u32)(time_elapsed * (anim->frame_rate / 1000.0f)) % anim->num_frames;
-
-      entity->sprite_component.texture_offset.x = anim->current_frame * entity->sprite_component.dimensions.w;
+      Vec2F32 min = vec2_f32(colliders->min_x[draw_collider_i], colliders->min_y[draw_collider_i]);
+      Vec2F32 max = vec2_f32(colliders->max_x[draw_collider_i], colliders->max_y[draw_collider_i]);
+      SDL_Rect collider_bounding = vec2_f32_to_sdl_rect(min, max - min);
+      SDL_RenderDrawRect(renderer->renderer, &collider_bounding);
     }
 
-
-    if (HAS_FLAGS_ALL(entity->component_flags, (ENTITY_COMPONENT_FLAG_TRANSFORM | ENTITY_COMPONENT_FLAG_BOX_COLLIDER)))
+    // NOTE(Ryan): Last tick's system timings, wall then summed job time, so busy > wall means it ran in parallel
+    Font *font = (Font *)map_val_assert(&state->asset_store.fonts, "droid-sans");
+    Vec2F32 text_pos = vec2_f32(5.0f, 5.0f);
+    for (u32 system_i = 0; system_i < state->schedule->system_count; system_i += 1)
     {
-      for (Entity *collision_entity = entity->next; collision_entity != NULL; collision_entity = collision_entity->next)
-      {
-        SDL_Rect entity_bounding = \
-          vec2_f32_to_sdl_rect(entity->transform_component.position, entity->box_collider_component.size);
-        SDL_Rect collision_entity_bounding = \
-          vec2_f32_to_sdl_rect(collision_entity->transform_component.position, collision_entity->box_collider_component.size);
-
-        // AABB
-        if (SDL_HasIntersection(&entity_bounding, &collision_entity_bounding))
-        {
-          // TODO(Ryan): remove both entities
-          CollisionEvent collision_event = ZERO_STRUCT;
-        }
-      }
+      ScheduleSystem *system = &state->schedule->systems[system_i];
+      String8 timing = s8_fmt(temp_arena.arena, "%s: %.3fms wall, %.3fms busy", system->desc.name,
+                              (system->end_ns - system->start_ns) / 1000000.0, system->busy_ns / 1000000.0);
+      PreparedText text = prepare_text(renderer->renderer, font, timing);
+      draw_prepared_text(renderer->renderer, &text, text_pos);
+      text_pos.y += (f32)font->character_height;
     }
   }
 
-  // TODO(Ryan): Convert pixels/s to m/s
-
-  // TODO(Ryan): process event queues here?
-
-  // collision map for pixel perfect (mesh collider for 3d)
-
-  // TODO(Ryan): map render, cache texture from map asset store if doing subsets?
-
-  // TODO(Ryan): update state->last_entity as well
-  //printf("starting: ");
-  //print_entity_linked_list(state->first_entity);
-  state->first_entity = sort_entities_by_z_index(state->first_entity, 0);
-  //printf("final: ");
-  //print_entity_linked_list(state->first_entity);
-
+  // NOTE(Ryan): Dead code, kept as a sketch until particles are a system stepped per tick
 #if 0
-  for (Entity *entity = state->first_entity; entity != NULL; entity = entity->next)
-  {
-    if (HAS_FLAGS_ALL(entity->component_flags, (ENTITY_COMPONENT_FLAG_TRANSFORM | ENTITY_COMPONENT_FLAG_SPRITE)))
-    {
-
-      if (state->debug_overlay)
-      {
-        if (HAS_FLAGS_ALL(entity->component_flags, (ENTITY_COMPONENT_FLAG_BOX_COLLIDER)))
-        {
-          SDL_SetRenderDrawColor(renderer->renderer, 255, 255, 255, 255);
-
-          SDL_FRect dst_rect = vec2_f32_to_sdl_frect(entity->transform_component.position, entity->box_collider_component.size);
-          SDL_RenderDrawRectF(renderer->renderer, &dst_rect);
-        }
-      }
-
-      Vec2F32 texture_dim = vec2_f32_hadamard(entity->sprite_component.dimensions, entity->transform_component.scale);
-      draw_texture(renderer->renderer, &state->asset_store.textures, entity->sprite_component.texture_key,
-                   entity->transform_component.position, texture_dim, entity->sprite_component.texture_offset);
-    }
-  }
-
   // NOTE(Ryan): Particle system test
   // more randomness the better
+  // TODO(Ryan): Steps once per displayed frame; make it a system so it steps per tick
 #define PARTICLE_DENSITY_COUNT 1
   for (u32 particle_spawn_i = 0; particle_spawn_i < PARTICLE_DENSITY_COUNT; particle_spawn_i++)
   {
@@ -1273,7 +1189,7 @@ app(AppState *state, Renderer *renderer, Input *input, MemArena *perm_arena)
 
     particle->position = vec2_f32(400.0f, 400.0f);
 
-    particle->velocity = vec2_f32(rand_bilateral_f32(&state->rand_seed) * 100.0f, -100.0f);
+    particle->velocity = vec2_f32(rand_bilateral_f32(&state->effects_seed) * 100.0f, -100.0f);
     particle->acceleration = vec2_f32(0.0f, 220.0f);
     particle->colour = vec4_f32(0.8f, 0.5f, 0.9f, 1.0f);
     particle->colour_velocity = vec4_f32(0.0f, 0.0f, 0.0f, -0.5f);
@@ -1283,7 +1199,7 @@ app(AppState *state, Renderer *renderer, Input *input, MemArena *perm_arena)
   {
     Particle *particle = &state->particles[particle_i];
 
-    particle->position += particle->velocity * state->delta;
+    particle->position += particle->velocity * APP_TICK_DELTA;
     if (particle->position.y > 405.0f)
     {
       f32 restitution = 0.5f;
@@ -1291,12 +1207,14 @@ app(AppState *state, Renderer *renderer, Input *input, MemArena *perm_arena)
       particle->velocity.y = restitution * -particle->velocity.y;
     }
 
-    particle->velocity += particle->acceleration * state->delta;
-    particle->colour += particle->colour_velocity * state->delta;
+    particle->velocity += particle->acceleration * APP_TICK_DELTA;
+    particle->colour += particle->colour_velocity * APP_TICK_DELTA;
 
     // TODO(Ryan): Store texture width and height
     draw_texture(renderer->renderer, &state->asset_store.textures, map_key_str(s8_lit("tank-image")),
                  particle->position, vec2_f32(32.0f, 32.0f), vec2_i32(0, 0), 0.0f, particle->colour);
   }
 #endif
+
+  mem_arena_scratch_release(temp_arena);
 }
@@ -2,69 +2,8 @@
 #if !defined(APP_H)
 #define APP_H
 
-typedef u32 ENTITY_COMPONENT_FLAG;
-enum
-{
-  ENTITY_COMPONENT_FLAG_TRANSFORM = (1 << 0),
-  ENTITY_COMPONENT_FLAG_SPRITE = (1 << 1),
-  ENTITY_COMPONENT_FLAG_RIGID_BODY = (1 << 2),
-  ENTITY_COMPONENT_FLAG_PROJECTILE = (1 << 3),
-  ENTITY_COMPONENT_FLAG_ANIMATION = (1 << 4),
-  ENTITY_COMPONENT_FLAG_BOX_COLLIDER = (1 << 5),
-  // ...
-};
-
-// COMBINATORIC DATA:
-// IMPORTANT: “what something is” and how its memory should be interpreted are different
-// “why do I even care what ‘is a button’ or what ‘is a slider’, to the degree that I have to store it at each node in the hierarchy?”
-// higher level features can be described at a lower level with what data we have, what data we need to produce from that data, and a function (in the mathematical sense) taking our inputs to our outputs.
-// IMPORTANT: no discriminated unions now (okay to have 'waste' data)
-
-struct AnimationComponent
-{
-  u32 num_frames, current_frame, frame_rate; // frames per second
-  b32 should_loop;
-  u32 start_time;
-};
-
-// could also have circle, pixel-perfect etc.
-struct BoxColliderComponent
-{
-  Vec2F32 size, offset;
-};
-
-struct SpriteComponent
-{
-  Vec2F32 dimensions;
-  Vec2I32 texture_offset; 
-  // TODO(Ryan): OPTIMAL SOLUTION IS TO HAVE LAYERS, E.G. VEGETATION LAYER, BULLET LAYER, ETC.
-  u32 z_index;
-  MapKey texture_key;
-};
-
-struct Entity
-{
-  ENTITY_COMPONENT_FLAG component_flags;
-
-  Entity *next, *prev;
-
-  struct TransformComponent
-  {
-    Vec2F32 position, scale;
-    f32 rotation;
-  } transform_component;
-
-  SpriteComponent sprite_component;
-
-  BoxColliderComponent box_collider_component;
-
-  struct RigidBodyComponent
-  {
-    Vec2F32 velocity;
-  } rigid_body_component;
-
-  AnimationComponent animation_component;
-};
+#include "app-ecs.h"
+#include "app-schedule.h"
 
 struct Font
 {
@@ -88,7 +27,7 @@ struct AssetStore
 
 struct CollisionEvent
 {
-  Entity *a, *b;
+  EntityHandle a, b; // may be stale by the time the event is handled
 };
 
 struct Particle
@@ -97,21 +36,43 @@ struct Particle
   Vec4F32 colour, colour_velocity;
 };
 
+// NOTE(Ryan): Archetype arrays are pushed at this capacity, see app-ecs.h
+#define APP_MAX_ENTITY_COUNT 4096
+// NOTE(Ryan): Broad phase grid, around twice the typical collider size, see collision_broad_phase()
+#define APP_COLLISION_CELL_SIZE 128.0f
+
+// NOTE(Ryan): Per system, for its output, e.g. the sprite draw list
+#define APP_SYSTEM_ARENA_SIZE MB(64)
+// NOTE(Ryan): Live bullets; firing past this recycles the oldest, so holding fire can't fill the entity world
+#define APP_MAX_BULLET_COUNT 32
+#define APP_BULLET_SPEED 240.0f
+
+// NOTE(Ryan): Simulation rate, whatever the display's; linux-main.cpp runs as many ticks as wall time has banked
+#define APP_TICK_RATE 60
+#define APP_TICK_DELTA (1.0f / APP_TICK_RATE)
+
 IGNORE_WARNING_PADDED()
 typedef struct AppState AppState;
 struct AppState
 {
   b32 debugger_present;
   b32 is_initialised;
-  f32 delta;
-  u64 ms;
-  u32 rand_seed; // perhaps rename effects_series?
+  b32 is_render_initialised;
+  // IMPORTANT(Ryan): Everything app_update() reads must be in here or in its Input, never wall time,
+  // so recorded input replays to the same state bit for bit
+  u64 tick; // ticks simulated, so simulation time is tick * APP_TICK_DELTA
+  u32 rand_seed; // simulation only, and recorded with the input log
+  u32 effects_seed; // render-only randomness, e.g. particles, so the frame rate can't perturb rand_seed
 
   b32 debug_overlay;
 
-  Entity *first_free_entity;
-  Entity *first_entity;
-  Entity *last_entity;
+  EntityWorld *entity_world;
+  EntityHandle player; // fires bullets
+  EntityHandle bullets[APP_MAX_BULLET_COUNT];
+  u32 next_bullet;
+  JobSystem *job_system; // owned by platform, so its threads aren't running app.so code across a reload
+  Schedule *schedule;
+  AppSystemsState systems_state;
 
   u32 next_particle;
   Particle particles[64];
@@ -142,9 +103,15 @@ struct Input
 };
 IGNORE_WARNING_POP()
 
-typedef void (*app_func)(AppState *state, Renderer *renderer, Input *input, MemArena *perm_arena);
+// NOTE(Ryan): One fixed tick of simulation, deterministic given AppState and input
+typedef void (*app_update_func)(AppState *state, Input *input, MemArena *perm_arena);
+// NOTE(Ryan): Once per displayed frame, alpha of the way from the second last tick's state to the last
+typedef void (*app_render_func)(AppState *state, Renderer *renderer, f32 alpha, MemArena *perm_arena);
+
+EXPORT void
+app_update(AppState *state, Input *input, MemArena *perm_arena);
 
 EXPORT void
-app(AppState *state, Renderer *renderer, Input *input, MemArena *perm_arena);
+app_render(AppState *state, Renderer *renderer, f32 alpha, MemArena *perm_arena);
 
 #endif
@@ -17,11 +17,17 @@ some_func(void)
   return val; // NOTE(Ryan): May be NULL
 }
 
-INTERNAL void *
+// NOTE(Ryan): Runs on SDL's audio thread. Only consumer of the ring, so no SDL_LockAudioDevice() needed
+INTERNAL void
 feed_audio_cb(void *user_data, u8 *stream, int len)
 {
-  u32 bytes_remaining = SDL_AudioStreamAvailable(stream);
-  u32 silence_bytes = len - bytes_remaining;
+  SPSCRing *sample_ring = (SPSCRing *)user_data;
+
+  u32 sample_count = (u32)len / sizeof(f32);
+  u32 popped_count = (u32)spsc_ring_pop_batch(sample_ring, stream, sample_count);
+
+  // NOTE(Ryan): Underrun, so pad with silence rather than replaying stale samples
+  MEMORY_ZERO(stream + popped_count * sizeof(f32), (sample_count - popped_count) * sizeof(f32));
 }
 
 
@@ -42,11 +48,10 @@ gui_fatal_error(const char *attempt, const char *reason, const char *resolution)
 // TODO(Ryan): Introduced GUI_ASSERT, i.e. SDL_assert();
 // In face, introduce gui_error boxes
 
-// SDL_LockAudioDevice() implements a mutex
-// other audio functions, e.g. PutAudio are thread-safe, so can ignore explicit 
-// TODO: does this handle when say thread is writing audio and when free it simultaneously?
+// SDL_LockAudioDevice() implements a mutex, which the audio thread could block on whilst main thread holds it.
+// Instead, main thread is sole producer into a SPSC ring that callback is sole consumer of
 
-// AtomicSet() means all cores (more importantly all caches?) will see this change (used in conjunction with locks?)
+#define AUDIO_SAMPLE_RING_CAPACITY KB(16)
 
 f32 volume_slider_val = 0.0f;
 
@@ -63,6 +68,10 @@ audio_player(void)
   // also don't have to give up time slices
   wave_spec.callback = feed_audio_cb;
 
+  MemArena *audio_arena = mem_arena_allocate(MB(1));
+  SPSCRing *sample_ring = spsc_ring_create(audio_arena, sizeof(f32), AUDIO_SAMPLE_RING_CAPACITY);
+  wave_spec.userdata = sample_ring;
+
   SDL_AudioDeviceID audio_device = SDL_OpenAudioDevice(NULL, 0, &wave_spec, NULL, 0);
   if (audio_device == 0)
   {
@@ -92,13 +101,17 @@ audio_player(void)
   // convert all at once, i.e. don't wait for more to be put in queue
   SDL_AudioStreamFlush(audio_stream);
 
-  // returns bytes; confusing nomenclature with frames/samples etc.
-  if (SDL_GetQueuedAudioSize(audio_device) < KB(8))
+  SDL_PauseAudioDevice(audio_device, 0); // pauses progression of audio queue
+
+  u32 start_ms = SDL_GetTicks();
+  while (SDL_GetTicks() - start_ms < 5000)
   {
+    // returns bytes; confusing nomenclature with frames/samples etc.
     u32 bytes_remaining = SDL_AudioStreamAvailable(audio_stream);
-    if (bytes_remaining > 0)
+    u32 bytes_free = (u32)spsc_ring_free_count(sample_ring) * sizeof(f32);
+    if (bytes_remaining > 0 && bytes_free > 0)
     {
-      u32 bytes_to_write = MIN(bytes_remaining, KB(32));
+      u32 bytes_to_write = MIN(MIN(bytes_remaining, bytes_free), KB(32));
       u8 converted_audio_bytes[KB(32)] = ZERO_STRUCT;
       u32 num_converted_bytes = SDL_AudioStreamGet(audio_stream, converted_audio_bytes, bytes_to_write);
 
@@ -117,14 +130,14 @@ audio_player(void)
 
       }
 
-      SDL_QueueAudio(audio_device, converted_audio_bytes, num_converted_bytes);
+      // NOTE(Ryan): Only producer, so free count can only grow and this never comes up short
+      spsc_ring_push_batch(sample_ring, converted_audio_bytes, num_converted_bytes / sizeof(f32));
     }
-  }
-
 
+    SDL_Delay(1);
+  }
 
-  SDL_QueueAudio(audio_device, wave_buf, wave_len);
-  // as queue audio makes copy
+  // as stream put makes copy
   SDL_FreeWAV(wave_buf);
   
   SDL_FreeAudioStream(audio_stream);
@@ -139,9 +152,7 @@ audio_player(void)
   
   // SDL_PointInRect();
 
-  SDL_PauseAudioDevice(audio_device, 0); // pauses progression of audio queue
-
-  SDL_Delay(5000);
-
   SDL_CloseAudioDevice(audio_device);
+  // NOTE(Ryan): Only after close, as callback may still be reading ring until then
+  mem_arena_deallocate(audio_arena);
 }
@@ -0,0 +1,136 @@
+// SPDX-License-Identifier: zlib-acknowledgement
+#pragma once
+
+// IMPORTANT(Ryan): volatile only stops the compiler caching a value in a register.
+// It gives neither atomicity nor ordering with respect to other cores, so shared variables go through here.
+//
+// RELAXED: atomic, but no ordering of surrounding reads/writes (e.g. statistics counters)
+// ACQUIRE: later reads/writes can't move before this load (e.g. taking a lock, reading a 'ready' flag)
+// RELEASE: earlier reads/writes can't move after this store (e.g. releasing a lock, publishing data)
+// SEQ_CST: single total order across all SEQ_CST operations; required for store-then-load handshakes (Dekker)
+//
+// NOTE(Ryan): Read-modify-write macros return the value prior to the operation
+
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#define ATOMIC_LOAD_RELAXED(p) __atomic_load_n((p), __ATOMIC_RELAXED)
+#define ATOMIC_LOAD_ACQUIRE(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define ATOMIC_LOAD_SEQ_CST(p) __atomic_load_n((p), __ATOMIC_SEQ_CST)
+
+#define ATOMIC_STORE_RELAXED(p, v) __atomic_store_n((p), (v), __ATOMIC_RELAXED)
+#define ATOMIC_STORE_RELEASE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define ATOMIC_STORE_SEQ_CST(p, v) __atomic_store_n((p), (v), __ATOMIC_SEQ_CST)
+
+#define ATOMIC_ADD_RELAXED(p, v) __atomic_fetch_add((p), (v), __ATOMIC_RELAXED)
+#define ATOMIC_ADD_ACQ_REL(p, v) __atomic_fetch_add((p), (v), __ATOMIC_ACQ_REL)
+#define ATOMIC_ADD_SEQ_CST(p, v) __atomic_fetch_add((p), (v), __ATOMIC_SEQ_CST)
+
+#define ATOMIC_SUB_RELAXED(p, v) __atomic_fetch_sub((p), (v), __ATOMIC_RELAXED)
+#define ATOMIC_SUB_ACQ_REL(p, v) __atomic_fetch_sub((p), (v), __ATOMIC_ACQ_REL)
+#define ATOMIC_SUB_SEQ_CST(p, v) __atomic_fetch_sub((p), (v), __ATOMIC_SEQ_CST)
+
+#define ATOMIC_EXCHANGE_ACQUIRE(p, v) __atomic_exchange_n((p), (v), __ATOMIC_ACQUIRE)
+#define ATOMIC_EXCHANGE_ACQ_REL(p, v) __atomic_exchange_n((p), (v), __ATOMIC_ACQ_REL)
+#define ATOMIC_EXCHANGE_SEQ_CST(p, v) __atomic_exchange_n((p), (v), __ATOMIC_SEQ_CST)
+
+// NOTE(Ryan): On failure, *expected_p is updated with current value
+#define ATOMIC_CAS_ACQUIRE(p, expected_p, desired) \
+  __atomic_compare_exchange_n((p), (expected_p), (desired), false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)
+#define ATOMIC_CAS_ACQ_REL(p, expected_p, desired) \
+  __atomic_compare_exchange_n((p), (expected_p), (desired), false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)
+#define ATOMIC_CAS_SEQ_CST(p, expected_p, desired) \
+  __atomic_compare_exchange_n((p), (expected_p), (desired), false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)
+// NOTE(Ryan): May spuriously fail, so only use in a retry loop (cheaper on LL/SC architectures like ARM)
+#define ATOMIC_CAS_WEAK_ACQ_REL(p, expected_p, desired) \
+  __atomic_compare_exchange_n((p), (expected_p), (desired), true, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)
+
+#define FENCE_ACQUIRE() __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#define FENCE_RELEASE() __atomic_thread_fence(__ATOMIC_RELEASE)
+#define FENCE_SEQ_CST() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+// NOTE(Ryan): Compiler only, i.e. emits no instruction. Only for ordering against a signal handler on same thread
+#define COMPILER_BARRIER() __atomic_signal_fence(__ATOMIC_SEQ_CST)
+
+// NOTE(Ryan): Destructive interference size.
+// Adjacent-line prefetcher on Intel pulls pairs of lines, so hot counters may want 2 * CACHE_LINE_SIZE
+#define CACHE_LINE_SIZE 64
+#define CACHE_ALIGNED __attribute__((aligned(CACHE_LINE_SIZE)))
+// NOTE(Ryan): Pad remainder of a cache line after 'used' bytes of members
+#define CACHE_LINE_PAD(used) PAD(CACHE_LINE_SIZE - ((used) % CACHE_LINE_SIZE))
+
+#if defined(ARCH_X86_64)
+  // NOTE(Ryan): Hints spin to core; frees execution resources for SMT sibling and avoids memory order mis-speculation on exit
+  #define CPU_PAUSE() _mm_pause()
+#elif defined(ARCH_ARM64) || defined(ARCH_ARM32)
+  #define CPU_PAUSE() __asm__ __volatile__("yield")
+#else
+  #define CPU_PAUSE() COMPILER_BARRIER()
+#endif
+
+// NOTE(Ryan): Exponential backoff. Pauses while contention is likely short, then gives up time slice
+#define SPIN_PAUSE_LIMIT 64
+INTERNAL void
+spin_backoff(u32 *spin_count)
+{
+  if (*spin_count < SPIN_PAUSE_LIMIT)
+  {
+    for (u32 pause_i = 0; pause_i < *spin_count + 1; pause_i += 1)
+    {
+      CPU_PAUSE();
+    }
+    *spin_count = (*spin_count == 0) ? 1 : (*spin_count * 2);
+  }
+  else
+  {
+    sched_yield();
+  }
+}
+
+// NOTE(Ryan): Test-and-test-and-set, so waiters spin on a shared (read-only) cache line copy
+INTERNAL void
+spin_lock(u32 *lock)
+{
+  u32 spin_count = 0;
+  while (ATOMIC_EXCHANGE_ACQUIRE(lock, 1) != 0)
+  {
+    while (ATOMIC_LOAD_RELAXED(lock) != 0)
+    {
+      spin_backoff(&spin_count);
+    }
+  }
+}
+
+INTERNAL b32
+spin_try_lock(u32 *lock)
+{
+  return (ATOMIC_LOAD_RELAXED(lock) == 0 && ATOMIC_EXCHANGE_ACQUIRE(lock, 1) == 0);
+}
+
+INTERNAL void
+spin_unlock(u32 *lock)
+{
+  ATOMIC_STORE_RELEASE(lock, 0);
+}
+
+// IMPORTANT(Ryan): Sleeps only if *addr still equals expected, checked atomically by kernel,
+// so no lost wakeup if waker changes *addr before calling futex_wake().
+// May return spuriously, so always recheck condition in a loop
+INTERNAL void
+futex_wait(u32 *addr, u32 expected)
+{
+  syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+}
+
+INTERNAL void
+futex_wake(u32 *addr, u32 waiter_count)
+{
+  syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, waiter_count, NULL, NULL, 0);
+}
+
+INTERNAL void
+futex_wake_all(u32 *addr)
+{
+  futex_wake(addr, (u32)S32_MAX);
+}
@@ -97,9 +97,7 @@
   // TODO(Ryan): tail cail compiler macro?
   // https://blog.reverberate.org/2021/04/21/musttail-efficient-interpreters.html
   
-  // TODO(Ryan): Synchronisation atomics, e.g:
-  // #define AtomicAdd64(ptr, v) _InterlockedExchangeAdd64((ptr), (v))
-  // #define MEMORY_BARRIER()
+  // NOTE(Ryan): Synchronisation atomics in base-atomics.h
   #define THREAD_LOCAL __thread
 
   // NOTE(Ryan): 
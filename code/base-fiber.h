@@ -0,0 +1,124 @@
+// SPDX-License-Identifier: zlib-acknowledgement
+#pragma once
+
+// IMPORTANT(Ryan): Hand-rolled switch as swapcontext() does a sigprocmask() syscall every switch.
+// Only callee-saved state is preserved (SysV ABI), as switch is an ordinary function call to compiler.
+// A fiber can be resumed on a different thread to the one that suspended it,
+// so THREAD_LOCAL reads inside fiber code must not be cached across a switch
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+typedef struct FiberContext FiberContext;
+struct FiberContext
+{
+  void *stack_pointer;
+};
+
+typedef void (*fiber_func)(void *arg);
+
+typedef struct Fiber Fiber;
+struct Fiber
+{
+  FiberContext context;
+  u8 *stack_memory;
+  memory_index stack_memory_size;
+};
+
+#if defined(ARCH_X86_64)
+EXPORT void fiber_switch_context(FiberContext *from, FiberContext *to);
+EXPORT void fiber_entry_trampoline(void);
+
+// NOTE(Ryan): mxcsr and x87 control word are callee-saved too (rounding modes, denormal flags)
+__asm__(
+  ".text\n"
+  ".p2align 4\n"
+  "fiber_switch_context:\n"
+  "  pushq %rbp\n"
+  "  pushq %rbx\n"
+  "  pushq %r12\n"
+  "  pushq %r13\n"
+  "  pushq %r14\n"
+  "  pushq %r15\n"
+  "  subq $8, %rsp\n"
+  "  stmxcsr (%rsp)\n"
+  "  fnstcw 4(%rsp)\n"
+  "  movq %rsp, (%rdi)\n"
+  "  movq (%rsi), %rsp\n"
+  "  ldmxcsr (%rsp)\n"
+  "  fldcw 4(%rsp)\n"
+  "  addq $8, %rsp\n"
+  "  popq %r15\n"
+  "  popq %r14\n"
+  "  popq %r13\n"
+  "  popq %r12\n"
+  "  popq %rbx\n"
+  "  popq %rbp\n"
+  "  ret\n"
+  ".p2align 4\n"
+  "fiber_entry_trampoline:\n"
+  "  movq %r12, %rdi\n"
+  "  callq *%r13\n"
+  "  ud2\n"
+);
+#else
+  #error Fiber context switch not implemented for this architecture
+#endif
+
+// NOTE(Ryan): Lowest page is PROT_NONE, so an overflow faults instead of corrupting a neighbouring fiber
+INTERNAL Fiber
+fiber_create(memory_index stack_size, fiber_func func, void *arg)
+{
+  Fiber result = ZERO_STRUCT;
+
+  memory_index page_size = (memory_index)sysconf(_SC_PAGESIZE);
+  stack_size = ALIGN_POW2_UP(stack_size, page_size);
+  memory_index mapping_size = stack_size + page_size;
+
+  void *mapping = mmap(NULL, mapping_size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+  if (mapping == MAP_FAILED)
+  {
+    FATAL_ERROR("Failed to map fiber stack.", strerror(errno), "");
+  }
+
+  if (mprotect(mapping, page_size, PROT_NONE) != 0)
+  {
+    FATAL_ERROR("Failed to protect fiber stack guard page.", strerror(errno), "");
+  }
+
+  result.stack_memory = (u8 *)mapping;
+  result.stack_memory_size = mapping_size;
+
+  // NOTE(Ryan): Lay out stack so first switch 'returns' into trampoline with func/arg in r13/r12.
+  // Trampoline is entered with rsp 16-byte aligned, so call into func sees ABI alignment
+  u64 *stack_top = (u64 *)(result.stack_memory + mapping_size);
+  u64 *sp = stack_top - 8;
+  sp[0] = 0x00001f80 | ((u64)0x037f << 32); // default mxcsr | x87 control word
+  sp[1] = 0; // r15
+  sp[2] = 0; // r14
+  sp[3] = (u64)func; // r13
+  sp[4] = (u64)arg; // r12
+  sp[5] = 0; // rbx
+  sp[6] = 0; // rbp
+  sp[7] = (u64)fiber_entry_trampoline;
+
+  result.context.stack_pointer = sp;
+
+  return result;
+}
+
+INTERNAL void
+fiber_destroy(Fiber *fiber)
+{
+  munmap(fiber->stack_memory, fiber->stack_memory_size);
+  MEMORY_ZERO_STRUCT(fiber);
+}
+
+// NOTE(Ryan): Converting running thread into a fiber just requires somewhere to save its context,
+// so the 'from' of the first switch can be any FiberContext
+INTERNAL void
+fiber_switch(FiberContext *from, FiberContext *to)
+{
+  fiber_switch_context(from, to);
+}
@@ -50,11 +50,186 @@ s8_append_to_file(String8 file_name, String8 data)
   }
 }
 
+#include <dirent.h> 
+#include <sys/stat.h> 
+#include <sys/types.h> 
+#include <fcntl.h> 
+#include <unistd.h> 
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <linux/fs.h>
+
+// NOTE(Ryan): File contents never enter userspace, so no arena growth for large files.
+// Preference is a reflink (btrfs/xfs share extents, so O(1)), then in-kernel copy_file_range(),
+// then sendfile() for kernels/filesystems that reject copy_file_range() (e.g. cross-device pre 5.3)
+// IMPORTANT(Ryan): Destination permissions are copied from source
+INTERNAL b32
+s8_copy_file(String8 source_file, String8 dest_file)
+{
+  b32 result = false;
+
+  int source_fd = open((char *)source_file.str, O_RDONLY | O_CLOEXEC);
+  if (source_fd != -1)
+  {
+    struct stat source_stat = ZERO_STRUCT;
+    if (fstat(source_fd, &source_stat) == 0)
+    {
+      int dest_fd = open((char *)dest_file.str, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, source_stat.st_mode & 0777);
+      if (dest_fd != -1)
+      {
+        // NOTE(Ryan): O_CREAT mode is ignored if file already existed
+        fchmod(dest_fd, source_stat.st_mode & 07777);
+
+        if (ioctl(dest_fd, FICLONE, source_fd) == 0)
+        {
+          result = true;
+        }
+        else
+        {
+          u64 remaining = (u64)source_stat.st_size;
+          b32 want_sendfile = false;
+
+          while (remaining > 0)
+          {
+            ssize_t copied = copy_file_range(source_fd, NULL, dest_fd, NULL, remaining, 0);
+            if (copied == -1 && 
+                (errno == EXDEV || errno == ENOSYS || errno == EINVAL || errno == EOPNOTSUPP))
+            {
+              want_sendfile = true;
+              break;
+            }
+            if (copied <= 0)
+            {
+              break;
+            }
+            remaining -= (u64)copied;
+          }
+
+          if (want_sendfile)
+          {
+            // NOTE(Ryan): copy_file_range() may have partially succeeded, advancing both file offsets
+            off_t source_offset = (off_t)((u64)source_stat.st_size - remaining);
+            while (remaining > 0)
+            {
+              ssize_t copied = sendfile(dest_fd, source_fd, &source_offset, remaining);
+              if (copied <= 0)
+              {
+                break;
+              }
+              remaining -= (u64)copied;
+            }
+          }
+
+          result = (remaining == 0);
+        }
+
+        close(dest_fd);
+      }
+    }
+
+    close(source_fd);
+  }
+
+  return result;
+}
+
+#include <sys/mman.h>
+
+// NOTE(Ryan): Read-only view of file, so large assets aren't copied into an arena up front.
+// Pages are faulted in as they're touched, so a single front-to-back parse streams through file.
+// IMPORTANT(Ryan): Not null terminated, and valid until s8_unmap_entire_file()
+INTERNAL String8
+s8_map_entire_file(String8 file_name)
+{
+  String8 result = ZERO_STRUCT;
+
+  int fd = open((char *)file_name.str, O_RDONLY | O_CLOEXEC);
+  if (fd != -1)
+  {
+    struct stat file_stat = ZERO_STRUCT;
+    // NOTE(Ryan): mmap() of 0 bytes fails
+    if (fstat(fd, &file_stat) == 0 && file_stat.st_size > 0)
+    {
+      void *memory = mmap(NULL, (size_t)file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (memory != MAP_FAILED)
+      {
+        // NOTE(Ryan): Hint kernel to read ahead aggressively
+        madvise(memory, (size_t)file_stat.st_size, MADV_SEQUENTIAL);
+        result.str = (u8 *)memory;
+        result.size = (u64)file_stat.st_size;
+      }
+    }
+
+    // NOTE(Ryan): Mapping holds its own reference to file
+    close(fd);
+  }
+
+  return result;
+}
+
 INTERNAL void
-s8_copy_file(MemArena *arena, String8 source_file, String8 dest_file)
+s8_unmap_entire_file(String8 file)
 {
-  String8 source_file_data = s8_read_entire_file(arena, source_file);
-  s8_write_entire_file(dest_file, source_file_data);
+  if (file.str != NULL)
+  {
+    munmap(file.str, file.size);
+  }
+}
+
+#include <sys/uio.h>
+
+// NOTE(Ryan): Parts are gathered by the kernel, so e.g. a header and a large pixel buffer
+// needn't be copied into one allocation first. Issued in batches of IOV_MAX (1024 on Linux) parts,
+// and a short write (signal, >2GB) resumes mid-part
+INTERNAL b32
+s8_write_entire_file_vectored(String8 file_name, String8 *parts, u32 part_count)
+{
+  b32 result = false;
+
+  int fd = open((char *)file_name.str, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd != -1)
+  {
+    result = true;
+
+    u32 part_i = 0;
+    u64 part_offset = 0;
+    while (part_i < part_count)
+    {
+      struct iovec iovecs[1024];
+      u32 iovec_count = 0;
+      for (u32 i = part_i; i < part_count && iovec_count < ARRAY_COUNT(iovecs); i += 1)
+      {
+        u64 offset = (i == part_i) ? part_offset : 0;
+        iovecs[iovec_count].iov_base = parts[i].str + offset;
+        iovecs[iovec_count].iov_len = parts[i].size - offset;
+        iovec_count += 1;
+      }
+
+      ssize_t written = writev(fd, iovecs, (int)iovec_count);
+      if (written == -1 && errno == EINTR)
+      {
+        continue;
+      }
+      if (written <= 0)
+      {
+        result = false;
+        break;
+      }
+
+      u64 advance = (u64)written;
+      while (part_i < part_count && advance >= parts[part_i].size - part_offset)
+      {
+        advance -= parts[part_i].size - part_offset;
+        part_i += 1;
+        part_offset = 0;
+      }
+      part_offset += advance;
+    }
+
+    close(fd);
+  }
+
+  return result;
 }
 
 typedef u32 FILE_INFO_FLAG;
@@ -77,12 +252,6 @@ struct FileInfo
   u64 modify_time;
 };
 
-#include <dirent.h> 
-#include <sys/stat.h> 
-#include <sys/types.h> 
-#include <fcntl.h> 
-#include <unistd.h> 
-
 typedef struct FileIter FileIter;
 struct FileIter
 {
@@ -0,0 +1,760 @@
+// SPDX-License-Identifier: zlib-acknowledgement
+#pragma once
+
+// NOTE(Ryan): Writers for 32 bit 0xAARRGGBB pixels, rows stored bottom-up as in BMP/GL.
+// Every file is assembled as a list of parts and written with one s8_write_entire_file_vectored(),
+// so pixel data that is already in file order (BMP) is never copied.
+// Work proportional to pixel count (swizzle, PNG filter + deflate) is split into row bands run as jobs;
+// pass NULL JobSystem to run them on calling thread.
+// IMPORTANT(Ryan): Scratch comes from a temporary region of arena, so nothing is left allocated on return
+
+#define IMAGE_BAND_TARGET_SIZE KB(512)
+
+INTERNAL u32
+image_rows_per_band(u64 row_size)
+{
+  u32 result = (u32)MAX(1, IMAGE_BAND_TARGET_SIZE / row_size);
+
+  return result;
+}
+
+INTERNAL void
+image_write_u32_be(u8 *dst, u32 value)
+{
+  dst[0] = (u8)(value >> 24);
+  dst[1] = (u8)(value >> 16);
+  dst[2] = (u8)(value >> 8);
+  dst[3] = (u8)value;
+}
+
+// NOTE(Ryan): Waits like any other worker, so calling thread encodes bands too
+INTERNAL void
+image_run_band_jobs(JobSystem *jobs, job_func func, void *payloads, memory_index payload_size, u32 band_count)
+{
+  if (jobs != NULL)
+  {
+    JobCounter counter = ZERO_STRUCT;
+    for (u32 band_i = 0; band_i < band_count; band_i += 1)
+    {
+      job_submit(jobs, func, (u8 *)payloads + band_i * payload_size, &counter);
+    }
+    job_wait_for_counter(jobs, &counter);
+  }
+  else
+  {
+    for (u32 band_i = 0; band_i < band_count; band_i += 1)
+    {
+      func(NULL, (u8 *)payloads + band_i * payload_size);
+    }
+  }
+}
+
+typedef struct BitmapHeader BitmapHeader;
+struct BitmapHeader
+{
+  u16 signature;
+  u32 file_size;
+  u32 reserved;
+  u32 data_offset;
+  u32 size;
+  u32 width;
+  u32 height;
+  u16 planes;
+  u16 bits_per_pixel;
+  u32 compression;
+  u32 size_of_bitmap;
+  u32 horz_resolution;
+  u32 vert_resolution;
+  u32 colors_used;
+  u32 colors_important;
+
+  u32 red_mask;
+  u32 green_mask;
+  u32 blue_mask;
+} __attribute__((packed));
+
+// NOTE(Ryan): BI_BITFIELDS with masks matching 0xAARRGGBB, so pixels go out as they are
+INTERNAL b32
+image_write_bmp(String8 file_name, u32 *pixels, u32 width, u32 height)
+{
+  BitmapHeader bitmap_header = ZERO_STRUCT;
+
+  u32 output_pixel_size = width * height * sizeof(u32);
+
+  bitmap_header.signature = 0x4d42;
+  bitmap_header.file_size = sizeof(bitmap_header) + output_pixel_size;
+  bitmap_header.data_offset = sizeof(bitmap_header);
+  bitmap_header.size = sizeof(bitmap_header) - 14;
+  bitmap_header.width = width;
+  bitmap_header.height = height;
+  bitmap_header.planes = 1;
+  bitmap_header.bits_per_pixel = 32;
+  bitmap_header.compression = 3;
+  bitmap_header.size_of_bitmap = 0;
+  bitmap_header.horz_resolution = 4096;
+  bitmap_header.vert_resolution = 4096;
+  bitmap_header.colors_used = 0;
+  bitmap_header.colors_important = 0;
+  bitmap_header.red_mask   = 0x00ff0000;
+  bitmap_header.green_mask = 0x0000ff00;
+  bitmap_header.blue_mask  = 0x000000ff;
+
+  String8 parts[2] = {s8((u8 *)&bitmap_header, sizeof(bitmap_header)), s8((u8 *)pixels, output_pixel_size)};
+  b32 result = s8_write_entire_file_vectored(file_name, parts, ARRAY_COUNT(parts));
+
+  return result;
+}
+
+// NOTE(Ryan): Output row 0 is top of image
+INTERNAL void
+image_u32_row_to_rgb8(u32 *pixels, u32 width, u32 height, u32 row, u8 *dst)
+{
+  u32 *src = pixels + (height - 1 - row) * width;
+  for (u32 x = 0; x < width; x += 1)
+  {
+    u32 pixel = src[x];
+    dst[0] = (u8)(pixel >> 16);
+    dst[1] = (u8)(pixel >> 8);
+    dst[2] = (u8)pixel;
+    dst += 3;
+  }
+}
+
+typedef struct ImageRGB8Band ImageRGB8Band;
+struct ImageRGB8Band
+{
+  u32 *pixels;
+  u32 width, height;
+  u32 row_begin, row_end;
+  u8 *dst;
+};
+
+INTERNAL void
+image_rgb8_band_job(JobSystem *jobs, void *payload)
+{
+  ImageRGB8Band *band = (ImageRGB8Band *)payload;
+
+  for (u32 row = band->row_begin; row < band->row_end; row += 1)
+  {
+    image_u32_row_to_rgb8(band->pixels, band->width, band->height, row, band->dst + (row - band->row_begin) * band->width * 3);
+  }
+}
+
+// NOTE(Ryan): Binary P6
+INTERNAL b32
+image_write_ppm(MemArena *arena, JobSystem *jobs, String8 file_name, u32 *pixels, u32 width, u32 height)
+{
+  MemArenaTemp temp = mem_arena_temp_begin(arena);
+
+  char header[64] = ZERO_STRUCT;
+  int header_size = snprintf(header, sizeof(header), "P6\n%u %u\n255\n", width, height);
+
+  u64 row_size = (u64)width * 3;
+  u8 *rgb = MEM_ARENA_PUSH_ARRAY(arena, u8, row_size * height);
+
+  u32 rows_per_band = image_rows_per_band(row_size);
+  u32 band_count = (height + rows_per_band - 1) / rows_per_band;
+  ImageRGB8Band *bands = MEM_ARENA_PUSH_ARRAY_ZERO(arena, ImageRGB8Band, band_count);
+  for (u32 band_i = 0; band_i < band_count; band_i += 1)
+  {
+    ImageRGB8Band *band = &bands[band_i];
+    band->pixels = pixels;
+    band->width = width;
+    band->height = height;
+    band->row_begin = band_i * rows_per_band;
+    band->row_end = MIN(height, band->row_begin + rows_per_band);
+    band->dst = rgb + band->row_begin * row_size;
+  }
+  image_run_band_jobs(jobs, image_rgb8_band_job, bands, sizeof(ImageRGB8Band), band_count);
+
+  String8 parts[2] = {s8((u8 *)header, (u64)header_size), s8(rgb, row_size * height)};
+  b32 result = s8_write_entire_file_vectored(file_name, parts, ARRAY_COUNT(parts));
+
+  mem_arena_temp_end(temp);
+
+  return result;
+}
+
+// NOTE(Ryan): PNG. Each band is filtered and deflated independently into its own IDAT chunk,
+// which is allowed as a PNG decoder concatenates IDAT data into one zlib stream.
+// A band ends its deflate block with an empty stored block to realign to a byte (a 'sync flush'),
+// so bands join bit-exactly. Matches don't reach into previous band, which costs well under 1% in size.
+// Zlib's adler32 is over all uncompressed data, so per band checksums are combined once all finish.
+// Blocks use fixed Huffman codes, which skips building code tables per band;
+// rendered images filter to mostly small residuals and long runs, so LZ77 does most of the work
+
+#define DEFLATE_WINDOW_SIZE 32768
+#define DEFLATE_HASH_BITS 15
+#define DEFLATE_MIN_MATCH 3
+#define DEFLATE_MAX_MATCH 258
+// NOTE(Ryan): Candidates tried per position, and longest match whose inner positions are still hashed; quality vs. speed
+#define DEFLATE_MAX_CHAIN 8
+#define DEFLATE_MAX_INSERT_LENGTH 32
+
+GLOBAL u16 deflate_length_base[29] =
+{
+  3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+GLOBAL u8 deflate_length_extra[29] =
+{
+  0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+GLOBAL u16 deflate_distance_base[30] =
+{
+  1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769,
+  1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+GLOBAL u8 deflate_distance_extra[30] =
+{
+  0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+// NOTE(Ryan): Built once per write on calling thread, then read-only in band jobs
+typedef struct PNGTables PNGTables;
+struct PNGTables
+{
+  u32 crc[256];
+
+  // NOTE(Ryan): Huffman codes are sent most significant bit first, so stored reversed for LSB-first bit writer
+  u16 literal_codes[288];
+  u8 literal_lengths[288];
+  u8 length_symbols[DEFLATE_MAX_MATCH + 1];
+  // NOTE(Ryan): Index distance - 1 if < 256, else 256 + ((distance - 1) >> 7), as in zlib
+  u8 distance_symbols[512];
+};
+
+INTERNAL u32
+deflate_reverse_bits(u32 code, u32 length)
+{
+  u32 result = 0;
+
+  for (u32 bit_i = 0; bit_i < length; bit_i += 1)
+  {
+    result = (result << 1) | ((code >> bit_i) & 1);
+  }
+
+  return result;
+}
+
+INTERNAL void
+png_tables_init(PNGTables *tables)
+{
+  for (u32 byte = 0; byte < 256; byte += 1)
+  {
+    u32 crc = byte;
+    for (u32 bit_i = 0; bit_i < 8; bit_i += 1)
+    {
+      crc = (crc & 1) ? (0xedb88320 ^ (crc >> 1)) : (crc >> 1);
+    }
+    tables->crc[byte] = crc;
+  }
+
+  for (u32 symbol = 0; symbol < 288; symbol += 1)
+  {
+    u32 code = 0, length = 0;
+    if (symbol < 144)      { code = 0x30 + symbol; length = 8; }
+    else if (symbol < 256) { code = 0x190 + (symbol - 144); length = 9; }
+    else if (symbol < 280) { code = symbol - 256; length = 7; }
+    else                   { code = 0xc0 + (symbol - 280); length = 8; }
+
+    tables->literal_codes[symbol] = (u16)deflate_reverse_bits(code, length);
+    tables->literal_lengths[symbol] = (u8)length;
+  }
+
+  for (u32 symbol = 0; symbol < ARRAY_COUNT(deflate_length_base); symbol += 1)
+  {
+    // NOTE(Ryan): 258 has its own symbol, even though 227 + 5 extra bits could reach it
+    u32 last = (symbol + 1 < ARRAY_COUNT(deflate_length_base)) ? deflate_length_base[symbol + 1] - 1u : DEFLATE_MAX_MATCH;
+    for (u32 length = deflate_length_base[symbol]; length <= last; length += 1)
+    {
+      tables->length_symbols[length] = (u8)symbol;
+    }
+  }
+
+  for (u32 symbol = 0; symbol < ARRAY_COUNT(deflate_distance_base); symbol += 1)
+  {
+    u32 first = deflate_distance_base[symbol];
+    u32 last = first + (1u << deflate_distance_extra[symbol]) - 1;
+    for (u32 distance = first; distance <= last; distance += 1)
+    {
+      u32 index = (distance - 1 < 256) ? (distance - 1) : (256 + ((distance - 1) >> 7));
+      tables->distance_symbols[index] = (u8)symbol;
+    }
+  }
+}
+
+INTERNAL u32
+png_crc_update(PNGTables *tables, u32 crc, u8 *data, u64 size)
+{
+  for (u64 i = 0; i < size; i += 1)
+  {
+    crc = tables->crc[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+  }
+
+  return crc;
+}
+
+#define ADLER32_MOD 65521
+INTERNAL u32
+adler32_update(u32 adler, u8 *data, u64 size)
+{
+  u32 a = adler & 0xffff;
+  u32 b = adler >> 16;
+
+  while (size > 0)
+  {
+    // NOTE(Ryan): Largest n where b can't overflow u32 before reducing
+    u64 block_size = MIN(size, 5552);
+    size -= block_size;
+    for (u64 i = 0; i < block_size; i += 1)
+    {
+      a += data[i];
+      b += a;
+    }
+    data += block_size;
+    a %= ADLER32_MOD;
+    b %= ADLER32_MOD;
+  }
+
+  return (b << 16) | a;
+}
+
+// NOTE(Ryan): Checksum of A followed by B from their separate checksums and B's length (zlib's adler32_combine)
+INTERNAL u32
+adler32_combine(u32 adler_a, u32 adler_b, u64 size_b)
+{
+  u32 remainder = (u32)(size_b % ADLER32_MOD);
+  u32 sum1 = adler_a & 0xffff;
+  u32 sum2 = (u32)(((u64)remainder * sum1) % ADLER32_MOD);
+
+  sum1 += (adler_b & 0xffff) + ADLER32_MOD - 1;
+  sum2 += (adler_a >> 16) + (adler_b >> 16) + ADLER32_MOD - remainder;
+  if (sum1 >= ADLER32_MOD) sum1 -= ADLER32_MOD;
+  if (sum1 >= ADLER32_MOD) sum1 -= ADLER32_MOD;
+  if (sum2 >= (ADLER32_MOD << 1)) sum2 -= (ADLER32_MOD << 1);
+  if (sum2 >= ADLER32_MOD) sum2 -= ADLER32_MOD;
+
+  return (sum2 << 16) | sum1;
+}
+
+typedef struct DeflateWriter DeflateWriter;
+struct DeflateWriter
+{
+  u8 *out;
+  u64 out_size;
+  u64 bits;
+  u32 bit_count;
+};
+
+// NOTE(Ryan): Flushes 32 bits at a time; count <= 16, so 64 bit accumulator never overflows.
+// IMPORTANT(Ryan): Little endian only
+INTERNAL void
+deflate_put_bits(DeflateWriter *writer, u32 value, u32 count)
+{
+  writer->bits |= (u64)value << writer->bit_count;
+  writer->bit_count += count;
+  if (writer->bit_count >= 32)
+  {
+    u32 low = (u32)writer->bits;
+    MEMORY_COPY(writer->out + writer->out_size, &low, sizeof(low));
+    writer->out_size += sizeof(low);
+    writer->bits >>= 32;
+    writer->bit_count -= 32;
+  }
+}
+
+INTERNAL void
+deflate_align_to_byte(DeflateWriter *writer)
+{
+  writer->bit_count = (writer->bit_count + 7) & ~7u;
+  while (writer->bit_count > 0)
+  {
+    writer->out[writer->out_size++] = (u8)writer->bits;
+    writer->bits >>= 8;
+    writer->bit_count -= 8;
+  }
+}
+
+INTERNAL u32
+deflate_hash(u8 *at)
+{
+  u32 result = ((u32)at[0] << 16 | (u32)at[1] << 8 | (u32)at[2]) * 2654435761u >> (32 - DEFLATE_HASH_BITS);
+
+  return result;
+}
+
+INTERNAL u32
+deflate_match_length(u8 *a, u8 *b, u32 max_length)
+{
+  u32 result = 0;
+
+  while (result + 4 <= max_length)
+  {
+    u32 word_a, word_b;
+    MEMORY_COPY(&word_a, a + result, 4);
+    MEMORY_COPY(&word_b, b + result, 4);
+    u32 difference = word_a ^ word_b;
+    if (difference != 0)
+    {
+      return result + u32_count_trailing_zeroes(difference) / 8;
+    }
+    result += 4;
+  }
+  while (result < max_length && a[result] == b[result])
+  {
+    result += 1;
+  }
+
+  return result;
+}
+
+// NOTE(Ryan): One fixed Huffman block over data.
+// If not final, followed by empty stored block so output ends byte aligned and can be concatenated.
+// hash_head/hash_prev are DEFLATE_WINDOW_SIZE scratch; prev is indexed by position within window,
+// so a stale entry shows up as a chain going forwards in position
+INTERNAL void
+deflate_fixed(PNGTables *tables, DeflateWriter *writer, u8 *data, u64 size, b32 is_final, u32 *hash_head, u32 *hash_prev)
+{
+  memset(hash_head, 0xff, (1 << DEFLATE_HASH_BITS) * sizeof(u32));
+
+  deflate_put_bits(writer, is_final ? 1 : 0, 1);
+  deflate_put_bits(writer, 1, 2);
+
+  u64 pos = 0;
+  while (pos < size)
+  {
+    u32 best_length = 0;
+    u32 best_distance = 0;
+
+    if (pos + DEFLATE_MIN_MATCH <= size)
+    {
+      u32 max_length = (u32)MIN(DEFLATE_MAX_MATCH, size - pos);
+      u32 hash = deflate_hash(data + pos);
+      u32 candidate = hash_head[hash];
+
+      for (u32 chain_i = 0;
+           chain_i < DEFLATE_MAX_CHAIN && candidate != U32_MAX && pos - candidate <= DEFLATE_WINDOW_SIZE;
+           chain_i += 1)
+      {
+        // NOTE(Ryan): Can only beat best if it matches at best's last byte
+        if (data[candidate + best_length] == data[pos + best_length] || best_length == 0)
+        {
+          u32 length = deflate_match_length(data + candidate, data + pos, max_length);
+          if (length > best_length)
+          {
+            best_length = length;
+            best_distance = (u32)(pos - candidate);
+            if (length == max_length)
+            {
+              break;
+            }
+          }
+        }
+
+        u32 next = hash_prev[candidate & (DEFLATE_WINDOW_SIZE - 1)];
+        if (next >= candidate)
+        {
+          break;
+        }
+        candidate = next;
+      }
+
+      hash_prev[pos & (DEFLATE_WINDOW_SIZE - 1)] = hash_head[hash];
+      hash_head[hash] = (u32)pos;
+    }
+
+    if (best_length >= DEFLATE_MIN_MATCH)
+    {
+      u32 length_symbol = tables->length_symbols[best_length];
+      deflate_put_bits(writer, tables->literal_codes[257 + length_symbol], tables->literal_lengths[257 + length_symbol]);
+      deflate_put_bits(writer, best_length - deflate_length_base[length_symbol], deflate_length_extra[length_symbol]);
+
+      u32 distance_index = (best_distance - 1 < 256) ? (best_distance - 1) : (256 + ((best_distance - 1) >> 7));
+      u32 distance_symbol = tables->distance_symbols[distance_index];
+      deflate_put_bits(writer, deflate_reverse_bits(distance_symbol, 5), 5);
+      deflate_put_bits(writer, best_distance - deflate_distance_base[distance_symbol], deflate_distance_extra[distance_symbol]);
+
+      // NOTE(Ryan): Positions inside short matches go in hash too, else repeats of them are missed.
+      // Long matches are mostly runs, whose positions are all equivalent
+      u64 match_end = pos + best_length;
+      if (best_length <= DEFLATE_MAX_INSERT_LENGTH)
+      {
+        for (pos += 1; pos < match_end && pos + DEFLATE_MIN_MATCH <= size; pos += 1)
+        {
+          u32 hash = deflate_hash(data + pos);
+          hash_prev[pos & (DEFLATE_WINDOW_SIZE - 1)] = hash_head[hash];
+          hash_head[hash] = (u32)pos;
+        }
+      }
+      pos = match_end;
+    }
+    else
+    {
+      u8 literal = data[pos];
+      deflate_put_bits(writer, tables->literal_codes[literal], tables->literal_lengths[literal]);
+      pos += 1;
+    }
+  }
+
+  // NOTE(Ryan): End of block
+  deflate_put_bits(writer, tables->literal_codes[256], tables->literal_lengths[256]);
+
+  if (!is_final)
+  {
+    deflate_put_bits(writer, 0, 3);
+    deflate_align_to_byte(writer);
+    deflate_put_bits(writer, 0x0000, 16);
+    deflate_put_bits(writer, 0xffff, 16);
+  }
+  deflate_align_to_byte(writer);
+}
+
+INTERNAL u8
+png_paeth(u8 a, u8 b, u8 c)
+{
+  s32 p = (s32)a + (s32)b - (s32)c;
+  s32 pa = abs(p - (s32)a);
+  s32 pb = abs(p - (s32)b);
+  s32 pc = abs(p - (s32)c);
+
+  // NOTE(Ryan): Selects rather than branches, as the choice is unpredictable
+  u8 result = (pb <= pc) ? b : c;
+  result = (pa <= pb && pa <= pc) ? a : result;
+
+  return result;
+}
+
+INTERNAL u64
+png_filter_cost(u8 *filtered, u64 size)
+{
+  u64 result = 0;
+
+  for (u64 i = 0; i < size; i += 1)
+  {
+    result += (u64)abs((s32)(signed char)filtered[i]);
+  }
+
+  return result;
+}
+
+// NOTE(Ryan): Tries all 5 filters and keeps one with smallest sum of absolute signed residuals,
+// the heuristic recommended by PNG spec. One simple loop per filter, so compiler can vectorise each.
+// IMPORTANT(Ryan): row and prev must have 3 readable zero bytes before them (left of first pixel),
+// and prev must be zeroes for top row, so loops have no edge cases
+INTERNAL void
+png_filter_row(u8 *row, u8 *prev, u64 row_size, u8 *candidates, u8 *dst)
+{
+  u8 *sub = candidates;
+  u8 *up = candidates + row_size;
+  u8 *average = candidates + 2 * row_size;
+  u8 *paeth = candidates + 3 * row_size;
+
+  for (u64 i = 0; i < row_size; i += 1)
+  {
+    sub[i] = (u8)(row[i] - row[i - 3]);
+  }
+  for (u64 i = 0; i < row_size; i += 1)
+  {
+    up[i] = (u8)(row[i] - prev[i]);
+  }
+  for (u64 i = 0; i < row_size; i += 1)
+  {
+    average[i] = (u8)(row[i] - (u8)(((u32)row[i - 3] + (u32)prev[i]) >> 1));
+  }
+  for (u64 i = 0; i < row_size; i += 1)
+  {
+    paeth[i] = (u8)(row[i] - png_paeth(row[i - 3], prev[i], prev[i - 3]));
+  }
+
+  u8 *filtered[5] = {row, sub, up, average, paeth};
+  u32 best_filter = 0;
+  u64 best_cost = png_filter_cost(row, row_size);
+  for (u32 filter = 1; filter < 5; filter += 1)
+  {
+    u64 cost = png_filter_cost(filtered[filter], row_size);
+    if (cost < best_cost)
+    {
+      best_cost = cost;
+      best_filter = filter;
+    }
+  }
+
+  dst[0] = (u8)best_filter;
+  MEMORY_COPY(dst + 1, filtered[best_filter], row_size);
+}
+
+typedef struct PNGBand PNGBand;
+struct PNGBand
+{
+  PNGTables *tables;
+  u32 *pixels;
+  u32 width, height;
+  u32 row_begin, row_end;
+  b32 is_first, is_last;
+
+  // NOTE(Ryan): Scratch
+  u8 *rows;
+  u8 *candidates;
+  u8 *filtered;
+  u32 *hash_head;
+  u32 *hash_prev;
+
+  // NOTE(Ryan): Complete IDAT chunk (length, type, data, crc) and adler32 of filtered
+  u8 *chunk;
+  u64 chunk_size;
+  u64 filtered_size;
+  u32 adler;
+};
+
+INTERNAL void
+png_band_job(JobSystem *jobs, void *payload)
+{
+  PNGBand *band = (PNGBand *)payload;
+
+  u64 row_size = (u64)band->width * 3;
+  // NOTE(Ryan): Zeroed, with 3 bytes of padding left of each row for png_filter_row()
+  u8 *row = band->rows + 3;
+  u8 *prev = band->rows + 3 + (row_size + 3);
+
+  // NOTE(Ryan): Filters reference row above, which for first row of band is in previous band
+  if (band->row_begin > 0)
+  {
+    image_u32_row_to_rgb8(band->pixels, band->width, band->height, band->row_begin - 1, prev);
+  }
+
+  u8 *filtered = band->filtered;
+  for (u32 y = band->row_begin; y < band->row_end; y += 1)
+  {
+    image_u32_row_to_rgb8(band->pixels, band->width, band->height, y, row);
+    png_filter_row(row, prev, row_size, band->candidates, filtered);
+    filtered += 1 + row_size;
+    SWAP(u8 *, row, prev);
+  }
+  band->filtered_size = (u64)(filtered - band->filtered);
+  band->adler = adler32_update(1, band->filtered, band->filtered_size);
+
+  // NOTE(Ryan): Length and type filled in after, once size known
+  DeflateWriter writer = ZERO_STRUCT;
+  writer.out = band->chunk + 8;
+  if (band->is_first)
+  {
+    // NOTE(Ryan): Zlib header: deflate with 32K window, no preset dictionary, check bits make it a multiple of 31
+    deflate_put_bits(&writer, 0x78, 8);
+    deflate_put_bits(&writer, 0x01, 8);
+  }
+  deflate_fixed(band->tables, &writer, band->filtered, band->filtered_size, band->is_last, band->hash_head, band->hash_prev);
+
+  image_write_u32_be(band->chunk, (u32)writer.out_size);
+  MEMORY_COPY(band->chunk + 4, "IDAT", 4);
+  u32 crc = png_crc_update(band->tables, 0xffffffff, band->chunk + 4, 4 + writer.out_size);
+  image_write_u32_be(band->chunk + 8 + writer.out_size, crc ^ 0xffffffff);
+  band->chunk_size = 12 + writer.out_size;
+}
+
+INTERNAL u64
+png_write_chunk(PNGTables *tables, u8 *dst, char const *type, u8 *data, u32 size)
+{
+  image_write_u32_be(dst, size);
+  MEMORY_COPY(dst + 4, type, 4);
+  MEMORY_COPY(dst + 8, data, size);
+  u32 crc = png_crc_update(tables, 0xffffffff, dst + 4, 4 + (u64)size);
+  image_write_u32_be(dst + 8 + size, crc ^ 0xffffffff);
+
+  return 12 + (u64)size;
+}
+
+// NOTE(Ryan): 8 bit RGB, alpha dropped
+INTERNAL b32
+image_write_png(MemArena *arena, JobSystem *jobs, String8 file_name, u32 *pixels, u32 width, u32 height)
+{
+  MemArenaTemp temp = mem_arena_temp_begin(arena);
+
+  PNGTables *tables = MEM_ARENA_PUSH_STRUCT(arena, PNGTables);
+  png_tables_init(tables);
+
+  u64 row_size = (u64)width * 3;
+  u32 rows_per_band = image_rows_per_band(1 + row_size);
+  u32 band_count = (height + rows_per_band - 1) / rows_per_band;
+
+  PNGBand *bands = MEM_ARENA_PUSH_ARRAY_ZERO(arena, PNGBand, band_count);
+  for (u32 band_i = 0; band_i < band_count; band_i += 1)
+  {
+    PNGBand *band = &bands[band_i];
+    band->tables = tables;
+    band->pixels = pixels;
+    band->width = width;
+    band->height = height;
+    band->row_begin = band_i * rows_per_band;
+    band->row_end = MIN(height, band->row_begin + rows_per_band);
+    band->is_first = (band_i == 0);
+    band->is_last = (band_i == band_count - 1);
+
+    u64 filtered_size = (band->row_end - band->row_begin) * (1 + row_size);
+    band->rows = MEM_ARENA_PUSH_ARRAY_ZERO(arena, u8, 2 * (row_size + 3));
+    band->candidates = MEM_ARENA_PUSH_ARRAY(arena, u8, 4 * row_size);
+    band->filtered = MEM_ARENA_PUSH_ARRAY(arena, u8, filtered_size);
+    band->hash_head = MEM_ARENA_PUSH_ARRAY(arena, u32, 1 << DEFLATE_HASH_BITS);
+    band->hash_prev = MEM_ARENA_PUSH_ARRAY(arena, u32, DEFLATE_WINDOW_SIZE);
+    // NOTE(Ryan): Fixed Huffman worst case is 9 bits per literal, plus block/flush overhead, zlib header and chunk framing
+    band->chunk = MEM_ARENA_PUSH_ARRAY(arena, u8, filtered_size * 9 / 8 + 64);
+  }
+
+  image_run_band_jobs(jobs, png_band_job, bands, sizeof(PNGBand), band_count);
+
+  u8 header[8 + 25] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+  u8 ihdr[13] = ZERO_STRUCT;
+  image_write_u32_be(ihdr, width);
+  image_write_u32_be(ihdr + 4, height);
+  ihdr[8] = 8; // bit depth
+  ihdr[9] = 2; // colour type RGB
+  png_write_chunk(tables, header + 8, "IHDR", ihdr, sizeof(ihdr));
+
+  u32 adler = bands[0].adler;
+  for (u32 band_i = 1; band_i < band_count; band_i += 1)
+  {
+    adler = adler32_combine(adler, bands[band_i].adler, bands[band_i].filtered_size);
+  }
+  u8 adler_be[4] = ZERO_STRUCT;
+  image_write_u32_be(adler_be, adler);
+
+  u8 trailer[16 + 12] = ZERO_STRUCT;
+  u64 trailer_size = png_write_chunk(tables, trailer, "IDAT", adler_be, sizeof(adler_be));
+  trailer_size += png_write_chunk(tables, trailer + trailer_size, "IEND", NULL, 0);
+
+  String8 *parts = MEM_ARENA_PUSH_ARRAY(arena, String8, band_count + 2);
+  parts[0] = s8(header, sizeof(header));
+  for (u32 band_i = 0; band_i < band_count; band_i += 1)
+  {
+    parts[1 + band_i] = s8(bands[band_i].chunk, bands[band_i].chunk_size);
+  }
+  parts[1 + band_count] = s8(trailer, trailer_size);
+  b32 result = s8_write_entire_file_vectored(file_name, parts, band_count + 2);
+
+  mem_arena_temp_end(temp);
+
+  return result;
+}
+
+// NOTE(Ryan): Format from extension: .png, .ppm, otherwise .bmp
+INTERNAL b32
+image_write(MemArena *arena, JobSystem *jobs, String8 file_name, u32 *pixels, u32 width, u32 height)
+{
+  b32 result = false;
+
+  String8 png_extension = s8_lit(".png");
+  String8 ppm_extension = s8_lit(".ppm");
+  if (file_name.size >= 4 && s8_match(s8_suffix(file_name, 4), png_extension, S8_MATCH_FLAG_CASE_INSENSITIVE))
+  {
+    result = image_write_png(arena, jobs, file_name, pixels, width, height);
+  }
+  else if (file_name.size >= 4 && s8_match(s8_suffix(file_name, 4), ppm_extension, S8_MATCH_FLAG_CASE_INSENSITIVE))
+  {
+    result = image_write_ppm(arena, jobs, file_name, pixels, width, height);
+  }
+  else
+  {
+    result = image_write_bmp(file_name, pixels, width, height);
+  }
+
+  return result;
+}
@@ -20,6 +20,11 @@
 #include "base-string.h"
 #include "base-map.h"
 #include "base-file.h"
+#include "base-atomics.h"
+#include "base-queue.h"
+#include "base-fiber.h"
+#include "base-job.h"
+#include "base-image.h"
 
 
 // TODO(Ryan):
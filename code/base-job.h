@@ -0,0 +1,775 @@
+// SPDX-License-Identifier: zlib-acknowledgement
+#pragma once
+
+// IMPORTANT(Ryan): Each worker owns a Chase-Lev deque.
+// The owner pushes and pops from the bottom (LIFO, so cache-warm), idle workers steal from the top (FIFO).
+// Jobs are fire-and-forget; completion is observed through a JobCounter shared by a batch of jobs.
+// Waiting on a counter executes other jobs instead of blocking, so submitting from within a job is fine.
+// The thread that creates the system is worker 0, so it can submit and wait like any other worker.
+//
+// IMPORTANT(Ryan): Jobs run on fibers from a shared pool. A job waiting on an incomplete counter parks its fiber
+// and the worker thread moves onto other work; the fiber is resumed by whichever worker first sees the counter at zero.
+// So dependent jobs (e.g. simulate -> build ui -> build render list) don't hold a thread hostage.
+// For I/O, submitter initialises a counter to 1, waits on it, and completion handler calls job_counter_signal().
+// The handler can be on any thread; signalling the last count wakes a sleeping worker to resume the waiter
+//
+// NOTE(Ryan): Counters nest. A child linked to a parent holds one count on it until the child reaches zero.
+// So e.g. a frame counter can be waited on once while each pass tracks its own batch of tiles
+//
+// NOTE(Ryan): Threads outside the system (e.g. audio, I/O completion) submit into a shared MPMC injection queue
+// that workers check after their own deque and before stealing
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/sysinfo.h>
+
+typedef struct JobSystem JobSystem;
+typedef void (*job_func)(JobSystem *system, void *payload);
+
+// NOTE(Ryan): Payload is arena memory owned by submitter, so must outlive the counter reaching zero
+#define JOB_PUSH_PAYLOAD(arena, T) MEM_ARENA_PUSH_STRUCT_ZERO(arena, T)
+
+typedef struct JobCounter JobCounter;
+struct JobCounter
+{
+  u32 value;
+  JobCounter *parent;
+};
+
+typedef struct Job Job;
+struct Job
+{
+  job_func func;
+  void *payload;
+  JobCounter *counter;
+};
+
+// NOTE(Ryan): Power of 2 so index is a mask
+#define JOB_DEQUE_CAPACITY 4096
+
+// IMPORTANT(Ryan): Jobs are stored by value, so no job allocator is needed.
+// A thief copies the entry before its CAS on top, and the owner can't overwrite that slot until top moves,
+// so a successful CAS means the copy was intact
+typedef struct JobDeque JobDeque;
+// NOTE(Ryan): top is written by thieves and bottom by owner, so separate lines to avoid false sharing
+struct JobDeque
+{
+  Job *entries;
+  CACHE_ALIGNED s64 top;
+  CACHE_ALIGNED s64 bottom;
+};
+
+typedef u32 JOB_FIBER_STATE;
+enum
+{
+  JOB_FIBER_STATE_RUNNING,
+  JOB_FIBER_STATE_FINISHED,
+  JOB_FIBER_STATE_WAITING,
+};
+
+typedef struct JobFiber JobFiber;
+struct JobFiber
+{
+  JobFiber *next;
+  JobSystem *system;
+  Fiber fiber;
+  Job job;
+  JOB_FIBER_STATE state;
+  JobCounter *wait_counter;
+};
+
+// NOTE(Ryan): Bounds number of jobs that can be parked at once.
+// If pool is exhausted, jobs run on worker's own stack and waiting within them falls back to helping
+#define JOB_FIBER_COUNT 128
+#define JOB_FIBER_STACK_SIZE KB(64)
+
+#define JOB_INJECTION_QUEUE_CAPACITY 1024
+
+typedef struct JobWorker JobWorker;
+struct JobWorker
+{
+  JobSystem *system;
+  u32 index;
+  u32 steal_seed;
+  pthread_t thread;
+  JobDeque deque;
+
+  // NOTE(Ryan): Worker thread's own stack, switched back to when a fiber finishes or parks
+  FiberContext scheduler_context;
+};
+
+struct JobSystem
+{
+  u32 worker_count;
+  JobWorker *workers;
+  MPMCQueue *injection_queue;
+
+  b32 want_to_quit;
+
+  // NOTE(Ryan): Sleepers futex wait on wake_sequence, so a bump between their recheck and sleep isn't lost
+  CACHE_ALIGNED u32 sleeping_count;
+  u32 wake_sequence;
+
+  // NOTE(Ryan): Creating thread's affinity before it was pinned as worker 0, restored on destroy
+  b32 want_restore_creator_affinity;
+  cpu_set_t creator_affinity;
+
+  JobFiber *fibers;
+  CACHE_ALIGNED u32 fiber_lock;
+  JobFiber *first_free_fiber;
+  JobFiber *first_waiting_fiber;
+};
+
+// NOTE(Ryan): U32_MAX for threads not spawned by job system (and not the creating thread)
+THREAD_LOCAL u32 tl_job_worker_index = U32_MAX;
+THREAD_LOCAL JobFiber *tl_job_current_fiber = NULL;
+
+INTERNAL void
+job_deque_init(MemArena *arena, JobDeque *deque)
+{
+  deque->top = 0;
+  deque->bottom = 0;
+  deque->entries = MEM_ARENA_PUSH_ARRAY_ZERO(arena, Job, JOB_DEQUE_CAPACITY);
+}
+
+// NOTE(Ryan): Owner only. Returns false if full
+INTERNAL b32
+job_deque_push(JobDeque *deque, Job job)
+{
+  b32 result = false;
+
+  s64 bottom = ATOMIC_LOAD_RELAXED(&deque->bottom);
+  s64 top = ATOMIC_LOAD_ACQUIRE(&deque->top);
+
+  if (bottom - top < JOB_DEQUE_CAPACITY)
+  {
+    deque->entries[bottom & (JOB_DEQUE_CAPACITY - 1)] = job;
+    // NOTE(Ryan): Entry must be visible to thieves before the new bottom
+    FENCE_RELEASE();
+    ATOMIC_STORE_RELAXED(&deque->bottom, bottom + 1);
+    result = true;
+  }
+
+  return result;
+}
+
+// NOTE(Ryan): Owner only
+INTERNAL b32
+job_deque_pop(JobDeque *deque, Job *job)
+{
+  b32 result = false;
+
+  s64 bottom = ATOMIC_LOAD_RELAXED(&deque->bottom) - 1;
+  ATOMIC_STORE_RELAXED(&deque->bottom, bottom);
+  // IMPORTANT(Ryan): Store to bottom must be ordered before load of top, otherwise
+  // a thief and the owner could both take the last entry
+  FENCE_SEQ_CST();
+  s64 top = ATOMIC_LOAD_RELAXED(&deque->top);
+
+  if (top <= bottom)
+  {
+    *job = deque->entries[bottom & (JOB_DEQUE_CAPACITY - 1)];
+    result = true;
+    if (top == bottom)
+    {
+      // NOTE(Ryan): Last entry, so race thieves for it
+      if (!ATOMIC_CAS_SEQ_CST(&deque->top, &top, top + 1))
+      {
+        result = false;
+      }
+      ATOMIC_STORE_RELAXED(&deque->bottom, bottom + 1);
+    }
+  }
+  else
+  {
+    ATOMIC_STORE_RELAXED(&deque->bottom, bottom + 1);
+  }
+
+  return result;
+}
+
+// NOTE(Ryan): Any thread. False if empty or lost race with another thief/owner
+INTERNAL b32
+job_deque_steal(JobDeque *deque, Job *job)
+{
+  b32 result = false;
+
+  s64 top = ATOMIC_LOAD_ACQUIRE(&deque->top);
+  FENCE_SEQ_CST();
+  s64 bottom = ATOMIC_LOAD_ACQUIRE(&deque->bottom);
+
+  if (top < bottom)
+  {
+    *job = deque->entries[top & (JOB_DEQUE_CAPACITY - 1)];
+    result = ATOMIC_CAS_SEQ_CST(&deque->top, &top, top + 1);
+  }
+
+  return result;
+}
+
+// IMPORTANT(Ryan): NEVER_INLINE so the TLS address isn't hoisted across a fiber switch,
+// as fiber may have migrated threads
+NEVER_INLINE INTERNAL JobWorker *
+job_system_current_worker(JobSystem *system)
+{
+  JobWorker *result = NULL;
+
+  if (tl_job_worker_index < system->worker_count)
+  {
+    result = &system->workers[tl_job_worker_index];
+  }
+
+  return result;
+}
+
+INTERNAL b32
+job_system_find_job(JobSystem *system, JobWorker *worker, Job *job)
+{
+  b32 result = job_deque_pop(&worker->deque, job);
+
+  if (!result)
+  {
+    result = mpmc_queue_pop(system->injection_queue, job);
+  }
+
+  if (!result && system->worker_count > 1)
+  {
+    // NOTE(Ryan): Random start victim so thieves don't all hammer worker 0
+    u32 x = worker->steal_seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    worker->steal_seed = x;
+
+    u32 victim_offset = x % system->worker_count;
+    for (u32 i = 0; i < system->worker_count && !result; i += 1)
+    {
+      u32 victim_index = (victim_offset + i) % system->worker_count;
+      if (victim_index != worker->index)
+      {
+        result = job_deque_steal(&system->workers[victim_index].deque, job);
+      }
+    }
+  }
+
+  return result;
+}
+
+NEVER_INLINE INTERNAL JobFiber *
+job_current_fiber(void)
+{
+  return tl_job_current_fiber;
+}
+
+// NOTE(Ryan): Caller has just published a job or a ready fiber
+INTERNAL void
+job_system_wake_sleeper(JobSystem *system)
+{
+  // IMPORTANT(Ryan): Fence pairs with sleeper incrementing sleeping_count before rechecking queues.
+  // Without it, the load of sleeping_count can pass the publishing store (store-load reordering on x86)
+  FENCE_SEQ_CST();
+  if (ATOMIC_LOAD_RELAXED(&system->sleeping_count) > 0)
+  {
+    ATOMIC_ADD_SEQ_CST(&system->wake_sequence, 1);
+    futex_wake(&system->wake_sequence, 1);
+  }
+}
+
+INTERNAL void
+job_counter_signal(JobSystem *system, JobCounter *counter)
+{
+  u32 previous_value = ATOMIC_SUB_ACQ_REL(&counter->value, 1);
+
+  // NOTE(Ryan): A fiber parked on this counter is now ready.
+  // If signalled from a foreign thread, every worker may be asleep with nothing else to wake them
+  if (previous_value == 1)
+  {
+    if (counter->parent != NULL)
+    {
+      job_counter_signal(system, counter->parent);
+    }
+    job_system_wake_sleeper(system);
+  }
+}
+
+// NOTE(Ryan): Child holds one count on its parent whilst non-zero.
+// So a child can drain and refill during submission, or be reused, and the parent stays balanced
+INTERNAL void
+job_counter_link_child(JobCounter *parent, JobCounter *child)
+{
+  ASSERT(ATOMIC_LOAD_ACQUIRE(&child->value) == 0);
+
+  child->parent = parent;
+}
+
+INTERNAL void
+job_counter_increment(JobCounter *counter)
+{
+  u32 previous_value = ATOMIC_ADD_RELAXED(&counter->value, 1);
+
+  if (previous_value == 0 && counter->parent != NULL)
+  {
+    job_counter_increment(counter->parent);
+  }
+}
+
+INTERNAL b32
+job_counter_is_done(JobCounter *counter)
+{
+  return (ATOMIC_LOAD_ACQUIRE(&counter->value) == 0);
+}
+
+INTERNAL void
+job_execute(JobSystem *system, Job job)
+{
+  job.func(system, job.payload);
+
+  if (job.counter != NULL)
+  {
+    job_counter_signal(system, job.counter);
+  }
+}
+
+INTERNAL void
+job_fiber_lock(JobSystem *system)
+{
+  spin_lock(&system->fiber_lock);
+}
+
+INTERNAL void
+job_fiber_unlock(JobSystem *system)
+{
+  spin_unlock(&system->fiber_lock);
+}
+
+// NOTE(Ryan): Fiber body. Fibers are recycled, so loops running one job per resume from scheduler
+INTERNAL void
+job_fiber_main(void *arg)
+{
+  JobFiber *job_fiber = (JobFiber *)arg;
+  JobSystem *system = job_fiber->system;
+
+  while (true)
+  {
+    job_execute(system, job_fiber->job);
+
+    job_fiber->state = JOB_FIBER_STATE_FINISHED;
+    JobWorker *worker = job_system_current_worker(system);
+    fiber_switch(&job_fiber->fiber.context, &worker->scheduler_context);
+  }
+}
+
+// NOTE(Ryan): Parked fibers whose counter reached zero take priority over new jobs, 
+// so started work finishes first and fibers are returned to pool
+INTERNAL JobFiber *
+job_system_take_ready_fiber(JobSystem *system)
+{
+  JobFiber *result = NULL;
+
+  if (ATOMIC_LOAD_RELAXED(&system->first_waiting_fiber) != NULL)
+  {
+    job_fiber_lock(system);
+
+    JobFiber **link = &system->first_waiting_fiber;
+    for (JobFiber *job_fiber = *link; job_fiber != NULL; job_fiber = job_fiber->next)
+    {
+      if (job_counter_is_done(job_fiber->wait_counter))
+      {
+        *link = job_fiber->next;
+        result = job_fiber;
+        break;
+      }
+      link = &job_fiber->next;
+    }
+
+    job_fiber_unlock(system);
+  }
+
+  return result;
+}
+
+// NOTE(Ryan): Only sleepers need to peek, so don't bother with a relaxed early-out
+INTERNAL b32
+job_system_has_ready_fiber(JobSystem *system)
+{
+  b32 result = false;
+
+  job_fiber_lock(system);
+
+  for (JobFiber *job_fiber = system->first_waiting_fiber; job_fiber != NULL; job_fiber = job_fiber->next)
+  {
+    if (job_counter_is_done(job_fiber->wait_counter))
+    {
+      result = true;
+      break;
+    }
+  }
+
+  job_fiber_unlock(system);
+
+  return result;
+}
+
+INTERNAL JobFiber *
+job_system_take_free_fiber(JobSystem *system)
+{
+  job_fiber_lock(system);
+
+  JobFiber *result = system->first_free_fiber;
+  if (result != NULL)
+  {
+    SLL_STACK_POP(system->first_free_fiber);
+  }
+
+  job_fiber_unlock(system);
+
+  return result;
+}
+
+// NOTE(Ryan): Scheduler step, always on worker thread's own stack.
+// Returns true if any job progressed
+INTERNAL b32
+job_worker_run_one(JobSystem *system, JobWorker *worker)
+{
+  b32 result = false;
+
+  JobFiber *job_fiber = job_system_take_ready_fiber(system);
+  if (job_fiber == NULL)
+  {
+    Job job = ZERO_STRUCT;
+    if (job_system_find_job(system, worker, &job))
+    {
+      job_fiber = job_system_take_free_fiber(system);
+      if (job_fiber != NULL)
+      {
+        job_fiber->job = job;
+      }
+      else
+      {
+        job_execute(system, job);
+        result = true;
+      }
+    }
+  }
+
+  if (job_fiber != NULL)
+  {
+    job_fiber->state = JOB_FIBER_STATE_RUNNING;
+    tl_job_current_fiber = job_fiber;
+    fiber_switch(&worker->scheduler_context, &job_fiber->fiber.context);
+    tl_job_current_fiber = NULL;
+
+    // IMPORTANT(Ryan): Only publish fiber once switched off its stack, 
+    // otherwise another worker could resume it whilst still running here
+    job_fiber_lock(system);
+    if (job_fiber->state == JOB_FIBER_STATE_WAITING)
+    {
+      SLL_STACK_PUSH(system->first_waiting_fiber, job_fiber);
+    }
+    else
+    {
+      SLL_STACK_PUSH(system->first_free_fiber, job_fiber);
+    }
+    job_fiber_unlock(system);
+
+    result = true;
+  }
+
+  return result;
+}
+
+// NOTE(Ryan): Returns true if a job was executed.
+// Useful for callers that want to interleave their own work, e.g. progress reporting
+INTERNAL b32
+job_system_try_run(JobSystem *system)
+{
+  b32 result = false;
+
+  JobWorker *worker = job_system_current_worker(system);
+  ASSERT(worker != NULL);
+  // NOTE(Ryan): From within a job, use job_wait_for_counter() instead
+  ASSERT(job_current_fiber() == NULL);
+
+  result = job_worker_run_one(system, worker);
+
+  return result;
+}
+
+INTERNAL void
+job_submit(JobSystem *system, job_func func, void *payload, JobCounter *counter)
+{
+  JobWorker *worker = job_system_current_worker(system);
+
+  if (counter != NULL)
+  {
+    job_counter_increment(counter);
+  }
+
+  Job job = ZERO_STRUCT;
+  job.func = func;
+  job.payload = payload;
+  job.counter = counter;
+
+  b32 queued = false;
+  if (worker != NULL)
+  {
+    queued = job_deque_push(&worker->deque, job);
+  }
+
+  // NOTE(Ryan): Foreign thread, or owner's deque is full.
+  // Running overflow inline would serialise a large batch on the submitter and recurse if the job submits,
+  // so spill into the injection queue where any worker can take it
+  if (!queued)
+  {
+    u32 spin_count = 0;
+    while (!mpmc_queue_push(system->injection_queue, &job))
+    {
+      // NOTE(Ryan): Both full, so a submitting worker on its own stack drains some work itself to make room.
+      // Inside a fiber the scheduler can't be re-entered, so leave it to the other workers
+      b32 can_help = (worker != NULL && job_current_fiber() == NULL);
+      if (!can_help || !job_worker_run_one(system, worker))
+      {
+        spin_backoff(&spin_count);
+      }
+    }
+  }
+
+  job_system_wake_sleeper(system);
+}
+
+// NOTE(Ryan): Inside a fiber, parks until counter reaches zero.
+// Otherwise, helps execute jobs (including unrelated ones) until it does
+INTERNAL void
+job_wait_for_counter(JobSystem *system, JobCounter *counter)
+{
+  JobFiber *job_fiber = job_current_fiber();
+
+  if (job_fiber != NULL)
+  {
+    while (!job_counter_is_done(counter))
+    {
+      job_fiber->wait_counter = counter;
+      job_fiber->state = JOB_FIBER_STATE_WAITING;
+      JobWorker *worker = job_system_current_worker(system);
+      fiber_switch(&job_fiber->fiber.context, &worker->scheduler_context);
+    }
+  }
+  else
+  {
+    JobWorker *worker = job_system_current_worker(system);
+    ASSERT(worker != NULL);
+
+    while (!job_counter_is_done(counter))
+    {
+      if (!job_worker_run_one(system, worker))
+      {
+        CPU_PAUSE();
+      }
+    }
+  }
+}
+
+INTERNAL void *
+job_worker_thread(void *arg)
+{
+  JobWorker *worker = (JobWorker *)arg;
+  JobSystem *system = worker->system;
+
+  tl_job_worker_index = worker->index;
+
+  u32 idle_spin_count = 0;
+  while (!ATOMIC_LOAD_ACQUIRE(&system->want_to_quit))
+  {
+    if (job_worker_run_one(system, worker))
+    {
+      idle_spin_count = 0;
+    }
+    else if (idle_spin_count < 1024)
+    {
+      CPU_PAUSE();
+      idle_spin_count += 1;
+    }
+    else
+    {
+      u32 wake_sequence = ATOMIC_LOAD_ACQUIRE(&system->wake_sequence);
+      ATOMIC_ADD_SEQ_CST(&system->sleeping_count, 1);
+
+      // NOTE(Ryan): Recheck after announcing sleep, otherwise could miss a push or signal that saw sleeping_count == 0.
+      // A fiber parked after this check is published by an awake worker, which will resume it itself
+      Job job = ZERO_STRUCT;
+      b32 found_job = job_system_find_job(system, worker, &job);
+      b32 found_fiber = (!found_job && job_system_has_ready_fiber(system));
+      if (!found_job && !found_fiber && !ATOMIC_LOAD_ACQUIRE(&system->want_to_quit))
+      {
+        futex_wait(&system->wake_sequence, wake_sequence);
+      }
+
+      ATOMIC_SUB_SEQ_CST(&system->sleeping_count, 1);
+
+      if (found_job)
+      {
+        // NOTE(Ryan): Can't put it back in deque without reordering, so run without a fiber
+        job_execute(system, job);
+      }
+      idle_spin_count = 0;
+    }
+  }
+
+  return NULL;
+}
+
+// NOTE(Ryan): cpu_ids[worker_i] is the logical CPU each worker is pinned to, or NULL to leave all unpinned.
+// Calling thread becomes worker 0, so is pinned too until job_system_destroy() or job_system_unpin_creator()
+INTERNAL JobSystem *
+job_system_create_pinned(MemArena *arena, u32 worker_count, u32 *cpu_ids)
+{
+  JobSystem *system = (JobSystem *)mem_arena_push_aligned(arena, sizeof(JobSystem), CACHE_LINE_SIZE);
+  MEMORY_ZERO_STRUCT(system);
+
+  ASSERT(worker_count > 0);
+
+  system->worker_count = worker_count;
+  // NOTE(Ryan): CACHE_ALIGNED members only help if arena memory is also line aligned
+  system->workers = (JobWorker *)mem_arena_push_aligned(arena, sizeof(JobWorker) * worker_count, CACHE_LINE_SIZE);
+  MEMORY_ZERO(system->workers, sizeof(JobWorker) * worker_count);
+  system->injection_queue = mpmc_queue_create(arena, sizeof(Job), JOB_INJECTION_QUEUE_CAPACITY);
+
+  for (u32 worker_i = 0; worker_i < worker_count; worker_i += 1)
+  {
+    JobWorker *worker = &system->workers[worker_i];
+    worker->system = system;
+    worker->index = worker_i;
+    worker->steal_seed = 0x9E3779B9u * (worker_i + 1);
+    job_deque_init(arena, &worker->deque);
+  }
+
+  system->fibers = MEM_ARENA_PUSH_ARRAY_ZERO(arena, JobFiber, JOB_FIBER_COUNT);
+  for (u32 fiber_i = 0; fiber_i < JOB_FIBER_COUNT; fiber_i += 1)
+  {
+    JobFiber *job_fiber = &system->fibers[fiber_i];
+    job_fiber->system = system;
+    job_fiber->fiber = fiber_create(JOB_FIBER_STACK_SIZE, job_fiber_main, job_fiber);
+    SLL_STACK_PUSH(system->first_free_fiber, job_fiber);
+  }
+
+  tl_job_worker_index = 0;
+  system->workers[0].thread = pthread_self();
+
+  if (cpu_ids != NULL && sched_getaffinity(0, sizeof(system->creator_affinity), &system->creator_affinity) == 0)
+  {
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(cpu_ids[0], &cpu_set);
+    system->want_restore_creator_affinity = (sched_setaffinity(0, sizeof(cpu_set), &cpu_set) == 0);
+  }
+
+  for (u32 worker_i = 1; worker_i < worker_count; worker_i += 1)
+  {
+    JobWorker *worker = &system->workers[worker_i];
+
+    pthread_attr_t attr = ZERO_STRUCT;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, MB(1));
+
+    // NOTE(Ryan): Pinning keeps a worker's deque and job pool in its own core's cache
+    if (cpu_ids != NULL)
+    {
+      cpu_set_t cpu_set;
+      CPU_ZERO(&cpu_set);
+      CPU_SET(cpu_ids[worker_i], &cpu_set);
+      pthread_attr_setaffinity_np(&attr, sizeof(cpu_set), &cpu_set);
+    }
+
+    if (pthread_create(&worker->thread, &attr, job_worker_thread, worker) != 0)
+    {
+      FATAL_ERROR("Failed to create job worker thread.", strerror(errno), "");
+    }
+
+    pthread_attr_destroy(&attr);
+  }
+
+  return system;
+}
+
+// NOTE(Ryan): For a creator that also owns latency-sensitive work (e.g. SDL event pump and render submission).
+// Restores its original mask now rather than at job_system_destroy(), so the OS can move it off a busy core.
+// It still runs as worker 0 when waiting on counters
+INTERNAL void
+job_system_unpin_creator(JobSystem *system)
+{
+  ASSERT(job_system_current_worker(system) == &system->workers[0]);
+
+  if (system->want_restore_creator_affinity)
+  {
+    sched_setaffinity(0, sizeof(system->creator_affinity), &system->creator_affinity);
+    system->want_restore_creator_affinity = false;
+  }
+}
+
+// NOTE(Ryan): worker_count of 0 means one per usable logical CPU.
+// Workers fill physical cores before SMT siblings (see linux_get_cpu_topology()), 
+// wrapping if there are more workers than CPUs
+INTERNAL JobSystem *
+job_system_create(MemArena *arena, u32 worker_count)
+{
+  LinuxCPUTopology topology = linux_get_cpu_topology();
+  if (worker_count == 0)
+  {
+    worker_count = MAX(1, topology.cpu_count);
+  }
+
+  // NOTE(Ryan): No usable CPU below LINUX_MAX_CPUS, so let the scheduler place them
+  u32 *cpu_ids = NULL;
+  if (topology.cpu_count > 0)
+  {
+    cpu_ids = MEM_ARENA_PUSH_ARRAY(arena, u32, worker_count);
+    for (u32 worker_i = 0; worker_i < worker_count; worker_i += 1)
+    {
+      cpu_ids[worker_i] = topology.cpu_ids[worker_i % topology.cpu_count];
+    }
+  }
+
+  JobSystem *result = job_system_create_pinned(arena, worker_count, cpu_ids);
+
+  return result;
+}
+
+// NOTE(Ryan): A dlopen()ed module, e.g. app.so, has its own copy of the thread locals above
+// (unless the executable exports them), so the creating thread re-announces itself as worker 0 from inside the module
+// before submitting or waiting there. Other workers running the module's jobs see U32_MAX, so their submits
+// go through the injection queue, which is always safe
+INTERNAL void
+job_system_attach_creator_thread(JobSystem *system)
+{
+  ASSERT(pthread_equal(pthread_self(), system->workers[0].thread));
+
+  tl_job_worker_index = 0;
+}
+
+// NOTE(Ryan): Outstanding jobs are not drained, so wait on their counters first
+INTERNAL void
+job_system_destroy(JobSystem *system)
+{
+  ATOMIC_STORE_RELEASE(&system->want_to_quit, true);
+
+  ATOMIC_ADD_SEQ_CST(&system->wake_sequence, 1);
+  futex_wake_all(&system->wake_sequence);
+
+  // IMPORTANT(Ryan): Joining is what frees the thread stacks
+  for (u32 worker_i = 1; worker_i < system->worker_count; worker_i += 1)
+  {
+    pthread_join(system->workers[worker_i].thread, NULL);
+  }
+
+  for (u32 fiber_i = 0; fiber_i < JOB_FIBER_COUNT; fiber_i += 1)
+  {
+    fiber_destroy(&system->fibers[fiber_i].fiber);
+  }
+
+  if (system->want_restore_creator_affinity)
+  {
+    sched_setaffinity(0, sizeof(system->creator_affinity), &system->creator_affinity);
+  }
+
+  tl_job_worker_index = U32_MAX;
+}
@@ -1,428 +1,714 @@
 // SPDX-License-Identifier: zlib-acknowledgement
 #pragma once
 
-// NOTE(Ryan): Steam Hardware Survey as of March 2022: 
+// IMPORTANT(Ryan): A lane is one independent item (e.g. a ray) per SIMD element; every op is element-wise.
+// Code is written once against LaneF32/LaneU32/LaneV3 and compiles to scalar, SSE, AVX2 or AVX-512.
+// Divergent control flow is expressed with masks: a LaneU32 with each element all 1s or all 0s,
+// as produced by comparisons. conditional_assign() then only writes lanes whose mask is set.
+// Requires C++ for overloading.
+//
+// NOTE(Ryan): Steam Hardware Survey as of March 2022:
 //  SSE4.1 (99.06%)
-//  AVX (95.01%) 
-// This gives us load instructions.
-#if defined(__SSE4_1__) && defined(__AVX__)
-#define LANE_WIDTH 4
+//  AVX (95.01%)
+//  AVX2 (89.7%)
+//  AVX512F (9.4%)
+// Width defaults to widest the compiler is targeting; override with -DLANE_WIDTH=1|4|8|16
+#if !defined(LANE_WIDTH)
+  #if defined(__AVX512F__)
+    #define LANE_WIDTH 16
+  #elif defined(__AVX2__)
+    #define LANE_WIDTH 8
+  #elif defined(__SSE4_1__)
+    #define LANE_WIDTH 4
+  #else
+    #define LANE_WIDTH 1
+  #endif
+#endif
+
+#if (LANE_WIDTH == 16) && !defined(__AVX512F__)
+  #error LANE_WIDTH 16 requires AVX512F, e.g. -mavx512f
+#elif (LANE_WIDTH == 8) && !defined(__AVX2__)
+  #error LANE_WIDTH 8 requires AVX2, e.g. -mavx2
+#elif (LANE_WIDTH == 4) && !defined(__SSE4_1__)
+  #error LANE_WIDTH 4 requires SSE4.1, e.g. -msse4.1
+#elif (LANE_WIDTH != 1) && (LANE_WIDTH != 4) && (LANE_WIDTH != 8) && (LANE_WIDTH != 16)
+  #error LANE_WIDTH must be 1, 4, 8 or 16
+#endif
+
+#if (LANE_WIDTH != 1)
+  #include <immintrin.h>
+#endif
+
+#if (LANE_WIDTH == 16)
+
+typedef struct LaneF32 LaneF32;
 struct LaneF32
 {
-  __m128 value;
+  __m512 v;
 };
 
+typedef struct LaneU32 LaneU32;
 struct LaneU32
 {
-  __m128i value;
+  __m512i v;
 };
 
-#define LANE_R32_ADD(a, b) _mm_add_ps(a.value, b.value)
-#define LANE_R32_MUL(a, b) _mm_add_ps(a.value, b.value)
-#define LANE_R32_SUB(a, b) _mm_add_ps(a.value, b.value)
-#define LANE_R32_DIV(a, b) _mm_add_ps(a.value, b.value)
-#define LANE_R32_SLL(a, b) _mm_add_ps(a.value, b.value)
-#define LANE_R32_SRL(a, b) _mm_add_ps(a.value, b.value)
-
-#define LANE_R32_MIN(a, b) _mm_min_ps(a.value, b.value)
-#define LANE_R32_MAX(a, b) _mm_max_ps(a.value, b.value)
-
-#define LANE_R32_HADD(a, b) _mm_min_ps(a.value, b.value)
-
-#elif defined(__AVX2__)
-
-#define LANE_WIDTH 8
-struct LaneR32
+// NOTE(Ryan): AVX-512 comparisons produce a k-register; widened back to a vector so masks behave the same at every width
+INTERNAL LaneU32 lane_u32_from_k(__mmask16 k) { return {_mm512_maskz_mov_epi32(k, _mm512_set1_epi32(-1))}; }
+INTERNAL __mmask16 lane_k_from_u32(LaneU32 mask) { return _mm512_test_epi32_mask(mask.v, mask.v); }
+
+INTERNAL LaneF32 lane_f32(f32 replicate) { return {_mm512_set1_ps(replicate)}; }
+INTERNAL LaneU32 lane_u32(u32 replicate) { return {_mm512_set1_epi32((s32)replicate)}; }
+INTERNAL LaneF32 lane_f32_from_u32(LaneU32 a) { return {_mm512_cvtepu32_ps(a.v)}; }
+// NOTE(Ryan): Round to nearest even (default MXCSR mode); a must fit in s32
+INTERNAL LaneU32 lane_u32_round_f32(LaneF32 a) { return {_mm512_cvtps_epi32(a.v)}; }
+INTERNAL LaneF32 lane_f32_reinterpret_u32(LaneU32 a) { return {_mm512_castsi512_ps(a.v)}; }
+INTERNAL LaneU32 lane_u32_reinterpret_f32(LaneF32 a) { return {_mm512_castps_si512(a.v)}; }
+
+INTERNAL LaneF32 lane_f32_load(f32 *src) { return {_mm512_loadu_ps(src)}; }
+INTERNAL LaneU32 lane_u32_load(u32 *src) { return {_mm512_loadu_si512(src)}; }
+INTERNAL void lane_f32_store(f32 *dst, LaneF32 a) { _mm512_storeu_ps(dst, a.v); }
+INTERNAL void lane_u32_store(u32 *dst, LaneU32 a) { _mm512_storeu_si512(dst, a.v); }
+
+INTERNAL LaneF32 lane_f32_add(LaneF32 a, LaneF32 b) { return {_mm512_add_ps(a.v, b.v)}; }
+INTERNAL LaneF32 lane_f32_sub(LaneF32 a, LaneF32 b) { return {_mm512_sub_ps(a.v, b.v)}; }
+INTERNAL LaneF32 lane_f32_mul(LaneF32 a, LaneF32 b) { return {_mm512_mul_ps(a.v, b.v)}; }
+INTERNAL LaneF32 lane_f32_div(LaneF32 a, LaneF32 b) { return {_mm512_div_ps(a.v, b.v)}; }
+INTERNAL LaneF32 lane_f32_min(LaneF32 a, LaneF32 b) { return {_mm512_min_ps(a.v, b.v)}; }
+INTERNAL LaneF32 lane_f32_max(LaneF32 a, LaneF32 b) { return {_mm512_max_ps(a.v, b.v)}; }
+INTERNAL LaneF32 lane_f32_sqrt(LaneF32 a) { return {_mm512_sqrt_ps(a.v)}; }
+
+INTERNAL LaneU32 lane_f32_lt(LaneF32 a, LaneF32 b) { return lane_u32_from_k(_mm512_cmp_ps_mask(a.v, b.v, _CMP_LT_OQ)); }
+INTERNAL LaneU32 lane_f32_le(LaneF32 a, LaneF32 b) { return lane_u32_from_k(_mm512_cmp_ps_mask(a.v, b.v, _CMP_LE_OQ)); }
+INTERNAL LaneU32 lane_f32_gt(LaneF32 a, LaneF32 b) { return lane_u32_from_k(_mm512_cmp_ps_mask(a.v, b.v, _CMP_GT_OQ)); }
+INTERNAL LaneU32 lane_f32_ge(LaneF32 a, LaneF32 b) { return lane_u32_from_k(_mm512_cmp_ps_mask(a.v, b.v, _CMP_GE_OQ)); }
+INTERNAL LaneU32 lane_f32_eq(LaneF32 a, LaneF32 b) { return lane_u32_from_k(_mm512_cmp_ps_mask(a.v, b.v, _CMP_EQ_OQ)); }
+INTERNAL LaneU32 lane_f32_ne(LaneF32 a, LaneF32 b) { return lane_u32_from_k(_mm512_cmp_ps_mask(a.v, b.v, _CMP_NEQ_UQ)); }
+
+INTERNAL LaneU32 lane_u32_add(LaneU32 a, LaneU32 b) { return {_mm512_add_epi32(a.v, b.v)}; }
+INTERNAL LaneU32 lane_u32_sub(LaneU32 a, LaneU32 b) { return {_mm512_sub_epi32(a.v, b.v)}; }
+INTERNAL LaneU32 lane_u32_mul(LaneU32 a, LaneU32 b) { return {_mm512_mullo_epi32(a.v, b.v)}; }
+INTERNAL LaneU32 lane_u32_and(LaneU32 a, LaneU32 b) { return {_mm512_and_si512(a.v, b.v)}; }
+INTERNAL LaneU32 lane_u32_or(LaneU32 a, LaneU32 b) { return {_mm512_or_si512(a.v, b.v)}; }
+INTERNAL LaneU32 lane_u32_xor(LaneU32 a, LaneU32 b) { return {_mm512_xor_si512(a.v, b.v)}; }
+// NOTE(Ryan): a & ~b (intrinsic negates its first operand)
+INTERNAL LaneU32 lane_u32_and_not(LaneU32 a, LaneU32 b) { return {_mm512_andnot_si512(b.v, a.v)}; }
+INTERNAL LaneU32 lane_u32_shl(LaneU32 a, u32 shift) { return {_mm512_slli_epi32(a.v, shift)}; }
+INTERNAL LaneU32 lane_u32_shr(LaneU32 a, u32 shift) { return {_mm512_srli_epi32(a.v, shift)}; }
+INTERNAL LaneU32 lane_u32_eq(LaneU32 a, LaneU32 b) { return lane_u32_from_k(_mm512_cmpeq_epi32_mask(a.v, b.v)); }
+INTERNAL LaneU32 lane_u32_gt(LaneU32 a, LaneU32 b) { return lane_u32_from_k(_mm512_cmpgt_epu32_mask(a.v, b.v)); }
+
+INTERNAL LaneF32 lane_f32_select(LaneU32 mask, LaneF32 if_clear, LaneF32 if_set) { return {_mm512_mask_blend_ps(lane_k_from_u32(mask), if_clear.v, if_set.v)}; }
+INTERNAL LaneU32 lane_u32_select(LaneU32 mask, LaneU32 if_clear, LaneU32 if_set) { return {_mm512_mask_blend_epi32(lane_k_from_u32(mask), if_clear.v, if_set.v)}; }
+
+INTERNAL b32 mask_is_zeroed(LaneU32 mask) { return (lane_k_from_u32(mask) == 0); }
+INTERNAL b32 mask_is_full(LaneU32 mask) { return (lane_k_from_u32(mask) == 0xFFFF); }
+INTERNAL u32 mask_count(LaneU32 mask) { return u32_count_bits_set(lane_k_from_u32(mask)); }
+
+#elif (LANE_WIDTH == 8)
+
+typedef struct LaneF32 LaneF32;
+struct LaneF32
 {
-  __m256 value;
+  __m256 v;
 };
 
+typedef struct LaneU32 LaneU32;
 struct LaneU32
 {
-  __m256i value;
+  __m256i v;
 };
 
-// TODO(Ryan): Implement AVX512
-#else
-
-#define LANE_WIDTH 1
-struct LaneR32
+INTERNAL LaneF32 lane_f32(f32 replicate) { return {_mm256_set1_ps(replicate)}; }
+INTERNAL LaneU32 lane_u32(u32 replicate) { return {_mm256_set1_epi32((s32)replicate)}; }
+// IMPORTANT(Ryan): Signed conversion below AVX-512, so values must be < 2^31
+INTERNAL LaneF32 lane_f32_from_u32(LaneU32 a) { return {_mm256_cvtepi32_ps(a.v)}; }
+INTERNAL LaneU32 lane_u32_round_f32(LaneF32 a) { return {_mm256_cvtps_epi32(a.v)}; }
+INTERNAL LaneF32 lane_f32_reinterpret_u32(LaneU32 a) { return {_mm256_castsi256_ps(a.v)}; }
+INTERNAL LaneU32 lane_u32_reinterpret_f32(LaneF32 a) { return {_mm256_castps_si256(a.v)}; }
+
+INTERNAL LaneF32 lane_f32_load(f32 *src) { return {_mm256_loadu_ps(src)}; }
+INTERNAL LaneU32 lane_u32_load(u32 *src) { return {_mm256_loadu_si256((__m256i *)src)}; }
+INTERNAL void lane_f32_store(f32 *dst, LaneF32 a) { _mm256_storeu_ps(dst, a.v); }
+INTERNAL void lane_u32_store(u32 *dst, LaneU32 a) { _mm256_storeu_si256((__m256i *)dst, a.v); }
+
+INTERNAL LaneF32 lane_f32_add(LaneF32 a, LaneF32 b) { return {_mm256_add_ps(a.v, b.v)}; }
+INTERNAL LaneF32 lane_f32_sub(LaneF32 a, LaneF32 b) { return {_mm256_sub_ps(a.v, b.v)}; }
+INTERNAL LaneF32 lane_f32_mul(LaneF32 a, LaneF32 b) { return {_mm256_mul_ps(a.v, b.v)}; }
+INTERNAL LaneF32 lane_f32_div(LaneF32 a, LaneF32 b) { return {_mm256_div_ps(a.v, b.v)}; }
+INTERNAL LaneF32 lane_f32_min(LaneF32 a, LaneF32 b) { return {_mm256_min_ps(a.v, b.v)}; }
+INTERNAL LaneF32 lane_f32_max(LaneF32 a, LaneF32 b) { return {_mm256_max_ps(a.v, b.v)}; }
+INTERNAL LaneF32 lane_f32_sqrt(LaneF32 a) { return {_mm256_sqrt_ps(a.v)}; }
+
+INTERNAL LaneU32 lane_f32_lt(LaneF32 a, LaneF32 b) { return {_mm256_castps_si256(_mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ))}; }
+INTERNAL LaneU32 lane_f32_le(LaneF32 a, LaneF32 b) { return {_mm256_castps_si256(_mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ))}; }
+INTERNAL LaneU32 lane_f32_gt(LaneF32 a, LaneF32 b) { return {_mm256_castps_si256(_mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ))}; }
+INTERNAL LaneU32 lane_f32_ge(LaneF32 a, LaneF32 b) { return {_mm256_castps_si256(_mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ))}; }
+INTERNAL LaneU32 lane_f32_eq(LaneF32 a, LaneF32 b) { return {_mm256_castps_si256(_mm256_cmp_ps(a.v, b.v, _CMP_EQ_OQ))}; }
+INTERNAL LaneU32 lane_f32_ne(LaneF32 a, LaneF32 b) { return {_mm256_castps_si256(_mm256_cmp_ps(a.v, b.v, _CMP_NEQ_UQ))}; }
+
+INTERNAL LaneU32 lane_u32_add(LaneU32 a, LaneU32 b) { return {_mm256_add_epi32(a.v, b.v)}; }
+INTERNAL LaneU32 lane_u32_sub(LaneU32 a, LaneU32 b) { return {_mm256_sub_epi32(a.v, b.v)}; }
+INTERNAL LaneU32 lane_u32_mul(LaneU32 a, LaneU32 b) { return {_mm256_mullo_epi32(a.v, b.v)}; }
+INTERNAL LaneU32 lane_u32_and(LaneU32 a, LaneU32 b) { return {_mm256_and_si256(a.v, b.v)}; }
+INTERNAL LaneU32 lane_u32_or(LaneU32 a, LaneU32 b) { return {_mm256_or_si256(a.v, b.v)}; }
+INTERNAL LaneU32 lane_u32_xor(LaneU32 a, LaneU32 b) { return {_mm256_xor_si256(a.v, b.v)}; }
+INTERNAL LaneU32 lane_u32_and_not(LaneU32 a, LaneU32 b) { return {_mm256_andnot_si256(b.v, a.v)}; }
+INTERNAL LaneU32 lane_u32_shl(LaneU32 a, u32 shift) { return {_mm256_slli_epi32(a.v, shift)}; }
+INTERNAL LaneU32 lane_u32_shr(LaneU32 a, u32 shift) { return {_mm256_srli_epi32(a.v, shift)}; }
+INTERNAL LaneU32 lane_u32_eq(LaneU32 a, LaneU32 b) { return {_mm256_cmpeq_epi32(a.v, b.v)}; }
+// NOTE(Ryan): Only signed compare exists, so flip sign bits to compare unsigned
+INTERNAL LaneU32 lane_u32_gt(LaneU32 a, LaneU32 b)
+{
+  __m256i bias = _mm256_set1_epi32((s32)0x80000000);
+  return {_mm256_cmpgt_epi32(_mm256_xor_si256(a.v, bias), _mm256_xor_si256(b.v, bias))};
+}
+
+INTERNAL LaneF32 lane_f32_select(LaneU32 mask, LaneF32 if_clear, LaneF32 if_set) { return {_mm256_blendv_ps(if_clear.v, if_set.v, _mm256_castsi256_ps(mask.v))}; }
+INTERNAL LaneU32 lane_u32_select(LaneU32 mask, LaneU32 if_clear, LaneU32 if_set) { return {_mm256_blendv_epi8(if_clear.v, if_set.v, mask.v)}; }
+
+INTERNAL b32 mask_is_zeroed(LaneU32 mask) { return (_mm256_movemask_ps(_mm256_castsi256_ps(mask.v)) == 0); }
+INTERNAL b32 mask_is_full(LaneU32 mask) { return (_mm256_movemask_ps(_mm256_castsi256_ps(mask.v)) == 0xFF); }
+INTERNAL u32 mask_count(LaneU32 mask) { return u32_count_bits_set((u32)_mm256_movemask_ps(_mm256_castsi256_ps(mask.v))); }
+
+#elif (LANE_WIDTH == 4)
+
+typedef struct LaneF32 LaneF32;
+struct LaneF32
 {
-  r32 value;
+  __m128 v;
 };
 
+typedef struct LaneU32 LaneU32;
 struct LaneU32
 {
-  u32 value;
+  __m128i v;
 };
 
-#define LANE_R32_ADD_LANE_R32(a, b) (a.value + b.value)
+INTERNAL LaneF32 lane_f32(f32 replicate) { return {_mm_set1_ps(replicate)}; }
+INTERNAL LaneU32 lane_u32(u32 replicate) { return {_mm_set1_epi32((s32)replicate)}; }
+// IMPORTANT(Ryan): Signed conversion below AVX-512, so values must be < 2^31
+INTERNAL LaneF32 lane_f32_from_u32(LaneU32 a) { return {_mm_cvtepi32_ps(a.v)}; }
+INTERNAL LaneU32 lane_u32_round_f32(LaneF32 a) { return {_mm_cvtps_epi32(a.v)}; }
+INTERNAL LaneF32 lane_f32_reinterpret_u32(LaneU32 a) { return {_mm_castsi128_ps(a.v)}; }
+INTERNAL LaneU32 lane_u32_reinterpret_f32(LaneF32 a) { return {_mm_castps_si128(a.v)}; }
+
+INTERNAL LaneF32 lane_f32_load(f32 *src) { return {_mm_loadu_ps(src)}; }
+INTERNAL LaneU32 lane_u32_load(u32 *src) { return {_mm_loadu_si128((__m128i *)src)}; }
+INTERNAL void lane_f32_store(f32 *dst, LaneF32 a) { _mm_storeu_ps(dst, a.v); }
+INTERNAL void lane_u32_store(u32 *dst, LaneU32 a) { _mm_storeu_si128((__m128i *)dst, a.v); }
+
+INTERNAL LaneF32 lane_f32_add(LaneF32 a, LaneF32 b) { return {_mm_add_ps(a.v, b.v)}; }
+INTERNAL LaneF32 lane_f32_sub(LaneF32 a, LaneF32 b) { return {_mm_sub_ps(a.v, b.v)}; }
+INTERNAL LaneF32 lane_f32_mul(LaneF32 a, LaneF32 b) { return {_mm_mul_ps(a.v, b.v)}; }
+INTERNAL LaneF32 lane_f32_div(LaneF32 a, LaneF32 b) { return {_mm_div_ps(a.v, b.v)}; }
+INTERNAL LaneF32 lane_f32_min(LaneF32 a, LaneF32 b) { return {_mm_min_ps(a.v, b.v)}; }
+INTERNAL LaneF32 lane_f32_max(LaneF32 a, LaneF32 b) { return {_mm_max_ps(a.v, b.v)}; }
+INTERNAL LaneF32 lane_f32_sqrt(LaneF32 a) { return {_mm_sqrt_ps(a.v)}; }
+
+INTERNAL LaneU32 lane_f32_lt(LaneF32 a, LaneF32 b) { return {_mm_castps_si128(_mm_cmplt_ps(a.v, b.v))}; }
+INTERNAL LaneU32 lane_f32_le(LaneF32 a, LaneF32 b) { return {_mm_castps_si128(_mm_cmple_ps(a.v, b.v))}; }
+INTERNAL LaneU32 lane_f32_gt(LaneF32 a, LaneF32 b) { return {_mm_castps_si128(_mm_cmpgt_ps(a.v, b.v))}; }
+INTERNAL LaneU32 lane_f32_ge(LaneF32 a, LaneF32 b) { return {_mm_castps_si128(_mm_cmpge_ps(a.v, b.v))}; }
+INTERNAL LaneU32 lane_f32_eq(LaneF32 a, LaneF32 b) { return {_mm_castps_si128(_mm_cmpeq_ps(a.v, b.v))}; }
+INTERNAL LaneU32 lane_f32_ne(LaneF32 a, LaneF32 b) { return {_mm_castps_si128(_mm_cmpneq_ps(a.v, b.v))}; }
+
+INTERNAL LaneU32 lane_u32_add(LaneU32 a, LaneU32 b) { return {_mm_add_epi32(a.v, b.v)}; }
+INTERNAL LaneU32 lane_u32_sub(LaneU32 a, LaneU32 b) { return {_mm_sub_epi32(a.v, b.v)}; }
+INTERNAL LaneU32 lane_u32_mul(LaneU32 a, LaneU32 b) { return {_mm_mullo_epi32(a.v, b.v)}; }
+INTERNAL LaneU32 lane_u32_and(LaneU32 a, LaneU32 b) { return {_mm_and_si128(a.v, b.v)}; }
+INTERNAL LaneU32 lane_u32_or(LaneU32 a, LaneU32 b) { return {_mm_or_si128(a.v, b.v)}; }
+INTERNAL LaneU32 lane_u32_xor(LaneU32 a, LaneU32 b) { return {_mm_xor_si128(a.v, b.v)}; }
+INTERNAL LaneU32 lane_u32_and_not(LaneU32 a, LaneU32 b) { return {_mm_andnot_si128(b.v, a.v)}; }
+INTERNAL LaneU32 lane_u32_shl(LaneU32 a, u32 shift) { return {_mm_slli_epi32(a.v, shift)}; }
+INTERNAL LaneU32 lane_u32_shr(LaneU32 a, u32 shift) { return {_mm_srli_epi32(a.v, shift)}; }
+INTERNAL LaneU32 lane_u32_eq(LaneU32 a, LaneU32 b) { return {_mm_cmpeq_epi32(a.v, b.v)}; }
+INTERNAL LaneU32 lane_u32_gt(LaneU32 a, LaneU32 b)
+{
+  __m128i bias = _mm_set1_epi32((s32)0x80000000);
+  return {_mm_cmpgt_epi32(_mm_xor_si128(a.v, bias), _mm_xor_si128(b.v, bias))};
+}
+
+INTERNAL LaneF32 lane_f32_select(LaneU32 mask, LaneF32 if_clear, LaneF32 if_set) { return {_mm_blendv_ps(if_clear.v, if_set.v, _mm_castsi128_ps(mask.v))}; }
+INTERNAL LaneU32 lane_u32_select(LaneU32 mask, LaneU32 if_clear, LaneU32 if_set) { return {_mm_blendv_epi8(if_clear.v, if_set.v, mask.v)}; }
+
+INTERNAL b32 mask_is_zeroed(LaneU32 mask) { return (_mm_movemask_ps(_mm_castsi128_ps(mask.v)) == 0); }
+INTERNAL b32 mask_is_full(LaneU32 mask) { return (_mm_movemask_ps(_mm_castsi128_ps(mask.v)) == 0xF); }
+INTERNAL u32 mask_count(LaneU32 mask) { return u32_count_bits_set((u32)_mm_movemask_ps(_mm_castsi128_ps(mask.v))); }
 
-#endif
-
-struct lane_v3
-{
-  LaneR32 x;
-  LaneR32 y;
-  LaneR32 z;
-}
+#else
 
-INTERNAL LaneR32
-operator+(LaneR32 a, LaneR32 b)
+// NOTE(Ryan): Scalar reference; also useful for debugging as each lane is just a float
+typedef struct LaneF32 LaneF32;
+struct LaneF32
 {
-  LaneR32 result = {};
-
-  result = LANE_R32_ADD_LANE_R32(a, b);
-
-  return result;
-}
-
+  f32 v;
+};
 
-INTERNAL LaneR32
-operator-(LaneR32 a)
+typedef struct LaneU32 LaneU32;
+struct LaneU32
 {
-  LaneR32 result = {};
+  u32 v;
+};
 
-  result = LaneR32_from_r32(0) - a;
+INTERNAL LaneU32 lane_u32_from_b32(b32 cond) { return {cond ? 0xFFFFFFFF : 0}; }
+
+INTERNAL LaneF32 lane_f32(f32 replicate) { return {replicate}; }
+INTERNAL LaneU32 lane_u32(u32 replicate) { return {replicate}; }
+INTERNAL LaneF32 lane_f32_from_u32(LaneU32 a) { return {(f32)a.v}; }
+INTERNAL LaneU32 lane_u32_round_f32(LaneF32 a) { return {(u32)lrintf(a.v)}; }
+INTERNAL LaneF32 lane_f32_reinterpret_u32(LaneU32 a) { LaneF32 result; MEMORY_COPY(&result.v, &a.v, sizeof(f32)); return result; }
+INTERNAL LaneU32 lane_u32_reinterpret_f32(LaneF32 a) { LaneU32 result; MEMORY_COPY(&result.v, &a.v, sizeof(u32)); return result; }
+
+INTERNAL LaneF32 lane_f32_load(f32 *src) { return {*src}; }
+INTERNAL LaneU32 lane_u32_load(u32 *src) { return {*src}; }
+INTERNAL void lane_f32_store(f32 *dst, LaneF32 a) { *dst = a.v; }
+INTERNAL void lane_u32_store(u32 *dst, LaneU32 a) { *dst = a.v; }
+
+INTERNAL LaneF32 lane_f32_add(LaneF32 a, LaneF32 b) { return {a.v + b.v}; }
+INTERNAL LaneF32 lane_f32_sub(LaneF32 a, LaneF32 b) { return {a.v - b.v}; }
+INTERNAL LaneF32 lane_f32_mul(LaneF32 a, LaneF32 b) { return {a.v * b.v}; }
+INTERNAL LaneF32 lane_f32_div(LaneF32 a, LaneF32 b) { return {a.v / b.v}; }
+INTERNAL LaneF32 lane_f32_min(LaneF32 a, LaneF32 b) { return {MIN(a.v, b.v)}; }
+INTERNAL LaneF32 lane_f32_max(LaneF32 a, LaneF32 b) { return {MAX(a.v, b.v)}; }
+INTERNAL LaneF32 lane_f32_sqrt(LaneF32 a) { return {f32_sqrt(a.v)}; }
+
+INTERNAL LaneU32 lane_f32_lt(LaneF32 a, LaneF32 b) { return lane_u32_from_b32(a.v < b.v); }
+INTERNAL LaneU32 lane_f32_le(LaneF32 a, LaneF32 b) { return lane_u32_from_b32(a.v <= b.v); }
+INTERNAL LaneU32 lane_f32_gt(LaneF32 a, LaneF32 b) { return lane_u32_from_b32(a.v > b.v); }
+INTERNAL LaneU32 lane_f32_ge(LaneF32 a, LaneF32 b) { return lane_u32_from_b32(a.v >= b.v); }
+INTERNAL LaneU32 lane_f32_eq(LaneF32 a, LaneF32 b) { return lane_u32_from_b32(a.v == b.v); }
+INTERNAL LaneU32 lane_f32_ne(LaneF32 a, LaneF32 b) { return lane_u32_from_b32(a.v != b.v); }
+
+INTERNAL LaneU32 lane_u32_add(LaneU32 a, LaneU32 b) { return {a.v + b.v}; }
+INTERNAL LaneU32 lane_u32_sub(LaneU32 a, LaneU32 b) { return {a.v - b.v}; }
+INTERNAL LaneU32 lane_u32_mul(LaneU32 a, LaneU32 b) { return {a.v * b.v}; }
+INTERNAL LaneU32 lane_u32_and(LaneU32 a, LaneU32 b) { return {a.v & b.v}; }
+INTERNAL LaneU32 lane_u32_or(LaneU32 a, LaneU32 b) { return {a.v | b.v}; }
+INTERNAL LaneU32 lane_u32_xor(LaneU32 a, LaneU32 b) { return {a.v ^ b.v}; }
+INTERNAL LaneU32 lane_u32_and_not(LaneU32 a, LaneU32 b) { return {a.v & ~b.v}; }
+INTERNAL LaneU32 lane_u32_shl(LaneU32 a, u32 shift) { return {a.v << shift}; }
+INTERNAL LaneU32 lane_u32_shr(LaneU32 a, u32 shift) { return {a.v >> shift}; }
+INTERNAL LaneU32 lane_u32_eq(LaneU32 a, LaneU32 b) { return lane_u32_from_b32(a.v == b.v); }
+INTERNAL LaneU32 lane_u32_gt(LaneU32 a, LaneU32 b) { return lane_u32_from_b32(a.v > b.v); }
+
+INTERNAL LaneF32 lane_f32_select(LaneU32 mask, LaneF32 if_clear, LaneF32 if_set) { return (mask.v ? if_set : if_clear); }
+INTERNAL LaneU32 lane_u32_select(LaneU32 mask, LaneU32 if_clear, LaneU32 if_set) { return (mask.v ? if_set : if_clear); }
+
+INTERNAL b32 mask_is_zeroed(LaneU32 mask) { return (mask.v == 0); }
+INTERNAL b32 mask_is_full(LaneU32 mask) { return (mask.v == 0xFFFFFFFF); }
+INTERNAL u32 mask_count(LaneU32 mask) { return (mask.v != 0); }
 
-  return result;
-}
+#endif
 
+// NOTE(Ryan): Everything below is width independent, built on the primitives above
 
+INTERNAL LaneF32 lane_f32_abs(LaneF32 a) { return lane_f32_reinterpret_u32(lane_u32_and(lane_u32_reinterpret_f32(a), lane_u32(0x7FFFFFFF))); }
+INTERNAL LaneF32 lane_f32_clamp01(LaneF32 a) { return lane_f32_min(lane_f32_max(a, lane_f32(0.0f)), lane_f32(1.0f)); }
+INTERNAL LaneF32 lane_f32_lerp(LaneF32 a, LaneF32 b, LaneF32 t) { return lane_f32_add(a, lane_f32_mul(lane_f32_sub(b, a), t)); }
+INTERNAL LaneU32 lane_u32_not(LaneU32 a) { return lane_u32_xor(a, lane_u32(0xFFFFFFFF)); }
+INTERNAL LaneU32 lane_u32_ne(LaneU32 a, LaneU32 b) { return lane_u32_not(lane_u32_eq(a, b)); }
 
+// NOTE(Ryan): Per-lane constant, e.g. {0, 1, 2, 3} for deriving distinct seeds/pixel offsets
 INTERNAL LaneU32
-and_not(LaneU32 a, LaneU32 b)
-{
-  LaneU32 result = {};
-
-  result = _mm_andnot_si128(a.value, b.value);
-
-  return result;
-}
-
-INTERNAL b32
-mask_is_zeroed(LaneU32 a)
-{
-  int mask_value = _mm_movemask_epi8(a.value);
-
-  return (mask_value == 0);
-}
-
-// SSSE3 has instruction for this
-INTERNAL r64
-horizontal_add(LaneR32 a)
-{
-  r32 *val = (r32 *)&a.value;
-
-  r32 result = (r64)val[0] + (r64)val[1] + (r64)val[2] + (r64)val[3];
-
-  return result;
-}
-
-INTERNAL lane_v3
-lane_v3(LaneR32 x, LaneR32 y, LaneR32 z)
+lane_u32_index(void)
 {
-  lane_v3 result = {};
-
-  result.x = x;
-  result.y = y;
-  result.z = z;
+  u32 indices[LANE_WIDTH];
+  for (u32 lane_i = 0; lane_i < LANE_WIDTH; lane_i += 1)
+  {
+    indices[lane_i] = lane_i;
+  }
 
-  return result;
+  return lane_u32_load(indices);
 }
 
-// extract functions
-INTERNAL V3
-extract0(lane_v3 a)
+INTERNAL f32
+lane_f32_extract(LaneF32 a, u32 lane_index)
 {
-  V3 result = {};
-
-  result.x = (r32 *)&a.x[0];
-  result.y = (r32 *)&a.y[0];
-  result.z = (r32 *)&a.z[0];
+  f32 values[LANE_WIDTH];
+  lane_f32_store(values, a);
 
-  return result;
+  return values[lane_index];
 }
 
-
-INTERNAL LaneU32
-operator<(LaneR32 a, LaneR32 b)
+INTERNAL u32
+lane_u32_extract(LaneU32 a, u32 lane_index)
 {
-  LaneU32 result = {};
-
-  result = _mm_castps_si128(_mm_cmplt_ps(a.value, b.value));
+  u32 values[LANE_WIDTH];
+  lane_u32_store(values, a);
 
-  return result;
+  return values[lane_index];
 }
 
-INTERNAL LaneU32
-operator<<(LaneU32 a, u32 shift)
+// NOTE(Ryan): Summed as f64, as this is typically accumulating many samples
+INTERNAL f32
+horizontal_add(LaneF32 a)
 {
-  LaneU32 result;
+  f32 values[LANE_WIDTH];
+  lane_f32_store(values, a);
 
-  result.value = _mm_slli_epi32(a.value, shift);
+  f64 result = 0.0;
+  for (u32 lane_i = 0; lane_i < LANE_WIDTH; lane_i += 1)
+  {
+    result += (f64)values[lane_i];
+  }
 
-  return result;
+  return (f32)result;
 }
 
-INTERNAL LaneU32
-operator>>(LaneU32 a, u32 shift)
+INTERNAL u64
+horizontal_add(LaneU32 a)
 {
-  LaneU32 result;
+  u32 values[LANE_WIDTH];
+  lane_u32_store(values, a);
 
-  result.value = _mm_srli_epi32(a.value, shift);
+  u64 result = 0;
+  for (u32 lane_i = 0; lane_i < LANE_WIDTH; lane_i += 1)
+  {
+    result += values[lane_i];
+  }
 
   return result;
 }
 
-INTERNAL LaneU32
-operator^(LaneU32 a, LaneU32 b)
+INTERNAL f32
+horizontal_min(LaneF32 a)
 {
-  LaneU32 result;
+  f32 values[LANE_WIDTH];
+  lane_f32_store(values, a);
 
-  result = _mm_xor_si128(a.value, b.value);
+  f32 result = values[0];
+  for (u32 lane_i = 1; lane_i < LANE_WIDTH; lane_i += 1)
+  {
+    result = MIN(result, values[lane_i]);
+  }
 
   return result;
 }
 
-INTERNAL LaneR32
-operator+(LaneR32 a, LaneR32 b)
+INTERNAL f32
+horizontal_max(LaneF32 a)
 {
-  LaneR32 result;
+  f32 values[LANE_WIDTH];
+  lane_f32_store(values, a);
 
-  result = _mm_add_ps(a.value, b.value);
+  f32 result = values[0];
+  for (u32 lane_i = 1; lane_i < LANE_WIDTH; lane_i += 1)
+  {
+    result = MAX(result, values[lane_i]);
+  }
 
   return result;
 }
 
+// NOTE(Ryan): Loads member of a struct array at a different index per lane, e.g. material per hit.
+// Scalar loads, as hardware gather has no stride operand and isn't faster for a handful of lanes
+#define LANE_F32_GATHER(base, member, indices) \
+  lane_f32_gather((u8 *)&(base)->member, sizeof(*(base)), (indices))
+#define LANE_U32_GATHER(base, member, indices) \
+  lane_u32_gather((u8 *)&(base)->member, sizeof(*(base)), (indices))
+#define LANE_V3_GATHER(base, member, indices) \
+  lane_v3_gather((u8 *)&(base)->member, sizeof(*(base)), (indices))
 
-INTERNAL LaneR32
-operator/(LaneR32 a, r32 div)
+INTERNAL LaneF32
+lane_f32_gather(u8 *first, memory_index stride, LaneU32 indices)
 {
-  LaneR32 result;
+  u32 index_values[LANE_WIDTH];
+  lane_u32_store(index_values, indices);
 
-  result.v = _mm_div_ps(a.result, _mm_set1_ps(div));
+  f32 values[LANE_WIDTH];
+  for (u32 lane_i = 0; lane_i < LANE_WIDTH; lane_i += 1)
+  {
+    values[lane_i] = *(f32 *)(first + index_values[lane_i] * stride);
+  }
 
-  return result;
+  return lane_f32_load(values);
 }
 
-INTERNAL LaneR32
-LaneR32_from_LaneU32(LaneU32 a)
+INTERNAL LaneU32
+lane_u32_gather(u8 *first, memory_index stride, LaneU32 indices)
 {
-  LaneR32 result;
+  u32 index_values[LANE_WIDTH];
+  lane_u32_store(index_values, indices);
 
-  result.value = _mm_cvtepi32_ps(a.value);
+  u32 values[LANE_WIDTH];
+  for (u32 lane_i = 0; lane_i < LANE_WIDTH; lane_i += 1)
+  {
+    values[lane_i] = *(u32 *)(first + index_values[lane_i] * stride);
+  }
 
-  return result;
+  return lane_u32_load(values);
 }
 
-INTERNAL LaneR32
-LaneR32_from_u32(u32 replicate)
+INTERNAL void
+conditional_assign(LaneF32 *dest, LaneU32 mask, LaneF32 source)
 {
-  LaneR32 result;
-
-  result.value = _mm_set1_ps((r32)replicate);
-
-  return result;
+  *dest = lane_f32_select(mask, *dest, source);
 }
 
-INTERNAL LaneR32
-LaneR32_from_r32(r32 replicate)
+INTERNAL void
+conditional_assign(LaneU32 *dest, LaneU32 mask, LaneU32 source)
 {
-  LaneR32 result;
-
-  result.value = _mm_set1_ps(replicate);
+  *dest = lane_u32_select(mask, *dest, source);
+}
+
+INTERNAL LaneF32 operator+(LaneF32 a, LaneF32 b) { return lane_f32_add(a, b); }
+INTERNAL LaneF32 operator-(LaneF32 a, LaneF32 b) { return lane_f32_sub(a, b); }
+INTERNAL LaneF32 operator*(LaneF32 a, LaneF32 b) { return lane_f32_mul(a, b); }
+INTERNAL LaneF32 operator/(LaneF32 a, LaneF32 b) { return lane_f32_div(a, b); }
+INTERNAL LaneF32 operator+(LaneF32 a, f32 b) { return lane_f32_add(a, lane_f32(b)); }
+INTERNAL LaneF32 operator-(LaneF32 a, f32 b) { return lane_f32_sub(a, lane_f32(b)); }
+INTERNAL LaneF32 operator*(LaneF32 a, f32 b) { return lane_f32_mul(a, lane_f32(b)); }
+INTERNAL LaneF32 operator/(LaneF32 a, f32 b) { return lane_f32_div(a, lane_f32(b)); }
+INTERNAL LaneF32 operator+(f32 a, LaneF32 b) { return lane_f32_add(lane_f32(a), b); }
+INTERNAL LaneF32 operator-(f32 a, LaneF32 b) { return lane_f32_sub(lane_f32(a), b); }
+INTERNAL LaneF32 operator*(f32 a, LaneF32 b) { return lane_f32_mul(lane_f32(a), b); }
+INTERNAL LaneF32 operator/(f32 a, LaneF32 b) { return lane_f32_div(lane_f32(a), b); }
+INTERNAL LaneF32 operator-(LaneF32 a) { return lane_f32_sub(lane_f32(0.0f), a); }
+INTERNAL LaneF32 & operator+=(LaneF32 &a, LaneF32 b) { a = a + b; return a; }
+INTERNAL LaneF32 & operator-=(LaneF32 &a, LaneF32 b) { a = a - b; return a; }
+INTERNAL LaneF32 & operator*=(LaneF32 &a, LaneF32 b) { a = a * b; return a; }
+INTERNAL LaneF32 & operator/=(LaneF32 &a, LaneF32 b) { a = a / b; return a; }
+
+INTERNAL LaneU32 operator<(LaneF32 a, LaneF32 b) { return lane_f32_lt(a, b); }
+INTERNAL LaneU32 operator<=(LaneF32 a, LaneF32 b) { return lane_f32_le(a, b); }
+INTERNAL LaneU32 operator>(LaneF32 a, LaneF32 b) { return lane_f32_gt(a, b); }
+INTERNAL LaneU32 operator>=(LaneF32 a, LaneF32 b) { return lane_f32_ge(a, b); }
+INTERNAL LaneU32 operator==(LaneF32 a, LaneF32 b) { return lane_f32_eq(a, b); }
+INTERNAL LaneU32 operator!=(LaneF32 a, LaneF32 b) { return lane_f32_ne(a, b); }
+INTERNAL LaneU32 operator<(LaneF32 a, f32 b) { return lane_f32_lt(a, lane_f32(b)); }
+INTERNAL LaneU32 operator<=(LaneF32 a, f32 b) { return lane_f32_le(a, lane_f32(b)); }
+INTERNAL LaneU32 operator>(LaneF32 a, f32 b) { return lane_f32_gt(a, lane_f32(b)); }
+INTERNAL LaneU32 operator>=(LaneF32 a, f32 b) { return lane_f32_ge(a, lane_f32(b)); }
+
+INTERNAL LaneU32 operator+(LaneU32 a, LaneU32 b) { return lane_u32_add(a, b); }
+INTERNAL LaneU32 operator-(LaneU32 a, LaneU32 b) { return lane_u32_sub(a, b); }
+INTERNAL LaneU32 operator*(LaneU32 a, LaneU32 b) { return lane_u32_mul(a, b); }
+INTERNAL LaneU32 operator&(LaneU32 a, LaneU32 b) { return lane_u32_and(a, b); }
+INTERNAL LaneU32 operator|(LaneU32 a, LaneU32 b) { return lane_u32_or(a, b); }
+INTERNAL LaneU32 operator^(LaneU32 a, LaneU32 b) { return lane_u32_xor(a, b); }
+INTERNAL LaneU32 operator~(LaneU32 a) { return lane_u32_not(a); }
+INTERNAL LaneU32 operator<<(LaneU32 a, u32 shift) { return lane_u32_shl(a, shift); }
+INTERNAL LaneU32 operator>>(LaneU32 a, u32 shift) { return lane_u32_shr(a, shift); }
+INTERNAL LaneU32 operator==(LaneU32 a, LaneU32 b) { return lane_u32_eq(a, b); }
+INTERNAL LaneU32 operator!=(LaneU32 a, LaneU32 b) { return lane_u32_ne(a, b); }
+INTERNAL LaneU32 operator>(LaneU32 a, LaneU32 b) { return lane_u32_gt(a, b); }
+INTERNAL LaneU32 operator==(LaneU32 a, u32 b) { return lane_u32_eq(a, lane_u32(b)); }
+INTERNAL LaneU32 operator!=(LaneU32 a, u32 b) { return lane_u32_ne(a, lane_u32(b)); }
+// IMPORTANT(Ryan): Masks only. Both sides are always evaluated, i.e. no short-circuit
+INTERNAL LaneU32 operator&&(LaneU32 a, LaneU32 b) { return lane_u32_and(a, b); }
+INTERNAL LaneU32 operator||(LaneU32 a, LaneU32 b) { return lane_u32_or(a, b); }
+INTERNAL LaneU32 & operator+=(LaneU32 &a, LaneU32 b) { a = a + b; return a; }
+INTERNAL LaneU32 & operator-=(LaneU32 &a, LaneU32 b) { a = a - b; return a; }
+INTERNAL LaneU32 & operator&=(LaneU32 &a, LaneU32 b) { a = a & b; return a; }
+INTERNAL LaneU32 & operator|=(LaneU32 &a, LaneU32 b) { a = a | b; return a; }
+INTERNAL LaneU32 & operator^=(LaneU32 &a, LaneU32 b) { a = a ^ b; return a; }
+
+// NOTE(Ryan): sin(2π·turns) for turns in [0, 1], e.g. a random angle; no per-lane sinf() calls.
+// Folded onto [-π/2, π/2], where the degree 9 Taylor series is within 4e-6
+INTERNAL LaneF32
+lane_f32_sin_turns(LaneF32 turns)
+{
+  // sin(2π·x) = -sin(2π·(x - 0.5)), with x - 0.5 in [-0.5, 0.5]
+  LaneF32 x = turns - 0.5f;
+  // sin(π - a) = sin(a)
+  x = lane_f32_select(x > 0.25f, x, 0.5f - x);
+  x = lane_f32_select(x < -0.25f, x, -0.5f - x);
+
+  LaneF32 a = (2.0f * F32_PI) * x;
+  LaneF32 a2 = a * a;
+  LaneF32 sin_a = a * (1.0f + a2 * (-1.0f / 6.0f + a2 * (1.0f / 120.0f + a2 * (-1.0f / 5040.0f + a2 * (1.0f / 362880.0f)))));
+  LaneF32 result = -sin_a;
 
   return result;
 }
 
-// state is seed
-INTERNAL LaneU32
-xor_shift_u32(u32 *random_series)
+INTERNAL LaneF32
+lane_f32_cos_turns(LaneF32 turns)
 {
-	/* Algorithm "xor" from p. 4 of Marsaglia, "Xorshift RNGs" */
-	LaneU32 x = *random_series;
-	x ^= x << 13;
-	x ^= x >> 17;
-	x ^= x << 5;
-  *random_series = x;
-
-	return x;
-}
+  LaneF32 quarter_turn_ahead = turns + 0.25f;
+  quarter_turn_ahead = lane_f32_select(quarter_turn_ahead > 1.0f, quarter_turn_ahead, quarter_turn_ahead - 1.0f);
 
-INTERNAL LaneR32
-LaneR32_from_u32(LaneU32 a)
-{
-  LaneR32 result = (LaneR32)a;
+  LaneF32 result = lane_f32_sin_turns(quarter_turn_ahead);
 
   return result;
 }
 
-INTERNAL LaneR32
-random_unilateral(u32 *random_series)
+typedef struct LaneV3 LaneV3;
+struct LaneV3
 {
-  LaneR32 result = 0.0f;
+  LaneF32 x;
+  LaneF32 y;
+  LaneF32 z;
+};
 
-  // rand() implements mutexes so each thread has to run serially, use rand_r()
-  
-  result = LaneR32_from_u32(xor_shift_u32(random_series)) / LaneR32_from_u32(U32_MAX);
+INTERNAL LaneV3 lane_v3(LaneF32 x, LaneF32 y, LaneF32 z) { return {x, y, z}; }
+INTERNAL LaneV3 lane_v3(f32 x, f32 y, f32 z) { return {lane_f32(x), lane_f32(y), lane_f32(z)}; }
+INTERNAL LaneV3 lane_v3_from_vec3_f32(Vec3F32 replicate) { return lane_v3(replicate.x, replicate.y, replicate.z); }
+INTERNAL LaneV3 lane_v3_add(LaneV3 a, LaneV3 b) { return {a.x + b.x, a.y + b.y, a.z + b.z}; }
+INTERNAL LaneV3 lane_v3_sub(LaneV3 a, LaneV3 b) { return {a.x - b.x, a.y - b.y, a.z - b.z}; }
+INTERNAL LaneV3 lane_v3_mul(LaneV3 a, LaneF32 scale) { return {a.x * scale, a.y * scale, a.z * scale}; }
+INTERNAL LaneV3 lane_v3_hadamard(LaneV3 a, LaneV3 b) { return {a.x * b.x, a.y * b.y, a.z * b.z}; }
+INTERNAL LaneF32 lane_v3_dot(LaneV3 a, LaneV3 b) { return (a.x * b.x + a.y * b.y + a.z * b.z); }
+INTERNAL LaneF32 lane_v3_lengthsq(LaneV3 v) { return lane_v3_dot(v, v); }
+INTERNAL LaneV3 lane_v3_cross(LaneV3 a, LaneV3 b) { return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x}; }
+INTERNAL LaneV3 lane_v3_lerp(LaneV3 a, LaneV3 b, LaneF32 t) { return {lane_f32_lerp(a.x, b.x, t), lane_f32_lerp(a.y, b.y, t), lane_f32_lerp(a.z, b.z, t)}; }
+
+// NOTE(Ryan): Normalise or zero, so degenerate lanes don't produce NaNs that spread through later maths
+INTERNAL LaneV3
+lane_v3_noz(LaneV3 v)
+{
+  LaneV3 result = lane_v3(0.0f, 0.0f, 0.0f);
+
+  LaneF32 length_sq = lane_v3_lengthsq(v);
+  LaneU32 valid_mask = (length_sq > SQUARE(0.0001f));
+  // NOTE(Ryan): Invalid lanes divide by 1 rather than 0 before being masked off
+  LaneF32 inv_length = 1.0f / lane_f32_sqrt(lane_f32_select(valid_mask, lane_f32(1.0f), length_sq));
+  conditional_assign(&result.x, valid_mask, v.x * inv_length);
+  conditional_assign(&result.y, valid_mask, v.y * inv_length);
+  conditional_assign(&result.z, valid_mask, v.z * inv_length);
 
   return result;
 }
 
-INTERNAL LaneR32
-random_bilateral(u32 *random_series)
-{
-  LaneR32 result = 0.0f;
+INTERNAL LaneV3 operator+(LaneV3 a, LaneV3 b) { return lane_v3_add(a, b); }
+INTERNAL LaneV3 operator-(LaneV3 a, LaneV3 b) { return lane_v3_sub(a, b); }
+INTERNAL LaneV3 operator-(LaneV3 a) { return {-a.x, -a.y, -a.z}; }
+INTERNAL LaneV3 operator*(LaneF32 s, LaneV3 a) { return lane_v3_mul(a, s); }
+INTERNAL LaneV3 operator*(LaneV3 a, LaneF32 s) { return lane_v3_mul(a, s); }
+INTERNAL LaneV3 operator*(f32 s, LaneV3 a) { return lane_v3_mul(a, lane_f32(s)); }
+INTERNAL LaneV3 operator*(LaneV3 a, f32 s) { return lane_v3_mul(a, lane_f32(s)); }
+INTERNAL LaneV3 & operator+=(LaneV3 &a, LaneV3 b) { a = a + b; return a; }
+INTERNAL LaneV3 & operator-=(LaneV3 &a, LaneV3 b) { a = a - b; return a; }
 
-  result = -1.0f + 2.0f * random_unilateral(random_series);
-
-  return result;
-}
-
-INTERNAL LaneR32
-random_bilateral_lane(u32 *random_series)
+// NOTE(Ryan): Any 2 unit vectors perpendicular to normal and each other.
+// Duff et al. "Building an Orthonormal Basis, Revisited", branchless on normal's sign
+INTERNAL void
+lane_v3_basis(LaneV3 normal, LaneV3 *tangent, LaneV3 *bitangent)
 {
-  LaneR32 result = _mm_set_epi32(random_bilateral(random_series),
-                                  random_bilateral(random_series),
-                                  random_bilateral(random_series),
-                                  random_bilateral(random_series));
+  LaneF32 sign = lane_f32_select(normal.z < 0.0f, lane_f32(1.0f), lane_f32(-1.0f));
+  LaneF32 a = -1.0f / (sign + normal.z);
+  LaneF32 b = normal.x * normal.y * a;
 
-  return result;
+  *tangent = lane_v3(1.0f + sign * normal.x * normal.x * a, sign * b, -sign * normal.x);
+  *bitangent = lane_v3(b, sign + normal.y * normal.y * a, -normal.y);
 }
 
-// TODO(Ryan): Do newer SIMD implement a not?
-INTERNAL LaneU32
-operator!=(LaneU32 a, LaneU32 b)
+// NOTE(Ryan): Direction at polar angle acos(cos_theta) from axis, at azimuth of turns around it
+INTERNAL LaneV3
+lane_v3_from_axis(LaneV3 axis, LaneF32 cos_theta, LaneF32 turns)
 {
-  LaneU32 result = {};
+  LaneV3 tangent, bitangent;
+  lane_v3_basis(axis, &tangent, &bitangent);
 
-  result.value = _mm_xor_si128(_mm_cmpeq_si128(a.value, b.value), _mm_set1_epi32(0xFFFFFFFF));
+  LaneF32 sin_theta = lane_f32_sqrt(lane_f32_max(1.0f - cos_theta * cos_theta, lane_f32(0.0f)));
+  LaneV3 result = (sin_theta * lane_f32_cos_turns(turns)) * tangent + (sin_theta * lane_f32_sin_turns(turns)) * bitangent + 
+                  cos_theta * axis;
 
   return result;
 }
 
 INTERNAL void
-conditional_assign(LaneU32 *dest, LaneU32 mask, LaneU32 source)
-{
-  mask = (mask ? 0xffffffff : 0);
-
-  *dest = (~mask & *dest) | (mask & source);
-}
-
-INTERNAL void
-conditional_assign(LaneR32 *dest, LaneU32 mask, LaneR32 source)
-{
-  // only required for single lane
-  mask = (mask ? 0xffffffff : 0);
-
-  u32 result = (~mask & *(u32 *)dest) | (mask & *(u32 *)&source);
-  *dest = *(r32 *)&result;
-}
-
-INTERNAL void
-conditional_assign(lane_v3 *dest, LaneU32 mask, lane_v3 source)
+conditional_assign(LaneV3 *dest, LaneU32 mask, LaneV3 source)
 {
   conditional_assign(&dest->x, mask, source.x);
   conditional_assign(&dest->y, mask, source.y);
   conditional_assign(&dest->z, mask, source.z);
 }
 
-INTERNAL LaneR32
-max(LaneR32 a, LaneR32 b)
-{
-  return (a > b ? a : b);
-}
-
-INTERNAL b32
-mask_is_zeroed(LaneU32 lane_mask)
+INTERNAL Vec3F32
+lane_v3_extract(LaneV3 a, u32 lane_index)
 {
-  return (lane_mask == 0);
+  return vec3_f32(lane_f32_extract(a.x, lane_index), lane_f32_extract(a.y, lane_index), lane_f32_extract(a.z, lane_index));
 }
 
-INTERNAL r32
-horizontal_add(LaneR32 a)
+INTERNAL Vec3F32
+horizontal_add(LaneV3 a)
 {
-  // IMPORTANT(Ryan): We are only doing this in one dimension for now
-  return a;
+  return vec3_f32(horizontal_add(a.x), horizontal_add(a.y), horizontal_add(a.z));
 }
 
-INTERNAL V3
-horizontal_add(lane_v3 a)
+INTERNAL LaneV3
+lane_v3_gather(u8 *first, memory_index stride, LaneU32 indices)
 {
-  V3 result = {};
+  LaneV3 result = ZERO_STRUCT;
 
-  result.x = horizontal_add(a.x);
-  result.y = horizontal_add(a.y);
-  result.z = horizontal_add(a.z);
+  result.x = lane_f32_gather(first + OFFSET_OF_MEMBER(Vec3F32, x), stride, indices);
+  result.y = lane_f32_gather(first + OFFSET_OF_MEMBER(Vec3F32, y), stride, indices);
+  result.z = lane_f32_gather(first + OFFSET_OF_MEMBER(Vec3F32, z), stride, indices);
 
   return result;
 }
 
-INTERNAL LaneR32
-random_bilateral_lane(u32 *random_series)
+// NOTE(Ryan): Counter-based, so a random number is a pure function of (key, counter) rather than
+// the next step of a serial chain. Key identifies the sample (e.g. seed, pixel, sample index) per lane and
+// counter the dimension (e.g. jitter x, bounce n direction), so any sample can be regenerated independently 
+// of which thread drew what before it
+typedef struct LaneRandom LaneRandom;
+struct LaneRandom
 {
-  LaneR32 result = random_bilateral(random_series);
-
-  return result;
-}
-
-#else
-#error Lane width must bet set to 1!
-#endif
+  LaneU32 key;
+  u32 counter;
+};
 
-struct lane_v3
+// NOTE(Ryan): Wellons' "lowbias32" integer hash. Only fixed shifts and 32 bit multiplies, 
+// so full lane width on every ISA (SSE4 has no per-lane variable shift, ruling out PCG's output permutation)
+INTERNAL LaneU32
+lane_random_hash(LaneU32 x)
 {
-  LaneR32 x;
-  LaneR32 y;
-  LaneR32 z;
-};
+  x ^= x >> 16;
+  x = x * lane_u32(0x7FEB352D);
+  x ^= x >> 15;
+  x = x * lane_u32(0x846CA68B);
+  x ^= x >> 16;
 
-#if (LANE_WIDTH != 1)
+  return x;
+}
 
-INTERNAL lane_v3
-lane_v3_from_v3(V3 replicate)
+// NOTE(Ryan): Hashed in stages so that e.g. pixel n sample m+1 and pixel n+1 sample m don't share a key.
+// Stream key is per pixel, so compute once and reuse for each of its samples
+INTERNAL LaneU32
+lane_random_stream_key(u32 seed, u32 stream)
 {
-  lane_v3 result = {};
-
-  result.x = LaneR32_from_r32(replicate.x);
-  result.y = LaneR32_from_r32(replicate.y);
-  result.z = LaneR32_from_r32(replicate.z);
+  LaneU32 result = lane_random_hash(lane_u32(seed) ^ lane_random_hash(lane_u32(stream)));
 
   return result;
 }
 
-INTERNAL LaneU32 &
-operator-=(LaneU32 &a, LaneU32 b)
+INTERNAL LaneRandom
+lane_random_seed(LaneU32 stream_key, LaneU32 sample_index)
 {
-  a = a - b;
+  LaneRandom result = ZERO_STRUCT;
 
-  return a;
+  result.key = lane_random_hash(stream_key + sample_index);
+
+  return result;
 }
 
-INTERNAL LaneU32 &
-operator^=(LaneU32 &a, LaneU32 b)
+INTERNAL LaneU32
+lane_random_next_u32(LaneRandom *random)
 {
-  a.value = a ^ b;
+  // NOTE(Ryan): Weyl step spreads consecutive counters across all 32 bits before hashing
+  LaneU32 result = lane_random_hash(random->key ^ lane_u32(random->counter * 0x9E3779B9));
+  random->counter += 1;
 
-  return a;
+  return result;
 }
 
-INTERNAL void
-conditional_assign(LaneU32 *dest, LaneU32 mask, LaneU32 source)
+// NOTE(Ryan): [0, 1). Top 24 bits, as that is all a f32 mantissa holds and fits signed conversion
+INTERNAL LaneF32
+lane_random_unilateral(LaneRandom *random)
 {
-  // IMPORTANT(Ryan): This works as masks obtained from simd comparison will be all 1s or all 0s
-  *dest = and_not(mask, *dest) | (mask & source);
+  LaneF32 result = lane_f32_from_u32(lane_random_next_u32(random) >> 8) * (1.0f / 16777216.0f);
+
+  return result;
 }
 
-INTERNAL LaneR32
-clamp01(LaneR32 a)
+// NOTE(Ryan): [-1, 1)
+INTERNAL LaneF32
+lane_random_bilateral(LaneRandom *random)
 {
-  LaneR32 result = {};
-
-  result.value = LANE_R32_MIN(LANE_R32_MAX(a.value, LaneR32_from_r32(0.0f)), 1.0f);
+  LaneF32 result = -1.0f + 2.0f * lane_random_unilateral(random);
 
   return result;
 }
-
-#endif
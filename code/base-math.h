@@ -154,6 +154,27 @@ f32_map_to_range(f32 start, f32 a, f32 end)
   return result;
 }
 
+// NOTE(Ryan): Nearest rank, so always an actual sample. Sorts in place
+INTERNAL u64
+u64_percentile(u64 *values, u32 count, u32 percentile)
+{
+  for (u32 i = 1; i < count; i += 1)
+  {
+    u64 value = values[i];
+    u32 j = i;
+    for (; j > 0 && values[j - 1] > value; j -= 1)
+    {
+      values[j] = values[j - 1];
+    }
+    values[j] = value;
+  }
+
+  u32 rank = (percentile * count + 99) / 100;
+  u64 result = values[CLAMP(1, rank, count) - 1];
+
+  return result;
+}
+
 
 
 // NOTE(Ryan): To allow for anonymous structs
@@ -135,6 +135,20 @@ linux_get_ms(void)
   return result;
 }
 
+// NOTE(Ryan): Monotonic clock for all host timing, down to work well under a millisecond, e.g. a single system's update
+INTERNAL u64
+linux_get_ns(void)
+{
+  u64 result = 0;
+
+  struct timespec time_spec = {0};
+  clock_gettime(CLOCK_MONOTONIC_RAW, &time_spec);
+
+  result = (u64)time_spec.tv_sec * 1000000000ull + (u64)time_spec.tv_nsec;
+
+  return result;
+}
+
 INTERNAL u32
 linux_get_seed_u32(void)
 {
@@ -166,3 +180,235 @@ linux_was_launched_by_gdb(void)
   return result;
 }
 
+
+typedef struct LinuxCacheInfo LinuxCacheInfo;
+struct LinuxCacheInfo
+{
+  // NOTE(Ryan): Bytes; 0 if not reported (e.g. some VMs and containers hide sysfs cache topology)
+  u32 line_size;
+  u32 l1d_size;
+  u32 l2_size;
+  u32 l3_size;
+};
+
+// NOTE(Ryan): Sizes as seen by cpu0, assumed same for every core. 
+// Not cpuid, as leaf layout differs between vendors (AMD 0x8000001D vs. Intel 4)
+INTERNAL LinuxCacheInfo
+linux_get_cache_info(void)
+{
+  LinuxCacheInfo result = ZERO_STRUCT;
+
+  for (u32 index_i = 0; index_i < 16; index_i += 1)
+  {
+    char path[128] = ZERO_STRUCT;
+
+    u32 level = 0;
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%u/level", index_i);
+    FILE *level_file = fopen(path, "r");
+    if (level_file == NULL)
+    {
+      break;
+    }
+    fscanf(level_file, "%u", &level);
+    fclose(level_file);
+
+    // NOTE(Ryan): "Data", "Instruction" or "Unified"
+    char type[32] = ZERO_STRUCT;
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%u/type", index_i);
+    FILE *type_file = fopen(path, "r");
+    if (type_file != NULL)
+    {
+      fscanf(type_file, "%31s", type);
+      fclose(type_file);
+    }
+    if (strcmp(type, "Instruction") == 0)
+    {
+      continue;
+    }
+
+    // NOTE(Ryan): e.g. "48K"
+    u32 size = 0;
+    char size_unit = 'K';
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%u/size", index_i);
+    FILE *size_file = fopen(path, "r");
+    if (size_file != NULL)
+    {
+      fscanf(size_file, "%u%c", &size, &size_unit);
+      fclose(size_file);
+    }
+    if (size_unit == 'K')
+    {
+      size *= 1024;
+    }
+    else if (size_unit == 'M')
+    {
+      size *= 1024 * 1024;
+    }
+
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%u/coherency_line_size", index_i);
+    FILE *line_size_file = fopen(path, "r");
+    if (line_size_file != NULL)
+    {
+      fscanf(line_size_file, "%u", &result.line_size);
+      fclose(line_size_file);
+    }
+
+    if (level == 1)
+    {
+      result.l1d_size = size;
+    }
+    else if (level == 2)
+    {
+      result.l2_size = size;
+    }
+    else if (level == 3)
+    {
+      result.l3_size = size;
+    }
+  }
+
+  return result;
+}
+
+#include <sched.h>
+#include <sys/sysinfo.h>
+#include <dirent.h>
+
+// NOTE(Ryan): cpu_set_t can't describe more than this anyway
+#define LINUX_MAX_CPUS CPU_SETSIZE
+
+typedef struct LinuxCPUTopology LinuxCPUTopology;
+struct LinuxCPUTopology
+{
+  // NOTE(Ryan): Only CPUs in this process's affinity mask (e.g. taskset, cgroup cpusets), not all online
+  u32 cpu_count;
+  u32 physical_core_count;
+  u32 package_count;
+  u32 numa_node_count;
+  // NOTE(Ryan): Logical CPU ids in the order workers should take them. 
+  // First physical_core_count are one per physical core, alternating NUMA nodes; after that, their SMT siblings.
+  // So taking the first n gives no shared cores until n > physical_core_count
+  u32 cpu_ids[LINUX_MAX_CPUS];
+};
+
+INTERNAL s32
+linux_read_sysfs_s32(const char *path, s32 default_value)
+{
+  s32 result = default_value;
+
+  FILE *file = fopen(path, "r");
+  if (file != NULL)
+  {
+    if (fscanf(file, "%d", &result) != 1)
+    {
+      result = default_value;
+    }
+    fclose(file);
+  }
+
+  return result;
+}
+
+// NOTE(Ryan): Missing sysfs entries (some containers) degrade to every CPU being its own core on node 0
+INTERNAL LinuxCPUTopology
+linux_get_cpu_topology(void)
+{
+  LinuxCPUTopology result = ZERO_STRUCT;
+
+  cpu_set_t affinity;
+  CPU_ZERO(&affinity);
+  if (sched_getaffinity(0, sizeof(affinity), &affinity) != 0)
+  {
+    WARN("Failed to read CPU affinity mask. Assuming every online CPU.", strerror(errno));
+    for (u32 cpu_id = 0; cpu_id < (u32)get_nprocs() && cpu_id < LINUX_MAX_CPUS; cpu_id += 1)
+    {
+      CPU_SET(cpu_id, &affinity);
+    }
+  }
+
+  if ((u32)get_nprocs_conf() > LINUX_MAX_CPUS)
+  {
+    WARN("CPUs beyond CPU_SETSIZE are not used.", "cpu_set_t is too small for this machine's CPU ids");
+  }
+
+  s32 packages[LINUX_MAX_CPUS] = ZERO_STRUCT;
+  s32 cores[LINUX_MAX_CPUS] = ZERO_STRUCT;
+  u32 nodes[LINUX_MAX_CPUS] = ZERO_STRUCT;
+  u32 smt_ranks[LINUX_MAX_CPUS] = ZERO_STRUCT;
+  u32 node_ranks[LINUX_MAX_CPUS] = ZERO_STRUCT;
+  u32 sort_keys[LINUX_MAX_CPUS] = ZERO_STRUCT;
+
+  for (u32 cpu_id = 0; cpu_id < LINUX_MAX_CPUS; cpu_id += 1)
+  {
+    if (!CPU_ISSET(cpu_id, &affinity))
+    {
+      continue;
+    }
+
+    u32 i = result.cpu_count++;
+    result.cpu_ids[i] = cpu_id;
+
+    char path[128] = ZERO_STRUCT;
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/topology/physical_package_id", cpu_id);
+    packages[i] = linux_read_sysfs_s32(path, 0);
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/topology/core_id", cpu_id);
+    cores[i] = linux_read_sysfs_s32(path, (s32)cpu_id);
+
+    // NOTE(Ryan): Node is only exposed as a nodeN link in the cpu's directory
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u", cpu_id);
+    DIR *cpu_dir = opendir(path);
+    if (cpu_dir != NULL)
+    {
+      struct dirent *entry = NULL;
+      while ((entry = readdir(cpu_dir)) != NULL)
+      {
+        u32 node = 0;
+        if (sscanf(entry->d_name, "node%u", &node) == 1)
+        {
+          nodes[i] = node;
+          break;
+        }
+      }
+      closedir(cpu_dir);
+    }
+
+    // NOTE(Ryan): 0 for first logical CPU seen on a physical core, 1 for its first SMT sibling, ...
+    b32 is_new_package = true;
+    b32 is_new_node = true;
+    for (u32 j = 0; j < i; j += 1)
+    {
+      smt_ranks[i] += (packages[j] == packages[i] && cores[j] == cores[i]);
+      is_new_package &= (packages[j] != packages[i]);
+      is_new_node &= (nodes[j] != nodes[i]);
+    }
+    result.physical_core_count += (smt_ranks[i] == 0);
+    result.package_count += is_new_package;
+    result.numa_node_count += is_new_node;
+
+    for (u32 j = 0; j < i; j += 1)
+    {
+      node_ranks[i] += (nodes[j] == nodes[i] && smt_ranks[j] == smt_ranks[i]);
+    }
+  }
+
+  // NOTE(Ryan): Order by SMT rank, then position within node, then node, so NUMA nodes alternate
+  for (u32 i = 0; i < result.cpu_count; i += 1)
+  {
+    sort_keys[i] = (smt_ranks[i] << 24) | (node_ranks[i] << 12) | (nodes[i] & 0xFFF);
+  }
+  for (u32 i = 1; i < result.cpu_count; i += 1)
+  {
+    u32 key = sort_keys[i];
+    u32 cpu_id = result.cpu_ids[i];
+    u32 j = i;
+    for (; j > 0 && sort_keys[j - 1] > key; j -= 1)
+    {
+      sort_keys[j] = sort_keys[j - 1];
+      result.cpu_ids[j] = result.cpu_ids[j - 1];
+    }
+    sort_keys[j] = key;
+    result.cpu_ids[j] = cpu_id;
+  }
+
+  return result;
+}
@@ -0,0 +1,253 @@
+// SPDX-License-Identifier: zlib-acknowledgement
+#pragma once
+
+// IMPORTANT(Ryan): Fixed capacity, power of 2, elements copied in and out by value.
+// Full/empty is reported rather than waited on, so caller decides whether to spin, sleep or drop.
+//
+// MPMCQueue: any number of producers and consumers (Vyukov bounded queue).
+// Each cell has a sequence number that tells a producer/consumer whether the cell is ready for it,
+// so contention is only a CAS on the shared position, never a lock.
+//
+// SPSCRing: exactly one producer and one consumer thread, e.g. audio, logging.
+// Wait-free; each side only writes its own index and keeps a cached copy of the other side's,
+// so cross-core traffic only happens when the cached copy says ring looks full/empty.
+
+typedef struct MPMCQueue MPMCQueue;
+struct MPMCQueue
+{
+  u8 *cells;
+  memory_index cell_stride;
+  memory_index element_size;
+  u64 mask;
+
+  CACHE_ALIGNED u64 enqueue_pos;
+  CACHE_ALIGNED u64 dequeue_pos;
+};
+
+// NOTE(Ryan): Cell is a u64 sequence followed by element
+#define MPMC_CELL_SEQUENCE(queue, pos) ((u64 *)((queue)->cells + ((pos) & (queue)->mask) * (queue)->cell_stride))
+#define MPMC_CELL_ELEMENT(queue, pos) ((u8 *)MPMC_CELL_SEQUENCE(queue, pos) + sizeof(u64))
+
+INTERNAL MPMCQueue *
+mpmc_queue_create(MemArena *arena, memory_index element_size, u64 capacity)
+{
+  ASSERT(IS_POW2(capacity));
+
+  MPMCQueue *result = (MPMCQueue *)mem_arena_push_aligned(arena, sizeof(MPMCQueue), CACHE_LINE_SIZE);
+  MEMORY_ZERO_STRUCT(result);
+
+  result->element_size = element_size;
+  result->cell_stride = ALIGN_POW2_UP(sizeof(u64) + element_size, sizeof(u64));
+  result->mask = capacity - 1;
+  result->cells = (u8 *)mem_arena_push_aligned(arena, result->cell_stride * capacity, CACHE_LINE_SIZE);
+
+  for (u64 cell_i = 0; cell_i < capacity; cell_i += 1)
+  {
+    *MPMC_CELL_SEQUENCE(result, cell_i) = cell_i;
+  }
+
+  return result;
+}
+
+// NOTE(Ryan): Returns false if full
+INTERNAL b32
+mpmc_queue_push(MPMCQueue *queue, void *element)
+{
+  b32 result = false;
+
+  u64 pos = ATOMIC_LOAD_RELAXED(&queue->enqueue_pos);
+  while (true)
+  {
+    u64 sequence = ATOMIC_LOAD_ACQUIRE(MPMC_CELL_SEQUENCE(queue, pos));
+    s64 diff = (s64)sequence - (s64)pos;
+    if (diff == 0)
+    {
+      // NOTE(Ryan): Cell free for this lap, so claim it. On failure pos is reloaded
+      if (ATOMIC_CAS_WEAK_ACQ_REL(&queue->enqueue_pos, &pos, pos + 1))
+      {
+        result = true;
+        break;
+      }
+    }
+    else if (diff < 0)
+    {
+      // NOTE(Ryan): Cell still holds element from previous lap
+      break;
+    }
+    else
+    {
+      // NOTE(Ryan): Another producer claimed it
+      pos = ATOMIC_LOAD_RELAXED(&queue->enqueue_pos);
+    }
+  }
+
+  if (result)
+  {
+    MEMORY_COPY(MPMC_CELL_ELEMENT(queue, pos), element, queue->element_size);
+    // IMPORTANT(Ryan): Publishes element to consumer waiting on pos + 1
+    ATOMIC_STORE_RELEASE(MPMC_CELL_SEQUENCE(queue, pos), pos + 1);
+  }
+
+  return result;
+}
+
+// NOTE(Ryan): Returns false if empty
+INTERNAL b32
+mpmc_queue_pop(MPMCQueue *queue, void *element)
+{
+  b32 result = false;
+
+  u64 pos = ATOMIC_LOAD_RELAXED(&queue->dequeue_pos);
+  while (true)
+  {
+    u64 sequence = ATOMIC_LOAD_ACQUIRE(MPMC_CELL_SEQUENCE(queue, pos));
+    s64 diff = (s64)sequence - (s64)(pos + 1);
+    if (diff == 0)
+    {
+      if (ATOMIC_CAS_WEAK_ACQ_REL(&queue->dequeue_pos, &pos, pos + 1))
+      {
+        result = true;
+        break;
+      }
+    }
+    else if (diff < 0)
+    {
+      break;
+    }
+    else
+    {
+      pos = ATOMIC_LOAD_RELAXED(&queue->dequeue_pos);
+    }
+  }
+
+  if (result)
+  {
+    MEMORY_COPY(element, MPMC_CELL_ELEMENT(queue, pos), queue->element_size);
+    // NOTE(Ryan): Hands cell to producer of next lap
+    ATOMIC_STORE_RELEASE(MPMC_CELL_SEQUENCE(queue, pos), pos + queue->mask + 1);
+  }
+
+  return result;
+}
+
+// NOTE(Ryan): Approximate if other threads are active
+INTERNAL b32
+mpmc_queue_is_empty(MPMCQueue *queue)
+{
+  return (ATOMIC_LOAD_RELAXED(&queue->dequeue_pos) >= ATOMIC_LOAD_RELAXED(&queue->enqueue_pos));
+}
+
+typedef struct SPSCRing SPSCRing;
+struct SPSCRing
+{
+  u8 *elements;
+  memory_index element_size;
+  u64 capacity;
+
+  // NOTE(Ryan): Producer's line
+  CACHE_ALIGNED u64 write_index;
+  u64 cached_read_index;
+
+  // NOTE(Ryan): Consumer's line
+  CACHE_ALIGNED u64 read_index;
+  u64 cached_write_index;
+};
+
+INTERNAL SPSCRing *
+spsc_ring_create(MemArena *arena, memory_index element_size, u64 capacity)
+{
+  ASSERT(IS_POW2(capacity));
+
+  SPSCRing *result = (SPSCRing *)mem_arena_push_aligned(arena, sizeof(SPSCRing), CACHE_LINE_SIZE);
+  MEMORY_ZERO_STRUCT(result);
+
+  result->element_size = element_size;
+  result->capacity = capacity;
+  result->elements = (u8 *)mem_arena_push_aligned(arena, element_size * capacity, CACHE_LINE_SIZE);
+
+  return result;
+}
+
+// NOTE(Ryan): Indices increase monotonically, so wrap is only applied when copying
+INTERNAL void
+spsc_ring_copy_in(SPSCRing *ring, u64 index, u8 *src, u64 count)
+{
+  u64 start = index & (ring->capacity - 1);
+  u64 first_count = MIN(count, ring->capacity - start);
+  MEMORY_COPY(ring->elements + start * ring->element_size, src, first_count * ring->element_size);
+  MEMORY_COPY(ring->elements, src + first_count * ring->element_size, (count - first_count) * ring->element_size);
+}
+
+INTERNAL void
+spsc_ring_copy_out(SPSCRing *ring, u64 index, u8 *dst, u64 count)
+{
+  u64 start = index & (ring->capacity - 1);
+  u64 first_count = MIN(count, ring->capacity - start);
+  MEMORY_COPY(dst, ring->elements + start * ring->element_size, first_count * ring->element_size);
+  MEMORY_COPY(dst + first_count * ring->element_size, ring->elements, (count - first_count) * ring->element_size);
+}
+
+// NOTE(Ryan): Producer only. Returns number of elements pushed, which is less than count if ring fills
+INTERNAL u64
+spsc_ring_push_batch(SPSCRing *ring, void *elements, u64 count)
+{
+  u64 write_index = ring->write_index;
+
+  u64 free_count = ring->capacity - (write_index - ring->cached_read_index);
+  if (free_count < count)
+  {
+    ring->cached_read_index = ATOMIC_LOAD_ACQUIRE(&ring->read_index);
+    free_count = ring->capacity - (write_index - ring->cached_read_index);
+  }
+
+  u64 result = MIN(count, free_count);
+  if (result > 0)
+  {
+    spsc_ring_copy_in(ring, write_index, (u8 *)elements, result);
+    ATOMIC_STORE_RELEASE(&ring->write_index, write_index + result);
+  }
+
+  return result;
+}
+
+// NOTE(Ryan): Consumer only. Returns number of elements popped
+INTERNAL u64
+spsc_ring_pop_batch(SPSCRing *ring, void *elements, u64 max_count)
+{
+  u64 read_index = ring->read_index;
+
+  u64 available_count = ring->cached_write_index - read_index;
+  if (available_count < max_count)
+  {
+    ring->cached_write_index = ATOMIC_LOAD_ACQUIRE(&ring->write_index);
+    available_count = ring->cached_write_index - read_index;
+  }
+
+  u64 result = MIN(max_count, available_count);
+  if (result > 0)
+  {
+    spsc_ring_copy_out(ring, read_index, (u8 *)elements, result);
+    ATOMIC_STORE_RELEASE(&ring->read_index, read_index + result);
+  }
+
+  return result;
+}
+
+INTERNAL b32
+spsc_ring_push(SPSCRing *ring, void *element)
+{
+  return (spsc_ring_push_batch(ring, element, 1) == 1);
+}
+
+INTERNAL b32
+spsc_ring_pop(SPSCRing *ring, void *element)
+{
+  return (spsc_ring_pop_batch(ring, element, 1) == 1);
+}
+
+// NOTE(Ryan): Producer only. Lower bound, as consumer may free more concurrently
+INTERNAL u64
+spsc_ring_free_count(SPSCRing *ring)
+{
+  return ring->capacity - (ring->write_index - ATOMIC_LOAD_ACQUIRE(&ring->read_index));
+}
@@ -183,6 +183,80 @@ s8_find_substring(String8 str, String8 substring, u64 start_pos, MATCH_FLAGS fla
   return found_idx;
 }
 
+// NOTE(Ryan): Parsing stops at first invalid character, so trailing whitespace/delimiters are fine
+INTERNAL s64
+s8_to_s64(String8 str)
+{
+  s64 result = 0;
+
+  u64 i = 0;
+  s64 sign = 1;
+  if (i < str.size && (str.str[i] == '-' || str.str[i] == '+'))
+  {
+    sign = (str.str[i] == '-') ? -1 : 1;
+    i += 1;
+  }
+
+  for (; i < str.size && isdigit(str.str[i]); i += 1)
+  {
+    result = result * 10 + (str.str[i] - '0');
+  }
+
+  return sign * result;
+}
+
+// NOTE(Ryan): Decimal with optional fraction and exponent, e.g. -1.5e-3.
+// Digits accumulated as an integer and scaled once, so not correctly rounded like strtod() in all cases
+INTERNAL f64
+s8_to_f64(String8 str)
+{
+  f64 result = 0.0;
+
+  u64 i = 0;
+  f64 sign = 1.0;
+  if (i < str.size && (str.str[i] == '-' || str.str[i] == '+'))
+  {
+    sign = (str.str[i] == '-') ? -1.0 : 1.0;
+    i += 1;
+  }
+
+  // NOTE(Ryan): Digits beyond f64 precision are ignored rather than overflow the mantissa.
+  // Dropped integer digits still count towards the exponent
+  u64 mantissa_limit = 100000000000000000ULL;
+  u64 mantissa = 0;
+  s32 exponent = 0;
+  for (; i < str.size && isdigit(str.str[i]); i += 1)
+  {
+    if (mantissa < mantissa_limit)
+    {
+      mantissa = mantissa * 10 + (u64)(str.str[i] - '0');
+    }
+    else
+    {
+      exponent += 1;
+    }
+  }
+  if (i < str.size && str.str[i] == '.')
+  {
+    for (i += 1; i < str.size && isdigit(str.str[i]); i += 1)
+    {
+      if (mantissa < mantissa_limit)
+      {
+        mantissa = mantissa * 10 + (u64)(str.str[i] - '0');
+        exponent -= 1;
+      }
+    }
+  }
+  if (i < str.size && (str.str[i] == 'e' || str.str[i] == 'E'))
+  {
+    exponent += (s32)s8_to_s64(s8_advance(str, i + 1));
+  }
+
+  result = sign * (f64)mantissa * pow(10.0, (f64)exponent);
+
+  return result;
+}
+
 INTERNAL String8
 s8_copy(MemArena *arena, String8 string)
 {
@@ -197,18 +271,22 @@ s8_copy(MemArena *arena, String8 string)
 }
 
 INTERNAL String8
-s8_fmt(MemArena *arena, char *fmt, ...)
+s8_fmt(MemArena *arena, const char *fmt, ...)
 {
   va_list args;
   va_start(args, fmt);
+  // NOTE(Ryan): Measuring consumes the list, so format from a copy
+  va_list format_args;
+  va_copy(format_args, args);
 
   String8 result = ZERO_STRUCT;
   u64 needed_bytes = (u64)stbsp_vsnprintf(NULL, 0, fmt, args) + 1;
   result.str = MEM_ARENA_PUSH_ARRAY(arena, u8, needed_bytes);
   result.size = needed_bytes - 1;
   result.str[needed_bytes - 1] = '\0';
-  stbsp_vsnprintf((char *)result.str, (int)needed_bytes, fmt, args);
+  stbsp_vsnprintf((char *)result.str, (int)needed_bytes, fmt, format_args);
 
+  va_end(format_args);
   va_end(args);
 
   return result;
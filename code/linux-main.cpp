@@ -111,6 +111,43 @@ linux_was_launched_by_gdb(void)
   return result;
 }
 
+// NOTE(Ryan): Input log, a ReplayHeader then a ReplayTick per simulation tick, appended as each tick runs.
+// Tick count is implied by file size, so a log cut short by a crash still replays up to where it stopped.
+// Each tick has the Input app_update() was given and a checksum of the state it left,
+// so a replay reports the first tick where a code change, or any nondeterminism, made the simulation diverge.
+// IMPORTANT(Ryan): Bump REPLAY_VERSION whenever Input, the tick rate or the checksum changes
+#define REPLAY_MAGIC 0x594c5052 // "RPLY"
+#define REPLAY_VERSION 1
+
+typedef struct ReplayHeader ReplayHeader;
+struct ReplayHeader
+{
+  u32 magic;
+  u32 version;
+  u32 tick_rate;
+  u32 rand_seed;
+};
+
+IGNORE_WARNING_PADDED()
+typedef struct ReplayTick ReplayTick;
+struct ReplayTick
+{
+  Input input;
+  u64 checksum;
+};
+IGNORE_WARNING_POP()
+
+INTERNAL u64
+linux_app_checksum(AppState *app_state)
+{
+  u64 result = entity_world_checksum(app_state->entity_world);
+
+  result = checksum_bytes(result, &app_state->tick, sizeof(app_state->tick));
+  result = checksum_bytes(result, &app_state->rand_seed, sizeof(app_state->rand_seed));
+
+  return result;
+}
+
 INTERNAL u32
 sdl2_get_refresh_rate(SDL_Window *window)
 {
@@ -214,7 +251,25 @@ sdl2_map_window_mouse_to_render_mouse(Renderer *renderer, Input *input)
 int
 main(int argc, char *argv[])
 {
-  IGNORED(argc); IGNORED(argv);
+  int result = 0;
+
+  // NOTE(Ryan): [-record file] writes an input log of this session.
+  // [-replay file] drives the simulation from one instead of the keyboard and mouse,
+  // then prints update timings and exits non-zero if the simulation diverged from the recording.
+  // Both at once re-records, e.g. to accept an intended change in behaviour
+  const char *record_path = NULL;
+  const char *replay_path = NULL;
+  for (i32 arg_i = 1; arg_i < argc; arg_i += 1)
+  {
+    if (strcmp(argv[arg_i], "-record") == 0 && arg_i + 1 < argc)
+    {
+      record_path = argv[++arg_i];
+    }
+    else if (strcmp(argv[arg_i], "-replay") == 0 && arg_i + 1 < argc)
+    {
+      replay_path = argv[++arg_i];
+    }
+  }
 
   global_debugger_present = linux_was_launched_by_gdb();
 
@@ -324,17 +379,63 @@ main(int argc, char *argv[])
   u64 last_app_reload_time = 0;
   String8 app_name = s8_lit("app.so");
   void *app_lib = NULL;
-  app_func app = NULL;
+  app_update_func update = NULL;
+  app_render_func render = NULL;
 
   AppState *app_state = MEM_ARENA_PUSH_STRUCT(linux_mem_arena_perm, AppState);
-  // IMPORTANT(Ryan): Required to be called again if in fullscreen mode
+  // NOTE(Ryan): Informational only, as ticks run at APP_TICK_RATE and rendering interpolates between them
   u32 refresh_rate = sdl2_get_refresh_rate(window);
-  app_state->delta = 1.0f / refresh_rate;
+  DBG("Display %uHz, simulation %uHz\n", refresh_rate, APP_TICK_RATE);
 
   app_state->rand_seed = linux_get_seed_u32();
+  app_state->effects_seed = linux_get_seed_u32();
+
+  ReplayTick *replay_ticks = NULL;
+  u64 replay_tick_count = 0;
+  u64 replay_tick_i = 0;
+  u64 replay_desync_tick = U64_MAX;
+  u64 *replay_update_ns = NULL;
+  if (replay_path != NULL)
+  {
+    String8 replay_file = s8_read_entire_file(linux_mem_arena_perm, s8_cstring(replay_path));
+    ReplayHeader *replay_header = (ReplayHeader *)replay_file.str;
+    if (replay_file.size < sizeof(ReplayHeader) || replay_header->magic != REPLAY_MAGIC ||
+        replay_header->version != REPLAY_VERSION || replay_header->tick_rate != APP_TICK_RATE)
+    {
+      FATAL_ERROR("Failed to load input log.", replay_path, "Record it again with this build, using -record.");
+    }
+
+    app_state->rand_seed = replay_header->rand_seed;
+    replay_ticks = (ReplayTick *)(replay_file.str + sizeof(ReplayHeader));
+    replay_tick_count = (replay_file.size - sizeof(ReplayHeader)) / sizeof(ReplayTick);
+    replay_update_ns = MEM_ARENA_PUSH_ARRAY_ZERO(linux_mem_arena_perm, u64, replay_tick_count);
+  }
+
+  FILE *record_file = NULL;
+  if (record_path != NULL)
+  {
+    record_file = fopen(record_path, "wb");
+    if (record_file == NULL)
+    {
+      FATAL_ERROR("Failed to open input log.", strerror(errno), record_path);
+    }
+
+    ReplayHeader record_header = ZERO_STRUCT;
+    record_header.magic = REPLAY_MAGIC;
+    record_header.version = REPLAY_VERSION;
+    record_header.tick_rate = APP_TICK_RATE;
+    record_header.rand_seed = app_state->rand_seed;
+    fwrite(&record_header, sizeof(record_header), 1, record_file);
+  }
 
   app_state->debugger_present = global_debugger_present;
 
+  // NOTE(Ryan): Main thread becomes worker 0, and runs jobs whilst app_update() waits on its systems.
+  // Only the worker threads stay pinned; the main thread also pumps SDL events and presents, 
+  // so it's left free to migrate rather than stuck sharing a core with a worker
+  app_state->job_system = job_system_create(linux_mem_arena_perm, 0);
+  job_system_unpin_creator(app_state->job_system);
+
   Renderer *renderer = MEM_ARENA_PUSH_STRUCT(linux_mem_arena_perm, Renderer);
   renderer->renderer = sdl2_renderer;
   renderer->render_width = (u32)render_width;
@@ -344,6 +445,17 @@ main(int argc, char *argv[])
 
   Input *input = MEM_ARENA_PUSH_ARRAY_ZERO(linux_mem_arena_perm, Input, 1);
 
+  // NOTE(Ryan): Fixed timestep. Wall time is banked, then spent a tick at a time,
+  // so the simulation steps the same whatever the refresh rate or however long a frame took.
+  // Rendering then interpolates by whatever's left over, less than a tick.
+  // Frames are still paced by vsync, more accurate than OS scheduler granularity
+  u64 tick_ns = 1000000000ull / APP_TICK_RATE;
+  // NOTE(Ryan): Caps what's owed after a stall, e.g. a breakpoint or reload, rather than spiralling to catch up
+  u64 max_accumulator_ns = tick_ns * (APP_TICK_RATE / 4);
+  // NOTE(Ryan): Owes a tick from the start, so app_update() has loaded the level before the first app_render()
+  u64 accumulator_ns = tick_ns;
+  u64 last_frame_start_ns = linux_get_ns();
+
   b32 want_to_run = true;
   while (want_to_run)
   {
@@ -433,10 +545,10 @@ main(int argc, char *argv[])
         dlclose(app_lib);
       }
 
-      s8_copy_file(mem_arena_temp.arena, app_name, app_temp_abs_path);
-      struct stat app_stat = ZERO_STRUCT;
-      stat((char *)app_name.str, &app_stat);
-      chmod((char *)app_temp_abs_path.str, app_stat.st_mode);
+      if (!s8_copy_file(app_name, app_temp_abs_path))
+      {
+        WARN("Failed to copy app shared library.", strerror(errno));
+      }
 
       // TODO(Ryan): This will fail as it seems detects file change before can actually load.
       // So, will successfully load on subsequent calls
@@ -445,28 +557,33 @@ main(int argc, char *argv[])
 
       if (app_lib != NULL) 
       {
-        app = (app_func)dlsym(app_lib, "app");
-        if (app != NULL)
+        update = (app_update_func)dlsym(app_lib, "app_update");
+        render = (app_render_func)dlsym(app_lib, "app_render");
+        if (update != NULL && render != NULL)
         {
           last_app_reload_time = app_mod_time;
         }
         else
         {
           WARN("Failed to load app from shared library.", strerror(errno));
-          app = NULL;
+          update = NULL;
+          render = NULL;
         }
       }
       else
       {
         WARN("Failed to open app shared library.", strerror(errno));
-        app = NULL;
+        update = NULL;
+        render = NULL;
       }
     }
 
-    if (app != NULL)
-    {
-      app_state->ms = linux_get_ms();
+    u64 frame_start_ns = linux_get_ns();
+    accumulator_ns = MIN(accumulator_ns + (frame_start_ns - last_frame_start_ns), max_accumulator_ns);
+    last_frame_start_ns = frame_start_ns;
 
+    if (update != NULL && render != NULL)
+    {
       SDL_GetWindowSize(window, &window_width, &window_height);
       renderer->window_width = (u32)window_width;
       renderer->window_height = (u32)window_height;
@@ -478,13 +595,56 @@ main(int argc, char *argv[])
 
       sdl2_map_window_mouse_to_render_mouse(renderer, input);
 
-      // fps calculation?
-      // vsync more accurate than OS scheduler granularity
-      // IMPORTANT(Ryan): Still technically variable-delta-time, so not deterministic
-      app(app_state, renderer, input, linux_mem_arena_perm);
+      while (accumulator_ns >= tick_ns && want_to_run)
+      {
+        Input *tick_input = input;
+        if (replay_ticks != NULL)
+        {
+          if (replay_tick_i == replay_tick_count)
+          {
+            want_to_run = false;
+            break;
+          }
+          tick_input = &replay_ticks[replay_tick_i].input;
+        }
 
-      input->bullet_fired = false;
-      input->mouse_clicked = false;
+        u64 update_start_ns = linux_get_ns();
+        update(app_state, tick_input, linux_mem_arena_perm);
+        u64 update_ns = linux_get_ns() - update_start_ns;
+        accumulator_ns -= tick_ns;
+
+        if (record_file != NULL || replay_ticks != NULL)
+        {
+          u64 checksum = linux_app_checksum(app_state);
+
+          if (record_file != NULL)
+          {
+            ReplayTick record_tick;
+            MEMORY_ZERO_STRUCT(&record_tick); // padding too, so identical runs give identical logs
+            record_tick.input = *tick_input;
+            record_tick.checksum = checksum;
+            fwrite(&record_tick, sizeof(record_tick), 1, record_file);
+          }
+
+          if (replay_ticks != NULL)
+          {
+            if (checksum != replay_ticks[replay_tick_i].checksum && replay_desync_tick == U64_MAX)
+            {
+              replay_desync_tick = replay_tick_i;
+              WARN("Simulation diverged from input log.", "State checksum differs from the recording");
+            }
+            replay_update_ns[replay_tick_i] = update_ns;
+            replay_tick_i += 1;
+          }
+        }
+
+        // NOTE(Ryan): Edges go to the first tick after them, not to every tick run this frame
+        input->bullet_fired = false;
+        input->mouse_clicked = false;
+      }
+
+      f32 alpha = (f32)accumulator_ns / (f32)tick_ns;
+      render(app_state, renderer, alpha, linux_mem_arena_perm);
     }
     else
     {
@@ -497,6 +657,25 @@ main(int argc, char *argv[])
     SDL_RenderPresent(sdl2_renderer);
   }
 
+  if (record_file != NULL)
+  {
+    fclose(record_file);
+  }
+
+  if (replay_ticks != NULL && replay_tick_i > 0)
+  {
+    printf("Replay %s: %lu of %lu ticks, update median %.3fms, p99 %.3fms\n", replay_path, replay_tick_i,
+           replay_tick_count, u64_percentile(replay_update_ns, (u32)replay_tick_i, 50) / 1000000.0,
+           u64_percentile(replay_update_ns, (u32)replay_tick_i, 99) / 1000000.0);
+    if (replay_desync_tick != U64_MAX)
+    {
+      printf("  diverged at tick %lu\n", replay_desync_tick);
+      result = 1;
+    }
+  }
+
+  job_system_destroy(app_state->job_system);
+
   SDL_Quit();
 
   // IMPORTANT(Ryan): Instead of choosing the right data structure
@@ -505,7 +684,7 @@ main(int argc, char *argv[])
   
   LSAN_RUN();
   
-  return 0;
+  return result;
 }
 
 
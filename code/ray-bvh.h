@@ -0,0 +1,311 @@
+// SPDX-License-Identifier: zlib-acknowledgement
+#pragma once
+
+// NOTE(Ryan): Host side BVH builder over World primitives; traversal is in ray-kernel.cpp.
+// Split chosen with binned surface area heuristic (SAH):
+//   cost(split) = traversal_cost + (area(L)·count(L) + area(R)·count(R)) / area(parent)
+// i.e. probability a ray hitting the parent also hits each child, times the spheres it would then test.
+// Binning centroids into a few buckets per axis makes this O(n) per level instead of sorting
+
+#define BVH_BIN_COUNT 16
+#define BVH_MAX_LEAF_PRIMITIVE_COUNT 4
+// NOTE(Ryan): Relative to one primitive test. A node test is 1 slab test vs 1 quadratic per sphere or 2 crosses per triangle
+#define BVH_TRAVERSAL_COST 1.0f
+
+typedef struct BVHBounds BVHBounds;
+struct BVHBounds
+{
+  V3 min;
+  V3 max;
+};
+
+typedef struct BVHBin BVHBin;
+struct BVHBin
+{
+  BVHBounds bounds;
+  u32 primitive_count;
+};
+
+typedef struct BVHBuilder BVHBuilder;
+// NOTE(Ryan): Only primitive_indices is partitioned; bounds and centroids are looked up through it
+struct BVHBuilder
+{
+  BVHBounds *primitive_bounds;
+  V3 *centroids;
+  u32 *primitive_indices;
+
+  BVHNode *nodes;
+  u32 node_count;
+};
+
+INTERNAL BVHBounds
+bvh_bounds_empty(void)
+{
+  BVHBounds result = {};
+
+  result.min = vec3_f32(f32_inf(), f32_inf(), f32_inf());
+  result.max = vec3_f32(-f32_inf(), -f32_inf(), -f32_inf());
+
+  return result;
+}
+
+INTERNAL void
+bvh_bounds_grow(BVHBounds *bounds, V3 min, V3 max)
+{
+  bounds->min = vec3_f32(MIN(bounds->min.x, min.x), MIN(bounds->min.y, min.y), MIN(bounds->min.z, min.z));
+  bounds->max = vec3_f32(MAX(bounds->max.x, max.x), MAX(bounds->max.y, max.y), MAX(bounds->max.z, max.z));
+}
+
+INTERNAL f32
+bvh_bounds_surface_area(BVHBounds bounds)
+{
+  f32 result = 0.0f;
+
+  V3 extent = vec3_f32_sub(bounds.max, bounds.min);
+  // NOTE(Ryan): Empty bounds are inverted
+  if (extent.x >= 0.0f && extent.y >= 0.0f && extent.z >= 0.0f)
+  {
+    result = 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+  }
+
+  return result;
+}
+
+INTERNAL u32
+bvh_bin_index(f32 centroid, f32 centroid_min, f32 bin_scale)
+{
+  u32 result = (u32)((centroid - centroid_min) * bin_scale);
+
+  result = MIN(result, BVH_BIN_COUNT - 1);
+
+  return result;
+}
+
+INTERNAL void
+bvh_build_node(BVHBuilder *builder, u32 node_index, u32 first, u32 count, u32 depth)
+{
+  BVHNode *node = &builder->nodes[node_index];
+
+  BVHBounds bounds = bvh_bounds_empty();
+  BVHBounds centroid_bounds = bvh_bounds_empty();
+  for (u32 i = first; i < first + count; i += 1)
+  {
+    u32 primitive_index = builder->primitive_indices[i];
+    BVHBounds primitive_bounds = builder->primitive_bounds[primitive_index];
+    V3 centroid = builder->centroids[primitive_index];
+    bvh_bounds_grow(&bounds, primitive_bounds.min, primitive_bounds.max);
+    bvh_bounds_grow(&centroid_bounds, centroid, centroid);
+  }
+
+  node->bounds_min = bounds.min;
+  node->bounds_max = bounds.max;
+
+  f32 leaf_cost = (f32)count;
+  f32 best_cost = f32_inf();
+  u32 best_axis = 0;
+  u32 best_split = 0;
+
+  if (count > 1 && depth < BVH_MAX_DEPTH - 1)
+  {
+    f32 inv_parent_area = 1.0f / bvh_bounds_surface_area(bounds);
+
+    for (u32 axis = 0; axis < 3; axis += 1)
+    {
+      f32 centroid_min = centroid_bounds.min.elements[axis];
+      f32 centroid_extent = centroid_bounds.max.elements[axis] - centroid_min;
+      // NOTE(Ryan): All centroids on a plane perpendicular to axis, so no split possible
+      if (centroid_extent <= 0.0f)
+      {
+        continue;
+      }
+      f32 bin_scale = (f32)BVH_BIN_COUNT / centroid_extent;
+
+      BVHBin bins[BVH_BIN_COUNT] = {};
+      for (u32 bin_i = 0; bin_i < BVH_BIN_COUNT; bin_i += 1)
+      {
+        bins[bin_i].bounds = bvh_bounds_empty();
+      }
+      for (u32 i = first; i < first + count; i += 1)
+      {
+        u32 primitive_index = builder->primitive_indices[i];
+        BVHBin *bin = &bins[bvh_bin_index(builder->centroids[primitive_index].elements[axis], centroid_min, bin_scale)];
+        BVHBounds primitive_bounds = builder->primitive_bounds[primitive_index];
+        bvh_bounds_grow(&bin->bounds, primitive_bounds.min, primitive_bounds.max);
+        bin->primitive_count += 1;
+      }
+
+      // NOTE(Ryan): Sweep from right to get area and count of everything right of each split plane,
+      // then sweep from left to evaluate each split in one pass
+      f32 right_area[BVH_BIN_COUNT] = {};
+      u32 right_count[BVH_BIN_COUNT] = {};
+      BVHBounds right_bounds = bvh_bounds_empty();
+      u32 right_sum = 0;
+      for (u32 bin_i = BVH_BIN_COUNT - 1; bin_i > 0; bin_i -= 1)
+      {
+        bvh_bounds_grow(&right_bounds, bins[bin_i].bounds.min, bins[bin_i].bounds.max);
+        right_sum += bins[bin_i].primitive_count;
+        right_area[bin_i] = bvh_bounds_surface_area(right_bounds);
+        right_count[bin_i] = right_sum;
+      }
+
+      BVHBounds left_bounds = bvh_bounds_empty();
+      u32 left_sum = 0;
+      for (u32 split = 1; split < BVH_BIN_COUNT; split += 1)
+      {
+        bvh_bounds_grow(&left_bounds, bins[split - 1].bounds.min, bins[split - 1].bounds.max);
+        left_sum += bins[split - 1].primitive_count;
+
+        if (left_sum == 0 || right_count[split] == 0)
+        {
+          continue;
+        }
+
+        f32 cost = BVH_TRAVERSAL_COST + inv_parent_area *
+                   (bvh_bounds_surface_area(left_bounds) * (f32)left_sum + right_area[split] * (f32)right_count[split]);
+        if (cost < best_cost)
+        {
+          best_cost = cost;
+          best_axis = axis;
+          best_split = split;
+        }
+      }
+    }
+  }
+
+  // NOTE(Ryan): Small nodes only split if it pays for the extra traversal step; large ones always split if they can
+  b32 is_leaf = (best_split == 0) || (count <= BVH_MAX_LEAF_PRIMITIVE_COUNT && best_cost >= leaf_cost);
+  // NOTE(Ryan): Leaf primitive_count is a u16. If SAH has nothing to split on (e.g. coincident centroids),
+  // halve by index instead; children overlap, but no leaf is truncated
+  b32 is_index_split = (is_leaf && count > U16_MAX && depth < BVH_MAX_DEPTH - 1);
+  if (is_leaf && !is_index_split)
+  {
+    ASSERT(count <= U16_MAX);
+    node->offset = first;
+    node->primitive_count = (u16)count;
+    node->split_axis = 0;
+  }
+  else
+  {
+    u32 left_count = count / 2;
+    if (!is_index_split)
+    {
+      f32 centroid_min = centroid_bounds.min.elements[best_axis];
+      f32 bin_scale = (f32)BVH_BIN_COUNT / (centroid_bounds.max.elements[best_axis] - centroid_min);
+
+      // NOTE(Ryan): In-place partition, so each node covers a contiguous range of primitive_indices
+      u32 left_i = first;
+      u32 right_i = first + count;
+      while (left_i < right_i)
+      {
+        V3 centroid = builder->centroids[builder->primitive_indices[left_i]];
+        if (bvh_bin_index(centroid.elements[best_axis], centroid_min, bin_scale) < best_split)
+        {
+          left_i += 1;
+        }
+        else
+        {
+          right_i -= 1;
+          SWAP(u32, builder->primitive_indices[left_i], builder->primitive_indices[right_i]);
+        }
+      }
+      left_count = left_i - first;
+    }
+    ASSERT(left_count > 0 && left_count < count);
+
+    node->primitive_count = 0;
+    node->split_axis = (u16)best_axis;
+
+    u32 left_index = builder->node_count++;
+    ASSERT(left_index == node_index + 1);
+    bvh_build_node(builder, left_index, first, left_count, depth + 1);
+
+    u32 right_index = builder->node_count++;
+    node->offset = right_index;
+    bvh_build_node(builder, right_index, first + left_count, count - left_count, depth + 1);
+  }
+}
+
+INTERNAL BVHBounds
+bvh_sphere_bounds(void *primitive)
+{
+  BVHBounds result = {};
+
+  Sphere *sphere = (Sphere *)primitive;
+  V3 radius = vec3_f32(sphere->radius, sphere->radius, sphere->radius);
+  result.min = vec3_f32_sub(sphere->position, radius);
+  result.max = vec3_f32_add(sphere->position, radius);
+
+  return result;
+}
+
+INTERNAL BVHBounds
+bvh_triangle_bounds(void *primitive)
+{
+  BVHBounds result = bvh_bounds_empty();
+
+  Triangle *triangle = (Triangle *)primitive;
+  V3 vertex1 = vec3_f32_add(triangle->vertex0, triangle->edge1);
+  V3 vertex2 = vec3_f32_add(triangle->vertex0, triangle->edge2);
+  bvh_bounds_grow(&result, triangle->vertex0, triangle->vertex0);
+  bvh_bounds_grow(&result, vertex1, vertex1);
+  bvh_bounds_grow(&result, vertex2, vertex2);
+
+  return result;
+}
+
+typedef BVHBounds (*bvh_bounds_func)(void *primitive);
+
+// NOTE(Ryan): Reorders primitives in place to match leaf ranges
+INTERNAL BVH
+bvh_build(MemArena *arena, void *primitives, memory_index primitive_size, u32 primitive_count, bvh_bounds_func bounds_func)
+{
+  BVH result = {};
+
+  if (primitive_count > 0)
+  {
+    // NOTE(Ryan): Binary tree with at least 1 primitive per leaf has at most 2n - 1 nodes.
+    // Pushed before temporaries so it survives mem_arena_temp_end()
+    u32 max_node_count = 2 * primitive_count - 1;
+    BVHNode *nodes = (BVHNode *)mem_arena_push_aligned(arena, max_node_count * sizeof(BVHNode), CACHE_LINE_SIZE);
+
+    MemArenaTemp temp = mem_arena_temp_begin(arena);
+
+    BVHBuilder builder = {};
+    builder.primitive_bounds = MEM_ARENA_PUSH_ARRAY(arena, BVHBounds, primitive_count);
+    builder.centroids = MEM_ARENA_PUSH_ARRAY(arena, V3, primitive_count);
+    builder.primitive_indices = MEM_ARENA_PUSH_ARRAY(arena, u32, primitive_count);
+    for (u32 primitive_i = 0; primitive_i < primitive_count; primitive_i += 1)
+    {
+      BVHBounds bounds = bounds_func((u8 *)primitives + primitive_i * primitive_size);
+      builder.primitive_bounds[primitive_i] = bounds;
+      builder.centroids[primitive_i] = vec3_f32_mul(vec3_f32_add(bounds.min, bounds.max), 0.5f);
+      builder.primitive_indices[primitive_i] = primitive_i;
+    }
+    builder.nodes = nodes;
+    builder.node_count = 1;
+
+    bvh_build_node(&builder, 0, 0, primitive_count, 0);
+
+    u8 *unordered = MEM_ARENA_PUSH_ARRAY(arena, u8, primitive_count * primitive_size);
+    MEMORY_COPY(unordered, primitives, primitive_count * primitive_size);
+    for (u32 primitive_i = 0; primitive_i < primitive_count; primitive_i += 1)
+    {
+      MEMORY_COPY((u8 *)primitives + primitive_i * primitive_size, 
+                  unordered + builder.primitive_indices[primitive_i] * primitive_size, primitive_size);
+    }
+
+    mem_arena_temp_end(temp);
+
+    result.nodes = nodes;
+    result.node_count = builder.node_count;
+  }
+
+  return result;
+}
+
+INTERNAL void
+bvh_build_world(MemArena *arena, World *world)
+{
+  world->sphere_bvh = bvh_build(arena, world->spheres, sizeof(Sphere), world->sphere_count, bvh_sphere_bounds);
+  world->triangle_bvh = bvh_build(arena, world->triangles, sizeof(Triangle), world->triangle_count, bvh_triangle_bounds);
+}
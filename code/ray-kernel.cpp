@@ -0,0 +1,966 @@
+// SPDX-License-Identifier: zlib-acknowledgement
+
+// IMPORTANT(Ryan): Compiled once per ISA (see misc/build), each with its own LANE_WIDTH and -m flags.
+// Everything here is INTERNAL apart from the suffixed entry point, so the builds can't collide at link time
+// and an AVX-512 copy of a helper can never be picked for the scalar path
+
+#if !defined(RAY_KERNEL_ISA)
+  #error Define RAY_KERNEL_ISA, e.g. -DRAY_KERNEL_ISA=avx2
+#endif
+
+#include "ray.h"
+#include "base-lane.h"
+
+#define RAY_KERNEL_NAME(name) PASTE(PASTE(name, _), RAY_KERNEL_ISA)
+
+// IEEE 754 is in essense a compression algorithm, i.e. compressing all numbers from negative to positive infinity to a finite space of bits
+// Therefore, 0.1 + 0.2 != 0.3 (0.300000004) as it can't represent 0.3
+// epsilon is an allowable error margin for floating point
+//
+
+// NOTE(Ryan): Ad-hoc values
+#define RAY_MIN_HIT_DISTANCE 0.001f // as oppose to using 0?
+#define RAY_TOLERANCE 0.0001f
+
+// NOTE(Ryan): Counter each random draw uses within a sample, fixed per bounce so a bounce 
+// always draws the same numbers however many were drawn before it
+#define RAY_RANDOM_DIMENSION_JITTER 0
+#define RAY_RANDOM_DIMENSION_BOUNCE 2
+#define RAY_RANDOM_DIMENSIONS_PER_BOUNCE 7
+// NOTE(Ryan): Offsets within a bounce's dimensions
+#define RAY_RANDOM_DIMENSION_LIGHT_PICK 0
+#define RAY_RANDOM_DIMENSION_LIGHT_POINT 1 // 2 dimensions
+#define RAY_RANDOM_DIMENSION_LOBE 3
+#define RAY_RANDOM_DIMENSION_DIRECTION 4 // 2 dimensions
+#define RAY_RANDOM_DIMENSION_ROULETTE 6
+
+// NOTE(Ryan): Paths always get this many bounces before Russian roulette can end them,
+// as the first few carry most of the image's energy
+#define RAY_ROULETTE_MIN_BOUNCE_COUNT 3
+// NOTE(Ryan): Lower bound on survival probability, so a dim path's weight is at most multiplied by 1 / this
+#define RAY_ROULETTE_MIN_SURVIVAL 0.05f
+
+// NOTE(Ryan): Closest hit so far for each lane
+typedef struct LaneHit LaneHit;
+struct LaneHit
+{
+  LaneF32 distance;
+  // 0 is the sky material index, i.e. emitter of light
+  LaneU32 material_index;
+  LaneV3 position;
+  LaneV3 normal;
+};
+
+INTERNAL void
+intersect_planes(PlaneSoA *planes, LaneV3 ray_origin, LaneV3 ray_direction, LaneHit *hit)
+{
+  LaneF32 min_hit_distance = lane_f32(RAY_MIN_HIT_DISTANCE);
+  LaneF32 tolerance = lane_f32(RAY_TOLERANCE);
+
+  for (u32 plane_index = 0;
+      plane_index < planes->count;
+      ++plane_index)
+  {
+    LaneV3 plane_normal = lane_v3(planes->normal_x[plane_index], planes->normal_y[plane_index], 
+                                  planes->normal_z[plane_index]);
+    LaneF32 plane_distance = lane_f32(planes->distance[plane_index]);
+    LaneU32 plane_material_index = lane_u32(planes->material_index[plane_index]);
+
+    // for ray line: ray_origin + scale_factor·ray_direction
+    // substitute this in for point in plane equation and solve for scale_factor (in this case 't')
+    // (in this sense, is it more appropriate to say check for intersection?)
+    LaneF32 denom = lane_v3_dot(plane_normal, ray_direction);
+    LaneF32 t = (-plane_distance - lane_v3_dot(plane_normal, ray_origin)) / denom;
+
+    // zero if perpendicular to normal, a.k.a will never intersect plane
+    LaneU32 denom_mask = (denom < -tolerance || denom > tolerance);
+    LaneU32 t_mask = (t > min_hit_distance && t < hit->distance);
+    LaneU32 hit_mask = denom_mask & t_mask;
+
+    conditional_assign(&hit->distance, hit_mask, t);
+    conditional_assign(&hit->material_index, hit_mask, plane_material_index);
+    conditional_assign(&hit->position, hit_mask, ray_origin + t * ray_direction);
+    conditional_assign(&hit->normal, hit_mask, plane_normal);
+  }
+}
+
+// NOTE(Ryan): Nearest root of the ray/sphere quadratic, or a value failing hit_mask.
+// Lanes are either rays against one sphere or spheres against one ray, the maths is the same
+INTERNAL LaneF32
+intersect_sphere_distance(LaneV3 sphere_p, LaneF32 sphere_radius_squared, LaneV3 ray_origin, LaneV3 ray_direction, 
+                          LaneU32 *hit_mask)
+{
+  LaneF32 min_hit_distance = lane_f32(RAY_MIN_HIT_DISTANCE);
+  LaneF32 tolerance = lane_f32(RAY_TOLERANCE);
+
+  // to account for the sphere's origin
+  LaneV3 sphere_relative_ray_origin = ray_origin - sphere_p;
+
+  // for sphere: x² + y² + z² - r² = 0
+  // we see that this contains the dot product of itself: pᵗp - r² = 0
+  // substituting ray line equation we get a quadratic equation in terms of t
+  // so, use quadratic formula to solve
+  LaneF32 a = lane_v3_dot(ray_direction, ray_direction);
+  LaneF32 b = 2.0f * lane_v3_dot(ray_direction, sphere_relative_ray_origin);
+  LaneF32 c = lane_v3_dot(sphere_relative_ray_origin, sphere_relative_ray_origin) - sphere_radius_squared;
+
+  LaneF32 denom = 2.0f * a;
+  LaneF32 root_term = lane_f32_sqrt(b * b - 4.0f * a * c);
+  // NOTE(Ryan): NaN for negative discriminant compares false, so those lanes are masked off
+  LaneU32 root_mask = (root_term > tolerance);
+
+  LaneF32 t_pos = (-b + root_term) / denom;
+  LaneF32 t_neg = (-b - root_term) / denom;
+
+  LaneF32 result = t_pos;
+  // check if t_neg is a better hit
+  LaneU32 pick_mask = (t_neg > min_hit_distance && t_neg < t_pos);
+  conditional_assign(&result, pick_mask, t_neg);
+
+  *hit_mask = root_mask & (result > min_hit_distance);
+
+  return result;
+}
+
+// NOTE(Ryan): Packet against one sphere at a time; every lane's ray is tested, active or not.
+// Only distance and index are kept per sphere, so position and normalised normal are worked out once at the end
+INTERNAL void
+intersect_spheres_packet(SphereSoA *spheres, u32 first, u32 count, LaneV3 ray_origin, LaneV3 ray_direction, 
+                         LaneHit *hit)
+{
+  LaneF32 closest_distance = hit->distance;
+  LaneU32 closest_index = lane_u32(0);
+  LaneU32 closest_mask = lane_u32(0);
+
+  for (u32 sphere_index = first;
+      sphere_index < first + count;
+      ++sphere_index)
+  {
+    LaneV3 sphere_p = lane_v3(spheres->x[sphere_index], spheres->y[sphere_index], spheres->z[sphere_index]);
+    LaneF32 sphere_radius_squared = lane_f32(spheres->radius_squared[sphere_index]);
+
+    LaneU32 root_mask;
+    LaneF32 t = intersect_sphere_distance(sphere_p, sphere_radius_squared, ray_origin, ray_direction, &root_mask);
+    LaneU32 hit_mask = root_mask & (t < closest_distance);
+
+    conditional_assign(&closest_distance, hit_mask, t);
+    conditional_assign(&closest_index, hit_mask, lane_u32(sphere_index));
+    closest_mask |= hit_mask;
+  }
+
+  if (!mask_is_zeroed(closest_mask))
+  {
+    LaneV3 sphere_p = lane_v3(lane_f32_gather((u8 *)spheres->x, sizeof(f32), closest_index), 
+                              lane_f32_gather((u8 *)spheres->y, sizeof(f32), closest_index), 
+                              lane_f32_gather((u8 *)spheres->z, sizeof(f32), closest_index));
+    LaneU32 sphere_material_index = lane_u32_gather((u8 *)spheres->material_index, sizeof(u32), closest_index);
+    LaneV3 position = ray_origin + closest_distance * ray_direction;
+
+    hit->distance = closest_distance;
+    conditional_assign(&hit->material_index, closest_mask, sphere_material_index);
+    conditional_assign(&hit->position, closest_mask, position);
+    conditional_assign(&hit->normal, closest_mask, lane_v3_noz(position - sphere_p));
+  }
+}
+
+// NOTE(Ryan): Transposed; each active ray in turn against LANE_WIDTH consecutive spheres per step.
+// Last step reads past the range into the next spheres or padding, which is harmless as any hit is a real one
+INTERNAL void
+intersect_spheres_per_ray(SphereSoA *spheres, u32 first, u32 count, LaneV3 ray_origin, LaneV3 ray_direction, 
+                          LaneU32 lane_mask, LaneHit *hit)
+{
+  f32 origin_x[LANE_WIDTH], origin_y[LANE_WIDTH], origin_z[LANE_WIDTH];
+  f32 direction_x[LANE_WIDTH], direction_y[LANE_WIDTH], direction_z[LANE_WIDTH];
+  lane_f32_store(origin_x, ray_origin.x);
+  lane_f32_store(origin_y, ray_origin.y);
+  lane_f32_store(origin_z, ray_origin.z);
+  lane_f32_store(direction_x, ray_direction.x);
+  lane_f32_store(direction_y, ray_direction.y);
+  lane_f32_store(direction_z, ray_direction.z);
+
+  u32 active[LANE_WIDTH];
+  f32 hit_distance[LANE_WIDTH];
+  u32 hit_material_index[LANE_WIDTH];
+  f32 hit_position_x[LANE_WIDTH], hit_position_y[LANE_WIDTH], hit_position_z[LANE_WIDTH];
+  f32 hit_normal_x[LANE_WIDTH], hit_normal_y[LANE_WIDTH], hit_normal_z[LANE_WIDTH];
+  lane_u32_store(active, lane_mask);
+  lane_f32_store(hit_distance, hit->distance);
+  lane_u32_store(hit_material_index, hit->material_index);
+  lane_f32_store(hit_position_x, hit->position.x);
+  lane_f32_store(hit_position_y, hit->position.y);
+  lane_f32_store(hit_position_z, hit->position.z);
+  lane_f32_store(hit_normal_x, hit->normal.x);
+  lane_f32_store(hit_normal_y, hit->normal.y);
+  lane_f32_store(hit_normal_z, hit->normal.z);
+
+  for (u32 lane_i = 0; lane_i < LANE_WIDTH; lane_i += 1)
+  {
+    if (active[lane_i] == 0)
+    {
+      continue;
+    }
+
+    LaneV3 lane_ray_origin = lane_v3(origin_x[lane_i], origin_y[lane_i], origin_z[lane_i]);
+    LaneV3 lane_ray_direction = lane_v3(direction_x[lane_i], direction_y[lane_i], direction_z[lane_i]);
+
+    f32 closest_distance = hit_distance[lane_i];
+    u32 closest_index = U32_MAX;
+    for (u32 sphere_index = first;
+         sphere_index < first + count;
+         sphere_index += LANE_WIDTH)
+    {
+      LaneV3 sphere_p = lane_v3(lane_f32_load(spheres->x + sphere_index), lane_f32_load(spheres->y + sphere_index), 
+                                lane_f32_load(spheres->z + sphere_index));
+      LaneF32 sphere_radius_squared = lane_f32_load(spheres->radius_squared + sphere_index);
+
+      LaneU32 root_mask;
+      LaneF32 t = intersect_sphere_distance(sphere_p, sphere_radius_squared, lane_ray_origin, lane_ray_direction, 
+                                            &root_mask);
+      LaneU32 hit_mask = root_mask & (t < lane_f32(closest_distance));
+      if (mask_is_zeroed(hit_mask))
+      {
+        continue;
+      }
+
+      // NOTE(Ryan): Earliest sphere wins ties, as in the packet path
+      f32 t_values[LANE_WIDTH];
+      lane_f32_store(t_values, lane_f32_select(hit_mask, lane_f32(f32_inf()), t));
+      for (u32 sphere_lane_i = 0; sphere_lane_i < LANE_WIDTH; sphere_lane_i += 1)
+      {
+        if (t_values[sphere_lane_i] < closest_distance)
+        {
+          closest_distance = t_values[sphere_lane_i];
+          closest_index = sphere_index + sphere_lane_i;
+        }
+      }
+    }
+
+    if (closest_index != U32_MAX)
+    {
+      V3 position = vec3_f32(origin_x[lane_i] + closest_distance * direction_x[lane_i], 
+                             origin_y[lane_i] + closest_distance * direction_y[lane_i], 
+                             origin_z[lane_i] + closest_distance * direction_z[lane_i]);
+      V3 sphere_p = vec3_f32(spheres->x[closest_index], spheres->y[closest_index], spheres->z[closest_index]);
+      V3 normal = vec3_f32_normalise(vec3_f32_sub(position, sphere_p));
+
+      hit_distance[lane_i] = closest_distance;
+      hit_material_index[lane_i] = spheres->material_index[closest_index];
+      hit_position_x[lane_i] = position.x;
+      hit_position_y[lane_i] = position.y;
+      hit_position_z[lane_i] = position.z;
+      hit_normal_x[lane_i] = normal.x;
+      hit_normal_y[lane_i] = normal.y;
+      hit_normal_z[lane_i] = normal.z;
+    }
+  }
+
+  hit->distance = lane_f32_load(hit_distance);
+  hit->material_index = lane_u32_load(hit_material_index);
+  hit->position = lane_v3(lane_f32_load(hit_position_x), lane_f32_load(hit_position_y), lane_f32_load(hit_position_z));
+  hit->normal = lane_v3(lane_f32_load(hit_normal_x), lane_f32_load(hit_normal_y), lane_f32_load(hit_normal_z));
+}
+
+// NOTE(Ryan): Packet costs one test per sphere, per ray costs one per LANE_WIDTH spheres for each active lane,
+// plus about a lane's worth of transposing rays and hits in and out.
+// So only brute force (or large leaves) with lanes already terminated goes per ray; BVH leaves are too small
+INTERNAL void
+intersect_spheres(SphereSoA *spheres, u32 first, u32 count, LaneV3 ray_origin, LaneV3 ray_direction, LaneU32 lane_mask, 
+                  LaneHit *hit)
+{
+  u32 per_ray_cost = mask_count(lane_mask) * ((count + LANE_WIDTH - 1) / LANE_WIDTH) + LANE_WIDTH;
+  if (per_ray_cost < count)
+  {
+    intersect_spheres_per_ray(spheres, first, count, ray_origin, ray_direction, lane_mask, hit);
+  }
+  else
+  {
+    intersect_spheres_packet(spheres, first, count, ray_origin, ray_direction, hit);
+  }
+}
+
+// NOTE(Ryan): Möller–Trumbore; solves ray = vertex0 + u·edge1 + v·edge2 for (t, u, v) with Cramer's rule,
+// sharing cross products between the determinants so no plane equation is needed.
+// Hit if barycentrics are inside triangle, i.e. u, v >= 0 and u + v <= 1
+INTERNAL void
+intersect_triangles(Triangle *triangles, u32 triangle_count, LaneV3 ray_origin, LaneV3 ray_direction, LaneHit *hit)
+{
+  LaneF32 min_hit_distance = lane_f32(RAY_MIN_HIT_DISTANCE);
+  LaneF32 tolerance = lane_f32(RAY_TOLERANCE);
+
+  for (u32 triangle_index = 0;
+      triangle_index < triangle_count;
+      ++triangle_index)
+  {
+    Triangle *triangle = &triangles[triangle_index];
+
+    LaneV3 vertex0 = lane_v3_from_vec3_f32(triangle->vertex0);
+    LaneV3 edge1 = lane_v3_from_vec3_f32(triangle->edge1);
+    LaneV3 edge2 = lane_v3_from_vec3_f32(triangle->edge2);
+    LaneV3 triangle_normal = lane_v3_from_vec3_f32(triangle->normal);
+
+    LaneV3 p = lane_v3_cross(ray_direction, edge2);
+    LaneF32 det = lane_v3_dot(edge1, p);
+    // zero if ray parallel to triangle's plane
+    LaneU32 det_mask = (det < -tolerance || det > tolerance);
+    LaneF32 inv_det = 1.0f / lane_f32_select(det_mask, lane_f32(1.0f), det);
+
+    LaneV3 s = ray_origin - vertex0;
+    LaneF32 u = lane_v3_dot(s, p) * inv_det;
+    LaneV3 q = lane_v3_cross(s, edge1);
+    LaneF32 v = lane_v3_dot(ray_direction, q) * inv_det;
+    LaneF32 t = lane_v3_dot(edge2, q) * inv_det;
+
+    LaneU32 barycentric_mask = (u >= 0.0f && v >= 0.0f && (u + v) <= 1.0f);
+    LaneU32 t_mask = (t > min_hit_distance && t < hit->distance);
+    LaneU32 hit_mask = det_mask & barycentric_mask & t_mask;
+
+    // NOTE(Ryan): Meshes aren't consistently wound, so face normal towards ray for bounce to leave the right side
+    LaneU32 facing_away_mask = (lane_v3_dot(triangle_normal, ray_direction) > 0.0f);
+    conditional_assign(&triangle_normal, facing_away_mask, -triangle_normal);
+
+    conditional_assign(&hit->distance, hit_mask, t);
+    conditional_assign(&hit->material_index, hit_mask, lane_u32(triangle->material_index));
+    conditional_assign(&hit->position, hit_mask, ray_origin + t * ray_direction);
+    conditional_assign(&hit->normal, hit_mask, triangle_normal);
+  }
+}
+
+// NOTE(Ryan): Slab test; ray is inside box between the latest entry and earliest exit of the 3 slabs.
+// Division by 0 direction gives ±inf, which the min/max handle
+INTERNAL LaneU32
+intersect_bvh_node_bounds(BVHNode *node, LaneV3 ray_origin_over_direction, LaneV3 inv_ray_direction, LaneF32 hit_distance)
+{
+  LaneF32 tx0 = lane_f32(node->bounds_min.x) * inv_ray_direction.x - ray_origin_over_direction.x;
+  LaneF32 tx1 = lane_f32(node->bounds_max.x) * inv_ray_direction.x - ray_origin_over_direction.x;
+  LaneF32 ty0 = lane_f32(node->bounds_min.y) * inv_ray_direction.y - ray_origin_over_direction.y;
+  LaneF32 ty1 = lane_f32(node->bounds_max.y) * inv_ray_direction.y - ray_origin_over_direction.y;
+  LaneF32 tz0 = lane_f32(node->bounds_min.z) * inv_ray_direction.z - ray_origin_over_direction.z;
+  LaneF32 tz1 = lane_f32(node->bounds_max.z) * inv_ray_direction.z - ray_origin_over_direction.z;
+
+  LaneF32 t_enter = lane_f32_max(lane_f32_max(lane_f32_min(tx0, tx1), lane_f32_min(ty0, ty1)), lane_f32_min(tz0, tz1));
+  LaneF32 t_exit = lane_f32_min(lane_f32_min(lane_f32_max(tx0, tx1), lane_f32_max(ty0, ty1)), lane_f32_max(tz0, tz1));
+
+  // NOTE(Ryan): Box entirely behind ray, or further than closest hit so far, is culled
+  LaneU32 result = (t_enter <= t_exit && t_exit > RAY_MIN_HIT_DISTANCE && t_enter < hit_distance);
+
+  return result;
+}
+
+// NOTE(Ryan): Packet traversal; whole lane descends together and a node is only skipped if every active lane misses it.
+// Front-to-back order chosen from packet's average direction along split axis, so hit_distance shrinks early
+// and more far nodes are culled. Diffuse bounces make packets incoherent, but it's no worse than unordered
+typedef u32 BVH_PRIMITIVE;
+enum
+{
+  BVH_PRIMITIVE_SPHERE,
+  BVH_PRIMITIVE_TRIANGLE,
+};
+
+INTERNAL void
+intersect_bvh(World *world, BVH *bvh, BVH_PRIMITIVE primitive, LaneV3 ray_origin, LaneV3 ray_direction, LaneU32 lane_mask, 
+              LaneHit *hit)
+{
+  LaneV3 inv_ray_direction = lane_v3(1.0f / ray_direction.x, 1.0f / ray_direction.y, 1.0f / ray_direction.z);
+  // NOTE(Ryan): Precomputed so each slab is one multiply and subtract
+  LaneV3 ray_origin_over_direction = lane_v3_hadamard(ray_origin, inv_ray_direction);
+
+  b32 direction_is_negative[3] = {
+    (horizontal_add(ray_direction.x) < 0.0f),
+    (horizontal_add(ray_direction.y) < 0.0f),
+    (horizontal_add(ray_direction.z) < 0.0f),
+  };
+
+  // NOTE(Ryan): Each level pushes 1 far child, so depth bounds stack
+  u32 node_stack[BVH_MAX_DEPTH + 1];
+  u32 node_stack_count = 0;
+  node_stack[node_stack_count++] = 0;
+
+  while (node_stack_count > 0)
+  {
+    u32 node_index = node_stack[--node_stack_count];
+    BVHNode *node = &bvh->nodes[node_index];
+
+    LaneU32 node_mask = lane_mask & intersect_bvh_node_bounds(node, ray_origin_over_direction, inv_ray_direction, hit->distance);
+    if (mask_is_zeroed(node_mask))
+    {
+      continue;
+    }
+
+    if (node->primitive_count > 0)
+    {
+      if (primitive == BVH_PRIMITIVE_SPHERE)
+      {
+        intersect_spheres(&world->sphere_soa, node->offset, node->primitive_count, ray_origin, ray_direction, node_mask, 
+                          hit);
+      }
+      else
+      {
+        intersect_triangles(world->triangles + node->offset, node->primitive_count, ray_origin, ray_direction, hit);
+      }
+    }
+    else
+    {
+      u32 near_index = node_index + 1;
+      u32 far_index = node->offset;
+      if (direction_is_negative[node->split_axis])
+      {
+        SWAP(u32, near_index, far_index);
+      }
+
+      node_stack[node_stack_count++] = far_index;
+      node_stack[node_stack_count++] = near_index;
+    }
+  }
+}
+
+// NOTE(Ryan): Closest hit against everything; lanes outside lane_mask may be skipped by BVH
+INTERNAL LaneHit
+intersect_world(World *world, LaneV3 ray_origin, LaneV3 ray_direction, LaneU32 lane_mask)
+{
+  LaneHit result = {};
+  result.distance = lane_f32(f32_inf());
+  result.material_index = lane_u32(0);
+  result.position = lane_v3(0.0f, 0.0f, 0.0f);
+  result.normal = lane_v3(0.0f, 0.0f, 0.0f);
+
+  // NOTE(Ryan): Planes first, as a near ground hit lets BVH cull everything behind it
+  intersect_planes(&world->plane_soa, ray_origin, ray_direction, &result);
+
+  if (world->sphere_bvh.nodes != NULL)
+  {
+    intersect_bvh(world, &world->sphere_bvh, BVH_PRIMITIVE_SPHERE, ray_origin, ray_direction, lane_mask, &result);
+  }
+  else
+  {
+    intersect_spheres(&world->sphere_soa, 0, world->sphere_soa.count, ray_origin, ray_direction, lane_mask, &result);
+  }
+
+  if (world->triangle_bvh.nodes != NULL)
+  {
+    intersect_bvh(world, &world->triangle_bvh, BVH_PRIMITIVE_TRIANGLE, ray_origin, ray_direction, lane_mask, &result);
+  }
+  else
+  {
+    intersect_triangles(world->triangles, world->triangle_count, ray_origin, ray_direction, &result);
+  }
+
+  return result;
+}
+
+// NOTE(Ryan): Next-event estimation; radiance reaching each lane's hit directly from one light sphere, 
+// picked uniformly, through the diffuse part of its material.
+// Directions are sampled uniformly over the cone the sphere subtends, so pdf is 1 / cone solid angle, 
+// and a shadow ray checks nothing is nearer than the sphere along it.
+// Returned radiance still needs multiplying by the path's attenuation
+INTERNAL LaneV3
+sample_direct_light(World *world, LaneHit *hit, LaneV3 diffuse_colour, LaneU32 lane_mask, LaneRandom *random)
+{
+  LaneV3 result = lane_v3(0.0f, 0.0f, 0.0f);
+
+  u32 light_count = world->light_count;
+  SphereSoA *spheres = &world->sphere_soa;
+
+  // NOTE(Ryan): Top 16 bits scaled by count, so index is exact for any count below 65536
+  LaneU32 light_index = ((lane_random_next_u32(random) >> 16) * lane_u32(light_count)) >> 16;
+  LaneU32 sphere_index = lane_u32_gather((u8 *)world->light_sphere_indices, sizeof(u32), light_index);
+  LaneV3 light_p = lane_v3(lane_f32_gather((u8 *)spheres->x, sizeof(f32), sphere_index), 
+                           lane_f32_gather((u8 *)spheres->y, sizeof(f32), sphere_index), 
+                           lane_f32_gather((u8 *)spheres->z, sizeof(f32), sphere_index));
+  LaneF32 light_radius_squared = lane_f32_gather((u8 *)spheres->radius_squared, sizeof(f32), sphere_index);
+  LaneU32 light_material_index = lane_u32_gather((u8 *)spheres->material_index, sizeof(u32), sphere_index);
+
+  LaneV3 to_light = light_p - hit->position;
+  LaneF32 light_distance_squared = lane_v3_lengthsq(to_light);
+  // NOTE(Ryan): Points on or inside the light have no cone to sample
+  LaneU32 outside_mask = (light_distance_squared > light_radius_squared);
+  LaneF32 inv_light_distance = 1.0f / lane_f32_sqrt(lane_f32_select(outside_mask, lane_f32(1.0f), light_distance_squared));
+  LaneV3 light_axis = to_light * inv_light_distance;
+
+  LaneF32 cos_theta_max = lane_f32_sqrt(lane_f32_max(1.0f - light_radius_squared * inv_light_distance * inv_light_distance, 
+                                                     lane_f32(0.0f)));
+  LaneF32 cos_theta = 1.0f - lane_random_unilateral(random) * (1.0f - cos_theta_max);
+  LaneV3 light_direction = lane_v3_from_axis(light_axis, cos_theta, lane_random_unilateral(random));
+
+  LaneF32 cos_surface = lane_v3_dot(hit->normal, light_direction);
+  LaneU32 sample_mask = lane_mask & outside_mask & (cos_surface > 0.0f);
+  if (!mask_is_zeroed(sample_mask))
+  {
+    // NOTE(Ryan): Nearer root of ray against light sphere
+    LaneF32 projected_distance = lane_v3_dot(light_direction, to_light);
+    LaneF32 chord_half_squared = light_radius_squared - (light_distance_squared - projected_distance * projected_distance);
+    LaneF32 light_hit_distance = projected_distance - lane_f32_sqrt(lane_f32_max(chord_half_squared, lane_f32(0.0f)));
+
+    LaneHit shadow_hit = intersect_world(world, hit->position, light_direction, sample_mask);
+    // NOTE(Ryan): Light itself is in the scene, so unoccluded lanes hit it at (about) the analytic distance
+    sample_mask &= (shadow_hit.distance >= light_hit_distance * 0.999f);
+
+    LaneV3 light_emitted_colour = LANE_V3_GATHER(world->materials, emitted_colour, light_material_index);
+    LaneF32 cone_solid_angle = (2.0f * F32_PI) * (1.0f - cos_theta_max);
+    // diffuse BRDF is colour / π
+    LaneF32 weight = cos_surface * cone_solid_angle * ((f32)light_count / F32_PI);
+    conditional_assign(&result, sample_mask, lane_v3_hadamard(diffuse_colour, light_emitted_colour) * weight);
+  }
+
+  return result;
+}
+
+// NOTE(Ryan): Traces LANE_WIDTH rays at once; lanes are masked off on hitting the sky or losing Russian roulette.
+// Material is a mix of a mirror (probability scatter) and Lambertian diffuse, both reflecting reflected_colour.
+// Each bounce picks one lobe with that probability, so the attenuation needs no lobe weighting.
+// Diffuse directions are cosine weighted, which cancels the cosine and 1 / π of the BRDF.
+// Diffuse hits also sample a light directly; to avoid counting it twice, lights (emissive materials other than sky)
+// only add emission when reached by camera or mirror rays, where direct sampling can't help
+INTERNAL LaneV3
+cast_ray(WorkQueue *queue, World *world, LaneV3 ray_origin, LaneV3 ray_direction, LaneRandom *random)
+{
+  LaneV3 result = lane_v3(0.0f, 0.0f, 0.0f);
+  // starts as 1 as we have not attenuated the light at all
+  // i.e. when we initially cast a ray, there is no light absorption at all
+  LaneV3 attenuation = lane_v3(1.0f, 1.0f, 1.0f);
+
+  LaneU32 bounces_computed = lane_u32(0);
+  // this tells us which lane is active or terminated
+  LaneU32 lane_mask = lane_u32(0xFFFFFFFF);
+  // camera ray or previous bounce was mirror
+  LaneU32 count_light_emission_mask = lane_u32(0xFFFFFFFF);
+
+  u32 max_bounce_count = queue->max_bounce_count;
+  for (u32 bounce_count = 0;
+       bounce_count < max_bounce_count;
+       ++bounce_count)
+  {
+    // IMPORTANT(Ryan): As some items/rays in the lane may have terminated we cannot simply increment with ++
+    bounces_computed += (lane_u32(1) & lane_mask); 
+
+    LaneHit hit = intersect_world(world, ray_origin, ray_direction, lane_mask);
+
+    // NOTE(Ryan): Each lane may have hit a different material
+    LaneV3 material_emitted_colour = LANE_V3_GATHER(world->materials, emitted_colour, hit.material_index);
+    LaneV3 material_reflected_colour = LANE_V3_GATHER(world->materials, reflected_colour, hit.material_index);
+    LaneF32 material_scatter = LANE_F32_GATHER(world->materials, scatter, hit.material_index);
+
+    LaneU32 hit_sky_mask = (hit.material_index == 0u);
+
+    // NOTE(Ryan): Terminated lanes must not keep accumulating sky colour
+    LaneV3 emitted = lane_v3_hadamard(attenuation, material_emitted_colour);
+    conditional_assign(&result, lane_mask & (hit_sky_mask | count_light_emission_mask), result + emitted);
+
+    lane_mask = lane_u32_and_not(lane_mask, hit_sky_mask);
+    if (mask_is_zeroed(lane_mask))
+    {
+      break;
+    }
+
+    u32 bounce_dimension = RAY_RANDOM_DIMENSION_BOUNCE + bounce_count * RAY_RANDOM_DIMENSIONS_PER_BOUNCE;
+    if (world->light_count > 0)
+    {
+      random->counter = bounce_dimension + RAY_RANDOM_DIMENSION_LIGHT_PICK;
+      LaneV3 diffuse_colour = (1.0f - material_scatter) * material_reflected_colour;
+      LaneV3 direct = sample_direct_light(world, &hit, diffuse_colour, lane_mask, random);
+      conditional_assign(&result, lane_mask, result + lane_v3_hadamard(attenuation, direct));
+    }
+
+    random->counter = bounce_dimension + RAY_RANDOM_DIMENSION_LOBE;
+    LaneU32 mirror_mask = (lane_random_unilateral(random) < material_scatter);
+
+    LaneV3 mirror_direction = ray_direction - 2.0f * lane_v3_dot(ray_direction, hit.normal) * hit.normal;
+    // NOTE(Ryan): cos θ = sqrt(u) over the hemisphere is pdf cos θ / π
+    random->counter = bounce_dimension + RAY_RANDOM_DIMENSION_DIRECTION;
+    LaneF32 diffuse_cos_theta = lane_f32_sqrt(lane_random_unilateral(random));
+    LaneV3 diffuse_direction = lane_v3_from_axis(hit.normal, diffuse_cos_theta, lane_random_unilateral(random));
+
+    ray_origin = hit.position;
+    ray_direction = diffuse_direction;
+    conditional_assign(&ray_direction, mirror_mask, mirror_direction);
+    count_light_emission_mask = mirror_mask;
+
+    attenuation = lane_v3_hadamard(attenuation, material_reflected_colour);
+
+    // NOTE(Ryan): Survive with probability of the brightest channel, and scale survivors up to keep the estimate unbiased.
+    // Dim paths mostly end early, instead of every path spending max_bounce_count bounces.
+    // Black paths (e.g. off a light) can't add anything more, so always end
+    LaneF32 brightest = lane_f32_max(lane_f32_max(attenuation.x, attenuation.y), attenuation.z);
+    lane_mask &= (brightest > 0.0f);
+    if (bounce_count + 1 >= RAY_ROULETTE_MIN_BOUNCE_COUNT)
+    {
+      random->counter = bounce_dimension + RAY_RANDOM_DIMENSION_ROULETTE;
+      LaneF32 survival = lane_f32_min(lane_f32_max(brightest, lane_f32(RAY_ROULETTE_MIN_SURVIVAL)), lane_f32(1.0f));
+      lane_mask &= (lane_random_unilateral(random) < survival);
+      attenuation = attenuation * (1.0f / survival);
+    }
+
+    if (mask_is_zeroed(lane_mask))
+    {
+      break;
+    }
+
+    // black dots are if reflected and never hit sky
+    // could also be black say if purely red object attenuates the ray such that it does not reflect any green light so a green object will appear black as the red object as knocked out all the green
+  }
+
+  ATOMIC_ADD_RELAXED(&queue->bounces_computed, horizontal_add(bounces_computed));
+
+  return result;
+}
+
+INTERNAL f32
+exact_linear1_to_srgb1(f32 linear)
+{
+  f32 result = 0.0f;
+
+  linear = CLAMP(0.0f, linear, 1.0f);
+
+  result = linear * 12.92f;
+  if (linear > 0.0031308f)
+  {
+    result = 1.055f * f32_pow(linear, 1.0f / 2.4f) - 0.055f;
+  }
+
+  return result;
+}
+
+INTERNAL u32 *
+get_pixel_pointer(ImageU32 *image, u32 x, u32 y)
+{
+  u32 *result = NULL;
+  
+  result = image->pixels + y * image->width + x;
+
+  return result;
+}
+
+INTERNAL f32
+tonemap1(f32 linear, RAY_TONEMAP tonemap)
+{
+  f32 result = linear;
+
+  switch (tonemap)
+  {
+    case RAY_TONEMAP_REINHARD: result = linear / (1.0f + linear); break;
+    case RAY_TONEMAP_ACES: 
+    {
+      result = (linear * (2.51f * linear + 0.03f)) / (linear * (2.43f * linear + 0.59f) + 0.14f); 
+    } break;
+    default: break;
+  }
+
+  return result;
+}
+
+INTERNAL LaneF32
+lane_tonemap(LaneF32 linear, RAY_TONEMAP tonemap)
+{
+  LaneF32 result = linear;
+
+  switch (tonemap)
+  {
+    case RAY_TONEMAP_REINHARD: result = linear / (1.0f + linear); break;
+    // NOTE(Ryan): Narkowicz's fit of ACES filmic curve
+    case RAY_TONEMAP_ACES: 
+    {
+      result = (linear * (2.51f * linear + 0.03f)) / (linear * (2.43f * linear + 0.59f) + 0.14f); 
+    } break;
+    default: break;
+  }
+
+  return result;
+}
+
+// NOTE(Ryan): x^(1/2.4) segment fitted as a sum of x^(1/2), x^(1/4), x^(1/8) and x, so just 3 sqrts and no table.
+// Max absolute error vs. exact_linear1_to_srgb1() is 9.7e-4 (0.25 of an 8 bit step) at the segment's low end,
+// so after rounding to 8 bits output is exact or off by 1 where exact value is within 0.25 of a rounding boundary
+INTERNAL LaneF32
+lane_linear1_to_srgb1(LaneF32 linear)
+{
+  linear = lane_f32_clamp01(linear);
+
+  LaneF32 root2 = lane_f32_sqrt(linear);
+  LaneF32 root4 = lane_f32_sqrt(root2);
+  LaneF32 root8 = lane_f32_sqrt(root4);
+  LaneF32 curve = 0.662002687f * root2 + 0.684122060f * root4 - 0.323583601f * root8 - 0.0225411470f * linear;
+
+  LaneF32 result = lane_f32_select(linear <= 0.0031308f, curve, linear * 12.92f);
+
+  return result;
+}
+
+// NOTE(Ryan): 4x4 Bayer matrix as offsets in (-0.5, 0.5) of an 8 bit step.
+// Breaks up banding in smooth gradients (e.g. sky) without adding temporal noise, as it's fixed per pixel
+GLOBAL f32 ray_dither_offsets[16] =
+{
+  ( 0.5f / 16.0f) - 0.5f, ( 8.5f / 16.0f) - 0.5f, ( 2.5f / 16.0f) - 0.5f, (10.5f / 16.0f) - 0.5f,
+  (12.5f / 16.0f) - 0.5f, ( 4.5f / 16.0f) - 0.5f, (14.5f / 16.0f) - 0.5f, ( 6.5f / 16.0f) - 0.5f,
+  ( 3.5f / 16.0f) - 0.5f, (11.5f / 16.0f) - 0.5f, ( 1.5f / 16.0f) - 0.5f, ( 9.5f / 16.0f) - 0.5f,
+  (15.5f / 16.0f) - 0.5f, ( 7.5f / 16.0f) - 0.5f, (13.5f / 16.0f) - 0.5f, ( 5.5f / 16.0f) - 0.5f,
+};
+
+INTERNAL u32
+resolve_pixel_exact(WorkQueue *queue, V3 radiance, u32 sample_count, u32 x, u32 y)
+{
+  f32 dither_offset = queue->dither ? ray_dither_offsets[(y & 3) * 4 + (x & 3)] : 0.0f;
+  V3 colour = vec3_f32_mul(radiance, 1.0f / (f32)MAX(sample_count, 1));
+
+  V4 bmp_srgb255 = vec4_f32(
+    255.0f, 
+    CLAMP(0.0f, 255.0f * exact_linear1_to_srgb1(tonemap1(colour.r, queue->tonemap)) + dither_offset, 255.0f),
+    CLAMP(0.0f, 255.0f * exact_linear1_to_srgb1(tonemap1(colour.g, queue->tonemap)) + dither_offset, 255.0f),
+    CLAMP(0.0f, 255.0f * exact_linear1_to_srgb1(tonemap1(colour.b, queue->tonemap)) + dither_offset, 255.0f)
+  );
+
+  u32 result = u32_pack_4x8(bmp_srgb255);
+
+  return result;
+}
+
+// NOTE(Ryan): Converts a row of a tile from accumulated radiance to 0xAARRGGBB, LANE_WIDTH pixels at a time.
+// Accumulation is AoS, so each lane group is transposed on load; cheap next to 3 channels of sqrts and a divide
+INTERNAL void
+resolve_tile_row(WorkQueue *queue, Accumulation *accumulation, ImageU32 *image, u32 y, u32 x_min, u32 one_past_x_max)
+{
+  u32 *out = get_pixel_pointer(image, x_min, y);
+  u32 accumulation_index = y * accumulation->width + x_min;
+
+  if (queue->use_exact_srgb)
+  {
+    for (u32 x = x_min; x < one_past_x_max; x += 1)
+    {
+      *out++ = resolve_pixel_exact(queue, accumulation->radiance[accumulation_index], 
+                                   accumulation->sample_counts[accumulation_index], x, y);
+      accumulation_index += 1;
+    }
+  }
+  else
+  {
+    RAY_TONEMAP tonemap = queue->tonemap;
+    b32 dither = queue->dither;
+
+    for (u32 x = x_min; x < one_past_x_max; x += LANE_WIDTH)
+    {
+      u32 pixel_count = MIN(LANE_WIDTH, one_past_x_max - x);
+
+      // NOTE(Ryan): Unused tail lanes resolve to black and are dropped on store
+      f32 red[LANE_WIDTH] = {}, green[LANE_WIDTH] = {}, blue[LANE_WIDTH] = {};
+      u32 sample_counts[LANE_WIDTH] = {};
+      f32 dither_offsets[LANE_WIDTH] = {};
+      for (u32 lane_i = 0; lane_i < pixel_count; lane_i += 1)
+      {
+        V3 radiance = accumulation->radiance[accumulation_index + lane_i];
+        red[lane_i] = radiance.r;
+        green[lane_i] = radiance.g;
+        blue[lane_i] = radiance.b;
+        sample_counts[lane_i] = accumulation->sample_counts[accumulation_index + lane_i];
+        dither_offsets[lane_i] = dither ? ray_dither_offsets[(y & 3) * 4 + ((x + lane_i) & 3)] : 0.0f;
+      }
+
+      LaneF32 contrib = 1.0f / lane_f32_max(lane_f32_from_u32(lane_u32_load(sample_counts)), lane_f32(1.0f));
+      LaneF32 dither_offset = lane_f32_load(dither_offsets);
+
+      LaneF32 channels[3] = {lane_f32_load(red), lane_f32_load(green), lane_f32_load(blue)};
+      LaneU32 channels255[3] = {};
+      for (u32 channel_i = 0; channel_i < 3; channel_i += 1)
+      {
+        LaneF32 srgb = lane_linear1_to_srgb1(lane_tonemap(channels[channel_i] * contrib, tonemap));
+        LaneF32 srgb255 = 255.0f * lane_f32_clamp01(srgb + dither_offset * (1.0f / 255.0f));
+        channels255[channel_i] = lane_u32_round_f32(srgb255);
+      }
+
+      LaneU32 packed = lane_u32(0xff000000) | (channels255[0] << 16) | (channels255[1] << 8) | channels255[2];
+
+      u32 pixels[LANE_WIDTH];
+      lane_u32_store(pixels, packed);
+      MEMORY_COPY(out, pixels, pixel_count * sizeof(u32));
+
+      out += pixel_count;
+      accumulation_index += pixel_count;
+    }
+  }
+}
+
+INTERNAL void
+resolve_tile(WorkOrder *order)
+{
+  for (u32 y = order->y_min; y < order->one_past_y_max; y += 1)
+  {
+    resolve_tile_row(order->queue, order->accumulation, order->image, y, order->x_min, order->one_past_x_max);
+  }
+}
+
+// NOTE(Ryan): Standard error of pixel's mean luminance, scaled by slope of sqrt() at the mean.
+// sqrt() roughly matches sRGB's response, so this is the error as seen on display (0.01 is ~2.5 levels of 8 bit),
+// and dark pixels don't need a tiny absolute error like a relative one would ask for
+#define RAY_LUMINANCE_WEIGHTS vec3_f32(0.2126f, 0.7152f, 0.0722f)
+#define RAY_MIN_LUMINANCE 0.0001f
+
+INTERNAL f32
+pixel_error(V3 radiance, f32 luminance_squared, u32 sample_count)
+{
+  f32 result = f32_inf();
+
+  if (sample_count > 1)
+  {
+    f32 inv_sample_count = 1.0f / (f32)sample_count;
+    f32 mean = vec3_f32_dot(radiance, RAY_LUMINANCE_WEIGHTS) * inv_sample_count;
+    // NOTE(Ryan): Unbiased sample variance, clamped as cancellation can take it slightly negative
+    f32 variance = MAX(0.0f, (luminance_squared * inv_sample_count - mean * mean) * 
+                             ((f32)sample_count / (f32)(sample_count - 1)));
+    f32 standard_error = f32_sqrt(variance * inv_sample_count);
+
+    result = standard_error / (2.0f * f32_sqrt(MAX(mean, RAY_MIN_LUMINANCE)));
+  }
+
+  return result;
+}
+
+// NOTE(Ryan): One pass; adds rays_per_pixel_per_pass samples to each unconverged pixel's running sums,
+// then rewrites those pixels in image with the new average, so image always holds a complete estimate.
+// IMPORTANT(Ryan): A handful of samples can all miss a rare bright path and look converged,
+// so a pixel must have RAY_MIN_ADAPTIVE_SAMPLE_COUNT before it may stop
+#define RAY_MIN_ADAPTIVE_SAMPLE_COUNT 32
+INTERNAL void
+render_tile(WorkOrder *order)
+{
+  WorkQueue *queue = order->queue;
+
+  // NOTE(Ryan): Skipped tiles keep previous pass's estimate
+  if (ATOMIC_LOAD_RELAXED(&queue->cancel_requested))
+  {
+    return;
+  }
+
+  World *world = order->world; 
+  ImageU32 *image = order->image;
+  Accumulation *accumulation = order->accumulation;
+  u32 x_min = order->x_min;
+  u32 y_min = order->y_min;
+  u32 one_past_x_max = order->one_past_x_max; 
+  u32 one_past_y_max = order->one_past_y_max;
+
+  u32 random_seed = queue->random_seed;
+
+  // right hand rule here to derive these?
+  /* rays around the camera. so, want the camera to have a coordinate system, i.e. set of axis
+   */
+  LaneV3 camera_pos = lane_v3(0.0f, -10.0f, 1.0f);
+  // we are looking through -'z', i.e. opposite direction to what our camera z axis is
+  LaneV3 camera_z = lane_v3_noz(camera_pos);
+  // cross our z with universal z
+  LaneV3 camera_x = lane_v3_noz(lane_v3_cross(lane_v3(0.0f, 0.0f, 1.0f), camera_z));
+  LaneV3 camera_y = lane_v3_noz(lane_v3_cross(camera_z, camera_x));
+
+  f32 film_dist = 1.0f;
+  f32 film_w = 1.0f;
+  f32 film_h = 1.0f;
+  // aspect ratio correction
+  if (image->width > image->height)
+  {
+    film_h = film_w * ((r32)image->height / (r32)image->width);  
+  }
+  if (image->height > image->width)
+  {
+    film_w = film_h * ((r32)image->width / (r32)image->height);  
+  }
+  f32 half_film_w = 0.5f * film_w;
+  f32 half_film_h = 0.5f * film_h;
+  LaneV3 film_centre = camera_pos - (film_dist * camera_z);
+
+  f32 half_pix_w = 0.5f / image->width;
+  f32 half_pix_h = 0.5f / image->height;
+
+  // NOTE(Ryan): Round up so a rays_per_pixel_per_pass below LANE_WIDTH still casts a full lane
+  u32 lane_ray_count = (queue->rays_per_pixel_per_pass + LANE_WIDTH - 1) / LANE_WIDTH;
+  f32 target_error = queue->target_error;
+  b32 skip_converged_pixels = queue->skip_converged_pixels;
+  LaneV3 luminance_weights = lane_v3_from_vec3_f32(RAY_LUMINANCE_WEIGHTS);
+
+  u32 unconverged_pixel_count = 0;
+
+  for (u32 y = y_min; 
+       y < one_past_y_max;
+       ++y)
+  {
+    u32 accumulation_index = y * accumulation->width + x_min;
+
+    // for camera, z axis is looking from, x and y determine plane aperture 
+    r32 film_y = (-1.0f + 2.0f * ((r32)y / (r32)image->height)) + half_pix_h;
+    for (u32 x = x_min; 
+         x < one_past_x_max; 
+         ++x, ++accumulation_index)
+    {
+      V3 *radiance = &accumulation->radiance[accumulation_index];
+      f32 *luminance_squared = &accumulation->luminance_squared[accumulation_index];
+      u32 *sample_count = &accumulation->sample_counts[accumulation_index];
+
+      // NOTE(Ryan): Converged pixels keep their estimate already in image
+      if (skip_converged_pixels && *sample_count >= RAY_MIN_ADAPTIVE_SAMPLE_COUNT &&
+          pixel_error(*radiance, *luminance_squared, *sample_count) <= target_error)
+      {
+        continue;
+      }
+
+      r32 film_x = (-1.0f + 2.0f * ((r32)x / (r32)image->width)) + half_pix_w;
+
+      LaneV3 lane_colour = lane_v3(0.0f, 0.0f, 0.0f);
+      LaneF32 lane_luminance_squared = lane_f32(0.0f);
+      // NOTE(Ryan): Samples numbered per pixel, so a pixel's image depends only on how many samples it has taken,
+      // not on tile size, tile order, thread count or which pixels around it were skipped
+      LaneU32 stream_key = lane_random_stream_key(random_seed, y * image->width + x);
+      LaneU32 sample_index = lane_u32(*sample_count) + lane_u32_index();
+      // move this loop into a function cast_sample_rays()
+      for (u32 ray_index = 0;
+          ray_index < lane_ray_count;
+          ++ray_index)
+      {
+        LaneRandom random = lane_random_seed(stream_key, sample_index);
+        sample_index += lane_u32(LANE_WIDTH);
+
+        // we can get some anti-aliasing here
+        random.counter = RAY_RANDOM_DIMENSION_JITTER;
+        LaneF32 jitter_offx = film_x + lane_random_bilateral(&random) * half_pix_w;
+        LaneF32 jitter_offy = film_y + lane_random_bilateral(&random) * half_pix_h;
+
+        // need to do half width as from centre
+        LaneV3 film_p = film_centre + (jitter_offx * half_film_w * camera_x) + (jitter_offy * half_film_h * camera_y);
+        LaneV3 ray_origin = camera_pos;
+        LaneV3 ray_direction = lane_v3_noz(film_p - camera_pos);
+
+        // colour is a sum of a series of ray casts
+        LaneV3 sample_colour = cast_ray(queue, world, ray_origin, ray_direction, &random);
+        LaneF32 sample_luminance = lane_v3_dot(sample_colour, luminance_weights);
+        lane_colour += sample_colour;
+        lane_luminance_squared += sample_luminance * sample_luminance;
+      }
+
+      *radiance = vec3_f32_add(*radiance, horizontal_add(lane_colour));
+      *luminance_squared += horizontal_add(lane_luminance_squared);
+      *sample_count += lane_ray_count * LANE_WIDTH;
+
+      if (*sample_count < RAY_MIN_ADAPTIVE_SAMPLE_COUNT || 
+          pixel_error(*radiance, *luminance_squared, *sample_count) > target_error)
+      {
+        unconverged_pixel_count += 1;
+      }
+
+      //printf("\rRaycasting %d%%...    ", (y * 100 / output_height));
+    }
+
+    // NOTE(Ryan): Whole row at once so resolve runs LANE_WIDTH pixels wide; 
+    // dither is fixed per pixel, so converged pixels skipped above come out unchanged
+    resolve_tile_row(queue, accumulation, image, y, x_min, one_past_x_max);
+  }
+  
+  order->unconverged_pixel_count = unconverged_pixel_count;
+
+  ATOMIC_ADD_RELAXED(&queue->tiles_retired_count, 1);
+}
+
+EXPORT void
+RAY_KERNEL_NAME(render_tile)(WorkOrder *order)
+{
+  render_tile(order);
+}
+
+EXPORT void
+RAY_KERNEL_NAME(resolve_tile)(WorkOrder *order)
+{
+  resolve_tile(order);
+}
@@ -0,0 +1,232 @@
+// SPDX-License-Identifier: zlib-acknowledgement
+#pragma once
+
+// NOTE(Ryan): Wavefront OBJ subset: 'v' positions and 'f' faces.
+// Faces may be 'a', 'a/b', 'a//c' or 'a/b/c', with negative indices relative to end of vertex list so far.
+// Polygons are fanned into triangles. Normals, texture coordinates, groups and materials are ignored.
+//
+// File is mapped rather than read, and walked a line at a time with each line's tokens split into
+// a temporary region of the arena, so memory use is the output buffers plus one line regardless of file size.
+// Two passes: first counts, so output buffers can be exactly sized SoA arrays
+
+typedef struct Mesh Mesh;
+struct Mesh
+{
+  u32 vertex_count;
+  f32 *vertex_x;
+  f32 *vertex_y;
+  f32 *vertex_z;
+
+  u32 triangle_count;
+  u32 *indices; // 3 per triangle
+};
+
+INTERNAL String8
+obj_next_line(String8 *remaining)
+{
+  // NOTE(Ryan): Runs over every byte of the file, so a plain byte scan rather than general substring match
+  u8 *newline = (u8 *)memchr(remaining->str, '\n', remaining->size);
+  u64 line_end = (newline != NULL) ? (u64)(newline - remaining->str) : remaining->size;
+  String8 result = s8_prefix(*remaining, line_end);
+  *remaining = s8_advance(*remaining, line_end + 1);
+
+  if (result.size > 0 && result.str[result.size - 1] == '\r')
+  {
+    result = s8_chop(result, 1);
+  }
+
+  return result;
+}
+
+// NOTE(Ryan): s8_split() gives empty strings for repeated whitespace, so gather only non-empty tokens
+#define OBJ_MAX_LINE_TOKEN_COUNT 64
+INTERNAL u32
+obj_split_line(MemArena *arena, String8 line, String8 *tokens)
+{
+  u32 result = 0;
+
+  String8 splitters[] = {s8_lit(" "), s8_lit("\t")};
+  String8List split = s8_split(arena, line, ARRAY_COUNT(splitters), splitters);
+  for (String8Node *node = split.first; node != NULL && result < OBJ_MAX_LINE_TOKEN_COUNT; node = node->next)
+  {
+    if (node->string.size > 0)
+    {
+      tokens[result++] = node->string;
+    }
+  }
+
+  return result;
+}
+
+// NOTE(Ryan): Returns U32_MAX if out of range
+INTERNAL u32
+obj_resolve_index(String8 token, u32 vertex_count)
+{
+  u32 result = U32_MAX;
+
+  // NOTE(Ryan): Parse stops at '/', so only position index is read
+  s64 index = s8_to_s64(token);
+  s64 resolved = (index < 0) ? ((s64)vertex_count + index) : (index - 1);
+  if (index != 0 && resolved >= 0 && resolved < (s64)vertex_count)
+  {
+    result = (u32)resolved;
+  }
+
+  return result;
+}
+
+INTERNAL b32
+obj_load_mesh(MemArena *arena, String8 file_name, Mesh *mesh)
+{
+  b32 result = false;
+  MEMORY_ZERO_STRUCT(mesh);
+
+  String8 file = s8_map_entire_file(file_name);
+  if (file.str != NULL)
+  {
+    String8 tokens[OBJ_MAX_LINE_TOKEN_COUNT] = {};
+
+    u32 vertex_count = 0;
+    u32 triangle_count = 0;
+    for (String8 remaining = file; remaining.size > 0; )
+    {
+      String8 line = obj_next_line(&remaining);
+      if (line.size < 2 || (line.str[1] != ' ' && line.str[1] != '\t'))
+      {
+        continue;
+      }
+
+      if (line.str[0] == 'v')
+      {
+        vertex_count += 1;
+      }
+      else if (line.str[0] == 'f')
+      {
+        MemArenaTemp temp = mem_arena_temp_begin(arena);
+        u32 token_count = obj_split_line(arena, line, tokens);
+        if (token_count >= 4)
+        {
+          triangle_count += token_count - 3;
+        }
+        mem_arena_temp_end(temp);
+      }
+    }
+
+    mesh->vertex_x = MEM_ARENA_PUSH_ARRAY(arena, f32, vertex_count);
+    mesh->vertex_y = MEM_ARENA_PUSH_ARRAY(arena, f32, vertex_count);
+    mesh->vertex_z = MEM_ARENA_PUSH_ARRAY(arena, f32, vertex_count);
+    mesh->indices = MEM_ARENA_PUSH_ARRAY(arena, u32, 3 * triangle_count);
+
+    u32 skipped_face_count = 0;
+    for (String8 remaining = file; remaining.size > 0; )
+    {
+      String8 line = obj_next_line(&remaining);
+      if (line.size < 2 || (line.str[1] != ' ' && line.str[1] != '\t'))
+      {
+        continue;
+      }
+
+      MemArenaTemp temp = mem_arena_temp_begin(arena);
+      u32 token_count = obj_split_line(arena, line, tokens);
+
+      if (line.str[0] == 'v' && token_count >= 4)
+      {
+        mesh->vertex_x[mesh->vertex_count] = (f32)s8_to_f64(tokens[1]);
+        mesh->vertex_y[mesh->vertex_count] = (f32)s8_to_f64(tokens[2]);
+        mesh->vertex_z[mesh->vertex_count] = (f32)s8_to_f64(tokens[3]);
+        mesh->vertex_count += 1;
+      }
+      else if (line.str[0] == 'f' && token_count >= 4)
+      {
+        // NOTE(Ryan): Fan around first vertex. Indices resolve against vertices seen so far
+        u32 first_index = obj_resolve_index(tokens[1], mesh->vertex_count);
+        for (u32 token_i = 2; token_i + 1 < token_count; token_i += 1)
+        {
+          u32 index1 = obj_resolve_index(tokens[token_i], mesh->vertex_count);
+          u32 index2 = obj_resolve_index(tokens[token_i + 1], mesh->vertex_count);
+          if (first_index == U32_MAX || index1 == U32_MAX || index2 == U32_MAX)
+          {
+            skipped_face_count += 1;
+            break;
+          }
+
+          u32 *triangle_indices = &mesh->indices[3 * mesh->triangle_count];
+          triangle_indices[0] = first_index;
+          triangle_indices[1] = index1;
+          triangle_indices[2] = index2;
+          mesh->triangle_count += 1;
+        }
+      }
+
+      mem_arena_temp_end(temp);
+    }
+
+    if (skipped_face_count > 0)
+    {
+      WARN("OBJ faces reference vertices out of range.", (char *)file_name.str);
+    }
+
+    s8_unmap_entire_file(file);
+
+    result = (mesh->triangle_count > 0);
+  }
+  else
+  {
+    WARN("Failed to map OBJ file.", strerror(errno));
+  }
+
+  return result;
+}
+
+// NOTE(Ryan): Appends to World as triangles with precomputed edges, uniformly scaled so largest extent is 'size'
+// and resting on z = 0 plane centred on origin. OBJ is conventionally y-up, so (x, y, z) becomes (x, -z, y).
+// Degenerate triangles are dropped as they have no normal
+INTERNAL void
+mesh_add_to_world(MemArena *arena, World *world, Mesh *mesh, f32 size, u32 material_index)
+{
+  V3 bounds_min = vec3_f32(f32_inf(), f32_inf(), f32_inf());
+  V3 bounds_max = vec3_f32(-f32_inf(), -f32_inf(), -f32_inf());
+  for (u32 vertex_i = 0; vertex_i < mesh->vertex_count; vertex_i += 1)
+  {
+    V3 p = vec3_f32(mesh->vertex_x[vertex_i], -mesh->vertex_z[vertex_i], mesh->vertex_y[vertex_i]);
+    bounds_min = vec3_f32(MIN(bounds_min.x, p.x), MIN(bounds_min.y, p.y), MIN(bounds_min.z, p.z));
+    bounds_max = vec3_f32(MAX(bounds_max.x, p.x), MAX(bounds_max.y, p.y), MAX(bounds_max.z, p.z));
+  }
+
+  V3 extent = vec3_f32_sub(bounds_max, bounds_min);
+  f32 max_extent = MAX(extent.x, MAX(extent.y, extent.z));
+  f32 scale = (max_extent > 0.0f) ? (size / max_extent) : 1.0f;
+  V3 offset = vec3_f32(-0.5f * (bounds_min.x + bounds_max.x), -0.5f * (bounds_min.y + bounds_max.y), -bounds_min.z);
+
+  Triangle *triangles = MEM_ARENA_PUSH_ARRAY(arena, Triangle, world->triangle_count + mesh->triangle_count);
+  MEMORY_COPY(triangles, world->triangles, world->triangle_count * sizeof(Triangle));
+
+  u32 triangle_count = world->triangle_count;
+  for (u32 triangle_i = 0; triangle_i < mesh->triangle_count; triangle_i += 1)
+  {
+    V3 vertices[3] = {};
+    for (u32 corner_i = 0; corner_i < 3; corner_i += 1)
+    {
+      u32 index = mesh->indices[3 * triangle_i + corner_i];
+      V3 p = vec3_f32(mesh->vertex_x[index], -mesh->vertex_z[index], mesh->vertex_y[index]);
+      vertices[corner_i] = vec3_f32_mul(vec3_f32_add(p, offset), scale);
+    }
+
+    Triangle *triangle = &triangles[triangle_count];
+    triangle->vertex0 = vertices[0];
+    triangle->edge1 = vec3_f32_sub(vertices[1], vertices[0]);
+    triangle->edge2 = vec3_f32_sub(vertices[2], vertices[0]);
+    triangle->material_index = material_index;
+
+    V3 normal = vec3_f32_cross(triangle->edge1, triangle->edge2);
+    f32 normal_length = vec3_f32_length(normal);
+    if (normal_length > 0.0f)
+    {
+      triangle->normal = vec3_f32_mul(normal, 1.0f / normal_length);
+      triangle_count += 1;
+    }
+  }
+
+  world->triangles = triangles;
+  world->triangle_count = triangle_count;
+}
@@ -0,0 +1,1945 @@
+// SPDX-License-Identifier: zlib-acknowledgement
+
+// NOTE(Ryan): Host side of ray tracer, built for baseline x86-64.
+// Hot loop lives in ray-kernel.cpp, linked in once per ISA and chosen at startup via cpuid
+
+#include "base-inc.h"
+#include "ray.h"
+#include "ray-bvh.h"
+#include "ray-obj.h"
+
+#include <time.h>
+#include <sys/sysinfo.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+INTERNAL ImageU32
+create_image_u32(u32 width, u32 height)
+{
+  ImageU32 result = {};
+
+  result.width = width;
+  result.height = height;
+
+  result.pixels = (u32 *)malloc(width * height * sizeof(u32));
+  if (result.pixels == NULL)
+  {
+    WARN("Failed to allocate image pixels.", strerror(errno));
+  }
+
+  return result;
+}
+
+INTERNAL Accumulation
+create_accumulation(MemArena *arena, u32 width, u32 height)
+{
+  Accumulation result = {};
+
+  result.width = width;
+  result.height = height;
+  result.radiance = MEM_ARENA_PUSH_ARRAY_ZERO(arena, V3, width * height);
+  result.luminance_squared = MEM_ARENA_PUSH_ARRAY_ZERO(arena, f32, width * height);
+  result.sample_counts = MEM_ARENA_PUSH_ARRAY_ZERO(arena, u32, width * height);
+
+  return result;
+}
+
+// NOTE(Ryan): Written aside then renamed over, so a viewer polling the file never sees a partial image.
+// Aside name keeps extension, as that picks the format
+INTERNAL void
+write_image_u32_snapshot(MemArena *arena, JobSystem *job_system, ImageU32 *image, char const *file_name)
+{
+  char temp_file_name[256] = {};
+  char const *extension = strrchr(file_name, '.');
+  if (extension == NULL)
+  {
+    extension = file_name + strlen(file_name);
+  }
+  snprintf(temp_file_name, sizeof(temp_file_name), "%.*s.tmp%s", (int)(extension - file_name), file_name, extension);
+
+  if (!image_write(arena, job_system, s8_cstring(temp_file_name), image->pixels, image->width, image->height))
+  {
+    WARN("Failed to write image.", strerror(errno));
+  }
+  else if (rename(temp_file_name, file_name) != 0)
+  {
+    WARN("Failed to replace snapshot.", strerror(errno));
+  }
+}
+
+// NOTE(Ryan): Every host timing derives from linux_get_ns(); RAW isn't slewed by NTP mid-benchmark
+INTERNAL u64
+get_wall_clock(void)
+{
+  u64 result = linux_get_ns() / 1000000ull;
+
+  return result;
+}
+
+// NOTE(Ryan): Only a backstop; Russian roulette ends nearly every path well before this
+#define RAY_MAX_BOUNCE_COUNT 32
+
+typedef u32 RAY_TILE_ORDER;
+enum
+{
+  RAY_TILE_ORDER_SPIRAL,
+  RAY_TILE_ORDER_ROW,
+  RAY_TILE_ORDER_MORTON,
+  RAY_TILE_ORDER_HILBERT,
+  RAY_TILE_ORDER_COUNT,
+};
+
+GLOBAL const char *ray_tile_order_names[RAY_TILE_ORDER_COUNT] = {"spiral", "row", "morton", "hilbert"};
+
+// NOTE(Ryan): Per pixel bytes a tile's pass touches: accumulated radiance, luminance squared, sample count, output
+#define RAY_TILE_BYTES_PER_PIXEL (sizeof(V3) + sizeof(f32) + sizeof(u32) + sizeof(u32))
+
+// NOTE(Ryan): Largest power of 2 square whose pixels fit in half of L1d, leaving the other half for BVH nodes 
+// and materials every ray of the tile revisits. 64 if sysfs doesn't report cache sizes
+INTERNAL u32
+ray_tile_size_from_cache(LinuxCacheInfo *cache_info)
+{
+  u32 result = 64;
+
+  if (cache_info->l1d_size != 0)
+  {
+    u32 budget = cache_info->l1d_size / 2;
+    result = 8;
+    while (result < 256 && (result * 2) * (result * 2) * RAY_TILE_BYTES_PER_PIXEL <= budget)
+    {
+      result *= 2;
+    }
+  }
+
+  return result;
+}
+
+INTERNAL u32
+u32_compact_even_bits(u32 x)
+{
+  x &= 0x55555555;
+  x = (x | (x >> 1)) & 0x33333333;
+  x = (x | (x >> 2)) & 0x0F0F0F0F;
+  x = (x | (x >> 4)) & 0x00FF00FF;
+  x = (x | (x >> 8)) & 0x0000FFFF;
+
+  return x;
+}
+
+// NOTE(Ryan): Z-order over the enclosing power of 2 square, skipping codes outside the grid.
+// Consecutive tiles stay spatially close at every scale, so workers share BVH nodes and scene data in L2/L3
+INTERNAL u32 *
+create_morton_tile_order(MemArena *arena, u32 tile_count_x, u32 tile_count_y)
+{
+  u32 tile_count = tile_count_x * tile_count_y;
+  u32 *result = MEM_ARENA_PUSH_ARRAY(arena, u32, tile_count);
+
+  u32 side = 1;
+  while (side < MAX(tile_count_x, tile_count_y))
+  {
+    side *= 2;
+  }
+
+  u32 order_count = 0;
+  for (u32 code = 0; code < side * side && order_count < tile_count; code += 1)
+  {
+    u32 x = u32_compact_even_bits(code);
+    u32 y = u32_compact_even_bits(code >> 1);
+    if (x < tile_count_x && y < tile_count_y)
+    {
+      result[order_count++] = y * tile_count_x + x;
+    }
+  }
+
+  return result;
+}
+
+// NOTE(Ryan): As Morton, but consecutive tiles are always adjacent (no long jumps between quadrants).
+// Curve index to (x, y) as in Wikipedia's "Hilbert curve" d2xy()
+INTERNAL u32 *
+create_hilbert_tile_order(MemArena *arena, u32 tile_count_x, u32 tile_count_y)
+{
+  u32 tile_count = tile_count_x * tile_count_y;
+  u32 *result = MEM_ARENA_PUSH_ARRAY(arena, u32, tile_count);
+
+  u32 side = 1;
+  while (side < MAX(tile_count_x, tile_count_y))
+  {
+    side *= 2;
+  }
+
+  u32 order_count = 0;
+  for (u32 curve_index = 0; curve_index < side * side && order_count < tile_count; curve_index += 1)
+  {
+    u32 x = 0, y = 0;
+    u32 t = curve_index;
+    for (u32 quadrant_size = 1; quadrant_size < side; quadrant_size *= 2)
+    {
+      u32 rx = 1 & (t / 2);
+      u32 ry = 1 & (t ^ rx);
+      // NOTE(Ryan): Rotate quadrant so sub-curve's ends meet neighbours'
+      if (ry == 0)
+      {
+        if (rx == 1)
+        {
+          x = quadrant_size - 1 - x;
+          y = quadrant_size - 1 - y;
+        }
+        SWAP(u32, x, y);
+      }
+      x += quadrant_size * rx;
+      y += quadrant_size * ry;
+      t /= 4;
+    }
+
+    if (x < tile_count_x && y < tile_count_y)
+    {
+      result[order_count++] = y * tile_count_x + x;
+    }
+  }
+
+  return result;
+}
+
+// NOTE(Ryan): Walks outwards from centre tile (right 1, down 1, left 2, up 2, right 3, ...),
+// skipping positions outside the grid, so the middle of the image, where the subject usually is, resolves first
+INTERNAL u32 *
+create_spiral_tile_order(MemArena *arena, u32 tile_count_x, u32 tile_count_y)
+{
+  u32 tile_count = tile_count_x * tile_count_y;
+  u32 *result = MEM_ARENA_PUSH_ARRAY(arena, u32, tile_count);
+
+  s32 x = (s32)(tile_count_x - 1) / 2;
+  s32 y = (s32)(tile_count_y - 1) / 2;
+  s32 dir_x = 1, dir_y = 0;
+  u32 leg_length = 1;
+
+  u32 order_count = 0;
+  while (order_count < tile_count)
+  {
+    // NOTE(Ryan): Leg length grows every 2 turns
+    for (u32 leg_i = 0; leg_i < 2 && order_count < tile_count; leg_i += 1)
+    {
+      for (u32 step_i = 0; step_i < leg_length && order_count < tile_count; step_i += 1)
+      {
+        if (x >= 0 && x < (s32)tile_count_x && y >= 0 && y < (s32)tile_count_y)
+        {
+          result[order_count++] = (u32)y * tile_count_x + (u32)x;
+        }
+        x += dir_x;
+        y += dir_y;
+      }
+
+      // NOTE(Ryan): Turn clockwise
+      s32 temp = dir_x;
+      dir_x = -dir_y;
+      dir_y = temp;
+    }
+    leg_length += 1;
+  }
+
+  return result;
+}
+
+INTERNAL u32 *
+create_row_tile_order(MemArena *arena, u32 tile_count_x, u32 tile_count_y)
+{
+  u32 tile_count = tile_count_x * tile_count_y;
+  u32 *result = MEM_ARENA_PUSH_ARRAY(arena, u32, tile_count);
+
+  for (u32 tile_i = 0; tile_i < tile_count; tile_i += 1)
+  {
+    result[tile_i] = tile_i;
+  }
+
+  return result;
+}
+
+// NOTE(Ryan): Indices into row major tiles, in the order they're submitted each pass
+INTERNAL u32 *
+create_tile_order(MemArena *arena, RAY_TILE_ORDER tile_order, u32 tile_count_x, u32 tile_count_y)
+{
+  u32 *result = NULL;
+
+  switch (tile_order)
+  {
+    case RAY_TILE_ORDER_ROW: result = create_row_tile_order(arena, tile_count_x, tile_count_y); break;
+    case RAY_TILE_ORDER_MORTON: result = create_morton_tile_order(arena, tile_count_x, tile_count_y); break;
+    case RAY_TILE_ORDER_HILBERT: result = create_hilbert_tile_order(arena, tile_count_x, tile_count_y); break;
+    default: result = create_spiral_tile_order(arena, tile_count_x, tile_count_y); break;
+  }
+
+  return result;
+}
+
+#define RAY_TARGET_CONVERGED_FRACTION 0.999f
+
+INTERNAL void
+render_tile_job(JobSystem *system, void *payload)
+{
+  WorkOrder *order = (WorkOrder *)payload;
+  RayWorkerStats *worker_stats = order->queue->worker_stats;
+
+  if (worker_stats != NULL)
+  {
+    // NOTE(Ryan): Tile jobs never wait, so they finish on the worker they started on
+    u64 start_clock = linux_get_ns();
+    order->queue->render_tile(order);
+    worker_stats[job_system_current_worker(system)->index].busy_ns += linux_get_ns() - start_clock;
+  }
+  else
+  {
+    order->queue->render_tile(order);
+  }
+
+  ATOMIC_STORE_RELEASE(&order->passes_retired, order->passes_retired + 1);
+}
+
+// NOTE(Ryan): Tiles row major; orders persist across passes, as each records whether its tile has converged
+INTERNAL WorkOrder *
+create_work_orders(MemArena *arena, WorkQueue *queue, World *world, ImageU32 *image, Accumulation *accumulation,
+                   u32 tile_width, u32 tile_height)
+{
+  // for an uneven divisor, we want too many, not too few
+  // i.e. want to always be able to get to the end of a row
+  u32 tile_count_x = (image->width + tile_width - 1) / tile_width;
+  u32 tile_count_y = (image->height + tile_height - 1) / tile_height;
+
+  WorkOrder *result = MEM_ARENA_PUSH_ARRAY_ZERO(arena, WorkOrder, tile_count_x * tile_count_y);
+  for (u32 tile_y = 0;
+       tile_y < tile_count_y;
+       ++tile_y)
+  {
+    u32 min_y = tile_y * tile_height;
+    u32 max_y = MIN(min_y + tile_height, image->height);
+
+    for (u32 tile_x = 0;
+        tile_x < tile_count_x;
+        ++tile_x)
+    {
+      u32 min_x = tile_x * tile_width;
+      u32 max_x = MIN(min_x + tile_width, image->width);
+
+      WorkOrder *work_order = &result[tile_y * tile_count_x + tile_x];
+      work_order->queue = queue;
+      work_order->world = world;
+      work_order->image = image;
+      work_order->accumulation = accumulation;
+      work_order->x_min = min_x;
+      work_order->y_min = min_y; 
+      work_order->one_past_x_max = max_x; 
+      work_order->one_past_y_max = max_y;
+      work_order->unconverged_pixel_count = (max_x - min_x) * (max_y - min_y);
+    }
+  }
+
+  return result;
+}
+
+typedef u32 RAY_KERNEL_ISA;
+enum
+{
+  RAY_KERNEL_ISA_SCALAR,
+  RAY_KERNEL_ISA_SSE4,
+  RAY_KERNEL_ISA_AVX2,
+  RAY_KERNEL_ISA_AVX512,
+  RAY_KERNEL_ISA_COUNT,
+};
+
+typedef struct RayKernel RayKernel;
+struct RayKernel
+{
+  const char *name;
+  u32 lane_width;
+  render_tile_func render_tile;
+  render_tile_func resolve_tile;
+};
+
+// NOTE(Ryan): Order of preference is reverse of this
+GLOBAL RayKernel ray_kernels[RAY_KERNEL_ISA_COUNT] = {
+  {"scalar", 1, render_tile_scalar, resolve_tile_scalar},
+  {"sse4", 4, render_tile_sse4, resolve_tile_sse4},
+  {"avx2", 8, render_tile_avx2, resolve_tile_avx2},
+  {"avx512", 16, render_tile_avx512, resolve_tile_avx512},
+};
+
+// NOTE(Ryan): __builtin_cpu_supports() also checks OS has enabled the wider register state (xgetbv)
+INTERNAL b32
+ray_kernel_is_supported(RAY_KERNEL_ISA isa)
+{
+  b32 result = false;
+
+  switch (isa)
+  {
+    case RAY_KERNEL_ISA_SCALAR: result = true; break;
+    case RAY_KERNEL_ISA_SSE4: result = __builtin_cpu_supports("sse4.1"); break;
+    case RAY_KERNEL_ISA_AVX2: result = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"); break;
+    case RAY_KERNEL_ISA_AVX512: result = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx2") && 
+                                         __builtin_cpu_supports("fma"); break;
+    default: break;
+  }
+
+  return result;
+}
+
+// NOTE(Ryan): Widest supported, unless forced with -isa <name> (e.g. to compare kernels on one machine)
+INTERNAL RayKernel *
+ray_kernel_select(const char *forced_name)
+{
+  RayKernel *result = NULL;
+
+  __builtin_cpu_init();
+
+  // NOTE(Ryan): A typo would otherwise silently benchmark the scalar kernel
+  if (forced_name != NULL)
+  {
+    b32 is_known_name = false;
+    char valid_names[128] = ZERO_STRUCT;
+    u32 valid_names_len = 0;
+    for (u32 isa = 0; isa < RAY_KERNEL_ISA_COUNT; isa += 1)
+    {
+      is_known_name |= (strcmp(forced_name, ray_kernels[isa].name) == 0);
+      valid_names_len += (u32)snprintf(valid_names + valid_names_len, sizeof(valid_names) - valid_names_len, 
+                                       "%s%s", (isa == 0) ? "Valid -isa names: " : ", ", ray_kernels[isa].name);
+    }
+
+    if (!is_known_name)
+    {
+      FATAL_ERROR("Unknown kernel ISA requested.", forced_name, valid_names);
+    }
+  }
+
+  for (s32 isa = RAY_KERNEL_ISA_COUNT - 1; isa >= 0; isa -= 1)
+  {
+    if (forced_name != NULL && strcmp(forced_name, ray_kernels[isa].name) != 0)
+    {
+      continue;
+    }
+
+    if (ray_kernel_is_supported((RAY_KERNEL_ISA)isa))
+    {
+      result = &ray_kernels[isa];
+      break;
+    }
+    else if (forced_name != NULL)
+    {
+      WARN("Requested kernel ISA not supported by this CPU.", forced_name);
+    }
+  }
+
+  if (result == NULL)
+  {
+    result = &ray_kernels[RAY_KERNEL_ISA_SCALAR];
+  }
+
+  return result;
+}
+
+// in the final scene, the sphere and plane will reflect the sky's colour attenuated to a certain level
+INTERNAL World *
+create_default_world(MemArena *arena)
+{
+  World *result = MEM_ARENA_PUSH_STRUCT_ZERO(arena, World);
+
+  result->material_count = 6;
+  result->materials = MEM_ARENA_PUSH_ARRAY_ZERO(arena, Material, result->material_count);
+  Material *materials = result->materials;
+  materials[0].emitted_colour = {0.3f, 0.4f, 0.5f};
+  materials[1].reflected_colour = {0.5f, 0.5f, 0.5f};
+  materials[2].reflected_colour = {0.7f, 0.5f, 0.3f};
+  materials[3].emitted_colour = {4.0f, 0.0f, 0.0f};
+  materials[4].reflected_colour = {0.2f, 0.8f, 0.2f};
+  materials[4].scatter = 0.7f; 
+  materials[5].reflected_colour = {0.4f, 0.8f, 0.9f};
+  materials[5].scatter = 0.85f; 
+
+  result->plane_count = 1;
+  result->planes = MEM_ARENA_PUSH_ARRAY_ZERO(arena, Plane, result->plane_count);
+  Plane *planes = result->planes;
+  planes[0].normal = {0, 0, 1};
+  planes[0].distance = 0;
+  planes[0].material_index = 1;
+
+  result->sphere_count = 4;
+  result->spheres = MEM_ARENA_PUSH_ARRAY_ZERO(arena, Sphere, result->sphere_count);
+  Sphere *spheres = result->spheres;
+  spheres[0].position = {0, 0, 0};
+  spheres[0].radius = 1.0f;
+  spheres[0].material_index = 2;
+  spheres[1].position = {3, -2, 0};
+  spheres[1].radius = 1.0f;
+  spheres[1].material_index = 3;
+  spheres[2].position = {-2, -1, 2};
+  spheres[2].radius = 1.0f;
+  spheres[2].material_index = 4;
+  spheres[3].position = {1, -1, 3};
+  spheres[3].radius = 1.0f;
+  spheres[3].material_index = 5;
+
+  return result;
+}
+
+// NOTE(Ryan): Deterministic so brute force and BVH runs render identical scenes
+INTERNAL f32
+scene_random_unilateral(u32 *state)
+{
+  // xorshift32
+  u32 x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *state = x;
+
+  return (f32)(x >> 8) / (f32)(1 << 24);
+}
+
+// NOTE(Ryan): Benchmark scene; enough spheres that intersection dominates and brute force cost is obvious
+INTERNAL World *
+create_spheres_world(MemArena *arena, u32 sphere_count)
+{
+  World *result = create_default_world(arena);
+
+  u32 random_state = 0x1234567;
+
+  result->sphere_count = sphere_count;
+  result->spheres = MEM_ARENA_PUSH_ARRAY_ZERO(arena, Sphere, result->sphere_count);
+  for (u32 sphere_i = 0; sphere_i < sphere_count; sphere_i += 1)
+  {
+    Sphere *sphere = &result->spheres[sphere_i];
+    sphere->radius = 0.05f + 0.2f * scene_random_unilateral(&random_state);
+    sphere->position.x = -8.0f + 16.0f * scene_random_unilateral(&random_state);
+    sphere->position.y = -4.0f + 16.0f * scene_random_unilateral(&random_state);
+    sphere->position.z = sphere->radius + 5.0f * scene_random_unilateral(&random_state);
+    // NOTE(Ryan): Skip sky material
+    sphere->material_index = 1 + (u32)(scene_random_unilateral(&random_state) * (f32)(result->material_count - 1));
+  }
+
+  return result;
+}
+
+// NOTE(Ryan): Mesh replaces default spheres, sized to sit where they were
+INTERNAL World *
+create_mesh_world(MemArena *arena, const char *obj_file_name)
+{
+  World *result = create_default_world(arena);
+  result->sphere_count = 0;
+
+  u64 load_start_clock = get_wall_clock();
+  Mesh mesh = {};
+  if (obj_load_mesh(arena, s8_cstring(obj_file_name), &mesh))
+  {
+    mesh_add_to_world(arena, result, &mesh, 4.0f, 2);
+    printf("Loaded %s: %u vertices, %u triangles in %lums\n", obj_file_name, mesh.vertex_count, mesh.triangle_count, 
+           get_wall_clock() - load_start_clock);
+  }
+
+  return result;
+}
+
+// NOTE(Ryan): Cache line aligned, so lane loads from the start of an array never split a line
+INTERNAL f32 *
+world_push_soa_f32(MemArena *arena, u32 padded_count, f32 padding)
+{
+  f32 *result = (f32 *)mem_arena_push_aligned(arena, sizeof(f32) * padded_count, CACHE_LINE_SIZE);
+  for (u32 i = 0; i < padded_count; i += 1)
+  {
+    result[i] = padding;
+  }
+
+  return result;
+}
+
+INTERNAL u32 *
+world_push_soa_u32(MemArena *arena, u32 padded_count)
+{
+  u32 *result = (u32 *)mem_arena_push_aligned(arena, sizeof(u32) * padded_count, CACHE_LINE_SIZE);
+  MEMORY_ZERO(result, sizeof(u32) * padded_count);
+
+  return result;
+}
+
+// NOTE(Ryan): Sky (material 0) emits too, but is reached by bounces rather than sampled
+INTERNAL b32
+world_material_is_light(World *world, u32 material_index)
+{
+  V3 emitted_colour = world->materials[material_index].emitted_colour;
+  b32 result = (material_index != 0 && (emitted_colour.x > 0.0f || emitted_colour.y > 0.0f || emitted_colour.z > 0.0f));
+
+  return result;
+}
+
+// IMPORTANT(Ryan): Call after bvh_build_world(), as that reorders spheres and leaves index the reordered array.
+// Padding planes have a zero normal and padding spheres a negative squared radius, so neither can be hit.
+// Also collects light spheres for direct sampling
+INTERNAL void
+world_build_soa(MemArena *arena, World *world)
+{
+  PlaneSoA *planes = &world->plane_soa;
+  u32 padded_plane_count = world->plane_count + RAY_SOA_PADDING;
+  planes->count = world->plane_count;
+  planes->normal_x = world_push_soa_f32(arena, padded_plane_count, 0.0f);
+  planes->normal_y = world_push_soa_f32(arena, padded_plane_count, 0.0f);
+  planes->normal_z = world_push_soa_f32(arena, padded_plane_count, 0.0f);
+  planes->distance = world_push_soa_f32(arena, padded_plane_count, 0.0f);
+  planes->material_index = world_push_soa_u32(arena, padded_plane_count);
+  for (u32 plane_i = 0; plane_i < world->plane_count; plane_i += 1)
+  {
+    Plane *plane = &world->planes[plane_i];
+    planes->normal_x[plane_i] = plane->normal.x;
+    planes->normal_y[plane_i] = plane->normal.y;
+    planes->normal_z[plane_i] = plane->normal.z;
+    planes->distance[plane_i] = plane->distance;
+    planes->material_index[plane_i] = plane->material_index;
+  }
+
+  SphereSoA *spheres = &world->sphere_soa;
+  u32 padded_sphere_count = world->sphere_count + RAY_SOA_PADDING;
+  spheres->count = world->sphere_count;
+  spheres->x = world_push_soa_f32(arena, padded_sphere_count, 0.0f);
+  spheres->y = world_push_soa_f32(arena, padded_sphere_count, 0.0f);
+  spheres->z = world_push_soa_f32(arena, padded_sphere_count, 0.0f);
+  spheres->radius_squared = world_push_soa_f32(arena, padded_sphere_count, -1.0f);
+  spheres->material_index = world_push_soa_u32(arena, padded_sphere_count);
+  for (u32 sphere_i = 0; sphere_i < world->sphere_count; sphere_i += 1)
+  {
+    Sphere *sphere = &world->spheres[sphere_i];
+    spheres->x[sphere_i] = sphere->position.x;
+    spheres->y[sphere_i] = sphere->position.y;
+    spheres->z[sphere_i] = sphere->position.z;
+    spheres->radius_squared[sphere_i] = sphere->radius * sphere->radius;
+    spheres->material_index[sphere_i] = sphere->material_index;
+  }
+
+  world->light_count = 0;
+  world->light_sphere_indices = MEM_ARENA_PUSH_ARRAY(arena, u32, world->sphere_count);
+  for (u32 sphere_i = 0; sphere_i < world->sphere_count; sphere_i += 1)
+  {
+    if (world_material_is_light(world, world->spheres[sphere_i].material_index))
+    {
+      world->light_sphere_indices[world->light_count++] = sphere_i;
+    }
+  }
+
+  for (u32 plane_i = 0; plane_i < world->plane_count; plane_i += 1)
+  {
+    if (world_material_is_light(world, world->planes[plane_i].material_index))
+    {
+      WARN("Emissive plane won't be sampled as a light.", "only spheres are lights");
+      break;
+    }
+  }
+  for (u32 triangle_i = 0; triangle_i < world->triangle_count; triangle_i += 1)
+  {
+    if (world_material_is_light(world, world->triangles[triangle_i].material_index))
+    {
+      WARN("Emissive triangle won't be sampled as a light.", "only spheres are lights");
+      break;
+    }
+  }
+}
+
+// NOTE(Ryan): Everything describing one render, so the same flags work on the command line and in -serve jobs
+typedef struct RaySettings RaySettings;
+struct RaySettings
+{
+  b32 use_bvh;
+  b32 use_spheres_scene;
+  const char *obj_file_name;
+  u32 sphere_count;
+  u32 image_width, image_height;
+  u32 rays_per_pixel;
+  u32 rays_per_pass;
+  u64 time_budget_ms;
+  f32 target_error;
+  b32 use_adaptive;
+  RAY_TONEMAP tonemap;
+  b32 use_dither;
+  b32 use_exact_srgb;
+  u32 random_seed;
+  u32 tile_size; // 0 to size from L1d
+  RAY_TILE_ORDER tile_order;
+};
+
+INTERNAL RaySettings
+ray_settings_default(void)
+{
+  RaySettings result = {};
+
+  result.use_bvh = true;
+  result.sphere_count = 4096;
+  result.image_width = 1280;
+  result.image_height = 720;
+  result.rays_per_pixel = 1024;
+  result.rays_per_pass = 16;
+  result.target_error = 0.01f;
+  result.use_adaptive = true;
+  result.tonemap = RAY_TONEMAP_NONE;
+  result.random_seed = 120322;
+  result.tile_order = RAY_TILE_ORDER_SPIRAL;
+
+  return result;
+}
+
+// NOTE(Ryan): Arguments consumed starting at argv[arg_i], or 0 if it isn't a render setting
+INTERNAL u32
+ray_settings_parse_arg(RaySettings *settings, s32 argc, char **argv, s32 arg_i)
+{
+  u32 result = 0;
+
+  char *arg = argv[arg_i];
+  char *value = (arg_i + 1 < argc) ? argv[arg_i + 1] : NULL;
+  if (strcmp(arg, "-no-bvh") == 0)
+  {
+    settings->use_bvh = false;
+    result = 1;
+  }
+  else if (strcmp(arg, "-no-adaptive") == 0)
+  {
+    settings->use_adaptive = false;
+    result = 1;
+  }
+  else if (strcmp(arg, "-dither") == 0)
+  {
+    settings->use_dither = true;
+    result = 1;
+  }
+  else if (strcmp(arg, "-exact-srgb") == 0)
+  {
+    settings->use_exact_srgb = true;
+    result = 1;
+  }
+  else if (value != NULL)
+  {
+    result = 2;
+    if (strcmp(arg, "-scene") == 0)
+    {
+      settings->use_spheres_scene = (strcmp(value, "spheres") == 0);
+    }
+    else if (strcmp(arg, "-obj") == 0)
+    {
+      settings->obj_file_name = value;
+    }
+    else if (strcmp(arg, "-sphere-count") == 0)
+    {
+      settings->sphere_count = (u32)strtoul(value, NULL, 10);
+    }
+    else if (strcmp(arg, "-rays-per-pixel") == 0)
+    {
+      settings->rays_per_pixel = (u32)strtoul(value, NULL, 10);
+    }
+    else if (strcmp(arg, "-rays-per-pass") == 0)
+    {
+      settings->rays_per_pass = (u32)strtoul(value, NULL, 10);
+    }
+    else if (strcmp(arg, "-time-budget") == 0)
+    {
+      settings->time_budget_ms = strtoull(value, NULL, 10);
+    }
+    else if (strcmp(arg, "-target-error") == 0)
+    {
+      settings->target_error = strtof(value, NULL);
+    }
+    else if (strcmp(arg, "-size") == 0)
+    {
+      sscanf(value, "%ux%u", &settings->image_width, &settings->image_height);
+    }
+    else if (strcmp(arg, "-tonemap") == 0)
+    {
+      if (strcmp(value, "reinhard") == 0)
+      {
+        settings->tonemap = RAY_TONEMAP_REINHARD;
+      }
+      else if (strcmp(value, "aces") == 0)
+      {
+        settings->tonemap = RAY_TONEMAP_ACES;
+      }
+      else
+      {
+        settings->tonemap = RAY_TONEMAP_NONE;
+      }
+    }
+    else if (strcmp(arg, "-seed") == 0)
+    {
+      settings->random_seed = (u32)strtoul(value, NULL, 10);
+    }
+    else if (strcmp(arg, "-tile-size") == 0)
+    {
+      settings->tile_size = (u32)strtoul(value, NULL, 10);
+    }
+    else if (strcmp(arg, "-tile-order") == 0)
+    {
+      for (RAY_TILE_ORDER order_i = 0; order_i < RAY_TILE_ORDER_COUNT; order_i += 1)
+      {
+        if (strcmp(value, ray_tile_order_names[order_i]) == 0)
+        {
+          settings->tile_order = order_i;
+        }
+      }
+    }
+    else
+    {
+      result = 0;
+    }
+  }
+
+  return result;
+}
+
+INTERNAL World *
+create_world(MemArena *arena, RaySettings *settings)
+{
+  World *result = NULL;
+
+  if (settings->obj_file_name != NULL)
+  {
+    result = create_mesh_world(arena, settings->obj_file_name);
+  }
+  else if (settings->use_spheres_scene)
+  {
+    result = create_spheres_world(arena, settings->sphere_count);
+  }
+  else
+  {
+    result = create_default_world(arena);
+  }
+  printf("Scene: %u planes, %u spheres, %u triangles\n", result->plane_count, result->sphere_count, result->triangle_count);
+
+  if (settings->use_bvh)
+  {
+    u64 bvh_start_clock = get_wall_clock();
+    bvh_build_world(arena, result);
+    printf("Intersection: BVH (%u sphere nodes, %u triangle nodes, built in %lums)\n", result->sphere_bvh.node_count, 
+           result->triangle_bvh.node_count, get_wall_clock() - bvh_start_clock);
+  }
+  else
+  {
+    printf("Intersection: brute force\n");
+  }
+  world_build_soa(arena, result);
+
+  return result;
+}
+
+// NOTE(Ryan): Single threaded, so numbers are per core. 
+// Times re-resolving the final accumulation with the per pixel powf() path, then the lane path, and diffs the two
+INTERNAL void
+run_resolve_bench(MemArena *arena, RayKernel *kernel, WorkQueue *queue, WorkOrder *work_orders, u32 work_order_count, 
+                  ImageU32 *image, u32 iteration_count)
+{
+  MemArenaTemp temp = mem_arena_temp_begin(arena);
+
+  u32 pixel_count = image->width * image->height;
+  u32 *path_pixels[2] = {MEM_ARENA_PUSH_ARRAY(arena, u32, pixel_count), MEM_ARENA_PUSH_ARRAY(arena, u32, pixel_count)};
+  u64 elapsed_ms[2] = {};
+
+  b32 use_exact_srgb = queue->use_exact_srgb;
+  for (u32 path_i = 0; path_i < 2; path_i += 1)
+  {
+    queue->use_exact_srgb = (path_i == 0);
+
+    u64 start_clock = get_wall_clock();
+    for (u32 iteration_i = 0; iteration_i < iteration_count; iteration_i += 1)
+    {
+      for (u32 order_i = 0; order_i < work_order_count; order_i += 1)
+      {
+        kernel->resolve_tile(&work_orders[order_i]);
+      }
+    }
+    elapsed_ms[path_i] = get_wall_clock() - start_clock;
+
+    MEMORY_COPY(path_pixels[path_i], image->pixels, pixel_count * sizeof(u32));
+  }
+
+  // NOTE(Ryan): Leave image as it would have been written
+  queue->use_exact_srgb = use_exact_srgb;
+  MEMORY_COPY(image->pixels, path_pixels[use_exact_srgb ? 0 : 1], pixel_count * sizeof(u32));
+
+  u32 *exact_pixels = path_pixels[0];
+  u32 *lane_pixels = path_pixels[1];
+  u32 max_difference = 0;
+  u64 total_difference = 0;
+  u32 differing_channel_count = 0;
+  for (u32 pixel_i = 0; pixel_i < pixel_count; pixel_i += 1)
+  {
+    for (u32 shift = 0; shift < 24; shift += 8)
+    {
+      s32 exact = (s32)((exact_pixels[pixel_i] >> shift) & 0xFF);
+      s32 lane = (s32)((lane_pixels[pixel_i] >> shift) & 0xFF);
+      u32 difference = (u32)abs(exact - lane);
+      max_difference = MAX(max_difference, difference);
+      total_difference += difference;
+      differing_channel_count += (difference != 0);
+    }
+  }
+
+  const char *path_names[2] = {"exact", kernel->name};
+  for (u32 path_i = 0; path_i < 2; path_i += 1)
+  {
+    r64 ms_per_image = (r64)elapsed_ms[path_i] / iteration_count;
+    printf("Resolve %s: %.2fms/image, %.1f Mpixels/s\n", path_names[path_i], ms_per_image, 
+           ms_per_image > 0.0 ? (r64)pixel_count / (ms_per_image * 1000.0) : 0.0);
+  }
+  printf("Resolve difference: max %u/255, %u/%u channels differ, mean %f\n", max_difference, 
+         differing_channel_count, pixel_count * 3, (r64)total_difference / (pixel_count * 3));
+
+  mem_arena_temp_end(temp);
+}
+
+typedef struct RayBenchConfig RayBenchConfig;
+struct RayBenchConfig
+{
+  const char *name; // also metric file name
+  b32 use_spheres_scene;
+  b32 use_all_cores; // else 1 thread
+  u32 rays_per_pixel;
+};
+
+// NOTE(Ryan): Changing any of these makes new results incomparable with what's already in the .metric files
+#define RAY_BENCH_WIDTH 640
+#define RAY_BENCH_HEIGHT 360
+#define RAY_BENCH_RAYS_PER_PASS 16
+#define RAY_BENCH_SEED 120322
+#define RAY_BENCH_SPHERE_COUNT 4096
+#define RAY_BENCH_TILE_SIZE 64
+
+// NOTE(Ryan): Spheres scene is ~15x the cost per bounce, so fewer samples keep a run to a few seconds
+GLOBAL RayBenchConfig ray_bench_configs[] = {
+  {"ray-default-1t", false, false, 64},
+  {"ray-spheres-1t", true, false, 16},
+  {"ray-default-mt", false, true, 64},
+  {"ray-spheres-mt", true, true, 16},
+};
+
+typedef struct RayBenchResult RayBenchResult;
+struct RayBenchResult
+{
+  u64 median_ns;
+  u64 p95_ns;
+  u64 bounces_per_run;
+  u32 thread_count;
+  r64 *worker_utilisations; // busy time over wall time, per worker
+};
+
+// NOTE(Ryan): Fixed seed, resolution and sample count with adaptive sampling off, 
+// so each run casts exactly the same bounces and only time varies.
+// Utilisation is each worker's time inside tile jobs over wall time; 
+// below 100% is time spent stealing, sleeping or waiting for the slowest tile of a pass
+INTERNAL RayBenchResult
+bench_render(MemArena *arena, RayKernel *kernel, World *world, u32 thread_count, u32 rays_per_pixel, 
+             u32 tile_size, RAY_TILE_ORDER tile_order, u32 warmup_count, u32 run_count)
+{
+  RayBenchResult result = {};
+  result.thread_count = thread_count;
+  result.worker_utilisations = MEM_ARENA_PUSH_ARRAY_ZERO(arena, r64, thread_count);
+
+  MemArenaTemp temp = mem_arena_temp_begin(arena);
+
+  ImageU32 image = {};
+  image.width = RAY_BENCH_WIDTH;
+  image.height = RAY_BENCH_HEIGHT;
+  image.pixels = MEM_ARENA_PUSH_ARRAY_ZERO(arena, u32, image.width * image.height);
+  Accumulation accumulation = create_accumulation(arena, image.width, image.height);
+
+  JobSystem *job_system = job_system_create(arena, thread_count);
+  RayWorkerStats *worker_stats = (RayWorkerStats *)mem_arena_push_aligned(arena, sizeof(RayWorkerStats) * thread_count, 
+                                                                         CACHE_LINE_SIZE);
+
+  WorkQueue work_queue = {};
+  work_queue.max_bounce_count = RAY_MAX_BOUNCE_COUNT;
+  work_queue.rays_per_pixel_per_pass = 
+    MAX(1, (RAY_BENCH_RAYS_PER_PASS + kernel->lane_width - 1) / kernel->lane_width) * kernel->lane_width;
+  work_queue.random_seed = RAY_BENCH_SEED;
+  work_queue.target_error = 0.0f;
+  work_queue.render_tile = kernel->render_tile;
+  work_queue.worker_stats = worker_stats;
+
+  u32 tile_count_x = (image.width + tile_size - 1) / tile_size;
+  u32 tile_count_y = (image.height + tile_size - 1) / tile_size;
+  u32 tile_count = tile_count_x * tile_count_y;
+  WorkOrder *work_orders = create_work_orders(arena, &work_queue, world, &image, &accumulation, tile_size, tile_size);
+  u32 *tile_indices = create_tile_order(arena, tile_order, tile_count_x, tile_count_y);
+  u32 pass_count = MAX(1, rays_per_pixel / work_queue.rays_per_pixel_per_pass);
+
+  u64 *elapsed_ns = MEM_ARENA_PUSH_ARRAY_ZERO(arena, u64, run_count);
+  u64 total_elapsed_ns = 0;
+  for (u32 run_i = 0; run_i < warmup_count + run_count; run_i += 1)
+  {
+    MEMORY_ZERO(accumulation.radiance, sizeof(V3) * image.width * image.height);
+    MEMORY_ZERO(accumulation.luminance_squared, sizeof(f32) * image.width * image.height);
+    MEMORY_ZERO(accumulation.sample_counts, sizeof(u32) * image.width * image.height);
+    MEMORY_ZERO(worker_stats, sizeof(RayWorkerStats) * thread_count);
+    work_queue.bounces_computed = 0;
+
+    u64 start_clock = linux_get_ns();
+    for (u32 pass_i = 0; pass_i < pass_count; pass_i += 1)
+    {
+      JobCounter tiles_counter = {};
+      for (u32 order_i = 0; order_i < tile_count; order_i += 1)
+      {
+        job_submit(job_system, render_tile_job, &work_orders[tile_indices[order_i]], &tiles_counter);
+      }
+      job_wait_for_counter(job_system, &tiles_counter);
+    }
+    u64 run_elapsed_ns = linux_get_ns() - start_clock;
+
+    if (run_i >= warmup_count)
+    {
+      elapsed_ns[run_i - warmup_count] = run_elapsed_ns;
+      total_elapsed_ns += run_elapsed_ns;
+      for (u32 worker_i = 0; worker_i < thread_count; worker_i += 1)
+      {
+        result.worker_utilisations[worker_i] += (r64)worker_stats[worker_i].busy_ns;
+      }
+    }
+    result.bounces_per_run = work_queue.bounces_computed;
+  }
+
+  job_system_destroy(job_system);
+
+  result.median_ns = u64_percentile(elapsed_ns, run_count, 50);
+  result.p95_ns = u64_percentile(elapsed_ns, run_count, 95);
+  for (u32 worker_i = 0; worker_i < thread_count; worker_i += 1)
+  {
+    result.worker_utilisations[worker_i] /= (r64)total_elapsed_ns;
+  }
+
+  mem_arena_temp_end(temp);
+
+  return result;
+}
+
+INTERNAL r64
+ray_bench_result_mean_utilisation(RayBenchResult *result)
+{
+  r64 sum = 0.0;
+  for (u32 worker_i = 0; worker_i < result->thread_count; worker_i += 1)
+  {
+    sum += result->worker_utilisations[worker_i];
+  }
+
+  r64 mean = sum / result->thread_count;
+
+  return mean;
+}
+
+// NOTE(Ryan): Each config appends its median ns/bounce to <metric_dir>/<name>.metric for misc/view-metrics.
+// Tiles stay fixed size and row major, so metrics only move when kernel does
+INTERNAL void
+run_bench(MemArena *arena, RayKernel *kernel, LinuxCPUTopology *topology, u32 warmup_count, u32 run_count, 
+          const char *metric_dir)
+{
+  u32 cpu_count = topology->cpu_count;
+  printf("Bench: %ux%u, %u warmups + %u runs, %u cpus\n", RAY_BENCH_WIDTH, RAY_BENCH_HEIGHT, 
+         warmup_count, run_count, cpu_count);
+
+  for (u32 config_i = 0; config_i < ARRAY_COUNT(ray_bench_configs); config_i += 1)
+  {
+    RayBenchConfig *config = &ray_bench_configs[config_i];
+    u32 thread_count = config->use_all_cores ? cpu_count : 1;
+    // NOTE(Ryan): Would only repeat the 1 thread config
+    if (config->use_all_cores && cpu_count == 1)
+    {
+      continue;
+    }
+
+    MemArenaTemp temp = mem_arena_temp_begin(arena);
+
+    World *world = config->use_spheres_scene ? create_spheres_world(arena, RAY_BENCH_SPHERE_COUNT) : 
+                                               create_default_world(arena);
+    bvh_build_world(arena, world);
+    world_build_soa(arena, world);
+
+    RayBenchResult result = bench_render(arena, kernel, world, thread_count, config->rays_per_pixel, 
+                                         RAY_BENCH_TILE_SIZE, RAY_TILE_ORDER_ROW, warmup_count, run_count);
+    r64 median_ns_per_bounce = (r64)result.median_ns / (r64)result.bounces_per_run;
+
+    printf("%s (%u rays/pixel): median %.1fms, p95 %.1fms, %.2f Mbounces/s, %.3fns/bounce\n", config->name, 
+           config->rays_per_pixel, result.median_ns / 1000000.0, result.p95_ns / 1000000.0, 
+           (r64)result.bounces_per_run * 1000.0 / (r64)result.median_ns, median_ns_per_bounce);
+    printf("  utilisation:");
+    for (u32 worker_i = 0; worker_i < thread_count; worker_i += 1)
+    {
+      printf(" %.0f%%", 100.0 * result.worker_utilisations[worker_i]);
+    }
+    printf("\n");
+
+    char metric_file_name[256] = {};
+    snprintf(metric_file_name, sizeof(metric_file_name), "%s/%s.metric", metric_dir, config->name);
+    char metric[64] = {};
+    snprintf(metric, sizeof(metric), "%.4f\n", median_ns_per_bounce);
+    s8_append_to_file(s8_cstring(metric_file_name), s8_cstring(metric));
+
+    mem_arena_temp_end(temp);
+  }
+}
+
+GLOBAL u32 ray_sweep_tile_sizes[] = {8, 16, 32, 64, 128};
+
+// NOTE(Ryan): Every tile size and issue order on default scene with all cores, fastest median wins.
+// Cache-derived size is included, so it's clear how far the heuristic is from this machine's best
+INTERNAL void
+run_tile_sweep(MemArena *arena, RayKernel *kernel, LinuxCacheInfo *cache_info, LinuxCPUTopology *topology, 
+               u32 warmup_count, u32 run_count)
+{
+  u32 cpu_count = topology->cpu_count;
+  u32 cache_tile_size = ray_tile_size_from_cache(cache_info);
+  printf("Sweep: %ux%u, %u warmups + %u runs, %u threads, cache-derived tile %ux%u\n", RAY_BENCH_WIDTH, 
+         RAY_BENCH_HEIGHT, warmup_count, run_count, cpu_count, cache_tile_size, cache_tile_size);
+
+  u32 tile_sizes[ARRAY_COUNT(ray_sweep_tile_sizes) + 1] = {};
+  u32 tile_size_count = 0;
+  b32 has_cache_tile_size = false;
+  for (u32 size_i = 0; size_i < ARRAY_COUNT(ray_sweep_tile_sizes); size_i += 1)
+  {
+    tile_sizes[tile_size_count++] = ray_sweep_tile_sizes[size_i];
+    has_cache_tile_size |= (ray_sweep_tile_sizes[size_i] == cache_tile_size);
+  }
+  if (!has_cache_tile_size)
+  {
+    tile_sizes[tile_size_count++] = cache_tile_size;
+  }
+
+  MemArenaTemp temp = mem_arena_temp_begin(arena);
+
+  World *world = create_default_world(arena);
+  bvh_build_world(arena, world);
+  world_build_soa(arena, world);
+
+  u64 best_median_ns = U64_MAX;
+  u32 best_tile_size = 0;
+  RAY_TILE_ORDER best_tile_order = RAY_TILE_ORDER_ROW;
+  u64 cache_best_median_ns = U64_MAX;
+  for (u32 size_i = 0; size_i < tile_size_count; size_i += 1)
+  {
+    for (RAY_TILE_ORDER tile_order = 0; tile_order < RAY_TILE_ORDER_COUNT; tile_order += 1)
+    {
+      RayBenchResult result = bench_render(arena, kernel, world, cpu_count, 64, tile_sizes[size_i], tile_order, 
+                                           warmup_count, run_count);
+      printf("  %3ux%-3u %-8s median %8.1fms, p95 %8.1fms, utilisation %.0f%%\n", tile_sizes[size_i], 
+             tile_sizes[size_i], ray_tile_order_names[tile_order], result.median_ns / 1000000.0, 
+             result.p95_ns / 1000000.0, 100.0 * ray_bench_result_mean_utilisation(&result));
+
+      if (result.median_ns < best_median_ns)
+      {
+        best_median_ns = result.median_ns;
+        best_tile_size = tile_sizes[size_i];
+        best_tile_order = tile_order;
+      }
+      if (tile_sizes[size_i] == cache_tile_size)
+      {
+        cache_best_median_ns = MIN(cache_best_median_ns, result.median_ns);
+      }
+    }
+  }
+
+  printf("Best: %ux%u %s, %.1fms (cache-derived %ux%u is %.1f%% slower)\n", best_tile_size, best_tile_size, 
+         ray_tile_order_names[best_tile_order], best_median_ns / 1000000.0, cache_tile_size, cache_tile_size,
+         100.0 * ((r64)cache_best_median_ns / (r64)best_median_ns - 1.0));
+  printf("Use: -tile-size %u -tile-order %s\n", best_tile_size, ray_tile_order_names[best_tile_order]);
+
+  mem_arena_temp_end(temp);
+}
+
+// NOTE(Ryan): Threads are added in topology order, so up to physical_core_count each new thread gets its own core
+// and beyond that shares one with an SMT sibling. 
+// Efficiency is speedup / threads; a drop at the SMT boundary is expected, a drop before it points at 
+// memory bandwidth, a shared L3, turbo clocks falling as more cores wake, or load imbalance (see utilisation)
+INTERNAL void
+run_scaling_report(MemArena *arena, RayKernel *kernel, LinuxCPUTopology *topology, u32 warmup_count, u32 run_count)
+{
+  printf("Scaling: %ux%u, %u warmups + %u runs, %u logical CPUs on %u physical cores\n", RAY_BENCH_WIDTH, 
+         RAY_BENCH_HEIGHT, warmup_count, run_count, topology->cpu_count, topology->physical_core_count);
+
+  MemArenaTemp temp = mem_arena_temp_begin(arena);
+
+  World *world = create_default_world(arena);
+  bvh_build_world(arena, world);
+  world_build_soa(arena, world);
+
+  u64 single_thread_median_ns = 0;
+  u64 physical_cores_median_ns = 0;
+  u64 all_cpus_median_ns = 0;
+  u64 best_median_ns = U64_MAX;
+  u32 best_thread_count = 1;
+  for (u32 thread_count = 1; thread_count <= topology->cpu_count; thread_count += 1)
+  {
+    RayBenchResult result = bench_render(arena, kernel, world, thread_count, 64, RAY_BENCH_TILE_SIZE, 
+                                         RAY_TILE_ORDER_ROW, warmup_count, run_count);
+    if (thread_count == 1)
+    {
+      single_thread_median_ns = result.median_ns;
+    }
+    if (thread_count == topology->physical_core_count)
+    {
+      physical_cores_median_ns = result.median_ns;
+    }
+    if (thread_count == topology->cpu_count)
+    {
+      all_cpus_median_ns = result.median_ns;
+    }
+    if (result.median_ns < best_median_ns)
+    {
+      best_median_ns = result.median_ns;
+      best_thread_count = thread_count;
+    }
+
+    r64 speedup = (r64)single_thread_median_ns / (r64)result.median_ns;
+    printf("  %3u threads%s: median %8.1fms, speedup %5.2fx, efficiency %3.0f%%, utilisation %3.0f%%\n", thread_count, 
+           thread_count > topology->physical_core_count ? " (SMT)" : "      ", result.median_ns / 1000000.0, speedup, 
+           100.0 * speedup / thread_count, 100.0 * ray_bench_result_mean_utilisation(&result));
+  }
+
+  printf("Best: %u threads, %.2fx\n", best_thread_count, (r64)single_thread_median_ns / (r64)best_median_ns);
+  // NOTE(Ryan): Positive is SMT siblings adding throughput, negative is them contending for the core more than they fill it
+  if (topology->cpu_count > topology->physical_core_count && physical_cores_median_ns != 0)
+  {
+    printf("Hyperthreads: %+.1f%% throughput going from %u to %u threads\n", 
+           100.0 * ((r64)physical_cores_median_ns / (r64)all_cpus_median_ns - 1.0), topology->physical_core_count, 
+           topology->cpu_count);
+  }
+
+  mem_arena_temp_end(temp);
+}
+
+// NOTE(Ryan): -serve protocol over a Unix domain stream socket, one client at a time.
+// Client writes jobs as lines of the same render flags as the command line, e.g. "-scene spheres -size 640x360\n";
+// a line of "quit" stops the server. For each job the server replies with headers, each followed by payload_size bytes:
+//  TILE: payload is width * height 0xAARRGGBB pixels, row major with y = 0 the bottom row as in ImageU32;
+//        sent once, when the tile won't be sampled again
+//  DONE: no payload; width, height are the image size; sent after every tile
+//  ERROR: payload is a message (not terminated); job wasn't rendered
+// Native endianness, as client and server share a machine
+typedef u32 RAY_SERVER_MESSAGE;
+enum
+{
+  RAY_SERVER_MESSAGE_TILE,
+  RAY_SERVER_MESSAGE_DONE,
+  RAY_SERVER_MESSAGE_ERROR,
+};
+
+typedef struct RayServerHeader RayServerHeader;
+struct RayServerHeader
+{
+  RAY_SERVER_MESSAGE type;
+  u32 job_id;
+  u32 x, y;
+  u32 width, height;
+  u64 elapsed_ms; // DONE only
+  u64 bounces_computed; // DONE only
+  u32 payload_size;
+  u32 reserved;
+};
+
+// NOTE(Ryan): Scenes are rebuilt from the same flags every time, so flags are the key.
+// Built into the server's arena, so only the first this many distinct scenes are kept
+#define RAY_SERVER_MAX_CACHED_WORLDS 8
+#define RAY_SERVER_MAX_JOB_ARGS 64
+
+typedef struct RayServerWorld RayServerWorld;
+struct RayServerWorld
+{
+  b32 use_bvh;
+  b32 use_spheres_scene;
+  u32 sphere_count;
+  char obj_file_name[256];
+  World *world;
+};
+
+INTERNAL b32
+ray_server_world_matches(RayServerWorld *cached, RaySettings *settings)
+{
+  const char *obj_file_name = (settings->obj_file_name != NULL) ? settings->obj_file_name : "";
+  b32 result = (cached->use_bvh == settings->use_bvh && cached->use_spheres_scene == settings->use_spheres_scene &&
+                cached->sphere_count == settings->sphere_count && strcmp(cached->obj_file_name, obj_file_name) == 0);
+
+  return result;
+}
+
+// NOTE(Ryan): MSG_NOSIGNAL, so a client hanging up is an error return rather than SIGPIPE killing the server
+INTERNAL b32
+ray_server_send(s32 client_fd, void *data, memory_index size)
+{
+  b32 result = true;
+
+  u8 *cursor = (u8 *)data;
+  while (size > 0)
+  {
+    ssize_t sent = send(client_fd, cursor, size, MSG_NOSIGNAL);
+    if (sent < 0)
+    {
+      if (errno != EINTR)
+      {
+        result = false;
+        break;
+      }
+    }
+    else
+    {
+      cursor += sent;
+      size -= (memory_index)sent;
+    }
+  }
+
+  return result;
+}
+
+INTERNAL b32
+ray_server_send_error(s32 client_fd, u32 job_id, const char *message)
+{
+  RayServerHeader header = {};
+  header.type = RAY_SERVER_MESSAGE_ERROR;
+  header.job_id = job_id;
+  header.payload_size = (u32)strlen(message);
+
+  b32 result = (ray_server_send(client_fd, &header, sizeof(header)) &&
+                ray_server_send(client_fd, (void *)message, header.payload_size));
+
+  return result;
+}
+
+// NOTE(Ryan): Tile rows copied out to be contiguous, so one send per tile
+INTERNAL b32
+ray_server_send_tile(s32 client_fd, u32 job_id, ImageU32 *image, WorkOrder *order, u32 *scratch_pixels)
+{
+  RayServerHeader header = {};
+  header.type = RAY_SERVER_MESSAGE_TILE;
+  header.job_id = job_id;
+  header.x = order->x_min;
+  header.y = order->y_min;
+  header.width = order->one_past_x_max - order->x_min;
+  header.height = order->one_past_y_max - order->y_min;
+  header.payload_size = header.width * header.height * sizeof(u32);
+
+  for (u32 row_i = 0; row_i < header.height; row_i += 1)
+  {
+    MEMORY_COPY(scratch_pixels + row_i * header.width, image->pixels + (header.y + row_i) * image->width + header.x,
+                header.width * sizeof(u32));
+  }
+
+  b32 result = (ray_server_send(client_fd, &header, sizeof(header)) &&
+                ray_server_send(client_fd, scratch_pixels, header.payload_size));
+
+  return result;
+}
+
+// NOTE(Ryan): Same progressive loop as main, without snapshots or progress output.
+// Each tile is sent as soon as its last pass retires (final pass, or converged when adaptive),
+// rather than after the whole image. Returns false if client went away, in which case rendering is cancelled
+INTERNAL b32
+ray_server_render_job(MemArena *arena, RayKernel *kernel, JobSystem *job_system, LinuxCacheInfo *cache_info,
+                      World *world, RaySettings *settings, s32 client_fd, u32 job_id)
+{
+  b32 result = true;
+
+  u64 start_clock = get_wall_clock();
+
+  ImageU32 image = {};
+  image.width = settings->image_width;
+  image.height = settings->image_height;
+  image.pixels = MEM_ARENA_PUSH_ARRAY_ZERO(arena, u32, image.width * image.height);
+  Accumulation accumulation = create_accumulation(arena, image.width, image.height);
+
+  u32 tile_size = (settings->tile_size != 0) ? settings->tile_size : ray_tile_size_from_cache(cache_info);
+  u32 tile_count_x = (image.width + tile_size - 1) / tile_size;
+  u32 tile_count_y = (image.height + tile_size - 1) / tile_size;
+  u32 tile_count = tile_count_x * tile_count_y;
+
+  u32 rays_per_pass = MAX(1, (settings->rays_per_pass + kernel->lane_width - 1) / kernel->lane_width);
+  rays_per_pass *= kernel->lane_width;
+  u32 pass_count = (settings->rays_per_pixel + rays_per_pass - 1) / rays_per_pass;
+
+  WorkQueue work_queue = {};
+  work_queue.max_bounce_count = RAY_MAX_BOUNCE_COUNT;
+  work_queue.rays_per_pixel_per_pass = rays_per_pass;
+  work_queue.random_seed = settings->random_seed;
+  work_queue.target_error = settings->target_error;
+  work_queue.skip_converged_pixels = settings->use_adaptive;
+  work_queue.tonemap = settings->tonemap;
+  work_queue.dither = settings->use_dither;
+  work_queue.use_exact_srgb = settings->use_exact_srgb;
+  work_queue.render_tile = kernel->render_tile;
+
+  WorkOrder *work_orders = create_work_orders(arena, &work_queue, world, &image, &accumulation, tile_size, tile_size);
+  u32 *tile_indices = create_tile_order(arena, settings->tile_order, tile_count_x, tile_count_y);
+  b32 *tile_sent = MEM_ARENA_PUSH_ARRAY_ZERO(arena, b32, tile_count);
+  u32 *scratch_pixels = MEM_ARENA_PUSH_ARRAY(arena, u32, tile_size * tile_size);
+
+  u32 unconverged_pixel_count = image.width * image.height;
+  for (u32 pass_i = 0;
+       pass_i < pass_count && !work_queue.cancel_requested && unconverged_pixel_count > 0;
+       pass_i += 1)
+  {
+    b32 is_last_pass = (pass_i + 1 == pass_count);
+
+    // NOTE(Ryan): A tile is only sent once it won't be sampled again, so sent tiles are the converged ones
+    JobCounter tiles_counter = {};
+    for (u32 order_i = 0; order_i < tile_count; order_i += 1)
+    {
+      u32 tile_index = tile_indices[order_i];
+      if (!tile_sent[tile_index])
+      {
+        job_submit(job_system, render_tile_job, &work_orders[tile_index], &tiles_counter);
+      }
+    }
+
+    b32 is_counter_done = false;
+    u32 spin_count = 0;
+    while (!is_counter_done)
+    {
+      // NOTE(Ryan): Read before scanning, so a tile retiring during the last scan is still picked up by it
+      is_counter_done = job_counter_is_done(&tiles_counter);
+
+      // NOTE(Ryan): Once the last tiles are running elsewhere, back off rather than hammer the deques and tile states
+      if (job_system_try_run(job_system))
+      {
+        spin_count = 0;
+      }
+      else
+      {
+        spin_backoff(&spin_count);
+      }
+
+      for (u32 tile_i = 0; tile_i < tile_count && result; tile_i += 1)
+      {
+        WorkOrder *work_order = &work_orders[tile_i];
+        if (!tile_sent[tile_i] && ATOMIC_LOAD_ACQUIRE(&work_order->passes_retired) == pass_i + 1 &&
+            (is_last_pass || (settings->use_adaptive && work_order->unconverged_pixel_count == 0)))
+        {
+          tile_sent[tile_i] = true;
+          result = ray_server_send_tile(client_fd, job_id, &image, work_order, scratch_pixels);
+        }
+      }
+
+      if (!result || (settings->time_budget_ms != 0 && get_wall_clock() - start_clock >= settings->time_budget_ms))
+      {
+        ATOMIC_STORE_RELAXED(&work_queue.cancel_requested, 1);
+      }
+    }
+
+    unconverged_pixel_count = 0;
+    for (u32 tile_i = 0; tile_i < tile_count; tile_i += 1)
+    {
+      unconverged_pixel_count += work_orders[tile_i].unconverged_pixel_count;
+    }
+  }
+
+  // NOTE(Ryan): Time budget or every pixel converging can end rendering with tiles still unsent
+  for (u32 tile_i = 0; tile_i < tile_count && result; tile_i += 1)
+  {
+    if (!tile_sent[tile_i])
+    {
+      result = ray_server_send_tile(client_fd, job_id, &image, &work_orders[tile_i], scratch_pixels);
+    }
+  }
+
+  u64 time_elapsed_ms = get_wall_clock() - start_clock;
+  if (result)
+  {
+    RayServerHeader header = {};
+    header.type = RAY_SERVER_MESSAGE_DONE;
+    header.job_id = job_id;
+    header.width = image.width;
+    header.height = image.height;
+    header.elapsed_ms = time_elapsed_ms;
+    header.bounces_computed = work_queue.bounces_computed;
+    result = ray_server_send(client_fd, &header, sizeof(header));
+  }
+
+  printf("Job %u: %ux%u in %u tiles, %lu bounces in %lums%s\n", job_id, image.width, image.height, tile_count,
+         work_queue.bounces_computed, time_elapsed_ms, result ? "" : " (client disconnected)");
+
+  return result;
+}
+
+// NOTE(Ryan): Long running alternative to a process per render.
+// Thread pool, kernel choice and built scenes (BVH included) persist across jobs.
+// Per job memory is a temporary region of one arena, so pages are only faulted in by the largest job so far
+INTERNAL void
+run_render_server(MemArena *arena, RayKernel *kernel, LinuxCacheInfo *cache_info, u32 thread_count, b32 use_pinning,
+                  const char *socket_path)
+{
+  struct sockaddr_un address = {};
+  address.sun_family = AF_UNIX;
+  if (strlen(socket_path) >= sizeof(address.sun_path))
+  {
+    WARN("Server socket path too long.", socket_path);
+    return;
+  }
+  strcpy(address.sun_path, socket_path);
+
+  s32 listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listen_fd < 0)
+  {
+    WARN("Failed to create server socket.", strerror(errno));
+    return;
+  }
+
+  // NOTE(Ryan): Socket file outlives a killed server and would fail bind
+  unlink(socket_path);
+  if (bind(listen_fd, (struct sockaddr *)&address, sizeof(address)) != 0 || listen(listen_fd, 8) != 0)
+  {
+    WARN("Failed to listen on server socket.", strerror(errno));
+    close(listen_fd);
+    return;
+  }
+
+  // IMPORTANT(Ryan): Created once, so -threads in a job is ignored
+  JobSystem *job_system = use_pinning ? job_system_create(arena, thread_count) :
+                                        job_system_create_pinned(arena, thread_count, NULL);
+  printf("Serving on %s with %u threads\n", socket_path, thread_count);
+
+  RayServerWorld *cached_worlds = MEM_ARENA_PUSH_ARRAY_ZERO(arena, RayServerWorld, RAY_SERVER_MAX_CACHED_WORLDS);
+  u32 cached_world_count = 0;
+  u32 job_count = 0;
+
+  b32 want_quit = false;
+  while (!want_quit)
+  {
+    s32 client_fd = accept(listen_fd, NULL, NULL);
+    if (client_fd < 0)
+    {
+      if (errno != EINTR)
+      {
+        WARN("Failed to accept client.", strerror(errno));
+        want_quit = true;
+      }
+      continue;
+    }
+
+    FILE *client = fdopen(client_fd, "r");
+    char line[4096] = {};
+    b32 is_connected = true;
+    while (is_connected && !want_quit && fgets(line, sizeof(line), client) != NULL)
+    {
+      char *job_args[RAY_SERVER_MAX_JOB_ARGS] = {};
+      s32 job_arg_count = 0;
+      for (char *token = strtok(line, " \t\r\n");
+           token != NULL && job_arg_count < RAY_SERVER_MAX_JOB_ARGS;
+           token = strtok(NULL, " \t\r\n"))
+      {
+        job_args[job_arg_count++] = token;
+      }
+
+      if (job_arg_count == 0)
+      {
+        continue;
+      }
+      if (strcmp(job_args[0], "quit") == 0)
+      {
+        want_quit = true;
+        continue;
+      }
+
+      u32 job_id = job_count++;
+      RaySettings settings = ray_settings_default();
+      const char *unknown_arg = NULL;
+      for (s32 arg_i = 0; arg_i < job_arg_count && unknown_arg == NULL; arg_i += 1)
+      {
+        u32 settings_arg_count = ray_settings_parse_arg(&settings, job_arg_count, job_args, arg_i);
+        if (settings_arg_count != 0)
+        {
+          arg_i += settings_arg_count - 1;
+        }
+        else
+        {
+          unknown_arg = job_args[arg_i];
+        }
+      }
+
+      if (unknown_arg != NULL)
+      {
+        char message[256] = {};
+        snprintf(message, sizeof(message), "Unknown or incomplete render flag: %s", unknown_arg);
+        is_connected = ray_server_send_error(client_fd, job_id, message);
+        continue;
+      }
+      if (settings.image_width == 0 || settings.image_height == 0 || settings.rays_per_pixel == 0)
+      {
+        is_connected = ray_server_send_error(client_fd, job_id, "Image size and rays per pixel must be non-zero");
+        continue;
+      }
+
+      World *world = NULL;
+      for (u32 cached_i = 0; cached_i < cached_world_count && world == NULL; cached_i += 1)
+      {
+        if (ray_server_world_matches(&cached_worlds[cached_i], &settings))
+        {
+          world = cached_worlds[cached_i].world;
+        }
+      }
+      if (world == NULL && cached_world_count < RAY_SERVER_MAX_CACHED_WORLDS)
+      {
+        RayServerWorld *cached = &cached_worlds[cached_world_count++];
+        cached->use_bvh = settings.use_bvh;
+        cached->use_spheres_scene = settings.use_spheres_scene;
+        cached->sphere_count = settings.sphere_count;
+        snprintf(cached->obj_file_name, sizeof(cached->obj_file_name), "%s",
+                 (settings.obj_file_name != NULL) ? settings.obj_file_name : "");
+        cached->world = create_world(arena, &settings);
+        world = cached->world;
+      }
+
+      MemArenaTemp temp = mem_arena_temp_begin(arena);
+      // NOTE(Ryan): Cache full, so built for this job only
+      if (world == NULL)
+      {
+        world = create_world(arena, &settings);
+      }
+      is_connected = ray_server_render_job(arena, kernel, job_system, cache_info, world, &settings, client_fd, job_id);
+      mem_arena_temp_end(temp);
+    }
+
+    fclose(client);
+  }
+
+  job_system_destroy(job_system);
+  close(listen_fd);
+  unlink(socket_path);
+}
+
+int
+main(int argc, char *argv[])
+{
+  printf("Ray tracing...\n");
+
+  // NOTE(Ryan): -size WxH (default 1280x720).
+  // -scene spheres [-sphere-count n] or -obj <file> for BVH benchmark; -no-bvh to compare against brute force.
+  // ms/bounce is independent of -rays-per-pixel, so lower it to keep brute force runs short.
+  // Rendering is progressive: passes of -rays-per-pass samples until the -rays-per-pixel cap or -time-budget <ms>,
+  // with the current estimate written to -output (.bmp, .ppm or .png) at most every -snapshot-interval <ms> (0 to disable).
+  // Pixels stop being sampled once their error is within -target-error; -no-adaptive samples every pixel every pass
+  // to compare time to reach the target against.
+  // -tonemap none|reinhard|aces and -dither apply on resolve to 8 bits; -exact-srgb uses per pixel powf().
+  // -resolve-bench <iterations> times resolving the final image with both sRGB paths.
+  // -seed <n> picks the noise pattern; for a given seed the image is the same for any -threads <n>.
+  // -bench [-bench-runs n] [-bench-warmups n] [-metric-dir dir] ignores all of the above apart from -isa,
+  // rendering fixed configurations and appending results to dir/*.metric (default misc, i.e. run from repo root).
+  // -tile-size n (default from L1d size) and -tile-order spiral|row|morton|hilbert; -sweep times every combination.
+  // Workers are pinned, filling physical cores before SMT siblings; -physical-cores stops there, -no-pin leaves placement
+  // to the scheduler. -scaling times 1 to all logical CPUs to show where extra threads (and hyperthreads) stop helping.
+  // -serve <socket path> keeps running, rendering jobs of the scene and render flags above sent over a Unix socket
+  // (protocol at run_render_server()); -isa, -threads, -physical-cores and -no-pin are fixed when it starts
+  const char *forced_isa = NULL;
+  RaySettings settings = ray_settings_default();
+  u64 snapshot_interval_ms = 1000;
+  const char *output_file_name = "output.bmp";
+  u32 resolve_bench_iteration_count = 0;
+  u32 thread_count = 0;
+  b32 want_bench = false;
+  u32 bench_run_count = 5;
+  u32 bench_warmup_count = 1;
+  const char *metric_dir = "misc";
+  b32 want_tile_sweep = false;
+  b32 use_physical_cores = false;
+  b32 use_pinning = true;
+  b32 want_scaling_report = false;
+  const char *server_socket_path = NULL;
+  for (s32 arg_i = 1; arg_i < argc; arg_i += 1)
+  {
+    u32 settings_arg_count = ray_settings_parse_arg(&settings, argc, argv, arg_i);
+    if (settings_arg_count != 0)
+    {
+      arg_i += settings_arg_count - 1;
+    }
+    else if (strcmp(argv[arg_i], "-isa") == 0 && arg_i + 1 < argc)
+    {
+      forced_isa = argv[++arg_i];
+    }
+    else if (strcmp(argv[arg_i], "-snapshot-interval") == 0 && arg_i + 1 < argc)
+    {
+      snapshot_interval_ms = strtoull(argv[++arg_i], NULL, 10);
+    }
+    else if (strcmp(argv[arg_i], "-output") == 0 && arg_i + 1 < argc)
+    {
+      output_file_name = argv[++arg_i];
+    }
+    else if (strcmp(argv[arg_i], "-resolve-bench") == 0 && arg_i + 1 < argc)
+    {
+      resolve_bench_iteration_count = (u32)strtoul(argv[++arg_i], NULL, 10);
+    }
+    else if (strcmp(argv[arg_i], "-threads") == 0 && arg_i + 1 < argc)
+    {
+      thread_count = (u32)strtoul(argv[++arg_i], NULL, 10);
+    }
+    else if (strcmp(argv[arg_i], "-bench") == 0)
+    {
+      want_bench = true;
+    }
+    else if (strcmp(argv[arg_i], "-bench-runs") == 0 && arg_i + 1 < argc)
+    {
+      bench_run_count = (u32)strtoul(argv[++arg_i], NULL, 10);
+      bench_run_count = MAX(1, bench_run_count);
+    }
+    else if (strcmp(argv[arg_i], "-bench-warmups") == 0 && arg_i + 1 < argc)
+    {
+      bench_warmup_count = (u32)strtoul(argv[++arg_i], NULL, 10);
+    }
+    else if (strcmp(argv[arg_i], "-metric-dir") == 0 && arg_i + 1 < argc)
+    {
+      metric_dir = argv[++arg_i];
+    }
+    else if (strcmp(argv[arg_i], "-physical-cores") == 0)
+    {
+      use_physical_cores = true;
+    }
+    else if (strcmp(argv[arg_i], "-no-pin") == 0)
+    {
+      use_pinning = false;
+    }
+    else if (strcmp(argv[arg_i], "-scaling") == 0)
+    {
+      want_scaling_report = true;
+    }
+    else if (strcmp(argv[arg_i], "-sweep") == 0)
+    {
+      want_tile_sweep = true;
+    }
+    else if (strcmp(argv[arg_i], "-serve") == 0 && arg_i + 1 < argc)
+    {
+      server_socket_path = argv[++arg_i];
+    }
+  }
+
+  RayKernel *kernel = ray_kernel_select(forced_isa);
+  printf("Kernel: %s (%u lanes)\n", kernel->name, kernel->lane_width);
+
+  LinuxCPUTopology topology = linux_get_cpu_topology();
+  printf("CPUs: %u logical, %u physical cores, %u packages, %u NUMA nodes\n", topology.cpu_count, 
+         topology.physical_core_count, topology.package_count, topology.numa_node_count);
+
+  LinuxCacheInfo cache_info = linux_get_cache_info();
+  printf("Caches: L1d %uKB, L2 %uKB, L3 %uKB, %uB lines\n", cache_info.l1d_size / 1024, cache_info.l2_size / 1024, 
+         cache_info.l3_size / 1024, cache_info.line_size);
+
+  u32 core_count = topology.cpu_count; // logical cores
+  if (use_physical_cores)
+  {
+    core_count = topology.physical_core_count;
+  }
+  if (thread_count != 0)
+  {
+    core_count = thread_count;
+  }
+
+  if (server_socket_path != NULL)
+  {
+    MemArena *server_arena = mem_arena_allocate(GB(4));
+    run_render_server(server_arena, kernel, &cache_info, core_count, use_pinning, server_socket_path);
+    return 0;
+  }
+
+  if (want_bench || want_tile_sweep || want_scaling_report)
+  {
+    MemArena *bench_arena = mem_arena_allocate(GB(1));
+    if (want_bench)
+    {
+      run_bench(bench_arena, kernel, &topology, bench_warmup_count, bench_run_count, metric_dir);
+    }
+    if (want_tile_sweep)
+    {
+      run_tile_sweep(bench_arena, kernel, &cache_info, &topology, bench_warmup_count, bench_run_count);
+    }
+    if (want_scaling_report)
+    {
+      run_scaling_report(bench_arena, kernel, &topology, bench_warmup_count, bench_run_count);
+    }
+    return 0;
+  }
+
+  /* 
+  TODO(Ryan): Comparison between using uint and r32 here.
+  Difference between FPU and SIMD instructions.
+
+  r32 val0 = 12.0f;
+  r32 val1 = 45.0f;
+  r32 test_val = 23.0f;
+  r32 norm_val = (test_val - val0) / (val1 - val0);
+  
+  r32 x0 = 5.0f;
+  r32 x1 = 10.0f;
+  r32 blend = 0.5f;
+  r32 lerp = ((x1 - x0) * blend) + x0;
+
+  map = norm + lerp;
+  */
+
+  ImageU32 image = create_image_u32(settings.image_width, settings.image_height);
+  if (image.pixels != NULL)
+  {
+
+    // NOTE(Ryan): 8K needs ~700MB of accumulation plus ~2x its 8 bit size while encoding PNG; pages only committed when touched
+    MemArena *arena = mem_arena_allocate(GB(4));
+
+    World *world = create_world(arena, &settings);
+
+    u64 start_clock = get_wall_clock();
+    u64 end_clock;
+
+    // NOTE(Ryan): Sized from cache rather than image.width / core_count, so there are also enough tiles
+    // for the issue order to be visible and for cancellation to take effect promptly
+    if (settings.tile_size == 0)
+    {
+      settings.tile_size = ray_tile_size_from_cache(&cache_info);
+    }
+    u32 tile_width = settings.tile_size;
+    u32 tile_height = tile_width;
+
+    // for an uneven divisor, we want too many, not too few
+    // i.e. want to always be able to get to the end of a row
+    u32 tile_count_x = (image.width + tile_width - 1) / tile_width;
+    u32 tile_count_y = (image.height + tile_height - 1) / tile_height;
+    u32 total_tile_count = tile_count_x * tile_count_y;
+
+    // from k/tile we can say if it will fit into L1 cache
+    printf("Configuration: %d cores with %d tiles, %dx%d (%ldk/tile) tiles issued in %s order\n", 
+        core_count, total_tile_count, tile_width, tile_height, tile_width * tile_height * RAY_TILE_BYTES_PER_PIXEL / 1024,
+        ray_tile_order_names[settings.tile_order]);
+
+    // NOTE(Ryan): Kernel rounds each pass up to a whole number of lanes
+    settings.rays_per_pass = 
+      MAX(1, (settings.rays_per_pass + kernel->lane_width - 1) / kernel->lane_width) * kernel->lane_width;
+    u32 pass_count = (settings.rays_per_pixel + settings.rays_per_pass - 1) / settings.rays_per_pass;
+    printf("Progressive: up to %u passes of %u rays/pixel, target error %g (%s)\n", pass_count, settings.rays_per_pass, 
+           settings.target_error, settings.use_adaptive ? "adaptive" : "fixed");
+
+    Accumulation accumulation = create_accumulation(arena, image.width, image.height);
+
+    // IMPORTANT(Ryan): Calling thread becomes worker 0, so it renders tiles too
+    JobSystem *job_system = use_pinning ? job_system_create(arena, core_count) : 
+                                          job_system_create_pinned(arena, core_count, NULL);
+
+    WorkQueue work_queue = {};
+    work_queue.max_bounce_count = RAY_MAX_BOUNCE_COUNT;
+    work_queue.rays_per_pixel_per_pass = settings.rays_per_pass;
+    work_queue.random_seed = settings.random_seed;
+    work_queue.target_error = settings.target_error;
+    work_queue.skip_converged_pixels = settings.use_adaptive;
+    work_queue.tonemap = settings.tonemap;
+    work_queue.dither = settings.use_dither;
+    work_queue.use_exact_srgb = settings.use_exact_srgb;
+    work_queue.render_tile = kernel->render_tile;
+
+    WorkOrder *work_orders = create_work_orders(arena, &work_queue, world, &image, &accumulation, 
+                                                tile_width, tile_height);
+
+    u32 *tile_indices = create_tile_order(arena, settings.tile_order, tile_count_x, tile_count_y);
+
+    u64 last_snapshot_clock = start_clock;
+    u32 passes_completed = 0;
+    u64 target_reached_ms = 0;
+    u64 target_reached_bounces = 0;
+    u32 unconverged_pixel_count = image.width * image.height;
+    for (u32 pass_i = 0; 
+         pass_i < pass_count && !work_queue.cancel_requested && unconverged_pixel_count > 0;
+         pass_i += 1)
+    {
+      JobCounter tiles_counter = {};
+      u64 tiles_retired_start = ATOMIC_LOAD_RELAXED(&work_queue.tiles_retired_count);
+      u32 tiles_submitted = 0;
+
+      for (u32 order_i = 0; order_i < total_tile_count; order_i += 1)
+      {
+        u32 tile_index = tile_indices[order_i];
+        WorkOrder *work_order = &work_orders[tile_index];
+
+        // NOTE(Ryan): Kernel would skip every pixel anyway, so save the job
+        if (settings.use_adaptive && work_order->unconverged_pixel_count == 0)
+        {
+          continue;
+        }
+
+        job_submit(job_system, render_tile_job, work_order, &tiles_counter);
+        tiles_submitted += 1;
+      }
+
+      // NOTE(Ryan): Same as job_wait_for_counter(), however interleave progress output and budget check
+      u32 spin_count = 0;
+      while (!job_counter_is_done(&tiles_counter))
+      {
+        if (job_system_try_run(job_system))
+        {
+          spin_count = 0;
+          // only show if we render it, to reduce output
+          u64 tiles_retired = ATOMIC_LOAD_RELAXED(&work_queue.tiles_retired_count) - tiles_retired_start;
+          printf("\rRaycasting pass %u/%u %lu%% (%u pixels unconverged)    ", pass_i + 1, pass_count, 
+                 tiles_retired * 100 / tiles_submitted, unconverged_pixel_count);
+          fflush(stdout);
+        }
+        else
+        {
+          spin_backoff(&spin_count);
+        }
+
+        if (settings.time_budget_ms != 0 && get_wall_clock() - start_clock >= settings.time_budget_ms)
+        {
+          ATOMIC_STORE_RELAXED(&work_queue.cancel_requested, 1);
+        }
+      }
+
+      if (!work_queue.cancel_requested)
+      {
+        passes_completed += 1;
+      }
+
+      unconverged_pixel_count = 0;
+      for (u32 tile_i = 0; tile_i < total_tile_count; tile_i += 1)
+      {
+        unconverged_pixel_count += work_orders[tile_i].unconverged_pixel_count;
+      }
+      // NOTE(Ryan): A few fireflies next to emitters take far longer than the rest,
+      // so time to target is when nearly all pixels converged rather than every last one
+      u32 pixel_count = image.width * image.height;
+      if (target_reached_ms == 0 && 
+          (f32)unconverged_pixel_count <= (1.0f - RAY_TARGET_CONVERGED_FRACTION) * (f32)pixel_count)
+      {
+        target_reached_ms = get_wall_clock() - start_clock;
+        target_reached_bounces = work_queue.bounces_computed;
+      }
+
+      u64 now_clock = get_wall_clock();
+      if (snapshot_interval_ms != 0 && now_clock - last_snapshot_clock >= snapshot_interval_ms)
+      {
+        write_image_u32_snapshot(arena, job_system, &image, output_file_name);
+        last_snapshot_clock = now_clock;
+      }
+    }
+
+    end_clock = get_wall_clock();
+    u64 time_elapsed_ms = end_clock - start_clock;
+
+    printf("\n");
+    if (work_queue.cancel_requested)
+    {
+      printf("Time budget reached: %u/%u passes completed for every tile\n", passes_completed, pass_count);
+    }
+    if (target_reached_ms != 0)
+    {
+      printf("Target error reached: %lums, %lu bounces\n", target_reached_ms, target_reached_bounces);
+    }
+    else
+    {
+      printf("Target error not reached\n");
+    }
+    printf("Unconverged: %u/%u pixels\n", unconverged_pixel_count, image.width * image.height);
+    printf("Raycasting time: %ldms\n", time_elapsed_ms);
+    printf("Bounces computed: %lu\n", work_queue.bounces_computed);
+    // NOTE(Ryan): Varies with scene and settings; -bench fixes them and records this in misc/*.metric
+    printf("Performance: %fms/bounce\n", (r64)time_elapsed_ms / work_queue.bounces_computed);
+
+    if (resolve_bench_iteration_count != 0)
+    {
+      run_resolve_bench(arena, kernel, &work_queue, work_orders, total_tile_count, &image, resolve_bench_iteration_count);
+    }
+
+    u64 write_start_clock = get_wall_clock();
+    write_image_u32_snapshot(arena, job_system, &image, output_file_name);
+    printf("Image written: %s in %lums\n", output_file_name, get_wall_clock() - write_start_clock);
+
+    job_system_destroy(job_system);
+
+    printf("\nDone\n");
+  }
+
+  return 0;
+}
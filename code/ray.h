@@ -0,0 +1,224 @@
+// SPDX-License-Identifier: zlib-acknowledgement
+#pragma once
+
+// IMPORTANT(Ryan): Shared between ray.cpp and every ISA build of ray-kernel.cpp.
+// Kernel translation units are compiled with different -m flags, so only the parts of the base layer
+// that are entirely INTERNAL may be included here; anything with external linkage
+// (e.g. fiber asm symbols, job system thread-locals) would be defined once per ISA and fail to link
+#include "base-context.h"
+#include "base-types.h"
+#include "base-math.h"
+#include "base-platform-linux.h"
+#include "base-memory.h"
+#include "base-atomics.h"
+
+typedef f32 r32;
+typedef f64 r64;
+typedef Vec3F32 V3;
+typedef Vec4F32 V4;
+
+typedef struct ImageU32 ImageU32;
+struct ImageU32
+{
+  u32 width, height;
+  u32 *pixels;
+};
+
+// NOTE(Ryan): Running sums over every sample so far, so estimate is radiance / sample_count.
+// Kept in float so passes can keep adding without the quantisation of ImageU32.
+// Sum of squared luminance gives each pixel's sample variance, so converged pixels can stop early
+typedef struct Accumulation Accumulation;
+struct Accumulation
+{
+  u32 width, height;
+  V3 *radiance;
+  f32 *luminance_squared;
+  u32 *sample_counts;
+};
+
+typedef struct Material Material;
+struct Material
+{
+  r32 scatter; // 0 is diffuse, 1 is specular
+  V3 emitted_colour;
+  V3 reflected_colour;
+};
+
+typedef struct Plane Plane;
+struct Plane
+{
+  V3 normal;
+  r32 distance; // distance along normal
+  u32 material_index;
+};
+
+typedef struct Sphere Sphere;
+struct Sphere
+{
+  V3 position;
+  r32 radius;
+  u32 material_index;
+};
+
+// NOTE(Ryan): Edges and normal precomputed for Möller–Trumbore, so per-ray work is just the intersection
+typedef struct Triangle Triangle;
+struct Triangle
+{
+  V3 vertex0;
+  V3 edge1; // vertex1 - vertex0
+  V3 edge2; // vertex2 - vertex0
+  V3 normal;
+  u32 material_index;
+};
+
+// NOTE(Ryan): 32 bytes, so 2 nodes per cache line.
+// Stored depth-first, so an interior node's left child is always the next node and only the right is stored
+typedef struct BVHNode BVHNode;
+struct BVHNode
+{
+  V3 bounds_min;
+  u32 offset; // leaf: first primitive, interior: right child node
+  V3 bounds_max;
+  u16 primitive_count; // 0 if interior
+  u16 split_axis;
+};
+
+// NOTE(Ryan): Builder stops splitting here, so traversal stack can be fixed size
+#define BVH_MAX_DEPTH 64
+
+// NOTE(Ryan): One per primitive type, so leaves are a contiguous range of a single World array
+typedef struct BVH BVH;
+struct BVH
+{
+  u32 node_count;
+  BVHNode *nodes; // NULL to brute force every primitive
+};
+
+// NOTE(Ryan): Kernel side copies of planes and spheres, one array per field, so a lane can be loaded straight
+// from any index rather than copied out of a struct and splatted.
+// Padded with a full widest lane (16) of entries past count that never hit, so a load starting at any
+// index < count stays in bounds; loads spilling past a range into real primitives are still correct hits
+#define RAY_SOA_PADDING 16
+
+typedef struct PlaneSoA PlaneSoA;
+struct PlaneSoA
+{
+  u32 count;
+  f32 *normal_x, *normal_y, *normal_z;
+  f32 *distance;
+  u32 *material_index;
+};
+
+typedef struct SphereSoA SphereSoA;
+struct SphereSoA
+{
+  u32 count;
+  f32 *x, *y, *z;
+  f32 *radius_squared; // negative for padding, so discriminant is never positive
+  u32 *material_index;
+};
+
+typedef struct World World;
+struct World
+{ 
+  u32 material_count;
+  Material *materials;
+
+  // NOTE(Ryan): Infinite, so always tested linearly
+  u32 plane_count;
+  Plane *planes;
+
+  // IMPORTANT(Ryan): Reordered by bvh_build_world() so each leaf is a contiguous range
+  u32 sphere_count;
+  Sphere *spheres;
+  u32 triangle_count;
+  Triangle *triangles;
+
+  BVH sphere_bvh;
+  BVH triangle_bvh;
+
+  // IMPORTANT(Ryan): Built from planes and spheres by world_build_soa(), after any reordering.
+  // Kernel only reads these, so authoring structs can change without touching it
+  PlaneSoA plane_soa;
+  SphereSoA sphere_soa;
+  // NOTE(Ryan): sphere_soa indices of spheres with an emissive material other than sky; sampled at every diffuse hit.
+  // Only spheres can be lights, so planes and triangles shouldn't use emissive materials
+  u32 light_count;
+  u32 *light_sphere_indices;
+};
+
+// NOTE(Ryan): Maps linear radiance into [0, 1] before sRGB encode; NONE just clips
+typedef u32 RAY_TONEMAP;
+enum
+{
+  RAY_TONEMAP_NONE,
+  RAY_TONEMAP_REINHARD,
+  RAY_TONEMAP_ACES,
+  RAY_TONEMAP_COUNT,
+};
+
+typedef struct WorkOrder WorkOrder;
+typedef void (*render_tile_func)(WorkOrder *order);
+
+// NOTE(Ryan): Host side only, one per job worker. Each written by its own worker, so padded to a line
+typedef struct RayWorkerStats RayWorkerStats;
+struct RayWorkerStats
+{
+  CACHE_ALIGNED u64 busy_ns;
+};
+
+typedef struct WorkQueue WorkQueue;
+struct WorkQueue
+{
+  // read-only once jobs are submitted
+  u32 max_bounce_count;
+  u32 rays_per_pixel_per_pass;
+  // NOTE(Ryan): Hashed with pixel and sample index, so same seed gives same image
+  u32 random_seed;
+  // NOTE(Ryan): Pixels whose error estimate is at or below this count as converged.
+  // Only skipped if skip_converged_pixels, so fixed sampling can still report when it reached the target
+  f32 target_error;
+  b32 skip_converged_pixels;
+  RAY_TONEMAP tonemap;
+  b32 dither;
+  // NOTE(Ryan): Per pixel powf() reference instead of lane-wide approximation, for comparison
+  b32 use_exact_srgb;
+  render_tile_func render_tile;
+  RayWorkerStats *worker_stats; // NULL unless benchmarking
+
+  // NOTE(Ryan): Set once by host to abandon remaining tiles; read at start of every tile
+  CACHE_ALIGNED u32 cancel_requested;
+
+  // NOTE(Ryan): Every tile adds to these, so keep them off the read-only line above and off each other
+  CACHE_ALIGNED u64 bounces_computed;
+  CACHE_ALIGNED u64 tiles_retired_count;
+};
+
+// NOTE(Ryan): Job payload
+struct WorkOrder
+{
+  WorkQueue *queue;
+  World *world;
+  ImageU32 *image; 
+  Accumulation *accumulation;
+  u32 x_min;
+  u32 y_min; 
+  u32 one_past_x_max; 
+  u32 one_past_y_max;
+
+  // NOTE(Ryan): Written by render_tile; pixels still above target error, so host can stop submitting tile at 0
+  u32 unconverged_pixel_count;
+  // NOTE(Ryan): Host side; released once the kernel returns, so tiles can be streamed out as they finish
+  u32 passes_retired;
+};
+
+// NOTE(Ryan): One symbol per ISA build of ray-kernel.cpp, selected at startup in ray.cpp.
+// resolve_tile rewrites a tile's pixels from its accumulation without sampling, e.g. to change tonemap
+EXPORT void render_tile_scalar(WorkOrder *order);
+EXPORT void render_tile_sse4(WorkOrder *order);
+EXPORT void render_tile_avx2(WorkOrder *order);
+EXPORT void render_tile_avx512(WorkOrder *order);
+EXPORT void resolve_tile_scalar(WorkOrder *order);
+EXPORT void resolve_tile_sse4(WorkOrder *order);
+EXPORT void resolve_tile_avx2(WorkOrder *order);
+EXPORT void resolve_tile_avx512(WorkOrder *order);
@@ -0,0 +1,530 @@
+// SPDX-License-Identifier: zlib-acknowledgement
+
+// IMPORTANT(Ryan): Compiled once per ISA (see build_tests() in misc/build), each with its own LANE_WIDTH and -m flags,
+// like ray-kernel.cpp. Every lane op is checked against a scalar reference computed per lane from the same inputs,
+// so a width that disagrees with LANE_WIDTH 1 is caught here rather than as noise in a render.
+// Only the suffixed entry points are visible, called from tests.cpp for each ISA the CPU supports
+
+#if !defined(TESTS_LANE_ISA)
+  #error Define TESTS_LANE_ISA, e.g. -DTESTS_LANE_ISA=avx2
+#endif
+
+// NOTE(Ryan): As in ray.h, only headers that are entirely INTERNAL, 
+// otherwise e.g. stb_sprintf would be defined once per ISA and fail to link
+#include "base-context.h"
+#include "base-types.h"
+#include "base-math.h"
+#include "base-platform-linux.h"
+#include "base-memory.h"
+#include "base-lane.h"
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+// NOTE(Ryan): Vendored cmocka.h has no C++ guards
+EXPORT_BEGIN
+#include <cmocka.h>
+EXPORT_END
+
+#define TESTS_LANE_NAME(name) PASTE(PASTE(name, _), TESTS_LANE_ISA)
+
+#define TESTS_LANE_ITERATION_COUNT 2000
+// NOTE(Ryan): Relative, for ops whose lane and scalar forms may round differently, e.g. FMA contraction of dot products
+#define TESTS_LANE_TOLERANCE 1e-5f
+
+typedef struct LaneTestInputs LaneTestInputs;
+struct LaneTestInputs
+{
+  f32 a[LANE_WIDTH];
+  f32 b[LANE_WIDTH];
+  f32 t[LANE_WIDTH]; // [0, 1]
+  u32 ua[LANE_WIDTH];
+  u32 ub[LANE_WIDTH];
+  u32 mask[LANE_WIDTH]; // all 1s or all 0s
+  Vec3F32 va[LANE_WIDTH];
+  Vec3F32 vb[LANE_WIDTH];
+};
+
+INTERNAL u32
+lane_test_random(u32 *state)
+{
+  u32 x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *state = x;
+
+  return x;
+}
+
+// NOTE(Ryan): Never 0 for b, so division is finite.
+// Some lanes share values, so equality comparisons see both outcomes
+INTERNAL f32
+lane_test_random_f32(u32 *state)
+{
+  f32 result = (f32)((s32)(lane_test_random(state) % 20001) - 10000) / 37.0f;
+
+  return result;
+}
+
+INTERNAL void
+lane_test_inputs_random(LaneTestInputs *inputs, u32 *state)
+{
+  for (u32 lane_i = 0; lane_i < LANE_WIDTH; lane_i += 1)
+  {
+    inputs->a[lane_i] = lane_test_random_f32(state);
+    inputs->b[lane_i] = lane_test_random_f32(state);
+    if (lane_test_random(state) % 4 == 0)
+    {
+      inputs->b[lane_i] = inputs->a[lane_i];
+    }
+    if (!(f32_abs(inputs->b[lane_i]) > 0.0f))
+    {
+      inputs->b[lane_i] = 1.0f;
+    }
+    inputs->t[lane_i] = (f32)(lane_test_random(state) % 1025) / 1024.0f;
+
+    inputs->ua[lane_i] = lane_test_random(state);
+    inputs->ub[lane_i] = (lane_test_random(state) % 4 == 0) ? inputs->ua[lane_i] : lane_test_random(state);
+    inputs->mask[lane_i] = (lane_test_random(state) % 2 == 0) ? 0xFFFFFFFF : 0;
+
+    inputs->va[lane_i] = vec3_f32(lane_test_random_f32(state), lane_test_random_f32(state), lane_test_random_f32(state));
+    inputs->vb[lane_i] = vec3_f32(lane_test_random_f32(state), lane_test_random_f32(state), lane_test_random_f32(state));
+    // NOTE(Ryan): Exercises lane_v3_noz() zeroing degenerate lanes
+    if (lane_test_random(state) % 8 == 0)
+    {
+      inputs->va[lane_i] = vec3_f32(0.0f, 0.0f, 0.0f);
+    }
+  }
+}
+
+INTERNAL LaneV3
+lane_v3_load(Vec3F32 *src)
+{
+  f32 x[LANE_WIDTH], y[LANE_WIDTH], z[LANE_WIDTH];
+  for (u32 lane_i = 0; lane_i < LANE_WIDTH; lane_i += 1)
+  {
+    x[lane_i] = src[lane_i].x;
+    y[lane_i] = src[lane_i].y;
+    z[lane_i] = src[lane_i].z;
+  }
+
+  return lane_v3(lane_f32_load(x), lane_f32_load(y), lane_f32_load(z));
+}
+
+INTERNAL void
+lane_test_check_f32(const char *op_name, LaneF32 actual, f32 *expected, f32 tolerance)
+{
+  f32 actual_values[LANE_WIDTH];
+  lane_f32_store(actual_values, actual);
+
+  for (u32 lane_i = 0; lane_i < LANE_WIDTH; lane_i += 1)
+  {
+    f32 error = f32_abs(actual_values[lane_i] - expected[lane_i]);
+    if (!(error <= tolerance * MAX(1.0f, f32_abs(expected[lane_i]))))
+    {
+      fail_msg("%s at width %u, lane %u: %.9g, expected %.9g", op_name, LANE_WIDTH, lane_i,
+               (f64)actual_values[lane_i], (f64)expected[lane_i]);
+    }
+  }
+}
+
+INTERNAL void
+lane_test_check_u32(const char *op_name, LaneU32 actual, u32 *expected)
+{
+  u32 actual_values[LANE_WIDTH];
+  lane_u32_store(actual_values, actual);
+
+  for (u32 lane_i = 0; lane_i < LANE_WIDTH; lane_i += 1)
+  {
+    if (actual_values[lane_i] != expected[lane_i])
+    {
+      fail_msg("%s at width %u, lane %u: 0x%08x, expected 0x%08x", op_name, LANE_WIDTH, lane_i,
+               actual_values[lane_i], expected[lane_i]);
+    }
+  }
+}
+
+INTERNAL void
+lane_test_check_v3(const char *op_name, LaneV3 actual, Vec3F32 *expected, f32 tolerance)
+{
+  f32 expected_x[LANE_WIDTH], expected_y[LANE_WIDTH], expected_z[LANE_WIDTH];
+  for (u32 lane_i = 0; lane_i < LANE_WIDTH; lane_i += 1)
+  {
+    expected_x[lane_i] = expected[lane_i].x;
+    expected_y[lane_i] = expected[lane_i].y;
+    expected_z[lane_i] = expected[lane_i].z;
+  }
+
+  lane_test_check_f32(op_name, actual.x, expected_x, tolerance);
+  lane_test_check_f32(op_name, actual.y, expected_y, tolerance);
+  lane_test_check_f32(op_name, actual.z, expected_z, tolerance);
+}
+
+// NOTE(Ryan): scalar_expr is evaluated per lane, with that lane's inputs named as in LaneTestInputs
+#define LANE_TEST_FOR_EACH_LANE(T, expected, scalar_expr) \
+  T expected[LANE_WIDTH]; \
+  for (u32 lane_i = 0; lane_i < LANE_WIDTH; lane_i += 1) \
+  { \
+    f32 a = inputs.a[lane_i], b = inputs.b[lane_i], t = inputs.t[lane_i]; \
+    u32 ua = inputs.ua[lane_i], ub = inputs.ub[lane_i], mask = inputs.mask[lane_i]; \
+    Vec3F32 va = inputs.va[lane_i], vb = inputs.vb[lane_i]; \
+    (void)a; (void)b; (void)t; (void)ua; (void)ub; (void)mask; (void)va; (void)vb; \
+    expected[lane_i] = (scalar_expr); \
+  }
+
+#define LANE_TEST_CHECK_F32(op_name, lane_expr, scalar_expr, tolerance) \
+  do { \
+    LANE_TEST_FOR_EACH_LANE(f32, expected, scalar_expr) \
+    lane_test_check_f32(op_name, lane_expr, expected, tolerance); \
+  } while (0)
+
+#define LANE_TEST_CHECK_U32(op_name, lane_expr, scalar_expr) \
+  do { \
+    LANE_TEST_FOR_EACH_LANE(u32, expected, scalar_expr) \
+    lane_test_check_u32(op_name, lane_expr, expected); \
+  } while (0)
+
+#define LANE_TEST_CHECK_V3(op_name, lane_expr, scalar_expr, tolerance) \
+  do { \
+    LANE_TEST_FOR_EACH_LANE(Vec3F32, expected, scalar_expr) \
+    lane_test_check_v3(op_name, lane_expr, expected, tolerance); \
+  } while (0)
+
+#define LANE_TEST_BOOL_MASK(cond) ((cond) ? 0xFFFFFFFF : 0)
+
+INTERNAL u32
+lane_test_reinterpret_f32(f32 value)
+{
+  u32 result = 0;
+  MEMORY_COPY(&result, &value, sizeof(result));
+
+  return result;
+}
+
+INTERNAL f32
+lane_test_reinterpret_u32(u32 value)
+{
+  f32 result = 0.0f;
+  MEMORY_COPY(&result, &value, sizeof(result));
+
+  return result;
+}
+
+INTERNAL f32
+lane_test_dot(Vec3F32 a, Vec3F32 b)
+{
+  return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+INTERNAL Vec3F32
+lane_test_cross(Vec3F32 a, Vec3F32 b)
+{
+  return vec3_f32(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+}
+
+INTERNAL Vec3F32
+lane_test_noz(Vec3F32 v)
+{
+  Vec3F32 result = vec3_f32(0.0f, 0.0f, 0.0f);
+
+  f32 length_sq = lane_test_dot(v, v);
+  if (length_sq > SQUARE(0.0001f))
+  {
+    f32 inv_length = 1.0f / f32_sqrt(length_sq);
+    result = vec3_f32(v.x * inv_length, v.y * inv_length, v.z * inv_length);
+  }
+
+  return result;
+}
+
+INTERNAL void
+test_lane_f32_matches_scalar(UNUSED void **state)
+{
+  u32 random_state = 0x9E3779B9;
+
+  for (u32 iteration_i = 0; iteration_i < TESTS_LANE_ITERATION_COUNT; iteration_i += 1)
+  {
+    LaneTestInputs inputs = ZERO_STRUCT;
+    lane_test_inputs_random(&inputs, &random_state);
+
+    LaneF32 la = lane_f32_load(inputs.a);
+    LaneF32 lb = lane_f32_load(inputs.b);
+    LaneF32 lt = lane_f32_load(inputs.t);
+    LaneU32 lmask = lane_u32_load(inputs.mask);
+
+    LANE_TEST_CHECK_F32("replicate", lane_f32(inputs.a[0]), inputs.a[0], 0.0f);
+    LANE_TEST_CHECK_F32("add", la + lb, a + b, 0.0f);
+    LANE_TEST_CHECK_F32("sub", la - lb, a - b, 0.0f);
+    LANE_TEST_CHECK_F32("mul", la * lb, a * b, 0.0f);
+    LANE_TEST_CHECK_F32("div", la / lb, a / b, 0.0f);
+    LANE_TEST_CHECK_F32("add f32", la + 3.5f, a + 3.5f, 0.0f);
+    LANE_TEST_CHECK_F32("f32 sub", 3.5f - la, 3.5f - a, 0.0f);
+    LANE_TEST_CHECK_F32("neg", -la, -a, 0.0f);
+    LANE_TEST_CHECK_F32("min", lane_f32_min(la, lb), MIN(a, b), 0.0f);
+    LANE_TEST_CHECK_F32("max", lane_f32_max(la, lb), MAX(a, b), 0.0f);
+    LANE_TEST_CHECK_F32("abs", lane_f32_abs(la), f32_abs(a), 0.0f);
+    LANE_TEST_CHECK_F32("sqrt", lane_f32_sqrt(lane_f32_abs(la)), f32_sqrt(f32_abs(a)), 0.0f);
+    LANE_TEST_CHECK_F32("clamp01", lane_f32_clamp01(la * 0.01f), CLAMP(0.0f, a * 0.01f, 1.0f), 0.0f);
+    LANE_TEST_CHECK_F32("lerp", lane_f32_lerp(la, lb, lt), a + (b - a) * t, TESTS_LANE_TOLERANCE);
+    LANE_TEST_CHECK_F32("select", lane_f32_select(lmask, la, lb), mask ? b : a, 0.0f);
+
+    LaneF32 assigned = la;
+    conditional_assign(&assigned, lmask, lb);
+    LANE_TEST_CHECK_F32("conditional_assign", assigned, mask ? b : a, 0.0f);
+
+    // NOTE(Ryan): Against sinf() rather than a scalar copy, as the polynomial is the thing under test
+    LANE_TEST_CHECK_F32("sin_turns", lane_f32_sin_turns(lt), f32_sin(2.0f * F32_PI * t), TESTS_LANE_TOLERANCE);
+    LANE_TEST_CHECK_F32("cos_turns", lane_f32_cos_turns(lt), f32_cos(2.0f * F32_PI * t), TESTS_LANE_TOLERANCE);
+
+    LANE_TEST_CHECK_U32("lt", la < lb, LANE_TEST_BOOL_MASK(a < b));
+    LANE_TEST_CHECK_U32("le", la <= lb, LANE_TEST_BOOL_MASK(a <= b));
+    LANE_TEST_CHECK_U32("gt", la > lb, LANE_TEST_BOOL_MASK(a > b));
+    LANE_TEST_CHECK_U32("ge", la >= lb, LANE_TEST_BOOL_MASK(a >= b));
+    LANE_TEST_CHECK_U32("eq", lane_f32_eq(la, lb), LANE_TEST_BOOL_MASK(a <= b && a >= b));
+    LANE_TEST_CHECK_U32("ne", lane_f32_ne(la, lb), LANE_TEST_BOOL_MASK(a < b || a > b));
+    LANE_TEST_CHECK_U32("lt f32", la < 1.0f, LANE_TEST_BOOL_MASK(a < 1.0f));
+
+    LANE_TEST_CHECK_U32("reinterpret", lane_u32_reinterpret_f32(la), lane_test_reinterpret_f32(a));
+    // NOTE(Ryan): Top 2 bits clear, so always a finite positive f32
+    LANE_TEST_CHECK_F32("reinterpret u32", lane_f32_reinterpret_u32(lane_u32_load(inputs.ua) >> 2), 
+                        lane_test_reinterpret_u32(ua >> 2), 0.0f);
+    // NOTE(Ryan): Below AVX-512 conversions are signed, so inputs kept < 2^31
+    LANE_TEST_CHECK_F32("from_u32", lane_f32_from_u32(lane_u32_load(inputs.ua) >> 1), (f32)(ua >> 1), 0.0f);
+    LANE_TEST_CHECK_U32("round_f32", lane_u32_round_f32(lane_f32_abs(la) * 100.0f), (u32)lrintf(f32_abs(a) * 100.0f));
+
+    f64 sum = 0.0;
+    f32 min = inputs.a[0];
+    f32 max = inputs.a[0];
+    for (u32 lane_i = 0; lane_i < LANE_WIDTH; lane_i += 1)
+    {
+      sum += (f64)inputs.a[lane_i];
+      min = MIN(min, inputs.a[lane_i]);
+      max = MAX(max, inputs.a[lane_i]);
+      assert_true(f32_abs(lane_f32_extract(la, lane_i) - inputs.a[lane_i]) <= 0.0f);
+    }
+    assert_true(f32_abs(horizontal_add(la) - (f32)sum) <= 0.0f);
+    assert_true(f32_abs(horizontal_min(la) - min) <= 0.0f);
+    assert_true(f32_abs(horizontal_max(la) - max) <= 0.0f);
+  }
+}
+
+typedef struct LaneTestGatherElement LaneTestGatherElement;
+struct LaneTestGatherElement
+{
+  f32 f;
+  u32 u;
+  Vec3F32 v;
+};
+
+#define LANE_TEST_GATHER_COUNT 64
+
+INTERNAL void
+test_lane_u32_matches_scalar(UNUSED void **state)
+{
+  u32 random_state = 0x85EBCA6B;
+
+  LaneTestGatherElement elements[LANE_TEST_GATHER_COUNT] = ZERO_STRUCT;
+  for (u32 element_i = 0; element_i < LANE_TEST_GATHER_COUNT; element_i += 1)
+  {
+    elements[element_i].f = (f32)element_i * 1.5f;
+    elements[element_i].u = element_i * 3;
+    elements[element_i].v = vec3_f32((f32)element_i, (f32)element_i * 2.0f, (f32)element_i * 3.0f);
+  }
+
+  for (u32 iteration_i = 0; iteration_i < TESTS_LANE_ITERATION_COUNT; iteration_i += 1)
+  {
+    LaneTestInputs inputs = ZERO_STRUCT;
+    lane_test_inputs_random(&inputs, &random_state);
+
+    LaneU32 lua = lane_u32_load(inputs.ua);
+    LaneU32 lub = lane_u32_load(inputs.ub);
+    LaneU32 lmask = lane_u32_load(inputs.mask);
+
+    LANE_TEST_CHECK_U32("replicate", lane_u32(inputs.ua[0]), inputs.ua[0]);
+    LANE_TEST_CHECK_U32("add", lua + lub, ua + ub);
+    LANE_TEST_CHECK_U32("sub", lua - lub, ua - ub);
+    LANE_TEST_CHECK_U32("mul", lua * lub, ua * ub);
+    LANE_TEST_CHECK_U32("and", lua & lub, ua & ub);
+    LANE_TEST_CHECK_U32("or", lua | lub, ua | ub);
+    LANE_TEST_CHECK_U32("xor", lua ^ lub, ua ^ ub);
+    LANE_TEST_CHECK_U32("and_not", lane_u32_and_not(lua, lub), ua & ~ub);
+    LANE_TEST_CHECK_U32("not", ~lua, ~ua);
+    LANE_TEST_CHECK_U32("shl", lua << 7, ua << 7);
+    LANE_TEST_CHECK_U32("shr", lua >> 9, ua >> 9);
+    LANE_TEST_CHECK_U32("eq", lua == lub, LANE_TEST_BOOL_MASK(ua == ub));
+    LANE_TEST_CHECK_U32("ne", lua != lub, LANE_TEST_BOOL_MASK(ua != ub));
+    // NOTE(Ryan): Inputs span all 32 bits, so catches a signed compare
+    LANE_TEST_CHECK_U32("gt", lua > lub, LANE_TEST_BOOL_MASK(ua > ub));
+    LANE_TEST_CHECK_U32("eq u32", lua == inputs.ua[0], LANE_TEST_BOOL_MASK(ua == inputs.ua[0]));
+    LANE_TEST_CHECK_U32("select", lane_u32_select(lmask, lua, lub), mask ? ub : ua);
+    LANE_TEST_CHECK_U32("index", lane_u32_index(), lane_i);
+
+    LaneU32 assigned = lua;
+    conditional_assign(&assigned, lmask, lub);
+    LANE_TEST_CHECK_U32("conditional_assign", assigned, mask ? ub : ua);
+
+    LaneU32 indices = lua & lane_u32(LANE_TEST_GATHER_COUNT - 1);
+    LANE_TEST_CHECK_F32("gather f32", LANE_F32_GATHER(elements, f, indices), elements[ua & (LANE_TEST_GATHER_COUNT - 1)].f, 0.0f);
+    LANE_TEST_CHECK_U32("gather u32", LANE_U32_GATHER(elements, u, indices), elements[ua & (LANE_TEST_GATHER_COUNT - 1)].u);
+
+    u32 set_count = 0;
+    u64 sum = 0;
+    for (u32 lane_i = 0; lane_i < LANE_WIDTH; lane_i += 1)
+    {
+      set_count += (inputs.mask[lane_i] != 0);
+      sum += inputs.ua[lane_i];
+      assert_int_equal(lane_u32_extract(lua, lane_i), inputs.ua[lane_i]);
+    }
+    assert_int_equal(mask_count(lmask), set_count);
+    assert_int_equal(mask_is_zeroed(lmask), (set_count == 0));
+    assert_int_equal(mask_is_full(lmask), (set_count == LANE_WIDTH));
+    assert_int_equal(horizontal_add(lua), sum);
+  }
+
+  // NOTE(Ryan): Random masks rarely come out all set at width 16
+  assert_true(mask_is_full(lane_u32(0xFFFFFFFF)));
+  assert_true(mask_is_zeroed(lane_u32(0)));
+}
+
+INTERNAL void
+test_lane_v3_matches_scalar(UNUSED void **state)
+{
+  u32 random_state = 0xC2B2AE35;
+
+  LaneTestGatherElement elements[LANE_TEST_GATHER_COUNT] = ZERO_STRUCT;
+  for (u32 element_i = 0; element_i < LANE_TEST_GATHER_COUNT; element_i += 1)
+  {
+    elements[element_i].v = vec3_f32((f32)element_i, (f32)element_i * 2.0f, (f32)element_i * 3.0f);
+  }
+
+  for (u32 iteration_i = 0; iteration_i < TESTS_LANE_ITERATION_COUNT; iteration_i += 1)
+  {
+    LaneTestInputs inputs = ZERO_STRUCT;
+    lane_test_inputs_random(&inputs, &random_state);
+
+    LaneV3 lva = lane_v3_load(inputs.va);
+    LaneV3 lvb = lane_v3_load(inputs.vb);
+    LaneF32 la = lane_f32_load(inputs.a);
+    LaneF32 lt = lane_f32_load(inputs.t);
+    LaneU32 lmask = lane_u32_load(inputs.mask);
+
+    LANE_TEST_CHECK_V3("replicate", lane_v3_from_vec3_f32(inputs.va[0]), inputs.va[0], 0.0f);
+    LANE_TEST_CHECK_V3("add", lva + lvb, vec3_f32(va.x + vb.x, va.y + vb.y, va.z + vb.z), 0.0f);
+    LANE_TEST_CHECK_V3("sub", lva - lvb, vec3_f32(va.x - vb.x, va.y - vb.y, va.z - vb.z), 0.0f);
+    LANE_TEST_CHECK_V3("neg", -lva, vec3_f32(-va.x, -va.y, -va.z), 0.0f);
+    LANE_TEST_CHECK_V3("mul", lva * la, vec3_f32(va.x * a, va.y * a, va.z * a), 0.0f);
+    LANE_TEST_CHECK_V3("mul f32", 0.5f * lva, vec3_f32(0.5f * va.x, 0.5f * va.y, 0.5f * va.z), 0.0f);
+    LANE_TEST_CHECK_V3("hadamard", lane_v3_hadamard(lva, lvb), vec3_f32(va.x * vb.x, va.y * vb.y, va.z * vb.z), 0.0f);
+    LANE_TEST_CHECK_V3("lerp", lane_v3_lerp(lva, lvb, lt),
+                       vec3_f32(va.x + (vb.x - va.x) * t, va.y + (vb.y - va.y) * t, va.z + (vb.z - va.z) * t),
+                       TESTS_LANE_TOLERANCE);
+    // NOTE(Ryan): Sums of products cancel, so tolerance is relative to the products' magnitude, not the result's
+    LANE_TEST_CHECK_F32("dot", lane_v3_dot(lva, lvb) * 1e-4f, lane_test_dot(va, vb) * 1e-4f, TESTS_LANE_TOLERANCE);
+    LANE_TEST_CHECK_F32("lengthsq", lane_v3_lengthsq(lva), lane_test_dot(va, va), TESTS_LANE_TOLERANCE);
+    LANE_TEST_CHECK_V3("cross", lane_v3_cross(lva, lvb) * 1e-4f, vec3_f32_mul(lane_test_cross(va, vb), 1e-4f), TESTS_LANE_TOLERANCE);
+    LANE_TEST_CHECK_V3("noz", lane_v3_noz(lva), lane_test_noz(va), TESTS_LANE_TOLERANCE);
+
+    LaneV3 assigned = lva;
+    conditional_assign(&assigned, lmask, lvb);
+    LANE_TEST_CHECK_V3("conditional_assign", assigned, mask ? vb : va, 0.0f);
+
+    LaneU32 indices = lane_u32_load(inputs.ua) & lane_u32(LANE_TEST_GATHER_COUNT - 1);
+    LANE_TEST_CHECK_V3("gather", LANE_V3_GATHER(elements, v, indices), elements[ua & (LANE_TEST_GATHER_COUNT - 1)].v, 0.0f);
+
+    Vec3F32 sum = vec3_f32(0.0f, 0.0f, 0.0f);
+    f64 sum_x = 0.0, sum_y = 0.0, sum_z = 0.0;
+    for (u32 lane_i = 0; lane_i < LANE_WIDTH; lane_i += 1)
+    {
+      Vec3F32 extracted = lane_v3_extract(lva, lane_i);
+      assert_true(f32_abs(extracted.x - inputs.va[lane_i].x) + f32_abs(extracted.y - inputs.va[lane_i].y) +
+                  f32_abs(extracted.z - inputs.va[lane_i].z) <= 0.0f);
+      sum_x += (f64)inputs.va[lane_i].x;
+      sum_y += (f64)inputs.va[lane_i].y;
+      sum_z += (f64)inputs.va[lane_i].z;
+    }
+    sum = vec3_f32((f32)sum_x, (f32)sum_y, (f32)sum_z);
+    Vec3F32 horizontal_sum = horizontal_add(lva);
+    assert_true(f32_abs(horizontal_sum.x - sum.x) + f32_abs(horizontal_sum.y - sum.y) +
+                f32_abs(horizontal_sum.z - sum.z) <= 0.0f);
+
+    // NOTE(Ryan): No scalar version of these, so check the properties callers rely on
+    LaneV3 normal = lane_v3_noz(lvb);
+    LaneV3 tangent, bitangent;
+    lane_v3_basis(normal, &tangent, &bitangent);
+    LANE_TEST_CHECK_F32("basis tangent length", lane_v3_lengthsq(tangent), 1.0f, 1e-4f);
+    LANE_TEST_CHECK_F32("basis bitangent length", lane_v3_lengthsq(bitangent), 1.0f, 1e-4f);
+    LANE_TEST_CHECK_F32("basis orthogonal", lane_v3_dot(tangent, bitangent) + lane_v3_dot(tangent, normal), 0.0f, 1e-4f);
+
+    LaneF32 cos_theta = 2.0f * lt - 1.0f;
+    LaneV3 direction = lane_v3_from_axis(normal, cos_theta, lane_f32_abs(la) * 0.001f);
+    LANE_TEST_CHECK_F32("from_axis length", lane_v3_lengthsq(direction), 1.0f, 1e-4f);
+    LANE_TEST_CHECK_F32("from_axis angle", lane_v3_dot(direction, normal), 2.0f * t - 1.0f, 1e-4f);
+  }
+}
+
+EXPORT int
+TESTS_LANE_NAME(tests_lane)(void)
+{
+  const struct CMUnitTest lane_tests[] = {
+    cmocka_unit_test(test_lane_f32_matches_scalar),
+    cmocka_unit_test(test_lane_u32_matches_scalar),
+    cmocka_unit_test(test_lane_v3_matches_scalar),
+  };
+
+  int result = cmocka_run_group_tests_name("lane_" STRINGIFY(TESTS_LANE_ISA), lane_tests, NULL, NULL);
+
+  return result;
+}
+
+#define BENCH_LANE_ELEMENT_COUNT 4096
+#define BENCH_LANE_REPEAT_COUNT 256
+
+// NOTE(Ryan): Million elements per second through a shading-like mix of LaneV3, LaneF32 and LaneU32 ops.
+// Same element count at every width, so rates are directly comparable
+EXPORT f64
+TESTS_LANE_NAME(bench_lane)(MemArena *arena)
+{
+  MemArenaTemp temp = mem_arena_temp_begin(arena);
+
+  f32 *xs = MEM_ARENA_PUSH_ARRAY(arena, f32, BENCH_LANE_ELEMENT_COUNT);
+  f32 *ys = MEM_ARENA_PUSH_ARRAY(arena, f32, BENCH_LANE_ELEMENT_COUNT);
+  f32 *zs = MEM_ARENA_PUSH_ARRAY(arena, f32, BENCH_LANE_ELEMENT_COUNT);
+  f32 *out = MEM_ARENA_PUSH_ARRAY(arena, f32, BENCH_LANE_ELEMENT_COUNT);
+  u32 random_state = 0x27D4EB2F;
+  for (u32 element_i = 0; element_i < BENCH_LANE_ELEMENT_COUNT; element_i += 1)
+  {
+    xs[element_i] = lane_test_random_f32(&random_state);
+    ys[element_i] = lane_test_random_f32(&random_state);
+    zs[element_i] = lane_test_random_f32(&random_state);
+  }
+
+  LaneV3 light = lane_v3_noz(lane_v3(0.3f, 0.8f, -0.5f));
+  LaneV3 colour = lane_v3(0.9f, 0.6f, 0.3f);
+
+  u64 start_ns = linux_get_ns();
+  for (u32 repeat_i = 0; repeat_i < BENCH_LANE_REPEAT_COUNT; repeat_i += 1)
+  {
+    for (u32 element_i = 0; element_i < BENCH_LANE_ELEMENT_COUNT; element_i += LANE_WIDTH)
+    {
+      LaneV3 normal = lane_v3_noz(lane_v3(lane_f32_load(xs + element_i), lane_f32_load(ys + element_i),
+                                          lane_f32_load(zs + element_i)));
+      LaneF32 lambert = lane_f32_clamp01(lane_v3_dot(normal, light));
+
+      LaneRandom random = ZERO_STRUCT;
+      random.key = lane_random_hash(lane_u32(element_i) + lane_u32_index());
+      LaneF32 jitter = lane_random_unilateral(&random);
+
+      LaneV3 shaded = lane_v3_lerp(lane_v3_hadamard(colour, lambert * normal), colour, jitter * 0.1f);
+      LaneF32 luminance = lane_v3_dot(shaded, lane_v3(0.2126f, 0.7152f, 0.0722f));
+      lane_f32_store(out + element_i, lane_f32_select(lambert > 0.0f, lane_f32(0.0f), luminance));
+    }
+  }
+  u64 elapsed_ns = linux_get_ns() - start_ns;
+
+  mem_arena_temp_end(temp);
+
+  f64 result = (f64)BENCH_LANE_ELEMENT_COUNT * BENCH_LANE_REPEAT_COUNT / ((f64)elapsed_ns / 1000.0);
+
+  return result;
+}
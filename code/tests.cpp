@@ -0,0 +1,1235 @@
+// SPDX-License-Identifier: zlib-acknowledgement
+
+// NOTE(Ryan): Headless unit and stress tests, built and run by misc/build tests.
+// There's no SDL, so only the base layer and SDL-free app headers are covered.
+// Benchmarks print once every test has passed; the tests target is a -O0 build,
+// so their numbers are only comparable with other runs of the tests target
+
+#include "base-inc.h"
+#include "base-lane.h"
+#include "app-ecs.h"
+#include "app-schedule.h"
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+// NOTE(Ryan): Vendored cmocka.h has no C++ guards
+EXPORT_BEGIN
+#include <cmocka.h>
+EXPORT_END
+
+typedef void *(*tests_thread_func)(void *arg);
+
+// NOTE(Ryan): One symbol per ISA build of tests-lane.cpp. Each returns its failed test count
+EXPORT int tests_lane_scalar(void);
+EXPORT int tests_lane_sse4(void);
+EXPORT int tests_lane_avx2(void);
+EXPORT int tests_lane_avx512(void);
+EXPORT f64 bench_lane_scalar(MemArena *arena);
+EXPORT f64 bench_lane_sse4(MemArena *arena);
+EXPORT f64 bench_lane_avx2(MemArena *arena);
+EXPORT f64 bench_lane_avx512(MemArena *arena);
+
+typedef int (*tests_lane_func)(void);
+typedef f64 (*bench_lane_func)(MemArena *arena);
+
+typedef struct TestsLaneISA TestsLaneISA;
+struct TestsLaneISA
+{
+  const char *name;
+  u32 lane_width;
+  tests_lane_func tests;
+  bench_lane_func bench;
+};
+
+GLOBAL TestsLaneISA tests_lane_isas[] = {
+  {"scalar", 1, tests_lane_scalar, bench_lane_scalar},
+  {"sse4", 4, tests_lane_sse4, bench_lane_sse4},
+  {"avx2", 8, tests_lane_avx2, bench_lane_avx2},
+  {"avx512", 16, tests_lane_avx512, bench_lane_avx512},
+};
+
+// NOTE(Ryan): Same checks as ray_kernel_is_supported(); unsupported widths are skipped rather than failed
+INTERNAL b32
+tests_lane_isa_is_supported(TestsLaneISA *isa)
+{
+  b32 result = true;
+
+  if (isa->lane_width == 4)
+  {
+    result = __builtin_cpu_supports("sse4.1");
+  }
+  else if (isa->lane_width == 8)
+  {
+    result = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+  }
+  else if (isa->lane_width == 16)
+  {
+    result = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+  }
+
+  return result;
+}
+
+// NOTE(Ryan): Small capacity, so producers keep finding the queue full and every cell wraps many laps
+#define TESTS_QUEUE_CAPACITY 64
+#define TESTS_QUEUE_ITEM_COUNT 20000
+#define TESTS_QUEUE_MAX_PAIR_COUNT 4
+
+typedef struct QueueStressShared QueueStressShared;
+struct QueueStressShared
+{
+  MPMCQueue *queue;
+  u32 producer_count;
+  u64 item_count; // per producer
+  u64 popped_count;
+  u32 *seen_counts; // by item, producer * item_count + sequence
+};
+
+typedef struct QueueStressThread QueueStressThread;
+struct QueueStressThread
+{
+  QueueStressShared *shared;
+  u32 index;
+  b32 is_ordered;
+};
+
+// NOTE(Ryan): Items are (producer << 32) | sequence, so consumers can tell whose each is and in what order it was pushed
+INTERNAL void *
+mpmc_stress_producer(void *arg)
+{
+  QueueStressThread *thread = (QueueStressThread *)arg;
+  QueueStressShared *shared = thread->shared;
+
+  for (u64 sequence = 0; sequence < shared->item_count; sequence += 1)
+  {
+    u64 item = ((u64)thread->index << 32) | sequence;
+    u32 spin_count = 0;
+    while (!mpmc_queue_push(shared->queue, &item))
+    {
+      spin_backoff(&spin_count);
+    }
+  }
+
+  return NULL;
+}
+
+// NOTE(Ryan): Vyukov's queue is linearisable, so one consumer sees each producer's items in push order
+INTERNAL void *
+mpmc_stress_consumer(void *arg)
+{
+  QueueStressThread *thread = (QueueStressThread *)arg;
+  QueueStressShared *shared = thread->shared;
+
+  u64 next_sequences[TESTS_QUEUE_MAX_PAIR_COUNT] = ZERO_STRUCT;
+  u64 total_count = shared->producer_count * shared->item_count;
+  thread->is_ordered = true;
+
+  u32 spin_count = 0;
+  while (ATOMIC_LOAD_ACQUIRE(&shared->popped_count) < total_count)
+  {
+    u64 item = 0;
+    if (mpmc_queue_pop(shared->queue, &item))
+    {
+      u32 producer = (u32)(item >> 32);
+      u64 sequence = item & U32_MAX;
+      if (sequence < next_sequences[producer])
+      {
+        thread->is_ordered = false;
+      }
+      next_sequences[producer] = sequence + 1;
+
+      ATOMIC_ADD_RELAXED(&shared->seen_counts[producer * shared->item_count + sequence], 1);
+      ATOMIC_ADD_ACQ_REL(&shared->popped_count, 1);
+      spin_count = 0;
+    }
+    else
+    {
+      spin_backoff(&spin_count);
+    }
+  }
+
+  return NULL;
+}
+
+INTERNAL void
+test_mpmc_queue_delivers_every_item_once(UNUSED void **state)
+{
+  MemArena *arena = mem_arena_allocate(MB(64));
+
+  for (u32 pair_count = 1; pair_count <= TESTS_QUEUE_MAX_PAIR_COUNT; pair_count *= 2)
+  {
+    MemArenaTemp temp = mem_arena_temp_begin(arena);
+
+    QueueStressShared shared = ZERO_STRUCT;
+    shared.queue = mpmc_queue_create(arena, sizeof(u64), TESTS_QUEUE_CAPACITY);
+    shared.producer_count = pair_count;
+    shared.item_count = TESTS_QUEUE_ITEM_COUNT;
+    shared.seen_counts = MEM_ARENA_PUSH_ARRAY_ZERO(arena, u32, pair_count * shared.item_count);
+
+    // NOTE(Ryan): Producers first, then consumers, all running at once
+    QueueStressThread threads[2 * TESTS_QUEUE_MAX_PAIR_COUNT] = ZERO_STRUCT;
+    for (u32 thread_i = 0; thread_i < 2 * pair_count; thread_i += 1)
+    {
+      threads[thread_i].shared = &shared;
+      threads[thread_i].index = thread_i % pair_count;
+    }
+
+    pthread_t pthreads[2 * TESTS_QUEUE_MAX_PAIR_COUNT] = ZERO_STRUCT;
+    for (u32 thread_i = 0; thread_i < 2 * pair_count; thread_i += 1)
+    {
+      tests_thread_func func = (thread_i < pair_count) ? mpmc_stress_producer : mpmc_stress_consumer;
+      pthread_create(&pthreads[thread_i], NULL, func, &threads[thread_i]);
+    }
+    for (u32 thread_i = 0; thread_i < 2 * pair_count; thread_i += 1)
+    {
+      pthread_join(pthreads[thread_i], NULL);
+    }
+
+    for (u64 item_i = 0; item_i < pair_count * shared.item_count; item_i += 1)
+    {
+      assert_int_equal(shared.seen_counts[item_i], 1);
+    }
+    for (u32 consumer_i = pair_count; consumer_i < 2 * pair_count; consumer_i += 1)
+    {
+      assert_true(threads[consumer_i].is_ordered);
+    }
+    assert_true(mpmc_queue_is_empty(shared.queue));
+
+    mem_arena_temp_end(temp);
+  }
+}
+
+typedef struct SPSCStressThread SPSCStressThread;
+struct SPSCStressThread
+{
+  SPSCRing *ring;
+  u32 item_count;
+  b32 is_ordered;
+  u32 popped_count;
+};
+
+// NOTE(Ryan): Batch sizes coprime with the capacity, so batches straddle the wrap at every offset
+INTERNAL void *
+spsc_stress_producer(void *arg)
+{
+  SPSCStressThread *thread = (SPSCStressThread *)arg;
+
+  u32 batch[37] = ZERO_STRUCT;
+  u32 next_item = 0;
+  u32 spin_count = 0;
+  while (next_item < thread->item_count)
+  {
+    u32 batch_count = MIN((u32)ARRAY_COUNT(batch), thread->item_count - next_item);
+    for (u32 batch_i = 0; batch_i < batch_count; batch_i += 1)
+    {
+      batch[batch_i] = next_item + batch_i;
+    }
+
+    u64 pushed_count = 0;
+    if (next_item % 3 == 0)
+    {
+      pushed_count = spsc_ring_push(thread->ring, &batch[0]) ? 1 : 0;
+    }
+    else
+    {
+      pushed_count = spsc_ring_push_batch(thread->ring, batch, batch_count);
+    }
+
+    next_item += (u32)pushed_count;
+    if (pushed_count == 0)
+    {
+      spin_backoff(&spin_count);
+    }
+    else
+    {
+      spin_count = 0;
+    }
+  }
+
+  return NULL;
+}
+
+INTERNAL void *
+spsc_stress_consumer(void *arg)
+{
+  SPSCStressThread *thread = (SPSCStressThread *)arg;
+
+  u32 batch[23] = ZERO_STRUCT;
+  thread->is_ordered = true;
+  u32 spin_count = 0;
+  while (thread->popped_count < thread->item_count)
+  {
+    u64 popped_count = 0;
+    if (thread->popped_count % 2 == 0)
+    {
+      popped_count = spsc_ring_pop(thread->ring, &batch[0]) ? 1 : 0;
+    }
+    else
+    {
+      popped_count = spsc_ring_pop_batch(thread->ring, batch, ARRAY_COUNT(batch));
+    }
+
+    for (u64 batch_i = 0; batch_i < popped_count; batch_i += 1)
+    {
+      if (batch[batch_i] != thread->popped_count)
+      {
+        thread->is_ordered = false;
+      }
+      thread->popped_count += 1;
+    }
+
+    if (popped_count == 0)
+    {
+      spin_backoff(&spin_count);
+    }
+    else
+    {
+      spin_count = 0;
+    }
+  }
+
+  return NULL;
+}
+
+// NOTE(Ryan): N rings, each with its own producer and consumer thread, all running at once
+INTERNAL void
+test_spsc_ring_delivers_every_item_in_order(UNUSED void **state)
+{
+  MemArena *arena = mem_arena_allocate(MB(64));
+
+  for (u32 pair_count = 1; pair_count <= TESTS_QUEUE_MAX_PAIR_COUNT; pair_count *= 2)
+  {
+    MemArenaTemp temp = mem_arena_temp_begin(arena);
+
+    SPSCStressThread pairs[TESTS_QUEUE_MAX_PAIR_COUNT] = ZERO_STRUCT;
+    for (u32 pair_i = 0; pair_i < pair_count; pair_i += 1)
+    {
+      pairs[pair_i].ring = spsc_ring_create(arena, sizeof(u32), TESTS_QUEUE_CAPACITY);
+      pairs[pair_i].item_count = TESTS_QUEUE_ITEM_COUNT;
+    }
+
+    pthread_t pthreads[2 * TESTS_QUEUE_MAX_PAIR_COUNT] = ZERO_STRUCT;
+    for (u32 pair_i = 0; pair_i < pair_count; pair_i += 1)
+    {
+      pthread_create(&pthreads[2 * pair_i], NULL, spsc_stress_producer, &pairs[pair_i]);
+      pthread_create(&pthreads[2 * pair_i + 1], NULL, spsc_stress_consumer, &pairs[pair_i]);
+    }
+    for (u32 thread_i = 0; thread_i < 2 * pair_count; thread_i += 1)
+    {
+      pthread_join(pthreads[thread_i], NULL);
+    }
+
+    for (u32 pair_i = 0; pair_i < pair_count; pair_i += 1)
+    {
+      assert_int_equal(pairs[pair_i].popped_count, pairs[pair_i].item_count);
+      assert_true(pairs[pair_i].is_ordered);
+    }
+
+    mem_arena_temp_end(temp);
+  }
+}
+
+#define TESTS_JOB_WORKER_COUNT 4
+#define TESTS_JOB_TIMEOUT_MS 2000
+
+typedef struct JobIOPayload JobIOPayload;
+struct JobIOPayload
+{
+  JobCounter io_counter;
+  b32 was_resumed;
+};
+
+INTERNAL void
+job_io_waiter(JobSystem *system, void *payload)
+{
+  JobIOPayload *io = (JobIOPayload *)payload;
+  job_wait_for_counter(system, &io->io_counter);
+  io->was_resumed = true;
+}
+
+typedef struct JobIOCompletion JobIOCompletion;
+struct JobIOCompletion
+{
+  JobSystem *system;
+  JobCounter *counter;
+};
+
+INTERNAL void *
+job_io_completion_thread(void *arg)
+{
+  JobIOCompletion *completion = (JobIOCompletion *)arg;
+  job_counter_signal(completion->system, completion->counter);
+
+  return NULL;
+}
+
+// NOTE(Ryan): Polls rather than helping, so creator doesn't run scheduler and resume parked fiber itself
+INTERNAL b32
+tests_poll_until(u32 *value, u32 expected)
+{
+  u64 deadline_ns = linux_get_ns() + (u64)TESTS_JOB_TIMEOUT_MS * 1000000;
+  while (ATOMIC_LOAD_ACQUIRE(value) != expected && linux_get_ns() < deadline_ns)
+  {
+    usleep(100);
+  }
+
+  b32 result = (ATOMIC_LOAD_ACQUIRE(value) == expected);
+
+  return result;
+}
+
+// NOTE(Ryan): Fiber parks on an I/O counter, every worker goes to sleep, then a foreign thread signals.
+// Signalling has to wake a worker, as nothing else will
+INTERNAL void
+test_job_foreign_signal_wakes_sleeping_worker(UNUSED void **state)
+{
+  MemArena *arena = mem_arena_allocate(MB(64));
+  JobSystem *system = job_system_create(arena, TESTS_JOB_WORKER_COUNT);
+
+  JobIOPayload *io = JOB_PUSH_PAYLOAD(arena, JobIOPayload);
+  io->io_counter.value = 1;
+  JobCounter job_counter = ZERO_STRUCT;
+  job_submit(system, job_io_waiter, io, &job_counter);
+
+  assert_true(tests_poll_until(&system->sleeping_count, TESTS_JOB_WORKER_COUNT - 1));
+  assert_non_null(ATOMIC_LOAD_ACQUIRE(&system->first_waiting_fiber));
+
+  JobIOCompletion completion = ZERO_STRUCT;
+  completion.system = system;
+  completion.counter = &io->io_counter;
+  pthread_t completion_pthread = ZERO_STRUCT;
+  pthread_create(&completion_pthread, NULL, job_io_completion_thread, &completion);
+  pthread_join(completion_pthread, NULL);
+
+  assert_true(tests_poll_until(&job_counter.value, 0));
+  assert_true(io->was_resumed);
+
+  job_system_destroy(system);
+}
+
+// NOTE(Ryan): Enough to fill the creator's deque and the injection queue behind it
+#define TESTS_JOB_OVERFLOW_COUNT (JOB_DEQUE_CAPACITY * 3)
+
+INTERNAL void
+job_count_once(UNUSED JobSystem *system, void *payload)
+{
+  u32 *executed_count = (u32 *)payload;
+  ATOMIC_ADD_RELAXED(executed_count, 1);
+}
+
+// NOTE(Ryan): Two child batches linked to one parent, together overflowing the submitter's deque.
+// Parent may only reach zero once every job in both batches has run
+INTERNAL void
+test_job_overflow_completes_under_parent_counter(UNUSED void **state)
+{
+  MemArena *arena = mem_arena_allocate(MB(64));
+  JobSystem *system = job_system_create(arena, TESTS_JOB_WORKER_COUNT);
+
+  JobCounter parent_counter = ZERO_STRUCT;
+  JobCounter child_counters[2] = ZERO_STRUCT;
+  for (u32 i = 0; i < ARRAY_COUNT(child_counters); i += 1)
+  {
+    job_counter_link_child(&parent_counter, &child_counters[i]);
+  }
+
+  u32 *executed_count = MEM_ARENA_PUSH_STRUCT_ZERO(arena, u32);
+  for (u32 i = 0; i < TESTS_JOB_OVERFLOW_COUNT; i += 1)
+  {
+    job_submit(system, job_count_once, executed_count, &child_counters[i & 1]);
+  }
+
+  job_wait_for_counter(system, &parent_counter);
+
+  assert_int_equal(ATOMIC_LOAD_ACQUIRE(executed_count), TESTS_JOB_OVERFLOW_COUNT);
+  assert_int_equal(ATOMIC_LOAD_ACQUIRE(&child_counters[0].value), 0);
+  assert_int_equal(ATOMIC_LOAD_ACQUIRE(&child_counters[1].value), 0);
+
+  job_system_destroy(system);
+}
+
+#define TESTS_ENTITY_MAX_COUNT 2000
+#define TESTS_ENTITY_OPERATION_COUNT 200000
+#define TESTS_ENTITY_DEAD_COUNT 512
+#define TESTS_ENTITY_DEFERRED_COUNT 5
+
+// NOTE(Ryan): Each live entity's transform holds its own handle, so a swap-remove that moves the wrong row,
+// or doesn't fix up the moved entity's slot, shows up as a mismatch
+INTERNAL void
+tests_entity_stamp(EntityWorld *world, EntityHandle handle)
+{
+  TransformComponent *transform = ENTITY_COMPONENT(world, handle, transforms);
+  transform->position.x = (f32)entity_handle_index(handle);
+  transform->position.y = (f32)entity_handle_generation(handle);
+}
+
+INTERNAL void
+tests_entity_check_stamp(EntityWorld *world, EntityHandle handle)
+{
+  assert_true(entity_is_alive(world, handle));
+
+  EntitySlot *slot = entity_slot(world, handle);
+  assert_true(world->archetypes[slot->archetype_index].entities[slot->row] == handle);
+
+  TransformComponent *transform = ENTITY_COMPONENT(world, handle, transforms);
+  assert_int_equal((u32)transform->position.x, entity_handle_index(handle));
+  assert_int_equal((u32)transform->position.y, entity_handle_generation(handle));
+}
+
+INTERNAL void
+tests_entity_remove(EntityHandle *handles, u32 *count, u32 index)
+{
+  *count -= 1;
+  handles[index] = handles[*count];
+}
+
+// NOTE(Ryan): Random mix of create, immediate destroy and deferred destroy, checked against a list of who should be alive.
+// Deferred batches queue each handle twice plus a stale one, which destroy_pending and the liveness check must drop
+INTERNAL void
+test_entity_handles_survive_random_create_destroy(UNUSED void **state)
+{
+  MemArena *arena = mem_arena_allocate(MB(64));
+  EntityWorld *world = entity_world_create(arena, TESTS_ENTITY_MAX_COUNT);
+
+  ENTITY_COMPONENT_FLAG archetype_flags[] = {
+    ENTITY_COMPONENT_FLAG_TRANSFORM,
+    ENTITY_COMPONENT_FLAG_TRANSFORM | ENTITY_COMPONENT_FLAG_SPRITE,
+    ENTITY_COMPONENT_FLAG_TRANSFORM | ENTITY_COMPONENT_FLAG_BOX_COLLIDER,
+  };
+
+  EntityHandle *alive = MEM_ARENA_PUSH_ARRAY(arena, EntityHandle, TESTS_ENTITY_MAX_COUNT);
+  u32 alive_count = 0;
+  EntityHandle dead[TESTS_ENTITY_DEAD_COUNT] = ZERO_STRUCT;
+  u32 dead_count = 0;
+
+  assert_false(entity_is_alive(world, ENTITY_HANDLE_INVALID));
+
+  u32 seed = 7;
+  for (u32 operation_i = 0; operation_i < TESTS_ENTITY_OPERATION_COUNT; operation_i += 1)
+  {
+    u32 operation = u32_rand_range(&seed, 10);
+    if (operation < 5 && alive_count < TESTS_ENTITY_MAX_COUNT)
+    {
+      EntityHandle handle = entity_create(world, archetype_flags[u32_rand_range(&seed, ARRAY_COUNT(archetype_flags))]);
+      tests_entity_stamp(world, handle);
+      alive[alive_count++] = handle;
+    }
+    else if (operation < 8 && alive_count > 0)
+    {
+      u32 alive_i = u32_rand_range(&seed, alive_count);
+      EntityHandle handle = alive[alive_i];
+      tests_entity_remove(alive, &alive_count, alive_i);
+
+      assert_true(entity_destroy(world, handle));
+      assert_false(entity_destroy(world, handle));
+      dead[dead_count++ % TESTS_ENTITY_DEAD_COUNT] = handle;
+    }
+    else if (alive_count > 0)
+    {
+      EntityHandle queued[TESTS_ENTITY_DEFERRED_COUNT] = ZERO_STRUCT;
+      u32 queued_count = 0;
+      for (u32 deferred_i = 0; deferred_i < TESTS_ENTITY_DEFERRED_COUNT; deferred_i += 1)
+      {
+        EntityHandle handle = alive[u32_rand_range(&seed, alive_count)];
+        entity_destroy_deferred(world, handle);
+        entity_destroy_deferred(world, handle);
+
+        b32 is_queued = false;
+        for (u32 queued_i = 0; queued_i < queued_count; queued_i += 1)
+        {
+          is_queued |= (queued[queued_i] == handle);
+        }
+        if (!is_queued)
+        {
+          queued[queued_count++] = handle;
+        }
+      }
+      if (dead_count > 0)
+      {
+        entity_destroy_deferred(world, dead[u32_rand_range(&seed, MIN(dead_count, TESTS_ENTITY_DEAD_COUNT))]);
+      }
+
+      assert_int_equal(world->pending_destroy_count, queued_count);
+      for (u32 queued_i = 0; queued_i < queued_count; queued_i += 1)
+      {
+        tests_entity_check_stamp(world, queued[queued_i]);
+      }
+
+      entity_world_sync(world);
+
+      assert_int_equal(world->pending_destroy_count, 0);
+      for (u32 queued_i = 0; queued_i < queued_count; queued_i += 1)
+      {
+        assert_false(entity_is_alive(world, queued[queued_i]));
+        dead[dead_count++ % TESTS_ENTITY_DEAD_COUNT] = queued[queued_i];
+        for (u32 alive_i = 0; alive_i < alive_count; alive_i += 1)
+        {
+          if (alive[alive_i] == queued[queued_i])
+          {
+            tests_entity_remove(alive, &alive_count, alive_i);
+            break;
+          }
+        }
+      }
+    }
+  }
+
+  assert_int_equal(world->entity_count, alive_count);
+  for (u32 alive_i = 0; alive_i < alive_count; alive_i += 1)
+  {
+    tests_entity_check_stamp(world, alive[alive_i]);
+  }
+  // NOTE(Ryan): Their slots have been reused many times over, so aliasing would show here
+  for (u32 dead_i = 0; dead_i < MIN(dead_count, TESTS_ENTITY_DEAD_COUNT); dead_i += 1)
+  {
+    assert_false(entity_is_alive(world, dead[dead_i]));
+  }
+}
+
+#define TESTS_ENTITY_PARALLEL_COUNT 100000
+#define TESTS_ENTITY_PARALLEL_THREAD_COUNT 8
+
+typedef struct EntityDeferThread EntityDeferThread;
+struct EntityDeferThread
+{
+  EntityWorld *world;
+  EntityHandle *handles;
+};
+
+// NOTE(Ryan): Every thread queues the same even handles, so each is contended by all of them
+INTERNAL void *
+entity_defer_thread(void *arg)
+{
+  EntityDeferThread *thread = (EntityDeferThread *)arg;
+
+  for (u32 handle_i = 0; handle_i < TESTS_ENTITY_PARALLEL_COUNT; handle_i += 2)
+  {
+    entity_destroy_deferred(thread->world, thread->handles[handle_i]);
+  }
+
+  return NULL;
+}
+
+INTERNAL void
+test_entity_parallel_deferred_destroy_queues_once(UNUSED void **state)
+{
+  MemArena *arena = mem_arena_allocate(MB(256));
+  EntityWorld *world = entity_world_create(arena, TESTS_ENTITY_PARALLEL_COUNT);
+
+  EntityHandle *handles = MEM_ARENA_PUSH_ARRAY(arena, EntityHandle, TESTS_ENTITY_PARALLEL_COUNT);
+  for (u32 handle_i = 0; handle_i < TESTS_ENTITY_PARALLEL_COUNT; handle_i += 1)
+  {
+    ENTITY_COMPONENT_FLAG flags = (handle_i % 2 == 0) ? ENTITY_COMPONENT_FLAG_TRANSFORM : 
+                                  (ENTITY_COMPONENT_FLAG_TRANSFORM | ENTITY_COMPONENT_FLAG_SPRITE);
+    handles[handle_i] = entity_create(world, flags);
+    tests_entity_stamp(world, handles[handle_i]);
+  }
+
+  EntityDeferThread thread = ZERO_STRUCT;
+  thread.world = world;
+  thread.handles = handles;
+  pthread_t pthreads[TESTS_ENTITY_PARALLEL_THREAD_COUNT] = ZERO_STRUCT;
+  for (u32 thread_i = 0; thread_i < TESTS_ENTITY_PARALLEL_THREAD_COUNT; thread_i += 1)
+  {
+    pthread_create(&pthreads[thread_i], NULL, entity_defer_thread, &thread);
+  }
+  for (u32 thread_i = 0; thread_i < TESTS_ENTITY_PARALLEL_THREAD_COUNT; thread_i += 1)
+  {
+    pthread_join(pthreads[thread_i], NULL);
+  }
+
+  assert_int_equal(world->pending_destroy_count, TESTS_ENTITY_PARALLEL_COUNT / 2);
+
+  entity_world_sync(world);
+
+  assert_int_equal(world->entity_count, TESTS_ENTITY_PARALLEL_COUNT / 2);
+  for (u32 handle_i = 0; handle_i < TESTS_ENTITY_PARALLEL_COUNT; handle_i += 1)
+  {
+    if (handle_i % 2 == 0)
+    {
+      assert_false(entity_is_alive(world, handles[handle_i]));
+    }
+    else
+    {
+      tests_entity_check_stamp(world, handles[handle_i]);
+    }
+  }
+}
+
+// NOTE(Ryan): Movers lerp from their pre-tick position; sprites without a rigid body are drawn where they are at any alpha
+INTERNAL void
+test_sprite_draws_interpolate_between_ticks(UNUSED void **state)
+{
+  MemArena *arena = mem_arena_allocate(MB(16));
+  EntityWorld *world = entity_world_create(arena, 2);
+
+  EntityHandle mover = entity_create(world, ENTITY_COMPONENT_FLAG_TRANSFORM | ENTITY_COMPONENT_FLAG_RIGID_BODY | 
+                                            ENTITY_COMPONENT_FLAG_SPRITE);
+  ENTITY_COMPONENT(world, mover, transforms)->position = vec2_f32(10.0f, 20.0f);
+  ENTITY_COMPONENT(world, mover, rigid_bodies)->velocity = vec2_f32(4.0f, -8.0f);
+  ENTITY_COMPONENT(world, mover, sprites)->z_index = 1;
+
+  EntityHandle still = entity_create(world, ENTITY_COMPONENT_FLAG_TRANSFORM | ENTITY_COMPONENT_FLAG_SPRITE);
+  ENTITY_COMPONENT(world, still, transforms)->position = vec2_f32(-3.0f, 5.0f);
+
+  entity_update_movement(world, 0.5f);
+  SpriteDrawList draws = entity_build_sprite_draws(arena, world);
+  assert_int_equal(draws.count, 2);
+
+  // NOTE(Ryan): Back to front, so z_index 0 is first
+  SpriteDraw *still_draw = &draws.draws[0];
+  SpriteDraw *mover_draw = &draws.draws[1];
+
+  f32 alphas[] = {0.0f, 0.25f, 0.5f, 1.0f};
+  for (u32 alpha_i = 0; alpha_i < ARRAY_COUNT(alphas); alpha_i += 1)
+  {
+    f32 alpha = alphas[alpha_i];
+
+    Vec2F32 mover_position = sprite_draw_interpolated_position(mover_draw, alpha);
+    assert_true(f32_abs(mover_position.x - (10.0f + 2.0f * alpha)) <= 0.0001f);
+    assert_true(f32_abs(mover_position.y - (20.0f - 4.0f * alpha)) <= 0.0001f);
+
+    Vec2F32 still_position = sprite_draw_interpolated_position(still_draw, alpha);
+    assert_true(f32_abs(still_position.x - -3.0f) <= 0.0001f);
+    assert_true(f32_abs(still_position.y - 5.0f) <= 0.0001f);
+  }
+}
+
+#define TESTS_SCHEDULE_WORKER_COUNT 4
+#define TESTS_SCHEDULE_FRAME_COUNT 3000
+#define TESTS_SCHEDULE_SYSTEM_COUNT 12
+#define TESTS_SCHEDULE_ENTITY_COUNT 20000
+// NOTE(Ryan): Pauses per job, so independent systems are likely to overlap
+#define TESTS_SCHEDULE_SPIN_COUNT 200
+
+// NOTE(Ryan): Stamps come from one counter, so a system's span is its first chunk begin to its last chunk end
+GLOBAL u32 tests_schedule_sequence;
+GLOBAL u32 tests_schedule_begins[TESTS_SCHEDULE_SYSTEM_COUNT];
+GLOBAL u32 tests_schedule_ends[TESTS_SCHEDULE_SYSTEM_COUNT];
+GLOBAL u32 tests_schedule_rows[TESTS_SCHEDULE_SYSTEM_COUNT];
+
+INTERNAL void
+tests_schedule_begin(u32 system_index)
+{
+  u32 stamp = ATOMIC_ADD_SEQ_CST(&tests_schedule_sequence, 1) + 1;
+  u32 begin = ATOMIC_LOAD_SEQ_CST(&tests_schedule_begins[system_index]);
+  while ((begin == 0 || stamp < begin) && !ATOMIC_CAS_SEQ_CST(&tests_schedule_begins[system_index], &begin, stamp)) {}
+}
+
+INTERNAL void
+tests_schedule_end(u32 system_index)
+{
+  u32 stamp = ATOMIC_ADD_SEQ_CST(&tests_schedule_sequence, 1) + 1;
+  u32 end = ATOMIC_LOAD_SEQ_CST(&tests_schedule_ends[system_index]);
+  while (end < stamp && !ATOMIC_CAS_SEQ_CST(&tests_schedule_ends[system_index], &end, stamp)) {}
+}
+
+// NOTE(Ryan): Systems only know who they are by their function, so each slot gets its own pair
+#define TESTS_SCHEDULE_SYSTEM(index) \
+  INTERNAL void \
+  tests_schedule_whole_##index(UNUSED SystemContext *context) \
+  { \
+    tests_schedule_begin(index); \
+    for (u32 spin_i = 0; spin_i < TESTS_SCHEDULE_SPIN_COUNT * 10; spin_i += 1) CPU_PAUSE(); \
+    tests_schedule_end(index); \
+  } \
+  INTERNAL void \
+  tests_schedule_chunk_##index(UNUSED SystemContext *context, UNUSED EntityArchetype *archetype, u32 row_begin, u32 row_end) \
+  { \
+    tests_schedule_begin(index); \
+    ATOMIC_ADD_SEQ_CST(&tests_schedule_rows[index], row_end - row_begin); \
+    for (u32 spin_i = 0; spin_i < TESTS_SCHEDULE_SPIN_COUNT; spin_i += 1) CPU_PAUSE(); \
+    tests_schedule_end(index); \
+  }
+
+TESTS_SCHEDULE_SYSTEM(0)
+TESTS_SCHEDULE_SYSTEM(1)
+TESTS_SCHEDULE_SYSTEM(2)
+TESTS_SCHEDULE_SYSTEM(3)
+TESTS_SCHEDULE_SYSTEM(4)
+TESTS_SCHEDULE_SYSTEM(5)
+TESTS_SCHEDULE_SYSTEM(6)
+TESTS_SCHEDULE_SYSTEM(7)
+TESTS_SCHEDULE_SYSTEM(8)
+TESTS_SCHEDULE_SYSTEM(9)
+TESTS_SCHEDULE_SYSTEM(10)
+TESTS_SCHEDULE_SYSTEM(11)
+
+GLOBAL system_func tests_schedule_whole_funcs[TESTS_SCHEDULE_SYSTEM_COUNT] = {
+  tests_schedule_whole_0, tests_schedule_whole_1, tests_schedule_whole_2, tests_schedule_whole_3,
+  tests_schedule_whole_4, tests_schedule_whole_5, tests_schedule_whole_6, tests_schedule_whole_7,
+  tests_schedule_whole_8, tests_schedule_whole_9, tests_schedule_whole_10, tests_schedule_whole_11,
+};
+
+GLOBAL system_chunk_func tests_schedule_chunk_funcs[TESTS_SCHEDULE_SYSTEM_COUNT] = {
+  tests_schedule_chunk_0, tests_schedule_chunk_1, tests_schedule_chunk_2, tests_schedule_chunk_3,
+  tests_schedule_chunk_4, tests_schedule_chunk_5, tests_schedule_chunk_6, tests_schedule_chunk_7,
+  tests_schedule_chunk_8, tests_schedule_chunk_9, tests_schedule_chunk_10, tests_schedule_chunk_11,
+};
+
+// NOTE(Ryan): Random systems over two components and two resources, each frame.
+// A pair that conflicts must run strictly in add order; chunked systems must cover every matching row exactly once
+INTERNAL void
+test_schedule_conflicting_systems_never_overlap(UNUSED void **state)
+{
+  MemArena *arena = mem_arena_allocate(GB(1));
+  EntityWorld *world = entity_world_create(arena, TESTS_SCHEDULE_ENTITY_COUNT);
+  for (u32 entity_i = 0; entity_i < TESTS_SCHEDULE_ENTITY_COUNT; entity_i += 1)
+  {
+    ENTITY_COMPONENT_FLAG flags = (entity_i % 3 == 0) ? ENTITY_COMPONENT_FLAG_TRANSFORM : 
+                                  (ENTITY_COMPONENT_FLAG_TRANSFORM | ENTITY_COMPONENT_FLAG_SPRITE);
+    entity_create(world, flags);
+  }
+
+  JobSystem *job_system = job_system_create(arena, TESTS_SCHEDULE_WORKER_COUNT);
+  Schedule *schedule = schedule_create(arena, job_system, KB(64));
+
+  u32 access_flags[] = {
+    ENTITY_COMPONENT_FLAG_TRANSFORM, 
+    ENTITY_COMPONENT_FLAG_SPRITE, 
+    SYSTEM_RESOURCE_FLAG_FIRST, 
+    SYSTEM_RESOURCE_FLAG_FIRST << 1,
+  };
+
+  u32 seed = 3;
+  for (u32 frame_i = 0; frame_i < TESTS_SCHEDULE_FRAME_COUNT; frame_i += 1)
+  {
+    MemArenaTemp frame_temp = mem_arena_temp_begin(arena);
+
+    tests_schedule_sequence = 0;
+    memset(tests_schedule_begins, 0, sizeof(tests_schedule_begins));
+    memset(tests_schedule_ends, 0, sizeof(tests_schedule_ends));
+    memset(tests_schedule_rows, 0, sizeof(tests_schedule_rows));
+
+    u32 system_count = 1 + u32_rand_range(&seed, TESTS_SCHEDULE_SYSTEM_COUNT);
+    SystemDesc descs[TESTS_SCHEDULE_SYSTEM_COUNT] = ZERO_STRUCT;
+    schedule_begin_frame(schedule);
+    for (u32 system_i = 0; system_i < system_count; system_i += 1)
+    {
+      SystemDesc *desc = &descs[system_i];
+      desc->name = "random";
+      for (u32 access_i = 0; access_i < ARRAY_COUNT(access_flags); access_i += 1)
+      {
+        u32 access = u32_rand_range(&seed, 4);
+        if (access == 0)
+        {
+          desc->reads |= access_flags[access_i];
+        }
+        else if (access == 1)
+        {
+          desc->writes |= access_flags[access_i];
+        }
+      }
+      if (u32_rand_range(&seed, 2) == 0)
+      {
+        desc->func = tests_schedule_whole_funcs[system_i];
+      }
+      else
+      {
+        desc->chunk_func = tests_schedule_chunk_funcs[system_i];
+      }
+      schedule_add_system(schedule, desc);
+    }
+
+    SystemContext context = ZERO_STRUCT;
+    context.world = world;
+    schedule_run(schedule, arena, &context);
+
+    for (u32 system_i = 0; system_i < system_count; system_i += 1)
+    {
+      SystemDesc *desc = &descs[system_i];
+      if (desc->func != NULL)
+      {
+        assert_int_not_equal(tests_schedule_begins[system_i], 0);
+      }
+      else
+      {
+        u32 components = (desc->reads | desc->writes) & (SYSTEM_RESOURCE_FLAG_FIRST - 1);
+        u32 expected_rows = 0;
+        for (u32 archetype_i = 0; archetype_i < world->archetype_count; archetype_i += 1)
+        {
+          if (HAS_FLAGS_ALL(world->archetypes[archetype_i].component_flags, components))
+          {
+            expected_rows += world->archetypes[archetype_i].count;
+          }
+        }
+        assert_int_equal(tests_schedule_rows[system_i], expected_rows);
+      }
+
+      for (u32 later_i = system_i + 1; later_i < system_count; later_i += 1)
+      {
+        SystemDesc *later = &descs[later_i];
+        b32 is_conflicting = ((desc->writes & (later->reads | later->writes)) != 0 ||
+                              (desc->reads & later->writes) != 0);
+        // NOTE(Ryan): A chunked system with no matching rows never stamps
+        if (is_conflicting && tests_schedule_begins[system_i] != 0 && tests_schedule_begins[later_i] != 0)
+        {
+          assert_true(tests_schedule_ends[system_i] < tests_schedule_begins[later_i]);
+        }
+      }
+    }
+
+    mem_arena_temp_end(frame_temp);
+  }
+
+  job_system_destroy(job_system);
+}
+
+#define TESTS_DETERMINISM_TICK_COUNT 60
+#define TESTS_DETERMINISM_MAX_COUNT 60000
+#define TESTS_DETERMINISM_INITIAL_COUNT 20000
+#define TESTS_DETERMINISM_SPAWN_COUNT 200
+#define TESTS_DETERMINISM_DELTA 0.5f
+
+typedef u32 TESTS_DETERMINISM_MODE;
+enum
+{
+  TESTS_DETERMINISM_MODE_SERIAL,
+  TESTS_DETERMINISM_MODE_SERIAL_REVERSE,
+  TESTS_DETERMINISM_MODE_SCHEDULED,
+};
+
+INTERNAL void
+tests_determinism_spawn(EntityWorld *world, u32 *seed, u32 count)
+{
+  for (u32 spawn_i = 0; spawn_i < count; spawn_i += 1)
+  {
+    EntityHandle handle = entity_create(world, ENTITY_COMPONENT_FLAG_TRANSFORM | ENTITY_COMPONENT_FLAG_RIGID_BODY | 
+                                               ENTITY_COMPONENT_FLAG_SPRITE | ENTITY_COMPONENT_FLAG_BOX_COLLIDER);
+    TransformComponent *transform = ENTITY_COMPONENT(world, handle, transforms);
+    transform->position = vec2_f32((f32)u32_rand_range(seed, 1000), (f32)u32_rand_range(seed, 1000));
+    transform->scale = vec2_f32(1.0f, 1.0f);
+    ENTITY_COMPONENT(world, handle, rigid_bodies)->velocity = vec2_f32((f32)u32_rand_range(seed, 100) - 50.0f, 3.0f);
+    ENTITY_COMPONENT(world, handle, sprites)->dimensions = vec2_f32(8.0f, 8.0f);
+    ENTITY_COMPONENT(world, handle, box_colliders)->size = vec2_f32(8.0f, 8.0f);
+  }
+}
+
+// NOTE(Ryan): Queues in reverse row order when asked, so queue order differs from the forward run
+INTERNAL void
+tests_determinism_destroy_out_of_bounds(EntityWorld *world, EntityArchetype *archetype, u32 row_begin, u32 row_end, 
+                                        b32 is_reverse)
+{
+  for (u32 row_i = row_begin; row_i < row_end; row_i += 1)
+  {
+    u32 row = is_reverse ? (row_end - 1 - (row_i - row_begin)) : row_i;
+    Vec2F32 position = archetype->transforms[row].position;
+    if (position.y > 900.0f || position.x < 0.0f)
+    {
+      entity_destroy_deferred(world, archetype->entities[row]);
+    }
+  }
+}
+
+INTERNAL void
+tests_determinism_movement_system(UNUSED SystemContext *context, EntityArchetype *archetype, u32 row_begin, u32 row_end)
+{
+  entity_update_movement_rows(archetype, row_begin, row_end, TESTS_DETERMINISM_DELTA);
+}
+
+// NOTE(Ryan): Alternate chunks run in reverse, on top of whatever order the workers happen to queue in
+INTERNAL void
+tests_determinism_bounds_system(SystemContext *context, EntityArchetype *archetype, u32 row_begin, u32 row_end)
+{
+  b32 is_reverse = ((row_begin / SCHEDULE_CHUNK_ROW_COUNT) & 1);
+  tests_determinism_destroy_out_of_bounds(context->world, archetype, row_begin, row_end, is_reverse);
+}
+
+INTERNAL void
+tests_determinism_collision_system(SystemContext *context)
+{
+  ColliderSet colliders = entity_gather_colliders(context->arena, context->world);
+  CollisionCandidates candidates = collision_broad_phase(context->arena, &colliders, 128.0f);
+  CollisionPairs pairs = collision_narrow_phase(context->arena, &candidates);
+  for (u32 pair_i = 0; pair_i < pairs.count; pair_i += 1)
+  {
+    entity_destroy_deferred(context->world, colliders.handles[pairs.b[pair_i]]);
+  }
+}
+
+GLOBAL SystemDesc tests_determinism_systems[] = {
+  {"movement", ENTITY_COMPONENT_FLAG_RIGID_BODY, ENTITY_COMPONENT_FLAG_TRANSFORM, NULL, tests_determinism_movement_system},
+  {"bounds", ENTITY_COMPONENT_FLAG_TRANSFORM, 0, NULL, tests_determinism_bounds_system},
+  {"collision", ENTITY_COMPONENT_FLAG_TRANSFORM | ENTITY_COMPONENT_FLAG_BOX_COLLIDER, SYSTEM_RESOURCE_FLAG_FIRST, 
+   tests_determinism_collision_system, NULL},
+};
+
+// NOTE(Ryan): Movement, out of bounds destroys and collision destroys every tick, then a sync and fresh spawns.
+// Writes each tick's world checksum to checksums
+INTERNAL void
+tests_determinism_run(MemArena *arena, TESTS_DETERMINISM_MODE mode, u32 worker_count, u64 *checksums)
+{
+  MemArenaTemp run_temp = mem_arena_temp_begin(arena);
+
+  EntityWorld *world = entity_world_create(arena, TESTS_DETERMINISM_MAX_COUNT);
+  u32 seed = 7;
+  tests_determinism_spawn(world, &seed, TESTS_DETERMINISM_INITIAL_COUNT);
+
+  JobSystem *job_system = NULL;
+  Schedule *schedule = NULL;
+  if (mode == TESTS_DETERMINISM_MODE_SCHEDULED)
+  {
+    job_system = job_system_create(arena, worker_count);
+    schedule = schedule_create(arena, job_system, MB(256));
+  }
+  MemArena *system_arena = mem_arena_allocate(MB(256));
+
+  for (u32 tick_i = 0; tick_i < TESTS_DETERMINISM_TICK_COUNT; tick_i += 1)
+  {
+    MemArenaTemp tick_temp = mem_arena_temp_begin(arena);
+
+    SystemContext context = ZERO_STRUCT;
+    context.world = world;
+    if (mode == TESTS_DETERMINISM_MODE_SCHEDULED)
+    {
+      schedule_begin_frame(schedule);
+      for (u32 system_i = 0; system_i < ARRAY_COUNT(tests_determinism_systems); system_i += 1)
+      {
+        schedule_add_system(schedule, &tests_determinism_systems[system_i]);
+      }
+      schedule_run(schedule, arena, &context);
+    }
+    else
+    {
+      entity_update_movement(world, TESTS_DETERMINISM_DELTA);
+      for (u32 archetype_i = 0; archetype_i < world->archetype_count; archetype_i += 1)
+      {
+        EntityArchetype *archetype = &world->archetypes[archetype_i];
+        tests_determinism_destroy_out_of_bounds(world, archetype, 0, archetype->count, 
+                                                (mode == TESTS_DETERMINISM_MODE_SERIAL_REVERSE));
+      }
+      mem_arena_clear(system_arena);
+      context.arena = system_arena;
+      tests_determinism_collision_system(&context);
+    }
+
+    entity_world_sync(world);
+    tests_determinism_spawn(world, &seed, TESTS_DETERMINISM_SPAWN_COUNT);
+    checksums[tick_i] = entity_world_checksum(world);
+
+    mem_arena_temp_end(tick_temp);
+  }
+
+  if (job_system != NULL)
+  {
+    job_system_destroy(job_system);
+  }
+  mem_arena_temp_end(run_temp);
+}
+
+// NOTE(Ryan): Destroy queue order depends on row walk direction and worker timing.
+// entity_world_sync() has to apply it in a fixed order, or freed slots get reused differently and the worlds diverge
+INTERNAL void
+test_schedule_ticks_are_deterministic(UNUSED void **state)
+{
+  MemArena *arena = mem_arena_allocate(GB(2));
+  u64 *expected_checksums = MEM_ARENA_PUSH_ARRAY(arena, u64, TESTS_DETERMINISM_TICK_COUNT);
+  u64 *checksums = MEM_ARENA_PUSH_ARRAY(arena, u64, TESTS_DETERMINISM_TICK_COUNT);
+
+  tests_determinism_run(arena, TESTS_DETERMINISM_MODE_SERIAL, 0, expected_checksums);
+
+  tests_determinism_run(arena, TESTS_DETERMINISM_MODE_SERIAL_REVERSE, 0, checksums);
+  assert_memory_equal(checksums, expected_checksums, sizeof(u64) * TESTS_DETERMINISM_TICK_COUNT);
+
+  u32 worker_counts[] = {2, 4};
+  for (u32 worker_count_i = 0; worker_count_i < ARRAY_COUNT(worker_counts); worker_count_i += 1)
+  {
+    tests_determinism_run(arena, TESTS_DETERMINISM_MODE_SCHEDULED, worker_counts[worker_count_i], checksums);
+    assert_memory_equal(checksums, expected_checksums, sizeof(u64) * TESTS_DETERMINISM_TICK_COUNT);
+  }
+}
+
+#define TESTS_LANE_RANDOM_ITERATION_COUNT 1000
+
+// NOTE(Ryan): Scalar "lowbias32", as lane_random_hash()
+INTERNAL u32
+tests_random_hash(u32 x)
+{
+  x ^= x >> 16;
+  x *= 0x7FEB352D;
+  x ^= x >> 15;
+  x *= 0x846CA68B;
+  x ^= x >> 16;
+
+  return x;
+}
+
+// NOTE(Ryan): Every draw must be a pure function of (seed, stream, sample index, counter), 
+// so each lane is recomputed on its own with the scalar hash. Runs at the tests target's default width
+INTERNAL void
+test_lane_random_matches_scalar_hash(UNUSED void **state)
+{
+  for (u32 iteration_i = 0; iteration_i < TESTS_LANE_RANDOM_ITERATION_COUNT; iteration_i += 1)
+  {
+    u32 seed = iteration_i * 7919;
+    u32 stream = iteration_i ^ 0xA5A5;
+    u32 first_sample_index = iteration_i * LANE_WIDTH;
+    u32 counter = iteration_i % 5;
+
+    LaneRandom random = lane_random_seed(lane_random_stream_key(seed, stream), 
+                                         lane_u32_index() + lane_u32(first_sample_index));
+    random.counter = counter;
+    LaneU32 draw = lane_random_next_u32(&random);
+    LaneF32 unilateral = lane_random_unilateral(&random);
+    LaneF32 bilateral = lane_random_bilateral(&random);
+    assert_int_equal(random.counter, counter + 3);
+
+    u32 stream_key = tests_random_hash(seed ^ tests_random_hash(stream));
+    for (u32 lane_i = 0; lane_i < LANE_WIDTH; lane_i += 1)
+    {
+      u32 key = tests_random_hash(stream_key + first_sample_index + lane_i);
+      assert_int_equal(lane_u32_extract(draw, lane_i), tests_random_hash(key ^ (counter * 0x9E3779B9)));
+
+      f32 expected_unilateral = (f32)(tests_random_hash(key ^ ((counter + 1) * 0x9E3779B9)) >> 8) * (1.0f / 16777216.0f);
+      assert_true(f32_abs(lane_f32_extract(unilateral, lane_i) - expected_unilateral) <= 0.0f);
+      assert_true(lane_f32_extract(unilateral, lane_i) < 1.0f);
+
+      f32 expected_bilateral = -1.0f + 2.0f * (f32)(tests_random_hash(key ^ ((counter + 2) * 0x9E3779B9)) >> 8) * (1.0f / 16777216.0f);
+      assert_true(f32_abs(lane_f32_extract(bilateral, lane_i) - expected_bilateral) <= 0.0f);
+    }
+  }
+}
+
+// NOTE(Ryan): Rate at each width the CPU supports, with speedup over scalar
+INTERNAL void
+bench_lanes(MemArena *arena)
+{
+  printf("Lane ops: million elements per second\n");
+
+  f64 scalar_rate = 0.0;
+  for (u32 isa_i = 0; isa_i < ARRAY_COUNT(tests_lane_isas); isa_i += 1)
+  {
+    TestsLaneISA *isa = &tests_lane_isas[isa_i];
+    if (tests_lane_isa_is_supported(isa))
+    {
+      f64 rate = isa->bench(arena);
+      if (isa->lane_width == 1)
+      {
+        scalar_rate = rate;
+      }
+      printf("  %-6s (width %2u): %8.2fM/s, %.2fx scalar\n", isa->name, isa->lane_width, rate, rate / scalar_rate);
+    }
+  }
+}
+
+#define BENCH_QUEUE_ITEM_COUNT 1000000
+#define BENCH_QUEUE_CAPACITY 1024
+
+// NOTE(Ryan): Million items per second through one MPMC queue shared by every pair, then through a ring per pair.
+// Same threads as the stress tests, so rings mix single and batch calls
+INTERNAL void
+bench_queues(MemArena *arena)
+{
+  u32 max_pair_count = CLAMP(1, (u32)get_nprocs() / 2, TESTS_QUEUE_MAX_PAIR_COUNT);
+  printf("Queue throughput: %u items per producer, capacity %u\n", BENCH_QUEUE_ITEM_COUNT, BENCH_QUEUE_CAPACITY);
+
+  for (u32 pair_count = 1; pair_count <= max_pair_count; pair_count += 1)
+  {
+    MemArenaTemp temp = mem_arena_temp_begin(arena);
+
+    QueueStressShared shared = ZERO_STRUCT;
+    shared.queue = mpmc_queue_create(arena, sizeof(u64), BENCH_QUEUE_CAPACITY);
+    shared.producer_count = pair_count;
+    shared.item_count = BENCH_QUEUE_ITEM_COUNT;
+    shared.seen_counts = MEM_ARENA_PUSH_ARRAY_ZERO(arena, u32, pair_count * shared.item_count);
+
+    QueueStressThread threads[2 * TESTS_QUEUE_MAX_PAIR_COUNT] = ZERO_STRUCT;
+    pthread_t pthreads[2 * TESTS_QUEUE_MAX_PAIR_COUNT] = ZERO_STRUCT;
+    u64 mpmc_start_ns = linux_get_ns();
+    for (u32 thread_i = 0; thread_i < 2 * pair_count; thread_i += 1)
+    {
+      threads[thread_i].shared = &shared;
+      threads[thread_i].index = thread_i % pair_count;
+      tests_thread_func func = (thread_i < pair_count) ? mpmc_stress_producer : mpmc_stress_consumer;
+      pthread_create(&pthreads[thread_i], NULL, func, &threads[thread_i]);
+    }
+    for (u32 thread_i = 0; thread_i < 2 * pair_count; thread_i += 1)
+    {
+      pthread_join(pthreads[thread_i], NULL);
+    }
+    u64 mpmc_ns = linux_get_ns() - mpmc_start_ns;
+
+    SPSCStressThread pairs[TESTS_QUEUE_MAX_PAIR_COUNT] = ZERO_STRUCT;
+    for (u32 pair_i = 0; pair_i < pair_count; pair_i += 1)
+    {
+      pairs[pair_i].ring = spsc_ring_create(arena, sizeof(u32), BENCH_QUEUE_CAPACITY);
+      pairs[pair_i].item_count = BENCH_QUEUE_ITEM_COUNT;
+    }
+    u64 spsc_start_ns = linux_get_ns();
+    for (u32 pair_i = 0; pair_i < pair_count; pair_i += 1)
+    {
+      pthread_create(&pthreads[2 * pair_i], NULL, spsc_stress_producer, &pairs[pair_i]);
+      pthread_create(&pthreads[2 * pair_i + 1], NULL, spsc_stress_consumer, &pairs[pair_i]);
+    }
+    for (u32 thread_i = 0; thread_i < 2 * pair_count; thread_i += 1)
+    {
+      pthread_join(pthreads[thread_i], NULL);
+    }
+    u64 spsc_ns = linux_get_ns() - spsc_start_ns;
+
+    f64 item_count = (f64)pair_count * BENCH_QUEUE_ITEM_COUNT;
+    printf("  %u pairs: mpmc %7.2fM/s, spsc %7.2fM/s\n", pair_count,
+           item_count / (mpmc_ns / 1000.0), item_count / (spsc_ns / 1000.0));
+
+    mem_arena_temp_end(temp);
+  }
+}
+
+int
+main(void)
+{
+  const struct CMUnitTest queue_tests[] = {
+    cmocka_unit_test(test_mpmc_queue_delivers_every_item_once),
+    cmocka_unit_test(test_spsc_ring_delivers_every_item_in_order),
+  };
+
+  const struct CMUnitTest job_tests[] = {
+    cmocka_unit_test(test_job_foreign_signal_wakes_sleeping_worker),
+    cmocka_unit_test(test_job_overflow_completes_under_parent_counter),
+  };
+
+  const struct CMUnitTest entity_tests[] = {
+    cmocka_unit_test(test_entity_handles_survive_random_create_destroy),
+    cmocka_unit_test(test_entity_parallel_deferred_destroy_queues_once),
+    cmocka_unit_test(test_sprite_draws_interpolate_between_ticks),
+  };
+
+  const struct CMUnitTest schedule_tests[] = {
+    cmocka_unit_test(test_schedule_conflicting_systems_never_overlap),
+    cmocka_unit_test(test_schedule_ticks_are_deterministic),
+  };
+
+  const struct CMUnitTest lane_random_tests[] = {
+    cmocka_unit_test(test_lane_random_matches_scalar_hash),
+  };
+
+  int failed_count = 0;
+  failed_count += cmocka_run_group_tests_name("queue", queue_tests, NULL, NULL);
+  failed_count += cmocka_run_group_tests_name("job", job_tests, NULL, NULL);
+  failed_count += cmocka_run_group_tests_name("entity", entity_tests, NULL, NULL);
+  failed_count += cmocka_run_group_tests_name("schedule", schedule_tests, NULL, NULL);
+  failed_count += cmocka_run_group_tests_name("lane random", lane_random_tests, NULL, NULL);
+
+  __builtin_cpu_init();
+  for (u32 isa_i = 0; isa_i < ARRAY_COUNT(tests_lane_isas); isa_i += 1)
+  {
+    TestsLaneISA *isa = &tests_lane_isas[isa_i];
+    if (tests_lane_isa_is_supported(isa))
+    {
+      failed_count += isa->tests();
+    }
+    else
+    {
+      printf("Skipping lane tests for %s, not supported by this CPU\n", isa->name);
+    }
+  }
+
+  if (failed_count == 0)
+  {
+    MemArena *bench_arena = mem_arena_allocate(GB(1));
+    bench_queues(bench_arena);
+    bench_lanes(bench_arena);
+  }
+
+  return failed_count;
+}